@@ -425,7 +425,10 @@ let package = Package(
         "connections/implementation/base_pcp_handler_test.cc",
         "connections/implementation/injected_bluetooth_device_store_test.cc",
         "connections/implementation/internal_payload_factory_test.cc",
+        "connections/implementation/keyed_serial_executor_test.cc",
         "connections/implementation/client_proxy_test.cc",
+        "connections/implementation/partial_file_store_test.cc",
+        "connections/implementation/payload_frame_scheduler_test.cc",
         "connections/implementation/payload_manager_test.cc",
         "connections/implementation/offline_frames_validator_test.cc",
         "connections/implementation/service_controller_router_test.cc",
@@ -453,11 +456,15 @@ let package = Package(
         "connections/implementation/mediums/wifi_test.cc",
         "connections/implementation/endpoint_channel_manager_test.cc",
         "connections/implementation/bwu_manager_test.cc",
+        "connections/implementation/chunk_read_ahead_test.cc",
+        "connections/implementation/chunk_size_controller_test.cc",
         "connections/implementation/base_bwu_handler_test.cc",
         "connections/implementation/endpoint_manager_test.cc",
         "connections/implementation/bluetooth_device_name_test.cc",
         "connections/implementation/wifi_lan_service_info_test.cc",
+        "connections/implementation/write_behind_output_file_test.cc",
         "connections/implementation/pcp_manager_test.cc",
+        "connections/implementation/timer_wheel_test.cc",
         "connections/implementation/ble_advertisement_test.cc",
         "connections/implementation/base_endpoint_channel_test.cc",
         "connections/v3/connections_device_test.cc",
@@ -487,10 +494,13 @@ let package = Package(
         "internal/platform/cancelable_alarm_test.cc",
         "internal/platform/crypto_test.cc",
         "internal/platform/byte_array_test.cc",
+        "internal/platform/byte_buffer_test.cc",
         "internal/platform/bluetooth_utils_test.cc",
         "internal/platform/credential_storage_impl_test.cc",
         "internal/platform/input_stream_test.cc",
+        "internal/platform/output_stream_test.cc",
         "internal/platform/single_thread_executor_test.cc",
+        "internal/platform/cached_thread_pool_test.cc",
         "internal/platform/scheduled_executor_test.cc",
         "internal/platform/count_down_latch_test.cc",
         "internal/platform/pipe_test.cc",
@@ -522,6 +532,7 @@ let package = Package(
         "internal/platform/implementation/apple/atomic_boolean_test.cc",
         "internal/platform/implementation/apple/atomic_uint32_test.cc",
         "internal/platform/implementation/shared/file_test.cc",
+        "internal/platform/implementation/shared/mmap_input_file_test.cc",
         "internal/platform/atomic_boolean_test.cc",
         "internal/platform/exception_test.cc",
         "internal/platform/error_code_recorder_test.cc",
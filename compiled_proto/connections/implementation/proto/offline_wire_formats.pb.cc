@@ -133,7 +133,8 @@ constexpr PayloadTransferFrame_ControlMessage::PayloadTransferFrame_ControlMessa
   ::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized)
   : offset_(int64_t{0})
   , event_(0)
-{}
+
+  , checksum_(0u){}
 struct PayloadTransferFrame_ControlMessageDefaultTypeInternal {
   constexpr PayloadTransferFrame_ControlMessageDefaultTypeInternal()
     : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
@@ -1034,32 +1035,40 @@ bool PayloadTransferFrame_ControlMessage_EventType_IsValid(int value) {
     case 1:
     case 2:
     case 3:
+    case 4:
+    case 5:
       return true;
     default:
       return false;
   }
 }
 
-static ::PROTOBUF_NAMESPACE_ID::internal::ExplicitlyConstructed<std::string> PayloadTransferFrame_ControlMessage_EventType_strings[4] = {};
+static ::PROTOBUF_NAMESPACE_ID::internal::ExplicitlyConstructed<std::string> PayloadTransferFrame_ControlMessage_EventType_strings[6] = {};
 
 static const char PayloadTransferFrame_ControlMessage_EventType_names[] =
   "PAYLOAD_CANCELED"
   "PAYLOAD_ERROR"
   "PAYLOAD_RECEIVED_ACK"
+  "PAYLOAD_RESUME_OFFSET"
+  "PAYLOAD_RESUME_QUERY"
   "UNKNOWN_EVENT_TYPE";
 
 static const ::PROTOBUF_NAMESPACE_ID::internal::EnumEntry PayloadTransferFrame_ControlMessage_EventType_entries[] = {
   { {PayloadTransferFrame_ControlMessage_EventType_names + 0, 16}, 2 },
   { {PayloadTransferFrame_ControlMessage_EventType_names + 16, 13}, 1 },
   { {PayloadTransferFrame_ControlMessage_EventType_names + 29, 20}, 3 },
-  { {PayloadTransferFrame_ControlMessage_EventType_names + 49, 18}, 0 },
+  { {PayloadTransferFrame_ControlMessage_EventType_names + 49, 21}, 5 },
+  { {PayloadTransferFrame_ControlMessage_EventType_names + 70, 20}, 4 },
+  { {PayloadTransferFrame_ControlMessage_EventType_names + 90, 18}, 0 },
 };
 
 static const int PayloadTransferFrame_ControlMessage_EventType_entries_by_number[] = {
-  3, // 0 -> UNKNOWN_EVENT_TYPE
+  5, // 0 -> UNKNOWN_EVENT_TYPE
   1, // 1 -> PAYLOAD_ERROR
   0, // 2 -> PAYLOAD_CANCELED
   2, // 3 -> PAYLOAD_RECEIVED_ACK
+  4, // 4 -> PAYLOAD_RESUME_QUERY
+  3, // 5 -> PAYLOAD_RESUME_OFFSET
 };
 
 const std::string& PayloadTransferFrame_ControlMessage_EventType_Name(
@@ -1068,12 +1077,12 @@ const std::string& PayloadTransferFrame_ControlMessage_EventType_Name(
       ::PROTOBUF_NAMESPACE_ID::internal::InitializeEnumStrings(
           PayloadTransferFrame_ControlMessage_EventType_entries,
           PayloadTransferFrame_ControlMessage_EventType_entries_by_number,
-          4, PayloadTransferFrame_ControlMessage_EventType_strings);
+          6, PayloadTransferFrame_ControlMessage_EventType_strings);
   (void) dummy;
   int idx = ::PROTOBUF_NAMESPACE_ID::internal::LookUpEnumName(
       PayloadTransferFrame_ControlMessage_EventType_entries,
       PayloadTransferFrame_ControlMessage_EventType_entries_by_number,
-      4, value);
+      6, value);
   return idx == -1 ? ::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString() :
                      PayloadTransferFrame_ControlMessage_EventType_strings[idx].get();
 }
@@ -1081,7 +1090,7 @@ bool PayloadTransferFrame_ControlMessage_EventType_Parse(
     ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, PayloadTransferFrame_ControlMessage_EventType* value) {
   int int_value;
   bool success = ::PROTOBUF_NAMESPACE_ID::internal::LookUpEnumValue(
-      PayloadTransferFrame_ControlMessage_EventType_entries, 4, name, &int_value);
+      PayloadTransferFrame_ControlMessage_EventType_entries, 6, name, &int_value);
   if (success) {
     *value = static_cast<PayloadTransferFrame_ControlMessage_EventType>(int_value);
   }
@@ -1092,6 +1101,8 @@ constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_Con
 constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::PAYLOAD_ERROR;
 constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::PAYLOAD_CANCELED;
 constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::PAYLOAD_RECEIVED_ACK;
+constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::PAYLOAD_RESUME_QUERY;
+constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::PAYLOAD_RESUME_OFFSET;
 constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::EventType_MIN;
 constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage::EventType_MAX;
 constexpr int PayloadTransferFrame_ControlMessage::EventType_ARRAYSIZE;
@@ -4615,6 +4626,9 @@ class PayloadTransferFrame_ControlMessage::_Internal {
   static void set_has_offset(HasBits* has_bits) {
     (*has_bits)[0] |= 1u;
   }
+  static void set_has_checksum(HasBits* has_bits) {
+    (*has_bits)[0] |= 4u;
+  }
 };
 
 PayloadTransferFrame_ControlMessage::PayloadTransferFrame_ControlMessage(::PROTOBUF_NAMESPACE_ID::Arena* arena,
@@ -4631,16 +4645,16 @@ PayloadTransferFrame_ControlMessage::PayloadTransferFrame_ControlMessage(const P
       _has_bits_(from._has_bits_) {
   _internal_metadata_.MergeFrom<std::string>(from._internal_metadata_);
   ::memcpy(&offset_, &from.offset_,
-    static_cast<size_t>(reinterpret_cast<char*>(&event_) -
-    reinterpret_cast<char*>(&offset_)) + sizeof(event_));
+    static_cast<size_t>(reinterpret_cast<char*>(&checksum_) -
+    reinterpret_cast<char*>(&offset_)) + sizeof(checksum_));
   // @@protoc_insertion_point(copy_constructor:location.nearby.connections.PayloadTransferFrame.ControlMessage)
 }
 
 inline void PayloadTransferFrame_ControlMessage::SharedCtor() {
 ::memset(reinterpret_cast<char*>(this) + static_cast<size_t>(
     reinterpret_cast<char*>(&offset_) - reinterpret_cast<char*>(this)),
-    0, static_cast<size_t>(reinterpret_cast<char*>(&event_) -
-    reinterpret_cast<char*>(&offset_)) + sizeof(event_));
+    0, static_cast<size_t>(reinterpret_cast<char*>(&checksum_) -
+    reinterpret_cast<char*>(&offset_)) + sizeof(checksum_));
 }
 
 PayloadTransferFrame_ControlMessage::~PayloadTransferFrame_ControlMessage() {
@@ -4671,10 +4685,10 @@ void PayloadTransferFrame_ControlMessage::Clear() {
   (void) cached_has_bits;
 
   cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x00000003u) {
+  if (cached_has_bits & 0x00000007u) {
     ::memset(&offset_, 0, static_cast<size_t>(
-        reinterpret_cast<char*>(&event_) -
-        reinterpret_cast<char*>(&offset_)) + sizeof(event_));
+        reinterpret_cast<char*>(&checksum_) -
+        reinterpret_cast<char*>(&offset_)) + sizeof(checksum_));
   }
   _has_bits_.Clear();
   _internal_metadata_.Clear<std::string>();
@@ -4709,6 +4723,15 @@ const char* PayloadTransferFrame_ControlMessage::_InternalParse(const char* ptr,
         } else
           goto handle_unusual;
         continue;
+      // optional uint32 checksum = 3;
+      case 3:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 24)) {
+          _Internal::set_has_checksum(&has_bits);
+          checksum_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -4753,6 +4776,12 @@ uint8_t* PayloadTransferFrame_ControlMessage::_InternalSerialize(
     target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteInt64ToArray(2, this->_internal_offset(), target);
   }
 
+  // optional uint32 checksum = 3;
+  if (cached_has_bits & 0x00000004u) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteUInt32ToArray(3, this->_internal_checksum(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = stream->WriteRaw(_internal_metadata_.unknown_fields<std::string>(::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString).data(),
         static_cast<int>(_internal_metadata_.unknown_fields<std::string>(::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString).size()), target);
@@ -4770,7 +4799,7 @@ size_t PayloadTransferFrame_ControlMessage::ByteSizeLong() const {
   (void) cached_has_bits;
 
   cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x00000003u) {
+  if (cached_has_bits & 0x00000007u) {
     // optional int64 offset = 2;
     if (cached_has_bits & 0x00000001u) {
       total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int64SizePlusOne(this->_internal_offset());
@@ -4782,6 +4811,11 @@ size_t PayloadTransferFrame_ControlMessage::ByteSizeLong() const {
         ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::EnumSize(this->_internal_event());
     }
 
+    // optional uint32 checksum = 3;
+    if (cached_has_bits & 0x00000004u) {
+      total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::UInt32SizePlusOne(this->_internal_checksum());
+    }
+
   }
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     total_size += _internal_metadata_.unknown_fields<std::string>(::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString).size();
@@ -4804,13 +4838,16 @@ void PayloadTransferFrame_ControlMessage::MergeFrom(const PayloadTransferFrame_C
   (void) cached_has_bits;
 
   cached_has_bits = from._has_bits_[0];
-  if (cached_has_bits & 0x00000003u) {
+  if (cached_has_bits & 0x00000007u) {
     if (cached_has_bits & 0x00000001u) {
       offset_ = from.offset_;
     }
     if (cached_has_bits & 0x00000002u) {
       event_ = from.event_;
     }
+    if (cached_has_bits & 0x00000004u) {
+      checksum_ = from.checksum_;
+    }
     _has_bits_[0] |= cached_has_bits;
   }
   _internal_metadata_.MergeFrom<std::string>(from._internal_metadata_);
@@ -4832,8 +4869,8 @@ void PayloadTransferFrame_ControlMessage::InternalSwap(PayloadTransferFrame_Cont
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
   swap(_has_bits_[0], other->_has_bits_[0]);
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(PayloadTransferFrame_ControlMessage, event_)
-      + sizeof(PayloadTransferFrame_ControlMessage::event_)
+      PROTOBUF_FIELD_OFFSET(PayloadTransferFrame_ControlMessage, checksum_)
+      + sizeof(PayloadTransferFrame_ControlMessage::checksum_)
       - PROTOBUF_FIELD_OFFSET(PayloadTransferFrame_ControlMessage, offset_)>(
           reinterpret_cast<char*>(&offset_),
           reinterpret_cast<char*>(&other->offset_));
@@ -347,11 +347,13 @@ enum PayloadTransferFrame_ControlMessage_EventType : int {
   PayloadTransferFrame_ControlMessage_EventType_UNKNOWN_EVENT_TYPE = 0,
   PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_ERROR = 1,
   PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_CANCELED = 2,
-  PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RECEIVED_ACK = 3
+  PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RECEIVED_ACK = 3,
+  PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RESUME_QUERY = 4,
+  PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RESUME_OFFSET = 5
 };
 bool PayloadTransferFrame_ControlMessage_EventType_IsValid(int value);
 constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage_EventType_EventType_MIN = PayloadTransferFrame_ControlMessage_EventType_UNKNOWN_EVENT_TYPE;
-constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage_EventType_EventType_MAX = PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RECEIVED_ACK;
+constexpr PayloadTransferFrame_ControlMessage_EventType PayloadTransferFrame_ControlMessage_EventType_EventType_MAX = PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RESUME_OFFSET;
 constexpr int PayloadTransferFrame_ControlMessage_EventType_EventType_ARRAYSIZE = PayloadTransferFrame_ControlMessage_EventType_EventType_MAX + 1;
 
 const std::string& PayloadTransferFrame_ControlMessage_EventType_Name(PayloadTransferFrame_ControlMessage_EventType value);
@@ -2454,6 +2456,10 @@ class PayloadTransferFrame_ControlMessage final :
     PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_CANCELED;
   static constexpr EventType PAYLOAD_RECEIVED_ACK =
     PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RECEIVED_ACK;
+  static constexpr EventType PAYLOAD_RESUME_QUERY =
+    PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RESUME_QUERY;
+  static constexpr EventType PAYLOAD_RESUME_OFFSET =
+    PayloadTransferFrame_ControlMessage_EventType_PAYLOAD_RESUME_OFFSET;
   static inline bool EventType_IsValid(int value) {
     return PayloadTransferFrame_ControlMessage_EventType_IsValid(value);
   }
@@ -2480,6 +2486,7 @@ class PayloadTransferFrame_ControlMessage final :
   enum : int {
     kOffsetFieldNumber = 2,
     kEventFieldNumber = 1,
+    kChecksumFieldNumber = 3,
   };
   // optional int64 offset = 2;
   bool has_offset() const;
@@ -2507,6 +2514,19 @@ class PayloadTransferFrame_ControlMessage final :
   void _internal_set_event(::location::nearby::connections::PayloadTransferFrame_ControlMessage_EventType value);
   public:
 
+  // optional uint32 checksum = 3;
+  bool has_checksum() const;
+  private:
+  bool _internal_has_checksum() const;
+  public:
+  void clear_checksum();
+  uint32_t checksum() const;
+  void set_checksum(uint32_t value);
+  private:
+  uint32_t _internal_checksum() const;
+  void _internal_set_checksum(uint32_t value);
+  public:
+
   // @@protoc_insertion_point(class_scope:location.nearby.connections.PayloadTransferFrame.ControlMessage)
  private:
   class _Internal;
@@ -2518,6 +2538,7 @@ class PayloadTransferFrame_ControlMessage final :
   mutable ::PROTOBUF_NAMESPACE_ID::internal::CachedSize _cached_size_;
   int64_t offset_;
   int event_;
+  uint32_t checksum_;
   friend struct ::TableStruct_connections_2fimplementation_2fproto_2foffline_5fwire_5fformats_2eproto;
 };
 // -------------------------------------------------------------------
@@ -10719,6 +10740,34 @@ inline void PayloadTransferFrame_ControlMessage::set_offset(int64_t value) {
   // @@protoc_insertion_point(field_set:location.nearby.connections.PayloadTransferFrame.ControlMessage.offset)
 }
 
+// optional uint32 checksum = 3;
+inline bool PayloadTransferFrame_ControlMessage::_internal_has_checksum() const {
+  bool value = (_has_bits_[0] & 0x00000004u) != 0;
+  return value;
+}
+inline bool PayloadTransferFrame_ControlMessage::has_checksum() const {
+  return _internal_has_checksum();
+}
+inline void PayloadTransferFrame_ControlMessage::clear_checksum() {
+  checksum_ = 0u;
+  _has_bits_[0] &= ~0x00000004u;
+}
+inline uint32_t PayloadTransferFrame_ControlMessage::_internal_checksum() const {
+  return checksum_;
+}
+inline uint32_t PayloadTransferFrame_ControlMessage::checksum() const {
+  // @@protoc_insertion_point(field_get:location.nearby.connections.PayloadTransferFrame.ControlMessage.checksum)
+  return _internal_checksum();
+}
+inline void PayloadTransferFrame_ControlMessage::_internal_set_checksum(uint32_t value) {
+  _has_bits_[0] |= 0x00000004u;
+  checksum_ = value;
+}
+inline void PayloadTransferFrame_ControlMessage::set_checksum(uint32_t value) {
+  _internal_set_checksum(value);
+  // @@protoc_insertion_point(field_set:location.nearby.connections.PayloadTransferFrame.ControlMessage.checksum)
+}
+
 // -------------------------------------------------------------------
 
 // PayloadTransferFrame
@@ -209,7 +209,9 @@ constexpr ConnectionsLog_Payload::ConnectionsLog_Payload(
   , num_chunks_(0)
   , num_bytes_transferred_(int64_t{0})
   , status_(0)
-{}
+
+  , num_successful_auto_resume_(0)
+  , max_chunk_size_bytes_(0){}
 struct ConnectionsLog_PayloadDefaultTypeInternal {
   constexpr ConnectionsLog_PayloadDefaultTypeInternal()
     : _instance(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized{}) {}
@@ -4181,6 +4183,12 @@ class ConnectionsLog_Payload::_Internal {
   static void set_has_status(HasBits* has_bits) {
     (*has_bits)[0] |= 32u;
   }
+  static void set_has_num_successful_auto_resume(HasBits* has_bits) {
+    (*has_bits)[0] |= 64u;
+  }
+  static void set_has_max_chunk_size_bytes(HasBits* has_bits) {
+    (*has_bits)[0] |= 128u;
+  }
 };
 
 ConnectionsLog_Payload::ConnectionsLog_Payload(::PROTOBUF_NAMESPACE_ID::Arena* arena,
@@ -4197,16 +4205,16 @@ ConnectionsLog_Payload::ConnectionsLog_Payload(const ConnectionsLog_Payload& fro
       _has_bits_(from._has_bits_) {
   _internal_metadata_.MergeFrom<std::string>(from._internal_metadata_);
   ::memcpy(&duration_millis_, &from.duration_millis_,
-    static_cast<size_t>(reinterpret_cast<char*>(&status_) -
-    reinterpret_cast<char*>(&duration_millis_)) + sizeof(status_));
+    static_cast<size_t>(reinterpret_cast<char*>(&max_chunk_size_bytes_) -
+    reinterpret_cast<char*>(&duration_millis_)) + sizeof(max_chunk_size_bytes_));
   // @@protoc_insertion_point(copy_constructor:location.nearby.analytics.proto.ConnectionsLog.Payload)
 }
 
 inline void ConnectionsLog_Payload::SharedCtor() {
 ::memset(reinterpret_cast<char*>(this) + static_cast<size_t>(
     reinterpret_cast<char*>(&duration_millis_) - reinterpret_cast<char*>(this)),
-    0, static_cast<size_t>(reinterpret_cast<char*>(&status_) -
-    reinterpret_cast<char*>(&duration_millis_)) + sizeof(status_));
+    0, static_cast<size_t>(reinterpret_cast<char*>(&max_chunk_size_bytes_) -
+    reinterpret_cast<char*>(&duration_millis_)) + sizeof(max_chunk_size_bytes_));
 }
 
 ConnectionsLog_Payload::~ConnectionsLog_Payload() {
@@ -4237,10 +4245,10 @@ void ConnectionsLog_Payload::Clear() {
   (void) cached_has_bits;
 
   cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x0000003fu) {
+  if (cached_has_bits & 0x000000ffu) {
     ::memset(&duration_millis_, 0, static_cast<size_t>(
-        reinterpret_cast<char*>(&status_) -
-        reinterpret_cast<char*>(&duration_millis_)) + sizeof(status_));
+        reinterpret_cast<char*>(&max_chunk_size_bytes_) -
+        reinterpret_cast<char*>(&duration_millis_)) + sizeof(max_chunk_size_bytes_));
   }
   _has_bits_.Clear();
   _internal_metadata_.Clear<std::string>();
@@ -4315,6 +4323,24 @@ const char* ConnectionsLog_Payload::_InternalParse(const char* ptr, ::PROTOBUF_N
         } else
           goto handle_unusual;
         continue;
+      // optional int32 num_successful_auto_resume = 7;
+      case 7:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 56)) {
+          _Internal::set_has_num_successful_auto_resume(&has_bits);
+          num_successful_auto_resume_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
+      // optional int32 max_chunk_size_bytes = 8;
+      case 8:
+        if (PROTOBUF_PREDICT_TRUE(static_cast<uint8_t>(tag) == 64)) {
+          _Internal::set_has_max_chunk_size_bytes(&has_bits);
+          max_chunk_size_bytes_ = ::PROTOBUF_NAMESPACE_ID::internal::ReadVarint32(&ptr);
+          CHK_(ptr);
+        } else
+          goto handle_unusual;
+        continue;
       default:
         goto handle_unusual;
     }  // switch
@@ -4384,6 +4410,18 @@ uint8_t* ConnectionsLog_Payload::_InternalSerialize(
       6, this->_internal_status(), target);
   }
 
+  // optional int32 num_successful_auto_resume = 7;
+  if (cached_has_bits & 0x00000040u) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteInt32ToArray(7, this->_internal_num_successful_auto_resume(), target);
+  }
+
+  // optional int32 max_chunk_size_bytes = 8;
+  if (cached_has_bits & 0x00000080u) {
+    target = stream->EnsureSpace(target);
+    target = ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::WriteInt32ToArray(8, this->_internal_max_chunk_size_bytes(), target);
+  }
+
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     target = stream->WriteRaw(_internal_metadata_.unknown_fields<std::string>(::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString).data(),
         static_cast<int>(_internal_metadata_.unknown_fields<std::string>(::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString).size()), target);
@@ -4401,7 +4439,7 @@ size_t ConnectionsLog_Payload::ByteSizeLong() const {
   (void) cached_has_bits;
 
   cached_has_bits = _has_bits_[0];
-  if (cached_has_bits & 0x0000003fu) {
+  if (cached_has_bits & 0x000000ffu) {
     // optional int64 duration_millis = 1;
     if (cached_has_bits & 0x00000001u) {
       total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int64SizePlusOne(this->_internal_duration_millis());
@@ -4434,6 +4472,16 @@ size_t ConnectionsLog_Payload::ByteSizeLong() const {
         ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::EnumSize(this->_internal_status());
     }
 
+    // optional int32 num_successful_auto_resume = 7;
+    if (cached_has_bits & 0x00000040u) {
+      total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int32SizePlusOne(this->_internal_num_successful_auto_resume());
+    }
+
+    // optional int32 max_chunk_size_bytes = 8;
+    if (cached_has_bits & 0x00000080u) {
+      total_size += ::PROTOBUF_NAMESPACE_ID::internal::WireFormatLite::Int32SizePlusOne(this->_internal_max_chunk_size_bytes());
+    }
+
   }
   if (PROTOBUF_PREDICT_FALSE(_internal_metadata_.have_unknown_fields())) {
     total_size += _internal_metadata_.unknown_fields<std::string>(::PROTOBUF_NAMESPACE_ID::internal::GetEmptyString).size();
@@ -4456,7 +4504,7 @@ void ConnectionsLog_Payload::MergeFrom(const ConnectionsLog_Payload& from) {
   (void) cached_has_bits;
 
   cached_has_bits = from._has_bits_[0];
-  if (cached_has_bits & 0x0000003fu) {
+  if (cached_has_bits & 0x000000ffu) {
     if (cached_has_bits & 0x00000001u) {
       duration_millis_ = from.duration_millis_;
     }
@@ -4475,6 +4523,12 @@ void ConnectionsLog_Payload::MergeFrom(const ConnectionsLog_Payload& from) {
     if (cached_has_bits & 0x00000020u) {
       status_ = from.status_;
     }
+    if (cached_has_bits & 0x00000040u) {
+      num_successful_auto_resume_ = from.num_successful_auto_resume_;
+    }
+    if (cached_has_bits & 0x00000080u) {
+      max_chunk_size_bytes_ = from.max_chunk_size_bytes_;
+    }
     _has_bits_[0] |= cached_has_bits;
   }
   _internal_metadata_.MergeFrom<std::string>(from._internal_metadata_);
@@ -4496,8 +4550,8 @@ void ConnectionsLog_Payload::InternalSwap(ConnectionsLog_Payload* other) {
   _internal_metadata_.InternalSwap(&other->_internal_metadata_);
   swap(_has_bits_[0], other->_has_bits_[0]);
   ::PROTOBUF_NAMESPACE_ID::internal::memswap<
-      PROTOBUF_FIELD_OFFSET(ConnectionsLog_Payload, status_)
-      + sizeof(ConnectionsLog_Payload::status_)
+      PROTOBUF_FIELD_OFFSET(ConnectionsLog_Payload, max_chunk_size_bytes_)
+      + sizeof(ConnectionsLog_Payload::max_chunk_size_bytes_)
       - PROTOBUF_FIELD_OFFSET(ConnectionsLog_Payload, duration_millis_)>(
           reinterpret_cast<char*>(&duration_millis_),
           reinterpret_cast<char*>(&other->duration_millis_));
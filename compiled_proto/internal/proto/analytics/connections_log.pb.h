@@ -2597,6 +2597,8 @@ class ConnectionsLog_Payload final :
     kNumChunksFieldNumber = 5,
     kNumBytesTransferredFieldNumber = 4,
     kStatusFieldNumber = 6,
+    kNumSuccessfulAutoResumeFieldNumber = 7,
+    kMaxChunkSizeBytesFieldNumber = 8,
   };
   // optional int64 duration_millis = 1;
   bool has_duration_millis() const;
@@ -2676,6 +2678,32 @@ class ConnectionsLog_Payload final :
   void _internal_set_status(::location::nearby::proto::connections::PayloadStatus value);
   public:
 
+  // optional int32 num_successful_auto_resume = 7;
+  bool has_num_successful_auto_resume() const;
+  private:
+  bool _internal_has_num_successful_auto_resume() const;
+  public:
+  void clear_num_successful_auto_resume();
+  int32_t num_successful_auto_resume() const;
+  void set_num_successful_auto_resume(int32_t value);
+  private:
+  int32_t _internal_num_successful_auto_resume() const;
+  void _internal_set_num_successful_auto_resume(int32_t value);
+  public:
+
+  // optional int32 max_chunk_size_bytes = 8;
+  bool has_max_chunk_size_bytes() const;
+  private:
+  bool _internal_has_max_chunk_size_bytes() const;
+  public:
+  void clear_max_chunk_size_bytes();
+  int32_t max_chunk_size_bytes() const;
+  void set_max_chunk_size_bytes(int32_t value);
+  private:
+  int32_t _internal_max_chunk_size_bytes() const;
+  void _internal_set_max_chunk_size_bytes(int32_t value);
+  public:
+
   // @@protoc_insertion_point(class_scope:location.nearby.analytics.proto.ConnectionsLog.Payload)
  private:
   class _Internal;
@@ -2691,6 +2719,8 @@ class ConnectionsLog_Payload final :
   int32_t num_chunks_;
   int64_t num_bytes_transferred_;
   int status_;
+  int32_t num_successful_auto_resume_;
+  int32_t max_chunk_size_bytes_;
   friend struct ::TableStruct_internal_2fproto_2fanalytics_2fconnections_5flog_2eproto;
 };
 // -------------------------------------------------------------------
@@ -6902,6 +6932,62 @@ inline void ConnectionsLog_Payload::set_status(::location::nearby::proto::connec
   // @@protoc_insertion_point(field_set:location.nearby.analytics.proto.ConnectionsLog.Payload.status)
 }
 
+// optional int32 num_successful_auto_resume = 7;
+inline bool ConnectionsLog_Payload::_internal_has_num_successful_auto_resume() const {
+  bool value = (_has_bits_[0] & 0x00000040u) != 0;
+  return value;
+}
+inline bool ConnectionsLog_Payload::has_num_successful_auto_resume() const {
+  return _internal_has_num_successful_auto_resume();
+}
+inline void ConnectionsLog_Payload::clear_num_successful_auto_resume() {
+  num_successful_auto_resume_ = 0;
+  _has_bits_[0] &= ~0x00000040u;
+}
+inline int32_t ConnectionsLog_Payload::_internal_num_successful_auto_resume() const {
+  return num_successful_auto_resume_;
+}
+inline int32_t ConnectionsLog_Payload::num_successful_auto_resume() const {
+  // @@protoc_insertion_point(field_get:location.nearby.analytics.proto.ConnectionsLog.Payload.num_successful_auto_resume)
+  return _internal_num_successful_auto_resume();
+}
+inline void ConnectionsLog_Payload::_internal_set_num_successful_auto_resume(int32_t value) {
+  _has_bits_[0] |= 0x00000040u;
+  num_successful_auto_resume_ = value;
+}
+inline void ConnectionsLog_Payload::set_num_successful_auto_resume(int32_t value) {
+  _internal_set_num_successful_auto_resume(value);
+  // @@protoc_insertion_point(field_set:location.nearby.analytics.proto.ConnectionsLog.Payload.num_successful_auto_resume)
+}
+
+// optional int32 max_chunk_size_bytes = 8;
+inline bool ConnectionsLog_Payload::_internal_has_max_chunk_size_bytes() const {
+  bool value = (_has_bits_[0] & 0x00000080u) != 0;
+  return value;
+}
+inline bool ConnectionsLog_Payload::has_max_chunk_size_bytes() const {
+  return _internal_has_max_chunk_size_bytes();
+}
+inline void ConnectionsLog_Payload::clear_max_chunk_size_bytes() {
+  max_chunk_size_bytes_ = 0;
+  _has_bits_[0] &= ~0x00000080u;
+}
+inline int32_t ConnectionsLog_Payload::_internal_max_chunk_size_bytes() const {
+  return max_chunk_size_bytes_;
+}
+inline int32_t ConnectionsLog_Payload::max_chunk_size_bytes() const {
+  // @@protoc_insertion_point(field_get:location.nearby.analytics.proto.ConnectionsLog.Payload.max_chunk_size_bytes)
+  return _internal_max_chunk_size_bytes();
+}
+inline void ConnectionsLog_Payload::_internal_set_max_chunk_size_bytes(int32_t value) {
+  _has_bits_[0] |= 0x00000080u;
+  max_chunk_size_bytes_ = value;
+}
+inline void ConnectionsLog_Payload::set_max_chunk_size_bytes(int32_t value) {
+  _internal_set_max_chunk_size_bytes(value);
+  // @@protoc_insertion_point(field_set:location.nearby.analytics.proto.ConnectionsLog.Payload.max_chunk_size_bytes)
+}
+
 // -------------------------------------------------------------------
 
 // ConnectionsLog_BandwidthUpgradeAttempt
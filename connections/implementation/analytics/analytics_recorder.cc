@@ -579,7 +579,8 @@ void AnalyticsRecorder::OnOutgoingPayloadStarted(
 
 void AnalyticsRecorder::OnPayloadChunkSent(const std::string &endpoint_id,
                                            std::int64_t payload_id,
-                                           std::int64_t chunk_size_bytes) {
+                                           std::int64_t chunk_size_bytes,
+                                           int max_chunk_size_bytes) {
   MutexLock lock(&mutex_);
   if (!CanRecordAnalyticsLocked("OnPayloadChunkSent")) {
     return;
@@ -589,7 +590,8 @@ void AnalyticsRecorder::OnPayloadChunkSent(const std::string &endpoint_id,
     return;
   }
   const std::unique_ptr<LogicalConnection> &logical_connection = it->second;
-  logical_connection->ChunkSent(payload_id, chunk_size_bytes);
+  logical_connection->ChunkSent(payload_id, chunk_size_bytes,
+                                max_chunk_size_bytes);
 }
 
 void AnalyticsRecorder::OnOutgoingPayloadDone(const std::string &endpoint_id,
@@ -1094,6 +1096,11 @@ void AnalyticsRecorder::PendingPayload::AddChunk(
   num_chunks_++;
 }
 
+void AnalyticsRecorder::PendingPayload::AddMaxChunkSize(
+    int max_chunk_size_bytes) {
+  max_chunk_size_bytes_ = std::max(max_chunk_size_bytes_, max_chunk_size_bytes);
+}
+
 ConnectionsLog::Payload AnalyticsRecorder::PendingPayload::GetProtoPayload(
     PayloadStatus status) {
   ConnectionsLog::Payload payload;
@@ -1104,6 +1111,9 @@ ConnectionsLog::Payload AnalyticsRecorder::PendingPayload::GetProtoPayload(
   payload.set_num_bytes_transferred(num_bytes_transferred_);
   payload.set_num_chunks(num_chunks_);
   payload.set_status(status);
+  if (max_chunk_size_bytes_ > 0) {
+    payload.set_max_chunk_size_bytes(max_chunk_size_bytes_);
+  }
 
   return payload;
 }
@@ -1237,14 +1247,16 @@ void AnalyticsRecorder::LogicalConnection::OutgoingPayloadStarted(
       {payload_id, std::make_unique<PendingPayload>(type, total_size_bytes)});
 }
 
-void AnalyticsRecorder::LogicalConnection::ChunkSent(std::int64_t payload_id,
-                                                     std::int64_t size_bytes) {
+void AnalyticsRecorder::LogicalConnection::ChunkSent(
+    std::int64_t payload_id, std::int64_t size_bytes,
+    int max_chunk_size_bytes) {
   auto it = outgoing_payloads_.find(payload_id);
   if (it == outgoing_payloads_.end()) {
     return;
   }
   PendingPayload *payload = it->second.get();
   payload->AddChunk(size_bytes);
+  payload->AddMaxChunkSize(max_chunk_size_bytes);
 }
 
 void AnalyticsRecorder::LogicalConnection::OutgoingPayloadDone(
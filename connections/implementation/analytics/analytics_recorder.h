@@ -149,10 +149,12 @@ class AnalyticsRecorder {
                                 connections::PayloadType type,
                                 std::int64_t total_size_bytes)
       ABSL_LOCKS_EXCLUDED(mutex_);
+  // `chunk_size_bytes` is the size of the chunk body that was sent, and
+  // `max_chunk_size_bytes` the chunk size the sender chose for it.
   void OnPayloadChunkSent(const std::string &endpoint_id,
                           std::int64_t payload_id,
-                          std::int64_t chunk_size_bytes)
-      ABSL_LOCKS_EXCLUDED(mutex_);
+                          std::int64_t chunk_size_bytes,
+                          int max_chunk_size_bytes) ABSL_LOCKS_EXCLUDED(mutex_);
   void OnOutgoingPayloadDone(
       const std::string &endpoint_id, std::int64_t payload_id,
       location::nearby::proto::connections::PayloadStatus status)
@@ -206,6 +208,8 @@ class AnalyticsRecorder {
     ~PendingPayload() = default;
 
     void AddChunk(std::int64_t chunk_size_bytes);
+    // Records the chunk size chosen for an outgoing chunk.
+    void AddMaxChunkSize(int max_chunk_size_bytes);
 
     location::nearby::analytics::proto::ConnectionsLog::Payload GetProtoPayload(
         location::nearby::proto::connections::PayloadStatus status);
@@ -222,6 +226,7 @@ class AnalyticsRecorder {
     std::int64_t total_size_bytes_;
     std::int64_t num_bytes_transferred_;
     int num_chunks_;
+    int max_chunk_size_bytes_ = 0;
   };
 
   class LogicalConnection {
@@ -261,7 +266,8 @@ class AnalyticsRecorder {
         std::int64_t payload_id,
         location::nearby::proto::connections::PayloadType type,
         std::int64_t total_size_bytes);
-    void ChunkSent(std::int64_t payload_id, std::int64_t size_bytes);
+    void ChunkSent(std::int64_t payload_id, std::int64_t size_bytes,
+                   int max_chunk_size_bytes);
     void OutgoingPayloadDone(
         std::int64_t payload_id,
         location::nearby::proto::connections::PayloadStatus status);
@@ -794,14 +794,19 @@ TEST(AnalyticsRecorderTest, OutgoingPayloadUpgraded) {
                                              connection_token);
   analytics_recorder.OnOutgoingPayloadStarted(
       {endpoint_id}, payload_id, connections::PayloadType::kFile, 50);
-  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10);
-  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10);
+  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10,
+                                        /*max_chunk_size_bytes=*/1980);
+  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10,
+                                        /*max_chunk_size_bytes=*/1980);
   analytics_recorder.OnConnectionClosed(endpoint_id, BLUETOOTH, UPGRADED);
   analytics_recorder.OnConnectionEstablished(endpoint_id, WIFI_LAN,
                                              connection_token);
-  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10);
-  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10);
-  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10);
+  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10,
+                                        /*max_chunk_size_bytes=*/65536);
+  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10,
+                                        /*max_chunk_size_bytes=*/65536);
+  analytics_recorder.OnPayloadChunkSent(endpoint_id, payload_id, 10,
+                                        /*max_chunk_size_bytes=*/65536);
   analytics_recorder.OnOutgoingPayloadDone(endpoint_id, payload_id, SUCCESS);
   analytics_recorder.OnConnectionClosed(endpoint_id, WIFI_LAN,
                                         LOCAL_DISCONNECTION);
@@ -831,6 +836,7 @@ TEST(AnalyticsRecorderTest, OutgoingPayloadUpgraded) {
               num_bytes_transferred: 20
               num_chunks: 2
               status: MOVED_TO_NEW_MEDIUM
+              max_chunk_size_bytes: 1980
             >
             disconnection_reason: UPGRADED
             connection_token: "connection_token"
@@ -843,6 +849,7 @@ TEST(AnalyticsRecorderTest, OutgoingPayloadUpgraded) {
               num_bytes_transferred: 30
               num_chunks: 3
               status: SUCCESS
+              max_chunk_size_bytes: 65536
             >
             disconnection_reason: LOCAL_DISCONNECTION
             connection_token: "connection_token"
@@ -26,6 +26,10 @@ namespace analytics {
 
 struct PacketMetaData {
   int packet_size;
+  // Size of the payload chunk carried by the packet, as chosen by the sender.
+  int chunk_size = 0;
+  // Size of the payload chunk body the packet carries; 0 if it carries none.
+  int chunk_body_size = 0;
   absl::Time file_io_start_time;
   absl::Time file_io_end_time;
   absl::Time encryption_start_time;
@@ -38,6 +42,8 @@ struct PacketMetaData {
     socket_io_start_time = SystemClock::ElapsedRealtime();
     socket_io_start_time = SystemClock::ElapsedRealtime();
     packet_size = 0;
+    chunk_size = 0;
+    chunk_body_size = 0;
   }
 
   void SetPacketSize(int packet_size) {
@@ -48,6 +54,14 @@ struct PacketMetaData {
     return packet_size;
   }
 
+  void SetChunkSize(int chunk_size) { this->chunk_size = chunk_size; }
+
+  int GetChunkSize() { return chunk_size; }
+
+  void SetChunkBodySize(int chunk_body_size) {
+    this->chunk_body_size = chunk_body_size;
+  }
+
   void StartFileIo() {
     file_io_start_time = SystemClock::ElapsedRealtime();
   }
@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <new>
 #include <ostream>
 #include <string>
@@ -155,10 +156,12 @@ int ThroughputRecorder::CalculateThroughputMBps(int throughputKBps) {
   return throughputKBps / kKbInBytes;
 }
 
-void ThroughputRecorder::Throughput::Add(int frame_size, int64_t file_io_time,
+void ThroughputRecorder::Throughput::Add(int frame_size, int chunk_size,
+                                         int64_t file_io_time,
                                          int64_t encryption_time,
                                          int64_t socket_io_time) {
   total_byte_size_ += frame_size;
+  max_chunk_size_ = std::max(max_chunk_size_, chunk_size);
   // reset the last timestamp
   last_timestamp_ = SystemClock::ElapsedRealtime();
   file_io_time_ += file_io_time;
@@ -180,7 +183,7 @@ bool ThroughputRecorder::Throughput::dump() {
       "%s %s data(%ld bytes) via %s used %ld milliseconds, throughput is %d "
       "MB/s (%d KB/s), File IO takes %ld ms, %s takes %ld ms, "
       "Socket IO takes %ld ms, "
-      "Other takes %ld ms",
+      "Other takes %ld ms, max chunk size is %d bytes",
       (payload_direction_ == PayloadDirection::INCOMING_PAYLOAD) ? "Received"
                                                                  : "Sent",
       ToString(payload_type_), total_byte_size_,
@@ -188,7 +191,7 @@ bool ThroughputRecorder::Throughput::dump() {
       throughpu_mbps, throughput_kbps, file_io_time_,
       (payload_direction_ == PayloadDirection::INCOMING_PAYLOAD) ? "Decryption"
                                                                  : "Encryption",
-      encryption_time_, socket_io_time_, other);
+      encryption_time_, socket_io_time_, other, max_chunk_size_);
   NEARBY_LOGS(INFO) << dump_content;
   return true;
 }
@@ -229,7 +232,8 @@ void ThroughputRecorder::OnFrameSent(Medium medium,
                      packetMetaData.GetFileIoTimeInMillis() +
                      packetMetaData.GetSocketIoTimeInMillis();
   GetThroughput(medium, duration_millis_)
-      .Add(packetMetaData.packet_size, packetMetaData.GetFileIoTimeInMillis(),
+      .Add(packetMetaData.packet_size, packetMetaData.chunk_size,
+           packetMetaData.GetFileIoTimeInMillis(),
            packetMetaData.GetEncryptionTimeInMillis(),
            packetMetaData.GetSocketIoTimeInMillis());
   CalculateDurationTimes(packetMetaData);
@@ -248,7 +252,8 @@ void ThroughputRecorder::OnFrameReceived(Medium medium,
                      packetMetaData.GetFileIoTimeInMillis() +
                      packetMetaData.GetSocketIoTimeInMillis();
   GetThroughput(medium, duration_millis_)
-      .Add(packetMetaData.packet_size, packetMetaData.GetFileIoTimeInMillis(),
+      .Add(packetMetaData.packet_size, packetMetaData.chunk_size,
+           packetMetaData.GetFileIoTimeInMillis(),
            packetMetaData.GetEncryptionTimeInMillis(),
            packetMetaData.GetSocketIoTimeInMillis());
   CalculateDurationTimes(packetMetaData);
@@ -58,8 +58,8 @@ class ThroughputRecorder {
           payload_type_(payload_type),
           payload_direction_(payload_direction) {}
 
-    void Add(int frame_size, int64_t file_io_time, int64_t encryption_time,
-             int64_t socket_io_time);
+    void Add(int frame_size, int chunk_size, int64_t file_io_time,
+             int64_t encryption_time, int64_t socket_io_time);
 
     void SetLastTimestamp(absl::Time time_stamp) {
       last_timestamp_ = time_stamp;
@@ -67,6 +67,9 @@ class ThroughputRecorder {
 
     int64_t GetTotalByteSize() { return total_byte_size_; }
 
+    // Returns the largest payload chunk size seen on this medium.
+    int GetMaxChunkSize() { return max_chunk_size_; }
+
     bool dump();
 
    private:
@@ -74,6 +77,7 @@ class ThroughputRecorder {
     absl::Time start_timestamp_;
     PayloadType payload_type_;
     int64_t total_byte_size_ = 0;
+    int max_chunk_size_ = 0;
     absl::Time last_timestamp_;
     PayloadDirection payload_direction_ = PayloadDirection::INCOMING_PAYLOAD;
     int64_t file_io_time_ = 0;
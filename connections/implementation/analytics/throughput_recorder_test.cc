@@ -98,6 +98,28 @@ TEST_F(ThroughputRecorderTest, OnFrameSentSaveTransferredSize) {
   EXPECT_EQ(throughput.GetTotalByteSize(), kFrameSize * 3);
 }
 
+TEST_F(ThroughputRecorderTest, OnFrameSentSaveMaxChunkSize) {
+  auto TPRecorder = tp_recorder_container_.GetTPRecorder(
+      kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD);
+  TPRecorder->Start(PayloadType::kFile, PayloadDirection::OUTGOING_PAYLOAD);
+
+  PacketMetaData packet_meta_data;
+  packet_meta_data.SetPacketSize(kFrameSize);
+  packet_meta_data.SetChunkSize(64 * 1024);
+  TPRecorder->OnFrameSent(location::nearby::proto::connections::WIFI_LAN,
+                          packet_meta_data);
+  packet_meta_data.SetChunkSize(256 * 1024);
+  TPRecorder->OnFrameSent(location::nearby::proto::connections::WIFI_LAN,
+                          packet_meta_data);
+  packet_meta_data.SetChunkSize(128 * 1024);
+  TPRecorder->OnFrameSent(location::nearby::proto::connections::WIFI_LAN,
+                          packet_meta_data);
+
+  auto throughput = TPRecorder->GetThroughput(
+      location::nearby::proto::connections::WIFI_LAN, 0);
+  EXPECT_EQ(throughput.GetMaxChunkSize(), 256 * 1024);
+}
+
 TEST_F(ThroughputRecorderTest, OnIgnoreUnkownPaylaodType) {
   auto TPRecorder = tp_recorder_container_.GetTPRecorder(
       kPayloadIdA, PayloadDirection::OUTGOING_PAYLOAD);
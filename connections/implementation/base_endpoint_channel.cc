@@ -16,16 +16,20 @@
 
 #include <cassert>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "connections/implementation/offline_frames.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/mutex.h"
 #include "internal/platform/mutex_lock.h"
+#include "internal/platform/output_stream.h"
 
 namespace nearby {
 namespace connections {
@@ -54,6 +58,32 @@ ByteArray IntToBytes(std::int32_t value) {
   return ByteArray(int_bytes, sizeof(int_bytes));
 }
 
+std::string ToString(const ByteArray& data) { return std::string(data); }
+
+std::string ToString(const ByteBuffer& data) {
+  std::string result;
+  result.reserve(data.size());
+  for (absl::string_view segment : data.Segments()) {
+    result.append(segment.data(), segment.size());
+  }
+  return result;
+}
+
+// Prepends the length header to `body` by reference, so neither is copied to
+// form the frame. Streams that support gather writes send both in one write.
+Exception WriteFrameBody(OutputStream* writer, ByteArray header,
+                         const ByteBuffer& body) {
+  ByteBuffer frame = body;
+  frame.Prepend(std::move(header));
+  return writer->WriteBuffer(frame);
+}
+
+// Same, for a body that the frame borrows rather than copies.
+Exception WriteFrameBody(OutputStream* writer, ByteArray header,
+                         const ByteArray& body) {
+  return WriteFrameBody(writer, std::move(header), ByteBuffer::Borrow(body));
+}
+
 ExceptionOr<std::int32_t> ReadInt(InputStream* reader) {
   ExceptionOr<ByteArray> read_bytes = reader->ReadExactly(sizeof(std::int32_t));
   if (!read_bytes.ok()) {
@@ -62,10 +92,6 @@ ExceptionOr<std::int32_t> ReadInt(InputStream* reader) {
   return ExceptionOr<std::int32_t>(BytesToInt(std::move(read_bytes.result())));
 }
 
-Exception WriteInt(OutputStream* writer, std::int32_t value) {
-  return writer->Write(IntToBytes(value));
-}
-
 }  // namespace
 
 BaseEndpointChannel::BaseEndpointChannel(const std::string& service_id,
@@ -181,16 +207,12 @@ ExceptionOr<ByteArray> BaseEndpointChannel::Read(
     MutexLock lock(&last_read_mutex_);
     last_read_timestamp_ = SystemClock::ElapsedRealtime();
   }
-  return ExceptionOr<ByteArray>(result);
+  return ExceptionOr<ByteArray>(std::move(result));
 }
 
-Exception BaseEndpointChannel::Write(const ByteArray& data) {
-  PacketMetaData packet_meta_data;
-  return Write(data, packet_meta_data);
-}
-
-Exception BaseEndpointChannel::Write(const ByteArray& data,
-                                     PacketMetaData& packet_meta_data) {
+template <typename Data>
+Exception BaseEndpointChannel::WriteFrame(const Data& data,
+                                          PacketMetaData& packet_meta_data) {
   {
     MutexLock pause_lock(&is_paused_mutex_);
     if (is_paused_) {
@@ -198,32 +220,31 @@ Exception BaseEndpointChannel::Write(const ByteArray& data,
     }
   }
 
-  ByteArray encrypted_data;
-  const ByteArray* data_to_write = &data;
   {
     // Holding both mutexes is necessary to prevent the keep alive and payload
     // threads from writing encrypted messages out of order which causes a
     // failure to decrypt on the reader side. However we need to release the
     // crypto lock after encrypting to ensure read decryption is not blocked.
     MutexLock lock(&writer_mutex_);
+    std::optional<ByteBuffer> encrypted_data;
     {
       MutexLock crypto_lock(&crypto_mutex_);
       if (IsEncryptionEnabledLocked()) {
         // If encryption is enabled, encode the message.
         packet_meta_data.StartEncryption();
         std::unique_ptr<std::string> encrypted =
-            crypto_context_->EncodeMessageToPeer(std::string(data));
+            crypto_context_->EncodeMessageToPeer(ToString(data));
         packet_meta_data.StopEncryption();
         if (!encrypted) {
           NEARBY_LOGS(WARNING) << __func__ << ": Failed to encrypt data.";
           return {Exception::kIo};
         }
-        encrypted_data = ByteArray(std::move(*encrypted));
-        data_to_write = &encrypted_data;
+        encrypted_data.emplace(std::move(*encrypted));
       }
     }
 
-    size_t data_size = data_to_write->size();
+    size_t data_size =
+        encrypted_data.has_value() ? encrypted_data->size() : data.size();
     if (data_size < 0 || data_size > kMaxAllowedReadBytes) {
       NEARBY_LOGS(WARNING) << __func__ << ": Write an invalid number of bytes: "
                            << data_size;
@@ -231,27 +252,31 @@ Exception BaseEndpointChannel::Write(const ByteArray& data,
     }
 
     packet_meta_data.StartSocketIo();
+    ByteArray header = IntToBytes(static_cast<std::int32_t>(data_size));
     Exception write_exception =
-        WriteInt(writer_, static_cast<std::int32_t>(data_size));
-    if (write_exception.Raised()) {
-      NEARBY_LOGS(WARNING) << __func__ << ": Failed to write header: "
-                           << write_exception.value;
-      return write_exception;
-    }
-    write_exception = writer_->Write(*data_to_write);
+        encrypted_data.has_value()
+            ? WriteFrameBody(writer_, std::move(header), *encrypted_data)
+            : WriteFrameBody(writer_, std::move(header), data);
     if (write_exception.Raised()) {
-      NEARBY_LOGS(WARNING) << __func__ << ": Failed to write data: "
+      NEARBY_LOGS(WARNING) << __func__ << ": Failed to write frame: "
                            << write_exception.value;
+      chunk_size_controller_.OnWriteFailed(GetMaxTransmitPacketSize());
       return write_exception;
     }
     Exception flush_exception = writer_->Flush();
     if (flush_exception.Raised()) {
       NEARBY_LOGS(WARNING) << __func__ << ": Failed to flush writer: "
                            << flush_exception.value;
+      chunk_size_controller_.OnWriteFailed(GetMaxTransmitPacketSize());
       return flush_exception;
     }
     packet_meta_data.StopSocketIo();
     packet_meta_data.SetPacketSize(data_size + sizeof(std::uint32_t));
+    chunk_size_controller_.OnFrameWritten(
+        GetMaxTransmitPacketSize(), GetMaxChunkSize(),
+        packet_meta_data.chunk_body_size,
+        packet_meta_data.socket_io_end_time -
+            packet_meta_data.socket_io_start_time);
   }
 
   {
@@ -261,6 +286,21 @@ Exception BaseEndpointChannel::Write(const ByteArray& data,
   return {Exception::kSuccess};
 }
 
+Exception BaseEndpointChannel::Write(const ByteArray& data) {
+  PacketMetaData packet_meta_data;
+  return Write(data, packet_meta_data);
+}
+
+Exception BaseEndpointChannel::Write(const ByteArray& data,
+                                     PacketMetaData& packet_meta_data) {
+  return WriteFrame(data, packet_meta_data);
+}
+
+Exception BaseEndpointChannel::Write(const ByteBuffer& data,
+                                     PacketMetaData& packet_meta_data) {
+  return WriteFrame(data, packet_meta_data);
+}
+
 void BaseEndpointChannel::Close() {
   {
     // In case channel is paused, resume it first thing.
@@ -342,6 +382,15 @@ int BaseEndpointChannel::GetMaxTransmitPacketSize() const {
   return kDefaultMaxTransmitPacketSize;
 }
 
+int BaseEndpointChannel::GetOptimalChunkSize() const {
+  return chunk_size_controller_.GetChunkSize(GetMaxTransmitPacketSize(),
+                                             GetMaxChunkSize());
+}
+
+int BaseEndpointChannel::GetMaxChunkSize() const {
+  return ChunkSizeController::kMaxChunkSize;
+}
+
 void BaseEndpointChannel::EnableEncryption(
     std::shared_ptr<EncryptionContext> context) {
   MutexLock crypto_lock(&crypto_mutex_);
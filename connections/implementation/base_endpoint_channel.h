@@ -22,8 +22,10 @@
 #include "absl/base/thread_annotations.h"
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/analytics/packet_meta_data.h"
+#include "connections/implementation/chunk_size_controller.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/mutex.h"
@@ -55,6 +57,8 @@ class BaseEndpointChannel : public EndpointChannel {
   Exception Write(const ByteArray& data) override;
   Exception Write(const ByteArray& data, PacketMetaData& packet_meta_data)
       ABSL_LOCKS_EXCLUDED(writer_mutex_, crypto_mutex_) override;
+  Exception Write(const ByteBuffer& data, PacketMetaData& packet_meta_data)
+      ABSL_LOCKS_EXCLUDED(writer_mutex_, crypto_mutex_) override;
   void Close() ABSL_LOCKS_EXCLUDED(is_paused_mutex_) override;
   void Close(location::nearby::proto::connections::DisconnectionReason reason)
       override;
@@ -67,6 +71,10 @@ class BaseEndpointChannel : public EndpointChannel {
   int GetFrequency() const override;
   int GetTryCount() const override;
   int GetMaxTransmitPacketSize() const override;
+  int GetOptimalChunkSize() const override;
+  // Returns the largest chunk size GetOptimalChunkSize() may grow to. Defaults
+  // to ChunkSizeController::kMaxChunkSize.
+  virtual int GetMaxChunkSize() const;
   void EnableEncryption(std::shared_ptr<EncryptionContext> context) override;
   void DisableEncryption() override;
   bool IsEncrypted() override;
@@ -95,6 +103,10 @@ class BaseEndpointChannel : public EndpointChannel {
 
   bool IsEncryptionEnabledLocked() const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(crypto_mutex_);
+  // Writes `data`, a ByteArray or a ByteBuffer, as one length-prefixed frame,
+  // encrypting it first if encryption is enabled.
+  template <typename Data>
+  Exception WriteFrame(const Data& data, PacketMetaData& packet_meta_data);
   void UnblockPausedWriter() ABSL_EXCLUSIVE_LOCKS_REQUIRED(is_paused_mutex_);
   void BlockUntilUnpaused() ABSL_EXCLUSIVE_LOCKS_REQUIRED(is_paused_mutex_);
   void CloseIo() ABSL_NO_THREAD_SAFETY_ANALYSIS;
@@ -141,6 +153,9 @@ class BaseEndpointChannel : public EndpointChannel {
 
   analytics::AnalyticsRecorder* analytics_recorder_ = nullptr;
   std::string endpoint_id_ = "";
+
+  // Adapts the payload chunk size to the measured write times.
+  ChunkSizeController chunk_size_controller_;
 };
 
 }  // namespace connections
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "securegcm/ukey2_handshake.h"
 #include "gmock/gmock.h"
@@ -28,11 +29,13 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "connections/implementation/chunk_size_controller.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/encryption_runner.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/offline_frames.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
@@ -62,6 +65,45 @@ class TestEndpointChannel : public BaseEndpointChannel {
   MOCK_METHOD(void, CloseImpl, (), (override));
 };
 
+// Keeps chunks at the packet size, like the BLE and Bluetooth channels.
+class PacketSizedChunksEndpointChannel : public TestEndpointChannel {
+ public:
+  using TestEndpointChannel::TestEndpointChannel;
+
+  int GetMaxChunkSize() const override { return GetMaxTransmitPacketSize(); }
+};
+
+// Records each write. Uses the default WriteBuffer unless `gather_writes`.
+class RecordingOutputStream : public OutputStream {
+ public:
+  explicit RecordingOutputStream(bool gather_writes = false)
+      : gather_writes_(gather_writes) {}
+
+  Exception Write(const ByteArray& data) override {
+    writes_.push_back(data);
+    written_data_.push_back(data.data());
+    return {Exception::kSuccess};
+  }
+  Exception WriteBuffer(const ByteBuffer& data) override {
+    if (!gather_writes_) return OutputStream::WriteBuffer(data);
+    writes_.push_back(data.Flatten());
+    return {Exception::kSuccess};
+  }
+  Exception Flush() override { return {Exception::kSuccess}; }
+  Exception Close() override { return {Exception::kSuccess}; }
+
+  const std::vector<ByteArray>& writes() const { return writes_; }
+  // The address of the bytes passed to each Write(const ByteArray&) call.
+  const std::vector<const char*>& written_data() const {
+    return written_data_;
+  }
+
+ private:
+  const bool gather_writes_;
+  std::vector<ByteArray> writes_;
+  std::vector<const char*> written_data_;
+};
+
 std::function<void()> MakeDataPump(
     std::string label, InputStream* input, OutputStream* output,
     std::function<void(const ByteArray&)> monitor = nullptr) {
@@ -181,6 +223,102 @@ TEST(BaseEndpointChannelTest, ReadWrite) {
   EXPECT_EQ(rx_message, tx_message);
 }
 
+TEST(BaseEndpointChannelTest, WriteSendsHeaderAndBodyInOneGatherWrite) {
+  auto [input, unused_output] = CreatePipe();
+  RecordingOutputStream output(/*gather_writes=*/true);
+  TestEndpointChannel channel(input.get(), &output);
+  ByteBuffer tx_message{ByteArray("data message")};
+  PacketMetaData packet_meta_data;
+
+  EXPECT_FALSE(channel.Write(tx_message, packet_meta_data).Raised());
+
+  ASSERT_EQ(output.writes().size(), 1);
+  const ByteArray& frame = output.writes()[0];
+  ASSERT_EQ(frame.size(), 4 + tx_message.size());
+  EXPECT_EQ(std::string(frame).substr(4), std::string(tx_message.Flatten()));
+}
+
+TEST(BaseEndpointChannelTest, WriteCopiesSmallFrameIntoOneWriteByDefault) {
+  auto [input, unused_output] = CreatePipe();
+  RecordingOutputStream output;
+  TestEndpointChannel channel(input.get(), &output);
+  ByteBuffer tx_message{ByteArray("data message")};
+  PacketMetaData packet_meta_data;
+
+  EXPECT_FALSE(channel.Write(tx_message, packet_meta_data).Raised());
+
+  ASSERT_EQ(output.writes().size(), 1);
+  EXPECT_EQ(output.writes()[0].size(), 4 + tx_message.size());
+  EXPECT_EQ(std::string(output.writes()[0]).substr(4),
+            std::string(tx_message.Flatten()));
+}
+
+TEST(BaseEndpointChannelTest, WritePassesLargeBodyThroughByDefault) {
+  auto [input, unused_output] = CreatePipe();
+  RecordingOutputStream output;
+  TestEndpointChannel channel(input.get(), &output);
+  ByteArray tx_message{std::string(OutputStream::kMaxCoalescedWriteSize, 'a')};
+
+  EXPECT_FALSE(channel.Write(tx_message).Raised());
+
+  ASSERT_EQ(output.writes().size(), 2);
+  EXPECT_EQ(output.writes()[0].size(), 4);
+  ASSERT_EQ(output.written_data().size(), 2);
+  EXPECT_EQ(output.written_data()[1], tx_message.data());
+}
+
+TEST(BaseEndpointChannelTest, WriteSendsByteArrayFrameInOneGatherWrite) {
+  auto [input, unused_output] = CreatePipe();
+  RecordingOutputStream output(/*gather_writes=*/true);
+  TestEndpointChannel channel(input.get(), &output);
+  ByteArray tx_message{"data message"};
+
+  EXPECT_FALSE(channel.Write(tx_message).Raised());
+
+  ASSERT_EQ(output.writes().size(), 1);
+  const ByteArray& frame = output.writes()[0];
+  ASSERT_EQ(frame.size(), 4 + tx_message.size());
+  EXPECT_EQ(std::string(frame).substr(4), std::string(tx_message));
+}
+
+TEST(BaseEndpointChannelTest, OnlyFullChunkBodiesGrowOptimalChunkSize) {
+  auto [input, unused_output] = CreatePipe();
+  RecordingOutputStream output(/*gather_writes=*/true);
+  TestEndpointChannel channel(input.get(), &output);
+  const int default_chunk_size = channel.GetOptimalChunkSize();
+  // Bigger than a chunk, but it carries no chunk body.
+  ByteBuffer control_frame{ByteArray(2 * default_chunk_size)};
+
+  for (int i = 0; i < 2 * ChunkSizeController::kFastWritesToGrow; ++i) {
+    PacketMetaData packet_meta_data;
+    EXPECT_FALSE(channel.Write(control_frame, packet_meta_data).Raised());
+  }
+  EXPECT_EQ(channel.GetOptimalChunkSize(), default_chunk_size);
+
+  ByteBuffer data_frame{ByteArray(default_chunk_size + 100)};
+  for (int i = 0; i < ChunkSizeController::kFastWritesToGrow; ++i) {
+    PacketMetaData packet_meta_data;
+    packet_meta_data.SetChunkBodySize(default_chunk_size);
+    EXPECT_FALSE(channel.Write(data_frame, packet_meta_data).Raised());
+  }
+  EXPECT_EQ(channel.GetOptimalChunkSize(), 2 * default_chunk_size);
+}
+
+TEST(BaseEndpointChannelTest, OptimalChunkSizeDoesNotGrowPastMaxChunkSize) {
+  auto [input, unused_output] = CreatePipe();
+  RecordingOutputStream output(/*gather_writes=*/true);
+  PacketSizedChunksEndpointChannel channel(input.get(), &output);
+  const int default_chunk_size = channel.GetOptimalChunkSize();
+  ByteBuffer data_frame{ByteArray(default_chunk_size + 100)};
+
+  for (int i = 0; i < 2 * ChunkSizeController::kFastWritesToGrow; ++i) {
+    PacketMetaData packet_meta_data;
+    packet_meta_data.SetChunkBodySize(default_chunk_size);
+    EXPECT_FALSE(channel.Write(data_frame, packet_meta_data).Raised());
+  }
+  EXPECT_EQ(channel.GetOptimalChunkSize(), default_chunk_size);
+}
+
 TEST(BaseEndpointChannelTest, ChannelUnencryptedByDefault) {
   auto pipe = CreatePipe();
   TestEndpointChannel channel(pipe.first.get(), pipe.second.get());
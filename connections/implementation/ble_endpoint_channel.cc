@@ -53,6 +53,8 @@ int BleEndpointChannel::GetMaxTransmitPacketSize() const {
   return kDefaultBleMaxTransmitPacketSize;
 }
 
+int BleEndpointChannel::GetMaxChunkSize() const { return GetMaxTransmitPacketSize(); }
+
 void BleEndpointChannel::CloseImpl() {
   auto status = ble_socket_.Close();
   if (!status.Ok()) {
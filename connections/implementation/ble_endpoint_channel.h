@@ -32,6 +32,9 @@ class BleEndpointChannel final : public BaseEndpointChannel {
   location::nearby::proto::connections::Medium GetMedium() const override;
 
   int GetMaxTransmitPacketSize() const override;
+  // Keeps payload chunks at the packet size; larger chunks only add latency
+  // on this medium.
+  int GetMaxChunkSize() const override;
 
  private:
   static constexpr int kDefaultBleMaxTransmitPacketSize = 512;  // 512 bytes
@@ -58,6 +58,8 @@ int BleV2EndpointChannel::GetMaxTransmitPacketSize() const {
   return kDefaultBleMaxTransmitPacketSize;
 }
 
+int BleV2EndpointChannel::GetMaxChunkSize() const { return GetMaxTransmitPacketSize(); }
+
 void BleV2EndpointChannel::CloseImpl() {
   Exception status = ble_socket_.Close();
   if (!status.Ok()) {
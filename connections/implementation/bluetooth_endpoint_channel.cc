@@ -53,6 +53,8 @@ int BluetoothEndpointChannel::GetMaxTransmitPacketSize() const {
   return kDefaultBTMaxTransmitPacketSize;
 }
 
+int BluetoothEndpointChannel::GetMaxChunkSize() const { return GetMaxTransmitPacketSize(); }
+
 void BluetoothEndpointChannel::CloseImpl() {
   auto status = bluetooth_socket_.Close();
   if (!status.Ok()) {
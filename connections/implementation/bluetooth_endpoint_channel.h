@@ -33,6 +33,9 @@ class BluetoothEndpointChannel final : public BaseEndpointChannel {
   location::nearby::proto::connections::Medium GetMedium() const override;
 
   int GetMaxTransmitPacketSize() const override;
+  // Keeps payload chunks at the packet size; larger chunks only add latency
+  // on this medium.
+  int GetMaxChunkSize() const override;
 
  private:
   static constexpr int kDefaultBTMaxTransmitPacketSize = 1980;  // 990 * 2 Bytes
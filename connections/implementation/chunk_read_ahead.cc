@@ -0,0 +1,86 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/chunk_read_ahead.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "connections/implementation/internal_payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+ChunkReadAhead::ChunkReadAhead(InternalPayload* internal_payload, int depth)
+    : internal_payload_(internal_payload), depth_(std::max(depth, 1)) {}
+
+ChunkReadAhead::~ChunkReadAhead() {
+  {
+    MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  executor_.Shutdown();
+}
+
+ByteArray ChunkReadAhead::DetachNextChunk(int chunk_size) {
+  MutexLock lock(&mutex_);
+  chunk_size_ = chunk_size;
+  ScheduleReadsLocked();
+  while (chunks_.empty() && !end_of_payload_) {
+    chunk_ready_.Wait();
+  }
+  if (chunks_.empty()) return {};
+
+  ByteArray chunk = std::move(chunks_.front());
+  chunks_.pop_front();
+  ScheduleReadsLocked();
+  return chunk;
+}
+
+void ChunkReadAhead::ScheduleReadsLocked() {
+  while (!end_of_payload_ && !shutdown_ &&
+         static_cast<int>(chunks_.size()) + pending_reads_ < depth_) {
+    ++pending_reads_;
+    executor_.Execute("read-ahead", [this, chunk_size = chunk_size_]() {
+      ReadChunk(chunk_size);
+    });
+  }
+}
+
+void ChunkReadAhead::ReadChunk(int chunk_size) {
+  {
+    MutexLock lock(&mutex_);
+    if (shutdown_ || end_of_payload_) {
+      --pending_reads_;
+      return;
+    }
+  }
+
+  // Reads run one at a time on `executor_`, so chunks are queued in order.
+  ByteArray chunk = internal_payload_->DetachNextChunk(chunk_size);
+
+  MutexLock lock(&mutex_);
+  --pending_reads_;
+  if (chunk.Empty()) {
+    end_of_payload_ = true;
+  } else {
+    chunks_.push_back(std::move(chunk));
+  }
+  chunk_ready_.Notify();
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,74 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_CHUNK_READ_AHEAD_H_
+#define CORE_INTERNAL_CHUNK_READ_AHEAD_H_
+
+#include <deque>
+
+#include "absl/base/thread_annotations.h"
+#include "connections/implementation/internal_payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+
+// Reads the chunks of an outgoing payload ahead of the sender, on a thread of
+// its own, keeping up to `depth` chunks buffered. This lets the read of the
+// next chunks overlap with encrypting and writing the current one, instead of
+// the three stages running strictly one after the other.
+//
+// The first read is issued by the first DetachNextChunk() call, so callers may
+// still move the payload to a resume offset before that.
+class ChunkReadAhead {
+ public:
+  // `internal_payload` must outlive this object. Nothing else may detach
+  // chunks from it while this object is alive.
+  ChunkReadAhead(InternalPayload* internal_payload, int depth);
+  ChunkReadAhead(const ChunkReadAhead&) = delete;
+  ChunkReadAhead& operator=(const ChunkReadAhead&) = delete;
+  // Stops reading ahead; waits for a read in progress to finish.
+  ~ChunkReadAhead();
+
+  // Same contract as InternalPayload::DetachNextChunk(): returns the next
+  // chunk, or an empty ByteArray once the end of the payload is reached.
+  // Blocks until the next chunk has been read. `chunk_size` applies to reads
+  // scheduled from now on; chunks already read or scheduled keep their size.
+  ByteArray DetachNextChunk(int chunk_size) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void ScheduleReadsLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ReadChunk(int chunk_size) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  InternalPayload* const internal_payload_;
+  const int depth_;
+
+  Mutex mutex_;
+  ConditionVariable chunk_ready_{&mutex_};
+  int chunk_size_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::deque<ByteArray> chunks_ ABSL_GUARDED_BY(mutex_);
+  int pending_reads_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool end_of_payload_ ABSL_GUARDED_BY(mutex_) = false;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  SingleThreadExecutor executor_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_CHUNK_READ_AHEAD_H_
@@ -0,0 +1,119 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/chunk_read_ahead.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/mutex.h"
+#include "connections/implementation/internal_payload.h"
+#include "connections/payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+// Hands out `data` in chunks of the requested size, and records the sizes.
+class FakeInternalPayload : public InternalPayload {
+ public:
+  explicit FakeInternalPayload(std::string data)
+      : InternalPayload(Payload(ByteArray())), data_(std::move(data)) {}
+
+  location::nearby::connections::PayloadTransferFrame::PayloadHeader::
+      PayloadType
+      GetType() const override {
+    return location::nearby::connections::PayloadTransferFrame::PayloadHeader::
+        FILE;
+  }
+  std::int64_t GetTotalSize() const override { return data_.size(); }
+
+  ByteArray DetachNextChunk(int chunk_size) override {
+    absl::MutexLock lock(&mutex_);
+    read_sizes_.push_back(chunk_size);
+    size_t size = std::min<size_t>(chunk_size, data_.size() - offset_);
+    ByteArray chunk(data_.data() + offset_, size);
+    offset_ += size;
+    return chunk;
+  }
+  Exception AttachNextChunk(ByteArray chunk) override {
+    return {Exception::kIo};
+  }
+  ExceptionOr<size_t> SkipToOffset(size_t offset) override {
+    return {Exception::kIo};
+  }
+
+  std::vector<int> read_sizes() {
+    absl::MutexLock lock(&mutex_);
+    return read_sizes_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  const std::string data_;
+  size_t offset_ = 0;
+  std::vector<int> read_sizes_;
+};
+
+TEST(ChunkReadAheadTest, ReturnsChunksInOrder) {
+  FakeInternalPayload payload("0123456789");
+  ChunkReadAhead read_ahead(&payload, /*depth=*/3);
+
+  EXPECT_EQ(read_ahead.DetachNextChunk(4), ByteArray("0123"));
+  EXPECT_EQ(read_ahead.DetachNextChunk(4), ByteArray("4567"));
+  EXPECT_EQ(read_ahead.DetachNextChunk(4), ByteArray("89"));
+  EXPECT_TRUE(read_ahead.DetachNextChunk(4).Empty());
+  EXPECT_TRUE(read_ahead.DetachNextChunk(4).Empty());
+}
+
+TEST(ChunkReadAheadTest, DoesNotReadPastEndOfPayload) {
+  FakeInternalPayload payload("0123");
+  {
+    ChunkReadAhead read_ahead(&payload, /*depth=*/8);
+    EXPECT_EQ(read_ahead.DetachNextChunk(4), ByteArray("0123"));
+    EXPECT_TRUE(read_ahead.DetachNextChunk(4).Empty());
+  }
+
+  // One read for the data, one that found the end.
+  EXPECT_EQ(payload.read_sizes().size(), 2);
+}
+
+TEST(ChunkReadAheadTest, NewChunkSizeAppliesToLaterReads) {
+  FakeInternalPayload payload(std::string(100, 'x'));
+  ChunkReadAhead read_ahead(&payload, /*depth=*/1);
+
+  EXPECT_EQ(read_ahead.DetachNextChunk(10).size(), 10);
+  // The chunk after the first one was read ahead with the old size.
+  EXPECT_EQ(read_ahead.DetachNextChunk(20).size(), 10);
+  EXPECT_EQ(read_ahead.DetachNextChunk(20).size(), 20);
+}
+
+TEST(ChunkReadAheadTest, CanBeDestroyedWhileReadingAhead) {
+  FakeInternalPayload payload(std::string(1000, 'x'));
+  {
+    ChunkReadAhead read_ahead(&payload, /*depth=*/4);
+    EXPECT_EQ(read_ahead.DetachNextChunk(10).size(), 10);
+  }
+
+  EXPECT_LE(payload.read_sizes().size(), 5);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,104 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/chunk_size_controller.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/time/time.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+// Bounds the level so shifting the default chunk size can not overflow.
+constexpr int kMaxLevel = 16;
+}  // namespace
+
+int ChunkSizeController::GetChunkSize(int default_chunk_size,
+                                      int max_chunk_size) const {
+  MutexLock lock(&mutex_);
+  return GetChunkSizeForLevel(default_chunk_size, max_chunk_size, level_);
+}
+
+void ChunkSizeController::OnFrameWritten(int default_chunk_size,
+                                         int max_chunk_size,
+                                         size_t chunk_body_size,
+                                         absl::Duration write_time) {
+  MutexLock lock(&mutex_);
+  int chunk_size =
+      GetChunkSizeForLevel(default_chunk_size, max_chunk_size, level_);
+  if (write_time >= kSlowWriteTime) {
+    ShrinkLocked(default_chunk_size);
+    return;
+  }
+  // Frames without a full chunk (control frames, the last chunk of a payload)
+  // say nothing about how the link copes with full chunks.
+  if (chunk_body_size < static_cast<size_t>(chunk_size)) return;
+  if (write_time > kFastWriteTime) {
+    fast_writes_ = 0;
+    return;
+  }
+  if (++fast_writes_ < kFastWritesToGrow) return;
+  fast_writes_ = 0;
+  if (chunk_size >= std::min(max_chunk_size, kMaxChunkSize) ||
+      level_ >= kMaxLevel) {
+    return;
+  }
+  ++level_;
+  NEARBY_LOGS(INFO) << "ChunkSizeController: growing chunk size from "
+                    << chunk_size << " to "
+                    << GetChunkSizeForLevel(default_chunk_size, max_chunk_size,
+                                            level_);
+}
+
+void ChunkSizeController::OnWriteFailed(int default_chunk_size) {
+  MutexLock lock(&mutex_);
+  ShrinkLocked(default_chunk_size);
+}
+
+int ChunkSizeController::GetChunkSizeForLevel(int default_chunk_size,
+                                              int max_chunk_size, int level) {
+  if (default_chunk_size <= 0) return default_chunk_size;
+  std::int64_t chunk_size = level >= 0
+                                ? std::int64_t{default_chunk_size} << level
+                                : std::int64_t{default_chunk_size} >> -level;
+  std::int64_t min_chunk_size = std::min(default_chunk_size, kMinChunkSize);
+  return static_cast<int>(std::clamp<std::int64_t>(
+      chunk_size, min_chunk_size,
+      std::max<std::int64_t>(std::min(max_chunk_size, kMaxChunkSize),
+                             min_chunk_size)));
+}
+
+void ChunkSizeController::ShrinkLocked(int default_chunk_size) {
+  fast_writes_ = 0;
+  int chunk_size =
+      GetChunkSizeForLevel(default_chunk_size, kMaxChunkSize, level_);
+  if (chunk_size <= std::min(default_chunk_size, kMinChunkSize) ||
+      level_ <= -kMaxLevel) {
+    return;
+  }
+  --level_;
+  NEARBY_LOGS(INFO) << "ChunkSizeController: shrinking chunk size from "
+                    << chunk_size << " to "
+                    << GetChunkSizeForLevel(default_chunk_size, kMaxChunkSize,
+                                            level_);
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,85 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_CHUNK_SIZE_CONTROLLER_H_
+#define CORE_INTERNAL_CHUNK_SIZE_CONTROLLER_H_
+
+#include <cstddef>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/time/time.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// Picks the payload chunk size for one EndpointChannel from the measured time
+// it takes to write frames to the socket.
+//
+// The chunk size is kept as a power-of-two multiple of the medium's default
+// packet size. Consecutive fast writes of full chunks double it, up to the
+// medium's maximum (never more than kMaxChunkSize); a slow or failed write
+// halves it, down to kMinChunkSize (or the medium's default, if that is
+// smaller). This grows chunks on fast, low
+// latency links such as 5 GHz WifiLan, and backs off on congested or lossy
+// ones.
+class ChunkSizeController {
+ public:
+  // Largest chunk we hand out. Leaves room for the OfflineFrame and encryption
+  // overhead within BaseEndpointChannel's 1 MB frame limit.
+  static constexpr int kMaxChunkSize = 1024 * 1024 - 4 * 1024;
+  // Smallest chunk we shrink to, unless the medium's default is smaller.
+  static constexpr int kMinChunkSize = 512;
+  // A full chunk written faster than this counts towards growing the size.
+  static constexpr absl::Duration kFastWriteTime = absl::Milliseconds(25);
+  // A write slower than this shrinks the size.
+  static constexpr absl::Duration kSlowWriteTime = absl::Milliseconds(400);
+  // Number of consecutive fast writes required before growing.
+  static constexpr int kFastWritesToGrow = 3;
+
+  ChunkSizeController() = default;
+  ChunkSizeController(const ChunkSizeController&) = delete;
+  ChunkSizeController& operator=(const ChunkSizeController&) = delete;
+
+  // Returns the chunk size to use, derived from the medium's default packet
+  // size `default_chunk_size` and capped at `max_chunk_size`.
+  int GetChunkSize(int default_chunk_size, int max_chunk_size) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Records that a frame carrying a payload chunk body of `chunk_body_size`
+  // bytes (0 if it carries none) was written in `write_time`. The chunk size
+  // does not grow past `max_chunk_size`.
+  void OnFrameWritten(int default_chunk_size, int max_chunk_size,
+                      size_t chunk_body_size, absl::Duration write_time)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Records that writing a frame failed.
+  void OnWriteFailed(int default_chunk_size) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  static int GetChunkSizeForLevel(int default_chunk_size, int max_chunk_size,
+                                  int level);
+  void ShrinkLocked(int default_chunk_size)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable Mutex mutex_;
+  // The chunk size is default_chunk_size * 2^level_.
+  int level_ ABSL_GUARDED_BY(mutex_) = 0;
+  int fast_writes_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_CHUNK_SIZE_CONTROLLER_H_
@@ -0,0 +1,157 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/chunk_size_controller.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr int kDefaultChunkSize = 64 * 1024;
+constexpr int kMaxChunkSize = ChunkSizeController::kMaxChunkSize;
+constexpr absl::Duration kFastWrite = absl::Milliseconds(5);
+constexpr absl::Duration kModerateWrite = absl::Milliseconds(100);
+constexpr absl::Duration kSlowWrite = absl::Seconds(1);
+
+void WriteFullChunks(ChunkSizeController& controller, int count,
+                     absl::Duration write_time,
+                     int max_chunk_size = kMaxChunkSize) {
+  for (int i = 0; i < count; ++i) {
+    controller.OnFrameWritten(
+        kDefaultChunkSize, max_chunk_size,
+        controller.GetChunkSize(kDefaultChunkSize, max_chunk_size),
+        write_time);
+  }
+}
+
+TEST(ChunkSizeControllerTest, StartsAtDefaultChunkSize) {
+  ChunkSizeController controller;
+
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            kDefaultChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, GrowsAfterConsecutiveFastWrites) {
+  ChunkSizeController controller;
+
+  WriteFullChunks(controller, ChunkSizeController::kFastWritesToGrow - 1,
+                  kFastWrite);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            kDefaultChunkSize);
+
+  WriteFullChunks(controller, 1, kFastWrite);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            2 * kDefaultChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, ModerateWriteResetsGrowth) {
+  ChunkSizeController controller;
+
+  WriteFullChunks(controller, ChunkSizeController::kFastWritesToGrow - 1,
+                  kFastWrite);
+  WriteFullChunks(controller, 1, kModerateWrite);
+  WriteFullChunks(controller, ChunkSizeController::kFastWritesToGrow - 1,
+                  kFastWrite);
+
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            kDefaultChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, SmallFramesDoNotGrow) {
+  ChunkSizeController controller;
+
+  for (int i = 0; i < 10; ++i) {
+    controller.OnFrameWritten(kDefaultChunkSize, kMaxChunkSize, 100,
+                              kFastWrite);
+  }
+
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            kDefaultChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, IsCappedAtMaxChunkSize) {
+  ChunkSizeController controller;
+
+  WriteFullChunks(controller, 100, kFastWrite);
+
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            ChunkSizeController::kMaxChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, IsCappedAtMediumMaxChunkSize) {
+  constexpr int kMediumMaxChunkSize = 2 * kDefaultChunkSize;
+  ChunkSizeController controller;
+
+  WriteFullChunks(controller, 100, kFastWrite, kMediumMaxChunkSize);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMediumMaxChunkSize),
+            kMediumMaxChunkSize);
+
+  // The level stopped at the cap, so a single slow write backs off.
+  WriteFullChunks(controller, 1, kSlowWrite, kMediumMaxChunkSize);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMediumMaxChunkSize),
+            kDefaultChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, ShrinksOnSlowWriteAndFailure) {
+  ChunkSizeController controller;
+  WriteFullChunks(controller, 2 * ChunkSizeController::kFastWritesToGrow,
+                  kFastWrite);
+  ASSERT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            4 * kDefaultChunkSize);
+
+  WriteFullChunks(controller, 1, kSlowWrite);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            2 * kDefaultChunkSize);
+
+  controller.OnWriteFailed(kDefaultChunkSize);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            kDefaultChunkSize);
+
+  controller.OnWriteFailed(kDefaultChunkSize);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            kDefaultChunkSize / 2);
+}
+
+TEST(ChunkSizeControllerTest, NeverShrinksBelowMinChunkSize) {
+  ChunkSizeController controller;
+
+  for (int i = 0; i < 100; ++i) {
+    controller.OnWriteFailed(kDefaultChunkSize);
+  }
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            ChunkSizeController::kMinChunkSize);
+
+  // Grows back right away; failures do not build up below the minimum.
+  WriteFullChunks(controller, ChunkSizeController::kFastWritesToGrow,
+                  kFastWrite);
+  EXPECT_EQ(controller.GetChunkSize(kDefaultChunkSize, kMaxChunkSize),
+            2 * ChunkSizeController::kMinChunkSize);
+}
+
+TEST(ChunkSizeControllerTest, KeepsSmallMediumDefault) {
+  constexpr int kBleChunkSize = 256;
+  ChunkSizeController controller;
+
+  controller.OnWriteFailed(kBleChunkSize);
+
+  EXPECT_EQ(controller.GetChunkSize(kBleChunkSize, kBleChunkSize),
+            kBleChunkSize);
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -857,6 +857,15 @@ bool ClientProxy::IsPayloadReceivedAckEnabled(absl::string_view endpoint_id) {
               .min_nc_version_supports_payload_received_ack);
 }
 
+bool ClientProxy::IsResumableFileTransferEnabled(
+    absl::string_view endpoint_id) {
+  return GetRemoteSafeToDisconnectVersion(endpoint_id).has_value() &&
+         (GetRemoteSafeToDisconnectVersion(endpoint_id) >=
+          FeatureFlags::GetInstance()
+              .GetFlags()
+              .min_nc_version_supports_resumable_file_transfers);
+}
+
 void ClientProxy::CancelAllEndpoints() {
   for (const auto& item : cancellation_flags_) {
     CancellationFlag* cancellation_flag = item.second.get();
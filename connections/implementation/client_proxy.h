@@ -280,6 +280,9 @@ class ClientProxy final {
       const std::int32_t& safe_to_disconnect_version);
   bool IsSafeToDisconnectEnabled(absl::string_view endpoint_id);
   bool IsPayloadReceivedAckEnabled(absl::string_view endpoint_id);
+  // True if the remote endpoint has resumable file transfers enabled; it only
+  // claims the version that supports them then.
+  bool IsResumableFileTransferEnabled(absl::string_view endpoint_id);
 
  private:
   struct Connection {
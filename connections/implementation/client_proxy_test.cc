@@ -1050,6 +1050,21 @@ TEST_F(ClientProxyTest, SetRemoteInfoCorrect) {
             nearby_connections_version);
 }
 
+TEST_F(ClientProxyTest, ResumableFileTransferNeedsRemoteVersion) {
+  Endpoint advertising_endpoint =
+      StartAdvertising(&client1_, advertising_connection_listener_);
+  OnAdvertisingConnectionInitiated(&client1_, advertising_endpoint);
+
+  EXPECT_FALSE(
+      client1_.IsResumableFileTransferEnabled(advertising_endpoint.id));
+  client1_.SetRemoteSafeToDisconnectVersion(advertising_endpoint.id, 5);
+  EXPECT_FALSE(
+      client1_.IsResumableFileTransferEnabled(advertising_endpoint.id));
+  client1_.SetRemoteSafeToDisconnectVersion(advertising_endpoint.id, 6);
+  EXPECT_TRUE(
+      client1_.IsResumableFileTransferEnabled(advertising_endpoint.id));
+}
+
 // Test ClientProxy::AddCancellationFlag, where if a flag is already in the map,
 // uncancel it. This addresses the case when users use NS to share/receive a
 // file, then cancel in the middle because the wrong file was selected, and then
@@ -22,6 +22,7 @@
 #include "connections/implementation/analytics/analytics_recorder.h"
 #include "connections/implementation/analytics/packet_meta_data.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/mutex.h"
 
@@ -46,6 +47,15 @@ class EndpointChannel {
   virtual Exception Write(
       const ByteArray& data,
       PacketMetaData& packet_meta_data) = 0;  // throws Exception::IO
+
+  // Writes a frame held in a ByteBuffer. Implementations that can pass the
+  // buffer segments down without flattening them should override this.
+  // throws Exception::IO
+  virtual Exception Write(const ByteBuffer& data,
+                          PacketMetaData& packet_meta_data) {
+    return Write(data.Flatten(), packet_meta_data);
+  }
+
   // Closes this EndpointChannel, without tracking the closure in analytics.
 
   virtual void Close() = 0;
@@ -85,6 +95,11 @@ class EndpointChannel {
   // transport.
   virtual int GetMaxTransmitPacketSize() const = 0;
 
+  // Returns the payload chunk size that currently suits the underlying
+  // transport best, based on how fast earlier frames were written. Defaults to
+  // GetMaxTransmitPacketSize() for channels that do not measure this.
+  virtual int GetOptimalChunkSize() const { return GetMaxTransmitPacketSize(); }
+
   // Enables encryption on the EndpointChannel.
   virtual void EnableEncryption(std::shared_ptr<EncryptionContext> context) = 0;
 
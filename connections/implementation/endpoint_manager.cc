@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,10 +27,13 @@
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/endpoint_channel_manager.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames.h"
 #include "connections/implementation/payload_manager.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/implementation/service_id_constants.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/feature_flags.h"
@@ -59,6 +63,22 @@ constexpr absl::Time kInvalidTimestamp = absl::InfinitePast();
 // The maximum time we will wait for the encryption setup during negotiating a
 // connection.
 constexpr absl::Duration kDecryptRetryTimeout = absl::Seconds(3);
+
+// Counts a latch down when destroyed. A write task owns one, so the sender
+// waiting for the write wakes up whether the task runs or is dropped.
+class CountDownOnDestroy {
+ public:
+  explicit CountDownOnDestroy(CountDownLatch* latch) : latch_(latch) {}
+  CountDownOnDestroy(CountDownOnDestroy&& other)
+      : latch_(std::exchange(other.latch_, nullptr)) {}
+  CountDownOnDestroy& operator=(CountDownOnDestroy&&) = delete;
+  ~CountDownOnDestroy() {
+    if (latch_ != nullptr) latch_->CountDown();
+  }
+
+ private:
+  CountDownLatch* latch_;
+};
 }  // namespace
 
 class EndpointManager::LockedFrameProcessor {
@@ -350,6 +370,29 @@ ExceptionOr<bool> EndpointManager::HandleKeepAlive(
     EndpointChannel* endpoint_channel, absl::Duration keep_alive_interval,
     absl::Duration keep_alive_timeout, Mutex* keep_alive_waiter_mutex,
     ConditionVariable* keep_alive_waiter) {
+  ExceptionOr<absl::Duration> wait_for = CheckKeepAlive(
+      endpoint_channel, keep_alive_interval, keep_alive_timeout);
+  if (!wait_for.ok()) {
+    if (wait_for.GetException().Raised(Exception::kTimeout)) {
+      return ExceptionOr<bool>(false);
+    }
+    return ExceptionOr<bool>(wait_for.exception());
+  }
+
+  {
+    MutexLock lock(keep_alive_waiter_mutex);
+    Exception wait_exception = keep_alive_waiter->Wait(wait_for.result());
+    if (!wait_exception.Ok()) {
+      return ExceptionOr<bool>(wait_exception);
+    }
+  }
+
+  return ExceptionOr<bool>(true);
+}
+
+ExceptionOr<absl::Duration> EndpointManager::CheckKeepAlive(
+    EndpointChannel* endpoint_channel, absl::Duration keep_alive_interval,
+    absl::Duration keep_alive_timeout) {
   // Check if it has been too long since we received a frame from our endpoint.
   absl::Time last_read_time = endpoint_channel->GetLastReadTimestamp();
   absl::Duration duration_until_timeout =
@@ -358,7 +401,7 @@ ExceptionOr<bool> EndpointManager::HandleKeepAlive(
           : last_read_time + keep_alive_timeout -
                 SystemClock::ElapsedRealtime();
   if (duration_until_timeout <= absl::ZeroDuration()) {
-    return ExceptionOr<bool>(false);
+    return ExceptionOr<absl::Duration>(Exception::kTimeout);
   }
 
   // If we haven't written anything to the endpoint for a while, attempt to
@@ -374,22 +417,46 @@ ExceptionOr<bool> EndpointManager::HandleKeepAlive(
   if (duration_until_write_keep_alive <= absl::ZeroDuration()) {
     Exception write_exception = endpoint_channel->Write(parser::ForKeepAlive());
     if (!write_exception.Ok()) {
-      return ExceptionOr<bool>(write_exception);
+      return ExceptionOr<absl::Duration>(write_exception);
     }
     duration_until_write_keep_alive = keep_alive_interval;
   }
 
-  absl::Duration wait_for =
-      std::min(duration_until_timeout, duration_until_write_keep_alive);
-  {
-    MutexLock lock(keep_alive_waiter_mutex);
-    Exception wait_exception = keep_alive_waiter->Wait(wait_for);
-    if (!wait_exception.Ok()) {
-      return ExceptionOr<bool>(wait_exception);
+  return ExceptionOr<absl::Duration>(
+      std::min(duration_until_timeout, duration_until_write_keep_alive));
+}
+
+std::optional<absl::Duration> EndpointManager::OnKeepAliveTimer(
+    ClientProxy* client, const std::string& endpoint_id,
+    absl::Duration keep_alive_interval, absl::Duration keep_alive_timeout,
+    Medium* last_failed_medium) {
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+  // As in EndpointChannelLoopRunnable(), give up if the channel is gone, or if
+  // it's still the one that failed last time.
+  if (channel != nullptr && (*last_failed_medium == Medium::UNKNOWN_MEDIUM ||
+                             channel->GetMedium() != *last_failed_medium)) {
+    ExceptionOr<absl::Duration> wait_for =
+        CheckKeepAlive(channel.get(), keep_alive_interval, keep_alive_timeout);
+    if (wait_for.ok()) return wait_for.result();
+    if (!wait_for.GetException().Raised(Exception::kTimeout)) {
+      // Check again right away, in case the endpoint got a new channel.
+      *last_failed_medium = channel->GetMedium();
+      NEARBY_LOGS(INFO) << "KeepAlive write failed; last_failed_medium="
+                        << location::nearby::proto::connections::Medium_Name(
+                               *last_failed_medium);
+      return absl::ZeroDuration();
+    }
+    if (client->IsSafeToDisconnectEnabled(endpoint_id)) {
+      channel_manager_->MarkEndpointStopWaitToDisconnect(
+          endpoint_id, /* is_safe_to_disconnect */ false,
+          /* notify_stop_waiting */ true);
     }
   }
-
-  return ExceptionOr<bool>(true);
+  NEARBY_LOGS(INFO) << "KeepAlive timer going down; endpoint_id="
+                    << endpoint_id;
+  DiscardEndpoint(client, endpoint_id, DisconnectionReason::IO_ERROR);
+  return std::nullopt;
 }
 
 bool operator==(const EndpointManager::FrameProcessor& lhs,
@@ -412,7 +479,20 @@ EndpointManager::EndpointManager(EndpointChannelManager* manager)
 EndpointManager::EndpointManager(
     EndpointChannelManager* manager,
     std::unique_ptr<SingleThreadExecutor> serial_executor)
-    : channel_manager_(manager), serial_executor_(std::move(serial_executor)) {}
+    : channel_manager_(manager), serial_executor_(std::move(serial_executor)) {
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableKeepAliveTimerWheel)) {
+    keep_alive_wheel_ = std::make_unique<TimerWheel>(
+        kKeepAliveTimerTick, kKeepAliveTimerSlots, kMaxIdleKeepAliveThreads);
+  }
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableOverlappedEndpointWrites)) {
+    write_executor_ =
+        std::make_unique<KeyedSerialExecutor>(kMaxOverlappedEndpointWrites);
+  }
+}
 
 EndpointManager::~EndpointManager() {
   NEARBY_LOG(INFO, "Initiating shutdown of EndpointManager.");
@@ -431,6 +511,8 @@ EndpointManager::~EndpointManager() {
 
   NEARBY_LOG(INFO, "Bringing down control thread");
   serial_executor_->Shutdown();
+  if (keep_alive_wheel_) keep_alive_wheel_->Shutdown();
+  if (write_executor_) write_executor_->Shutdown();
   NEARBY_LOG(INFO, "EndpointManager is down");
 }
 
@@ -552,7 +634,9 @@ void EndpointManager::RegisterEndpoint(
 
     EndpointState& endpoint_state =
         endpoints_
-            .emplace(endpoint_id, EndpointState(endpoint_id, channel_manager_))
+            .emplace(endpoint_id,
+                     EndpointState(endpoint_id, channel_manager_,
+                                   keep_alive_wheel_.get()))
             .first->second;
 
     NEARBY_LOGS(INFO) << "Starting workers: endpoint " << endpoint_id;
@@ -572,7 +656,8 @@ void EndpointManager::RegisterEndpoint(
     });
 
     // For every endpoint, there's only one KeepAliveManager instance
-    // running on a dedicated thread. This instance will periodically send
+    // running on a dedicated thread (or, with kEnableKeepAliveTimerWheel, as
+    // a timer on the shared wheel). This instance will periodically send
     // out a ping* to the endpoint while listening for an incoming pong**.
     // If it fails to send the ping, or if no pong is heard within
     // keep_alive_timeout, it initiates a disconnection.
@@ -585,20 +670,29 @@ void EndpointManager::RegisterEndpoint(
     // listen for the pong.
     NEARBY_LOGS(VERBOSE) << "EndpointManager enabling KeepAlive for endpoint "
                          << endpoint_id;
-    endpoint_state.StartEndpointKeepAliveManager(
-        [this, client, endpoint_id, keep_alive_interval, keep_alive_timeout](
-            Mutex* keep_alive_waiter_mutex,
-            ConditionVariable* keep_alive_waiter) {
-          EndpointChannelLoopRunnable(
-              "KeepAliveManager", client, endpoint_id,
-              [this, keep_alive_interval, keep_alive_timeout,
-               keep_alive_waiter_mutex,
-               keep_alive_waiter](EndpointChannel* channel) {
-                return HandleKeepAlive(
-                    channel, keep_alive_interval, keep_alive_timeout,
-                    keep_alive_waiter_mutex, keep_alive_waiter);
-              });
-        });
+    if (keep_alive_wheel_) {
+      endpoint_state.StartEndpointKeepAliveTimer(
+          [this, client, endpoint_id, keep_alive_interval, keep_alive_timeout,
+           last_failed_medium = Medium::UNKNOWN_MEDIUM]() mutable {
+            return OnKeepAliveTimer(client, endpoint_id, keep_alive_interval,
+                                    keep_alive_timeout, &last_failed_medium);
+          });
+    } else {
+      endpoint_state.StartEndpointKeepAliveManager(
+          [this, client, endpoint_id, keep_alive_interval, keep_alive_timeout](
+              Mutex* keep_alive_waiter_mutex,
+              ConditionVariable* keep_alive_waiter) {
+            EndpointChannelLoopRunnable(
+                "KeepAliveManager", client, endpoint_id,
+                [this, keep_alive_interval, keep_alive_timeout,
+                 keep_alive_waiter_mutex,
+                 keep_alive_waiter](EndpointChannel* channel) {
+                  return HandleKeepAlive(
+                      channel, keep_alive_interval, keep_alive_timeout,
+                      keep_alive_waiter_mutex, keep_alive_waiter);
+                });
+          });
+    }
     NEARBY_LOGS(INFO) << "Registering endpoint " << endpoint_id
                       << ", workers started and notifying client.";
 
@@ -635,13 +729,26 @@ int EndpointManager::GetMaxTransmitPacketSize(const std::string& endpoint_id) {
   return channel->GetMaxTransmitPacketSize();
 }
 
+int EndpointManager::GetOptimalChunkSize(const std::string& endpoint_id) {
+  std::shared_ptr<EndpointChannel> channel =
+      channel_manager_->GetChannelForEndpoint(endpoint_id);
+  if (channel == nullptr) {
+    return 0;
+  }
+
+  return channel->GetOptimalChunkSize();
+}
+
 std::vector<std::string> EndpointManager::SendPayloadChunk(
     const PayloadTransferFrame::PayloadHeader& payload_header,
     const PayloadTransferFrame::PayloadChunk& payload_chunk,
+    const ByteBuffer& payload_chunk_body,
     const std::vector<std::string>& endpoint_ids,
     PacketMetaData& packet_meta_data) {
-  ByteArray bytes =
-      parser::ForDataPayloadTransfer(payload_header, payload_chunk);
+  // The frame shares the chunk body instead of copying it; all channels share
+  // the frame.
+  ByteBuffer bytes = parser::ForDataPayloadTransfer(
+      payload_header, payload_chunk, payload_chunk_body);
 
   return SendTransferFrameBytes(
       endpoint_ids, bytes, payload_header.id(),
@@ -715,7 +822,7 @@ std::vector<std::string> EndpointManager::SendControlMessage(
     const PayloadTransferFrame::PayloadHeader& header,
     const PayloadTransferFrame::ControlMessage& control,
     const std::vector<std::string>& endpoint_ids) {
-  ByteArray bytes = parser::ForControlPayloadTransfer(header, control);
+  ByteBuffer bytes(parser::ForControlPayloadTransfer(header, control));
   PacketMetaData packet_meta_data;
 
   return SendTransferFrameBytes(
@@ -902,10 +1009,18 @@ CountDownLatch EndpointManager::NotifyFrameProcessorsOnEndpointDisconnect(
 }
 
 std::vector<std::string> EndpointManager::SendTransferFrameBytes(
-    const std::vector<std::string>& endpoint_ids, const ByteArray& bytes,
+    const std::vector<std::string>& endpoint_ids, const ByteBuffer& bytes,
     std::int64_t payload_id, std::int64_t offset,
     const std::string& packet_type, PacketMetaData& packet_meta_data) {
+  struct EndpointWrite {
+    const std::string* endpoint_id;
+    std::shared_ptr<EndpointChannel> channel;
+    PacketMetaData packet_meta_data;
+    bool ok = false;
+  };
   std::vector<std::string> failed_endpoint_ids;
+  std::vector<EndpointWrite> writes;
+  writes.reserve(endpoint_ids.size());
   for (const std::string& endpoint_id : endpoint_ids) {
     std::shared_ptr<EndpointChannel> channel =
         channel_manager_->GetChannelForEndpoint(endpoint_id);
@@ -923,21 +1038,62 @@ std::vector<std::string> EndpointManager::SendTransferFrameBytes(
       failed_endpoint_ids.push_back(endpoint_id);
       continue;
     }
+    writes.push_back({&endpoint_id, std::move(channel), packet_meta_data});
+  }
+  if (writes.empty()) {
+    return failed_endpoint_ids;
+  }
 
-    Exception write_exception = channel->Write(bytes, packet_meta_data);
-    if (!write_exception.Ok()) {
-      failed_endpoint_ids.push_back(endpoint_id);
-      NEARBY_LOGS(INFO) << "Failed to send packet; endpoint_id=" << endpoint_id;
-      continue;
+  if (write_executor_ == nullptr || writes.size() == 1) {
+    for (EndpointWrite& write : writes) {
+      write.ok = WriteTransferFrameBytes(*write.endpoint_id, *write.channel,
+                                         bytes, payload_id, packet_meta_data);
+    }
+  } else {
+    // The writes share `bytes` without copying it. The first one runs on
+    // this thread, the others on the endpoints' write queues. A write that is
+    // dropped because the queues are shutting down fails.
+    CountDownLatch written(writes.size() - 1);
+    for (size_t i = 1; i < writes.size(); ++i) {
+      EndpointWrite* write = &writes[i];
+      write_executor_->Execute(
+          *write->endpoint_id, "write-transfer-frame",
+          [this, write, &bytes, payload_id,
+           written_guard = CountDownOnDestroy(&written)]() mutable {
+            CountDownOnDestroy done = std::move(written_guard);
+            write->ok = WriteTransferFrameBytes(
+                *write->endpoint_id, *write->channel, bytes, payload_id,
+                write->packet_meta_data);
+          });
     }
-    analytics::ThroughputRecorderContainer::GetInstance()
-        .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
-        ->OnFrameSent(channel->GetMedium(), packet_meta_data);
+    writes[0].ok =
+        WriteTransferFrameBytes(*writes[0].endpoint_id, *writes[0].channel,
+                                bytes, payload_id, writes[0].packet_meta_data);
+    written.Await();
+    packet_meta_data = writes.back().packet_meta_data;
   }
 
+  for (const EndpointWrite& write : writes) {
+    if (!write.ok) failed_endpoint_ids.push_back(*write.endpoint_id);
+  }
   return failed_endpoint_ids;
 }
 
+bool EndpointManager::WriteTransferFrameBytes(
+    const std::string& endpoint_id, EndpointChannel& channel,
+    const ByteBuffer& bytes, std::int64_t payload_id,
+    PacketMetaData& packet_meta_data) {
+  Exception write_exception = channel.Write(bytes, packet_meta_data);
+  if (!write_exception.Ok()) {
+    NEARBY_LOGS(INFO) << "Failed to send packet; endpoint_id=" << endpoint_id;
+    return false;
+  }
+  analytics::ThroughputRecorderContainer::GetInstance()
+      .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
+      ->OnFrameSent(channel.GetMedium(), packet_meta_data);
+  return true;
+}
+
 EndpointManager::EndpointState::~EndpointState() {
   // We must unregister the endpoint first to signal the runnables that they
   // should exit their loops. SingleThreadExecutor destructors will wait for
@@ -956,6 +1112,9 @@ EndpointManager::EndpointState::~EndpointState() {
     MutexLock lock(keep_alive_waiter_mutex_.get());
     keep_alive_waiter_->Notify();
   }
+  // A KeepAlive timer is stopped here, after the channel is closed so that a
+  // check blocked on a write returns.
+  if (keep_alive_wheel_) keep_alive_wheel_->Cancel(endpoint_id_);
 }
 
 void EndpointManager::EndpointState::StartEndpointReader(Runnable&& runnable) {
@@ -964,7 +1123,8 @@ void EndpointManager::EndpointState::StartEndpointReader(Runnable&& runnable) {
 
 void EndpointManager::EndpointState::StartEndpointKeepAliveManager(
     absl::AnyInvocable<void(Mutex*, ConditionVariable*)> runnable) {
-  keep_alive_thread_.Execute(
+  keep_alive_thread_ = std::make_unique<SingleThreadExecutor>();
+  keep_alive_thread_->Execute(
       "keep-alive", [runnable = std::move(runnable),
                      keep_alive_waiter_mutex = keep_alive_waiter_mutex_.get(),
                      keep_alive_waiter = keep_alive_waiter_.get()]() mutable {
@@ -972,6 +1132,12 @@ void EndpointManager::EndpointState::StartEndpointKeepAliveManager(
       });
 }
 
+void EndpointManager::EndpointState::StartEndpointKeepAliveTimer(
+    TimerWheel::Callback callback) {
+  keep_alive_wheel_->Schedule(endpoint_id_, absl::ZeroDuration(),
+                              std::move(callback));
+}
+
 void EndpointManager::RunOnEndpointManagerThread(const std::string& name,
                                                  Runnable runnable) {
   serial_executor_->Execute(name, std::move(runnable));
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,9 +32,12 @@
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_channel.h"
 #include "connections/implementation/endpoint_channel_manager.h"
+#include "connections/implementation/keyed_serial_executor.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/implementation/timer_wheel.h"
 #include "connections/listeners.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/runnable.h"
@@ -59,10 +63,32 @@ namespace connections {
 // chunks) originates on one of those threads before control is transferred over
 // to PayloadManager::ProcessFrame() (still running on that
 // same dedicated reader thread).
+//
+// Each endpoint also has a dedicated KeepAlive thread. With
+// kEnableKeepAliveTimerWheel, the KeepAlive checks of all endpoints run as
+// timers on one shared TimerWheel instead. A check holds a thread only while
+// it runs; one blocked on a slow KeepAlive write gets a thread of its own
+// rather than delaying the checks of other endpoints.
+//
+// Frames sent to several endpoints are written to one endpoint after the
+// other. With kEnableOverlappedEndpointWrites, the writes of a frame overlap,
+// on a pool shared by all endpoints. The send still returns only once every
+// write is done and reports the endpoints that failed it, so the slowest
+// endpoint still sets the pace from one frame to the next.
 
 class EndpointManager {
  public:
   using OfflineFrame = ::location::nearby::connections::OfflineFrame;
+  // Shape of the KeepAlive TimerWheel used with kEnableKeepAliveTimerWheel.
+  // 512 ticks of 100ms cover the default KeepAlive interval in one turn.
+  constexpr static absl::Duration kKeepAliveTimerTick = absl::Milliseconds(100);
+  constexpr static int kKeepAliveTimerSlots = 512;
+  // The wheel starts more threads while KeepAlive writes are blocked, one per
+  // endpoint at most, and keeps this many between checks.
+  constexpr static int kMaxIdleKeepAliveThreads = 2;
+  // Threads writing frames to endpoints with kEnableOverlappedEndpointWrites,
+  // on top of the sending thread.
+  constexpr static int kMaxOverlappedEndpointWrites = 4;
 
   class FrameProcessor {
    public:
@@ -125,7 +151,13 @@ class EndpointManager {
   // transport.
   int GetMaxTransmitPacketSize(const std::string& endpoint_id);
 
+  // Returns the payload chunk size adapted to the measured throughput of the
+  // endpoint's channel.
+  int GetOptimalChunkSize(const std::string& endpoint_id);
+
   // Returns the list of endpoints to which sending this chunk failed.
+  // `payload_chunk_body` goes in as the body of `payload_chunk`, without being
+  // copied; all endpoints are handed the same frame.
   //
   // Invoked from the PayloadManager's sendPayload() method.
   std::vector<std::string> SendPayloadChunk(
@@ -133,6 +165,7 @@ class EndpointManager {
           payload_header,
       const location::nearby::connections::PayloadTransferFrame::PayloadChunk&
           payload_chunk,
+      const ByteBuffer& payload_chunk_body,
       const std::vector<std::string>& endpoint_ids,
       analytics::PacketMetaData& packet_meta_data);
   std::vector<std::string> SendControlMessage(
@@ -147,7 +180,7 @@ class EndpointManager {
   //    a) We failed to read from the endpoint in its dedicated reader thread.
   //    b) We failed to write to the endpoint in PayloadManager.
   //    c) The connection was rejected in PCPHandler.
-  //    d) The dedicated KeepAlive thread exceeded its period of inactivity.
+  //    d) The KeepAlive thread or timer exceeded its period of inactivity.
   // Or in the numerous other cases where a failure occurred and we no longer
   // believe the endpoint is in a healthy state.
   //
@@ -166,10 +199,14 @@ class EndpointManager {
  private:
   class EndpointState {
    public:
+    // `keep_alive_wheel` may be null, in which case the endpoint gets a
+    // KeepAlive thread of its own.
     EndpointState(const std::string& endpoint_id,
-                  EndpointChannelManager* channel_manager)
+                  EndpointChannelManager* channel_manager,
+                  TimerWheel* keep_alive_wheel)
         : endpoint_id_{endpoint_id},
           channel_manager_{channel_manager},
+          keep_alive_wheel_{keep_alive_wheel},
           keep_alive_waiter_mutex_{std::make_unique<Mutex>()},
           keep_alive_waiter_{std::make_unique<ConditionVariable>(
               keep_alive_waiter_mutex_.get())} {}
@@ -181,6 +218,7 @@ class EndpointManager {
     EndpointState(EndpointState&& other)
         : endpoint_id_{std::move(other.endpoint_id_)},
           channel_manager_{std::exchange(other.channel_manager_, nullptr)},
+          keep_alive_wheel_{std::exchange(other.keep_alive_wheel_, nullptr)},
           reader_thread_{std::move(other.reader_thread_)},
           keep_alive_waiter_mutex_{
               std::exchange(other.keep_alive_waiter_mutex_, nullptr)},
@@ -193,10 +231,13 @@ class EndpointManager {
     void StartEndpointReader(Runnable&& runnable);
     void StartEndpointKeepAliveManager(
         absl::AnyInvocable<void(Mutex*, ConditionVariable*)> runnable);
+    void StartEndpointKeepAliveTimer(TimerWheel::Callback callback);
 
    private:
     const std::string endpoint_id_;
     EndpointChannelManager* channel_manager_;
+    // Set when the KeepAlive checks run as a timer on this wheel.
+    TimerWheel* keep_alive_wheel_;
     SingleThreadExecutor reader_thread_;
 
     // Use a condition variable so we can wait on the thread but still be able
@@ -206,7 +247,7 @@ class EndpointManager {
     // std::move operations.
     mutable std::unique_ptr<Mutex> keep_alive_waiter_mutex_;
     std::unique_ptr<ConditionVariable> keep_alive_waiter_;
-    SingleThreadExecutor keep_alive_thread_;
+    std::unique_ptr<SingleThreadExecutor> keep_alive_thread_;
   };
 
   // RAII accessor for FrameProcessor
@@ -238,6 +279,24 @@ class EndpointManager {
                                     Mutex* keep_alive_waiter_mutex,
                                     ConditionVariable* keep_alive_waiter);
 
+  // Checks that `endpoint_channel` has been read from recently enough, and
+  // writes a KeepAlive frame to it if it's time to. Returns how long until the
+  // next check is due, Exception::kTimeout if the endpoint has been silent for
+  // longer than `keep_alive_timeout`, or the exception of a failed write.
+  ExceptionOr<absl::Duration> CheckKeepAlive(EndpointChannel* endpoint_channel,
+                                             absl::Duration keep_alive_interval,
+                                             absl::Duration keep_alive_timeout);
+
+  // A KeepAlive timer on `keep_alive_wheel_`. Same as the KeepAlive thread's
+  // EndpointChannelLoopRunnable() with HandleKeepAlive(), one iteration per
+  // call: returns the delay until the next call, or std::nullopt once the
+  // endpoint has been discarded. `last_failed_medium` carries over between
+  // calls.
+  std::optional<absl::Duration> OnKeepAliveTimer(
+      ClientProxy* client, const std::string& endpoint_id,
+      absl::Duration keep_alive_interval, absl::Duration keep_alive_timeout,
+      location::nearby::proto::connections::Medium* last_failed_medium);
+
   // Waits for a given endpoint EndpointChannelLoopRunnable() workers to
   // terminate.
   // Is called from RegisterEndpoint to avoid races; also called from
@@ -280,9 +339,15 @@ class EndpointManager {
 
   std::vector<std::string> SendTransferFrameBytes(
       const std::vector<std::string>& endpoint_ids,
-      const ByteArray& payload_transfer_frame_bytes, std::int64_t payload_id,
+      const ByteBuffer& payload_transfer_frame_bytes, std::int64_t payload_id,
       std::int64_t offset, const std::string& packet_type,
       analytics::PacketMetaData& packet_meta_data);
+  // Writes the frame to one endpoint's channel; returns false if that failed.
+  bool WriteTransferFrameBytes(const std::string& endpoint_id,
+                               EndpointChannel& channel,
+                               const ByteBuffer& payload_transfer_frame_bytes,
+                               std::int64_t payload_id,
+                               analytics::PacketMetaData& packet_meta_data);
 
   // Executes all jobs sequentially, on a serial_executor_.
   void RunOnEndpointManagerThread(const std::string& name, Runnable runnable);
@@ -296,6 +361,13 @@ class EndpointManager {
                       FrameProcessorWithMutex>
       frame_processors_ ABSL_GUARDED_BY(frame_processors_lock_);
 
+  // Runs the endpoints' KeepAlive checks when kEnableKeepAliveTimerWheel is
+  // on. Declared before `endpoints_`, whose EndpointStates use it.
+  std::unique_ptr<TimerWheel> keep_alive_wheel_;
+  // Writes frames to endpoints when kEnableOverlappedEndpointWrites is on, one
+  // queue per endpoint.
+  std::unique_ptr<KeyedSerialExecutor> write_executor_;
+
   // We keep track of all registered channel endpoints here.
   absl::flat_hash_map<std::string, EndpointState> endpoints_;
 
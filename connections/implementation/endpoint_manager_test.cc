@@ -438,6 +438,51 @@ TEST_F(EndpointManagerTest, TryDecrypt) {
   RegisterEndpoint(std::move(endpoint_channel));
 }
 
+TEST_F(EndpointManagerTest, SendToSeveralEndpointsOverlapsWrites) {
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableOverlappedEndpointWrites,
+      true);
+  EndpointManager em(&ecm_);
+  CountDownLatch second_write_started(1);
+  auto first_channel = std::make_unique<MockEndpointChannel>();
+  auto second_channel = std::make_unique<MockEndpointChannel>();
+  auto third_channel = std::make_unique<MockEndpointChannel>();
+  // The first write only succeeds if the second one starts while it is still
+  // in progress.
+  EXPECT_CALL(*first_channel, Write(_, _))
+      .WillOnce([&second_write_started]() {
+        return second_write_started.Await(absl::Seconds(1)).result()
+                   ? Exception{Exception::kSuccess}
+                   : Exception{Exception::kIo};
+      });
+  EXPECT_CALL(*second_channel, Write(_, _)).WillOnce([&second_write_started]() {
+    second_write_started.CountDown();
+    return Exception{Exception::kSuccess};
+  });
+  EXPECT_CALL(*third_channel, Write(_, _))
+      .WillOnce(Return(Exception{Exception::kIo}));
+  ecm_.RegisterChannelForEndpoint(client_.get(), "first",
+                                  std::move(first_channel));
+  ecm_.RegisterChannelForEndpoint(client_.get(), "second",
+                                  std::move(second_channel));
+  ecm_.RegisterChannelForEndpoint(client_.get(), "third",
+                                  std::move(third_channel));
+  PayloadTransferFrame::PayloadHeader header;
+  header.set_id(12345);
+  PayloadTransferFrame::ControlMessage control;
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+
+  auto failed_ids = em.SendControlMessage(
+      header, control, std::vector<std::string>{"first", "second", "third"});
+
+  EXPECT_EQ(failed_ids, std::vector<std::string>{"third"});
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableOverlappedEndpointWrites,
+      false);
+}
+
 // Regression test for b/278729669.
 //
 // During the destruction of NearbyConnections, Core (which owns ClientProxy)
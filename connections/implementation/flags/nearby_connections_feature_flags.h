@@ -54,10 +54,68 @@ constexpr auto kEnablePayloadReceivedAck =
     flags::Flag<bool>(kConfigPackage, "45425840", false);
 
 // Support 0. disabled all. 1. safe-to-disconnect 2. reserved 3. auto-reconnect
-// 4. auto-resume for dev device 5. payload_ack
+// 4. auto-resume for dev device 5. payload_ack 6. resumable file transfers,
+// only claimed with kEnableResumableFileTransfers
 constexpr auto kSafeToDisconnectVersion =
     flags::Flag<int64_t>(kConfigPackage, "45425841", 0);
 
+// When true, payload chunk sizes adapt to the measured throughput of each
+// endpoint's channel instead of using the medium's fixed packet size.
+constexpr auto kEnableAdaptiveChunkSize =
+    flags::Flag<bool>(kConfigPackage, "45425842", false);
+
+// Number of chunks of an outgoing file payload to read ahead of the sender,
+// so disk reads overlap with encryption and socket writes. 0 disables it.
+constexpr auto kPayloadReadAheadChunks =
+    flags::Flag<int64_t>(kConfigPackage, "45425843", 0);
+
+// When true, file payloads to different endpoints are sent in parallel, and
+// file payloads to the same endpoint take turns sending a chunk each.
+constexpr auto kEnableParallelFilePayloads =
+    flags::Flag<bool>(kConfigPackage, "45425844", false);
+
+// When true, incoming files are preallocated and written on a thread of their
+// own, so slow storage doesn't stall reading from the endpoint until
+// kIncomingFileWriteBufferBytes of received data are waiting to be written.
+constexpr auto kEnableWriteBehindIncomingFiles =
+    flags::Flag<bool>(kConfigPackage, "45425845", false);
+
+// How many bytes of an incoming file may wait to be written, with
+// kEnableWriteBehindIncomingFiles.
+constexpr auto kIncomingFileWriteBufferBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45425846", 8 * 1024 * 1024);
+
+// With kEnableWriteBehindIncomingFiles, syncs incoming files to storage every
+// this many bytes and once they are complete. 0 leaves writeback to the OS.
+constexpr auto kIncomingFileSyncIntervalBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45425847", 0);
+
+// When true, the KeepAlive checks of all endpoints run as timers on one shared
+// timer wheel instead of on a thread per endpoint.
+constexpr auto kEnableKeepAliveTimerWheel =
+    flags::Flag<bool>(kConfigPackage, "45425849", false);
+
+// When true, the writes of a payload frame sent to several endpoints overlap,
+// so the frame takes as long as its slowest write rather than the sum of them.
+// Overlap only: there is no run-ahead window, so the next frame still waits
+// for every write of this one and the slowest endpoint paces all of them.
+constexpr auto kEnableOverlappedEndpointWrites =
+    flags::Flag<bool>(kConfigPackage, "45425850", false);
+
+// How many bytes of an incoming stream payload may wait for the app to read
+// them in its pipe, and as many again while the pipe is full; 0 for no limit.
+// This bound is fail-fast, not flow control: the sender is not held back, and
+// once the app falls further behind the payload fails. The endpoint's reader
+// never waits for the app.
+constexpr auto kIncomingStreamBufferBytes =
+    flags::Flag<int64_t>(kConfigPackage, "45425851", 0);
+
+// When true, a file payload cut off by a disconnect resumes where it stopped
+// when it is sent again: the receiver keeps what it got, and the sender asks
+// it how much that is before sending.
+constexpr auto kEnableResumableFileTransfers =
+    flags::Flag<bool>(kConfigPackage, "45425852", false);
+
 }  // namespace nearby_connections_feature
 }  // namespace config_package_nearby
 }  // namespace connections
@@ -0,0 +1,40 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "connections/implementation/offline_frames.h"
+#include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/platform/logging.h"
+
+// Checks that whatever parser::TryDecodeDataPayloadTransfer() accepts, the
+// generic protobuf parser accepts too, and reads as the same frame.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  absl::string_view bytes(reinterpret_cast<const char*>(data), size);
+
+  location::nearby::connections::OfflineFrame decoded;
+  if (!nearby::connections::parser::TryDecodeDataPayloadTransfer(bytes,
+                                                                 decoded)) {
+    return 0;
+  }
+
+  location::nearby::connections::OfflineFrame parsed;
+  CHECK(parsed.ParseFromString(std::string(bytes)));
+  CHECK(decoded.SerializeAsString() == parsed.SerializeAsString());
+
+  return 0;
+}
@@ -14,6 +14,10 @@
 
 #include "connections/implementation/internal_payload.h"
 
+#include <string>
+
+#include "internal/platform/file.h"
+
 namespace nearby {
 namespace connections {
 
@@ -27,5 +31,10 @@ Payload InternalPayload::ReleasePayload() { return std::move(payload_); }
 
 Payload::Id InternalPayload::GetId() const { return payload_id_; }
 
+std::string InternalPayload::GetFilePath() {
+  InputFile* file = payload_.AsFile();
+  return file != nullptr ? file->GetFilePath() : "";
+}
+
 }  // namespace connections
 }  // namespace nearby
@@ -16,6 +16,7 @@
 #define CORE_INTERNAL_INTERNAL_PAYLOAD_H_
 
 #include <cstdint>
+#include <string>
 
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/payload.h"
@@ -43,6 +44,11 @@ class InternalPayload {
 
   const std::string& GetParentFolder() { return payload_.GetParentFolder(); }
   const std::string& GetFileName() { return payload_.GetFileName(); }
+  PayloadPriority GetPriority() const { return payload_.GetPriority(); }
+
+  // Returns the path of the file of a file Payload, or an empty string for
+  // other Payloads and once the Payload has been released.
+  std::string GetFilePath();
 
   // Returns the PayloadType of the Payload to which this object is bound.
   //
@@ -81,8 +87,9 @@ class InternalPayload {
   //
   // @param chunk The next chunk; this being null signals that this is the last
   // chunk, which will typically be used as a trigger to perform whatever state
-  // cleanup may be required by the concrete implementation.
-  virtual Exception AttachNextChunk(const ByteArray& chunk) = 0;
+  // cleanup may be required by the concrete implementation. It is taken by
+  // value so that implementations which queue it can move it.
+  virtual Exception AttachNextChunk(ByteArray chunk) = 0;
 
   // Skips current stream pointer to the offset.
   //
@@ -14,23 +14,33 @@
 
 #include "connections/implementation/internal_payload_factory.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_cat.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/internal_payload.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "connections/implementation/write_behind_output_file.h"
 #include "connections/payload.h"
 #include "connections/payload_type.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/cached_thread_pool.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/file.h"
 #include "internal/platform/implementation/platform.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/mutex_lock.h"
 #include "internal/platform/os_name.h"
 #include "internal/platform/output_stream.h"
 #include "internal/platform/pipe.h"
@@ -69,7 +79,7 @@ class BytesInternalPayload : public InternalPayload {
   }
 
   // Does nothing.
-  Exception AttachNextChunk(const ByteArray& chunk) override {
+  Exception AttachNextChunk(ByteArray chunk) override {
     return {Exception::kSuccess};
   }
 
@@ -123,7 +133,7 @@ class OutgoingStreamInternalPayload : public InternalPayload {
     return scoped_bytes_read;
   }
 
-  Exception AttachNextChunk(const ByteArray& chunk) override {
+  Exception AttachNextChunk(ByteArray chunk) override {
     return {Exception::kIo};
   }
 
@@ -154,11 +164,132 @@ class OutgoingStreamInternalPayload : public InternalPayload {
   }
 };
 
+}  // namespace
+
+// Writes the chunks of an incoming stream payload into its bounded pipe on a
+// thread of `writers`, so that an app slow to read the stream only holds up
+// that thread, not the endpoint's reader. Chunks wait in a queue while the pipe
+// is full; once more than `max_queued_bytes` of them are waiting, the app fell
+// too far behind and writes fail.
+class IncomingStreamWriter
+    : public std::enable_shared_from_this<IncomingStreamWriter> {
+ public:
+  // Creates a writer that `writers` fails when it shuts down.
+  static std::shared_ptr<IncomingStreamWriter> Create(
+      IncomingStreamWriters& writers, std::unique_ptr<OutputStream> output,
+      std::int64_t max_queued_bytes) {
+    auto writer = std::shared_ptr<IncomingStreamWriter>(
+        new IncomingStreamWriter(writers, std::move(output), max_queued_bytes));
+    writers.Add(writer);
+    return writer;
+  }
+
+  // Queues `chunk` to be written. Returns Exception::kIo if an earlier write
+  // failed, after Close(), or if the queue is full.
+  Exception Write(ByteArray chunk) ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    if (failed_ || closed_) return {Exception::kIo};
+    std::int64_t size = chunk.size();
+    if (queued_bytes_ > 0 && queued_bytes_ + size > max_queued_bytes_) {
+      NEARBY_LOGS(WARNING) << "Incoming stream isn't read fast enough, "
+                           << queued_bytes_ << " bytes are waiting.";
+      FailLocked();
+      return {Exception::kIo};
+    }
+    queue_.push_back(std::move(chunk));
+    queued_bytes_ += size;
+    if (!writing_) {
+      writing_ = true;
+      writers_.threads_.Execute(
+          "write-stream", [self = shared_from_this()]() { self->Drain(); });
+    }
+    return {Exception::kSuccess};
+  }
+
+  // Closes the pipe once the queued chunks are written.
+  void Close() ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    closed_ = true;
+    if (!writing_) output_->Close();
+  }
+
+  // Drops the queued chunks and closes the pipe.
+  void Cancel() ABSL_LOCKS_EXCLUDED(mutex_) {
+    MutexLock lock(&mutex_);
+    FailLocked();
+  }
+
+ private:
+  IncomingStreamWriter(IncomingStreamWriters& writers,
+                       std::unique_ptr<OutputStream> output,
+                       std::int64_t max_queued_bytes)
+      : writers_(writers),
+        output_(std::move(output)),
+        max_queued_bytes_(max_queued_bytes) {}
+
+  void Drain() ABSL_LOCKS_EXCLUDED(mutex_) {
+    while (true) {
+      ByteArray chunk;
+      {
+        MutexLock lock(&mutex_);
+        if (queue_.empty()) {
+          writing_ = false;
+          if (closed_) output_->Close();
+          return;
+        }
+        chunk = std::move(queue_.front());
+        queue_.pop_front();
+        queued_bytes_ -= chunk.size();
+      }
+      // Blocks while the pipe is full.
+      Exception result = output_->Write(chunk);
+      if (result.Raised()) {
+        MutexLock lock(&mutex_);
+        FailLocked();
+      }
+    }
+  }
+
+  // Drops the queued chunks, and closes the pipe to also fail a write that is
+  // blocked on it.
+  void FailLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    failed_ = true;
+    queue_.clear();
+    queued_bytes_ = 0;
+    output_->Close();
+  }
+
+  IncomingStreamWriters& writers_;
+  // Thread-safe, like the pipe it writes to.
+  const std::unique_ptr<OutputStream> output_;
+  const std::int64_t max_queued_bytes_;
+  Mutex mutex_;
+  std::deque<ByteArray> queue_ ABSL_GUARDED_BY(mutex_);
+  std::int64_t queued_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Whether a Drain() task is queued or running.
+  bool writing_ ABSL_GUARDED_BY(mutex_) = false;
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+  bool failed_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+namespace {
+
+// Writer threads kept around for the next incoming streams.
+constexpr int kMaxIdleStreamWriterThreads = 2;
+
 class IncomingStreamInternalPayload : public InternalPayload {
  public:
   IncomingStreamInternalPayload(Payload payload,
                                 std::unique_ptr<OutputStream> output)
       : InternalPayload(std::move(payload)), output_(std::move(output)) {}
+  IncomingStreamInternalPayload(Payload payload,
+                                std::shared_ptr<IncomingStreamWriter> writer)
+      : InternalPayload(std::move(payload)), writer_(std::move(writer)) {}
+  ~IncomingStreamInternalPayload() override {
+    // Let the writer finish the stream, instead of cutting off what it still
+    // has queued.
+    if (writer_) writer_->Close();
+  }
 
   PayloadTransferFrame::PayloadHeader::PayloadType GetType() const override {
     return PayloadTransferFrame::PayloadHeader::STREAM;
@@ -168,7 +299,7 @@ class IncomingStreamInternalPayload : public InternalPayload {
 
   ByteArray DetachNextChunk(int chunk_size) override { return {}; }
 
-  Exception AttachNextChunk(const ByteArray& chunk) override {
+  Exception AttachNextChunk(ByteArray chunk) override {
     if (chunk.Empty()) {
       NEARBY_LOGS(INFO) << "Received null last chunk for incoming payload "
                         << this << ", closing OutputStream.";
@@ -176,6 +307,7 @@ class IncomingStreamInternalPayload : public InternalPayload {
       return {Exception::kSuccess};
     }
 
+    if (writer_) return writer_->Write(std::move(chunk));
     return output_->Write(chunk);
   }
 
@@ -185,10 +317,19 @@ class IncomingStreamInternalPayload : public InternalPayload {
     return {Exception::kIo};
   }
 
-  void Close() override { output_->Close(); }
+  void Close() override {
+    if (writer_) {
+      writer_->Close();
+    } else {
+      output_->Close();
+    }
+  }
 
  private:
+  // Only one of these is set: `writer_` for a bounded pipe, so that writes
+  // into it don't block the caller.
   std::unique_ptr<OutputStream> output_;
+  std::shared_ptr<IncomingStreamWriter> writer_;
 };
 
 class OutgoingFileInternalPayload : public InternalPayload {
@@ -227,7 +368,7 @@ class OutgoingFileInternalPayload : public InternalPayload {
     return bytes;
   }
 
-  Exception AttachNextChunk(const ByteArray& chunk) override {
+  Exception AttachNextChunk(ByteArray chunk) override {
     return {Exception::kIo};
   }
 
@@ -266,9 +407,22 @@ class IncomingFileInternalPayload : public InternalPayload {
  public:
   IncomingFileInternalPayload(Payload payload, OutputFile output_file,
                               std::int64_t total_size)
-      : InternalPayload(std::move(payload)),
-        output_file_(std::move(output_file)),
-        total_size_(total_size) {}
+      : InternalPayload(std::move(payload)), total_size_(total_size) {
+    if (NearbyFlags::GetInstance().GetBoolFlag(
+            config_package_nearby::nearby_connections_feature::
+                kEnableWriteBehindIncomingFiles)) {
+      write_behind_file_ = std::make_unique<WriteBehindOutputFile>(
+          std::move(output_file), total_size,
+          NearbyFlags::GetInstance().GetInt64Flag(
+              config_package_nearby::nearby_connections_feature::
+                  kIncomingFileWriteBufferBytes),
+          NearbyFlags::GetInstance().GetInt64Flag(
+              config_package_nearby::nearby_connections_feature::
+                  kIncomingFileSyncIntervalBytes));
+    } else {
+      output_file_ = std::make_unique<OutputFile>(std::move(output_file));
+    }
+  }
 
   location::nearby::connections::PayloadTransferFrame::PayloadHeader::
       PayloadType
@@ -281,14 +435,16 @@ class IncomingFileInternalPayload : public InternalPayload {
 
   ByteArray DetachNextChunk(int chunk_size) override { return {}; }
 
-  Exception AttachNextChunk(const ByteArray& chunk) override {
+  Exception AttachNextChunk(ByteArray chunk) override {
     if (chunk.Empty()) {
       // Received null last chunk for incoming payload.
-      output_file_.Close();
+      if (write_behind_file_) return write_behind_file_->Close();
+      output_file_->Close();
       return {Exception::kSuccess};
     }
 
-    return output_file_.Write(chunk);
+    if (write_behind_file_) return write_behind_file_->Write(std::move(chunk));
+    return output_file_->Write(chunk);
   }
 
   ExceptionOr<size_t> SkipToOffset(size_t offset) override {
@@ -297,10 +453,19 @@ class IncomingFileInternalPayload : public InternalPayload {
     return {Exception::kIo};
   }
 
-  void Close() override { output_file_.Close(); }
+  void Close() override {
+    if (write_behind_file_) {
+      write_behind_file_->Close();
+    } else {
+      output_file_->Close();
+    }
+  }
 
  private:
-  OutputFile output_file_;
+  // Exactly one of these is set, depending on
+  // kEnableWriteBehindIncomingFiles.
+  std::unique_ptr<OutputFile> output_file_;
+  std::unique_ptr<WriteBehindOutputFile> write_behind_file_;
   const std::int64_t total_size_;
 };
 
@@ -309,6 +474,40 @@ class IncomingFileInternalPayload : public InternalPayload {
 using ::nearby::api::ImplementationPlatform;
 using ::nearby::api::OSName;
 
+IncomingStreamWriters::IncomingStreamWriters()
+    : threads_(kMaxIdleStreamWriterThreads) {}
+
+IncomingStreamWriters::~IncomingStreamWriters() { Shutdown(); }
+
+void IncomingStreamWriters::Shutdown() {
+  std::vector<std::weak_ptr<IncomingStreamWriter>> writers;
+  {
+    MutexLock lock(&mutex_);
+    shutdown_ = true;
+    writers = std::move(writers_);
+    writers_.clear();
+  }
+  // Releases the threads blocked on pipes that nobody reads, so that they can
+  // be stopped.
+  for (const auto& weak_writer : writers) {
+    if (auto writer = weak_writer.lock()) writer->Cancel();
+  }
+  threads_.Shutdown();
+}
+
+void IncomingStreamWriters::Add(std::shared_ptr<IncomingStreamWriter> writer) {
+  MutexLock lock(&mutex_);
+  if (shutdown_) {
+    writer->Cancel();
+    return;
+  }
+  // Forgets the streams that are done.
+  writers_.erase(std::remove_if(writers_.begin(), writers_.end(),
+                                [](const auto& w) { return w.expired(); }),
+                 writers_.end());
+  writers_.push_back(std::move(writer));
+}
+
 std::unique_ptr<InternalPayload> CreateOutgoingInternalPayload(
     Payload payload) {
   switch (payload.GetType()) {
@@ -352,7 +551,8 @@ std::string make_path(const std::string& custom_save_path,
 
 std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
     const location::nearby::connections::PayloadTransferFrame& frame,
-    const std::string& custom_save_path) {
+    const std::string& custom_save_path,
+    IncomingStreamWriters& stream_writers) {
   if (frame.packet_type() !=
       location::nearby::connections::PayloadTransferFrame::DATA) {
     return {};
@@ -366,10 +566,22 @@ std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
     }
 
     case PayloadTransferFrame::PayloadHeader::STREAM: {
-      auto [input, output] = CreatePipe();
-
+      std::int64_t max_buffered_bytes = NearbyFlags::GetInstance().GetInt64Flag(
+          config_package_nearby::nearby_connections_feature::
+              kIncomingStreamBufferBytes);
+      if (max_buffered_bytes <= 0) {
+        auto [input, output] = CreatePipe();
+        return std::make_unique<IncomingStreamInternalPayload>(
+            Payload(payload_id, std::move(input)), std::move(output));
+      }
+      // The endpoint's reader hands chunks to a writer, which waits for the
+      // app when the pipe is full, and fails the stream once the app falls
+      // further behind.
+      auto [input, output] = CreatePipe(max_buffered_bytes);
       return std::make_unique<IncomingStreamInternalPayload>(
-          Payload(payload_id, std::move(input)), std::move(output));
+          Payload(payload_id, std::move(input)),
+          IncomingStreamWriter::Create(stream_writers, std::move(output),
+                                       max_buffered_bytes));
     }
 
     case PayloadTransferFrame::PayloadHeader::FILE: {
@@ -425,5 +637,35 @@ std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
   }
 }
 
+std::unique_ptr<InternalPayload> CreateResumedIncomingInternalPayload(
+    const location::nearby::connections::PayloadTransferFrame& frame,
+    const std::string& file_path, std::int64_t offset,
+    std::int64_t total_size) {
+  // On Chrome files are named by the payload id instead of a path.
+  if (frame.packet_type() != PayloadTransferFrame::DATA ||
+      frame.payload_header().type() !=
+          PayloadTransferFrame::PayloadHeader::FILE ||
+      ImplementationPlatform::GetCurrentOS() == OSName::kChromeOS) {
+    return {};
+  }
+
+  OutputFile output_file(file_path, offset);
+  if (!output_file.IsValid()) {
+    NEARBY_LOGS(WARNING) << "Cannot resume incoming file Payload "
+                         << frame.payload_header().id() << " at offset "
+                         << offset;
+    return {};
+  }
+
+  const Payload::Id payload_id = frame.payload_header().id();
+  std::string file_name = frame.payload_header().has_file_name()
+                              ? frame.payload_header().file_name()
+                              : std::to_string(payload_id);
+  return std::make_unique<IncomingFileInternalPayload>(
+      Payload(payload_id, frame.payload_header().parent_folder(), file_name,
+              InputFile(file_path, total_size)),
+      std::move(output_file), total_size);
+}
+
 }  // namespace connections
 }  // namespace nearby
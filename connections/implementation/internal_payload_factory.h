@@ -15,24 +15,70 @@
 #ifndef CORE_INTERNAL_INTERNAL_PAYLOAD_FACTORY_H_
 #define CORE_INTERNAL_INTERNAL_PAYLOAD_FACTORY_H_
 
+#include <cstdint>
 #include <string>
 
 #include <memory>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "connections/implementation/internal_payload.h"
 #include "connections/payload.h"
+#include "internal/platform/cached_thread_pool.h"
+#include "internal/platform/mutex.h"
 
 namespace nearby {
 namespace connections {
 
+class IncomingStreamWriter;
+
+// Writes the chunks of incoming stream payloads into their pipes, when
+// kIncomingStreamBufferBytes bounds them. A stream takes a thread only while
+// it has chunks waiting for its pipe, so there are at most as many threads as
+// incoming streams.
+class IncomingStreamWriters {
+ public:
+  IncomingStreamWriters();
+  IncomingStreamWriters(const IncomingStreamWriters&) = delete;
+  IncomingStreamWriters& operator=(const IncomingStreamWriters&) = delete;
+  ~IncomingStreamWriters();
+
+  // Fails the streams that are still written, which releases the threads
+  // waiting for their apps to read, and stops the threads. Streams added
+  // afterwards fail right away.
+  void Shutdown() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  friend class IncomingStreamWriter;
+
+  void Add(std::shared_ptr<IncomingStreamWriter> writer)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  CachedThreadPool threads_;
+  Mutex mutex_;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::weak_ptr<IncomingStreamWriter>> writers_
+      ABSL_GUARDED_BY(mutex_);
+};
+
 // Creates an InternalPayload representing an outgoing Payload.
 std::unique_ptr<InternalPayload> CreateOutgoingInternalPayload(Payload payload);
 
 // Creates an InternalPayload representing an incoming Payload from a remote
-// endpoint.
+// endpoint. A bounded incoming stream is written by `stream_writers`.
 std::unique_ptr<InternalPayload> CreateIncomingInternalPayload(
     const location::nearby::connections::PayloadTransferFrame& frame,
-    const std::string& custom_save_path);
+    const std::string& custom_save_path,
+    IncomingStreamWriters& stream_writers);
+
+// Creates an InternalPayload representing an incoming file Payload whose first
+// `offset` bytes were already received into `file_path` by an earlier
+// transfer; the chunks that follow are appended to them. Returns null if that
+// file can't be written at `offset`.
+std::unique_ptr<InternalPayload> CreateResumedIncomingInternalPayload(
+    const location::nearby::connections::PayloadTransferFrame& frame,
+    const std::string& file_path, std::int64_t offset,
+    std::int64_t total_size);
 
 }  // namespace connections
 }  // namespace nearby
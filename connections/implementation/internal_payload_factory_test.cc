@@ -20,10 +20,12 @@
 #include <utility>
 
 #include "gtest/gtest.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/internal_payload.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/payload.h"
 #include "connections/payload_type.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/file.h"
@@ -72,6 +74,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromFilePayload) {
 }
 
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromByteMessage) {
+  IncomingStreamWriters stream_writers;
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
   frame.set_packet_type(PayloadTransferFrame::DATA);
@@ -87,7 +90,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromByteMessage) {
   header.set_total_size(512);
   *frame.mutable_payload_chunk() = std::move(payload_chunk);
   std::unique_ptr<InternalPayload> internal_payload =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, path, stream_writers);
   EXPECT_NE(internal_payload, nullptr);
   Payload payload = internal_payload->ReleasePayload();
   EXPECT_EQ(payload.AsFile(), nullptr);
@@ -96,6 +99,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromByteMessage) {
 }
 
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamMessage) {
+  IncomingStreamWriters stream_writers;
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
   frame.set_packet_type(PayloadTransferFrame::DATA);
@@ -104,7 +108,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamMessage) {
   header.set_id(12345);
   header.set_total_size(0);
   std::unique_ptr<InternalPayload> internal_payload =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, path, stream_writers);
   EXPECT_NE(internal_payload, nullptr);
   {
     Payload payload = internal_payload->ReleasePayload();
@@ -118,7 +122,96 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromStreamMessage) {
   internal_payload->Close();
 }
 
+// Returns an incoming stream payload whose pipe holds `max_buffered_bytes`.
+std::unique_ptr<InternalPayload> CreateBoundedIncomingStream(
+    IncomingStreamWriters& stream_writers, std::int64_t max_buffered_bytes) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kIncomingStreamBufferBytes,
+      max_buffered_bytes);
+  PayloadTransferFrame frame;
+  frame.set_packet_type(PayloadTransferFrame::DATA);
+  auto& header = *frame.mutable_payload_header();
+  header.set_type(PayloadTransferFrame::PayloadHeader::STREAM);
+  header.set_id(12345);
+  header.set_total_size(0);
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateIncomingInternalPayload(frame, "", stream_writers);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+  return internal_payload;
+}
+
+TEST(InternalPayloadFactoryTest, BoundedIncomingStreamDeliversChunksInOrder) {
+  IncomingStreamWriters stream_writers;
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateBoundedIncomingStream(stream_writers, /*max_buffered_bytes=*/6);
+  ASSERT_NE(internal_payload, nullptr);
+  Payload payload = internal_payload->ReleasePayload();
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("ABCD")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("EF")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray()).Ok());
+
+  InputStream* stream = payload.AsStream();
+  ASSERT_NE(stream, nullptr);
+  std::string received;
+  while (true) {
+    ExceptionOr<ByteArray> chunk = stream->Read(1024);
+    ASSERT_TRUE(chunk.ok());
+    if (chunk.result().Empty()) break;
+    received += std::string(chunk.result());
+  }
+  EXPECT_EQ(received, "ABCDEF");
+}
+
+TEST(InternalPayloadFactoryTest, BoundedIncomingStreamFailsWhenNotRead) {
+  IncomingStreamWriters stream_writers;
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateBoundedIncomingStream(stream_writers, /*max_buffered_bytes=*/6);
+  ASSERT_NE(internal_payload, nullptr);
+  Payload payload = internal_payload->ReleasePayload();
+
+  // Nothing reads the stream, yet attaching doesn't block: once the pipe and
+  // the chunks waiting for it are full, the writes fail.
+  int attached = 0;
+  while (attached < 10 &&
+         internal_payload->AttachNextChunk(ByteArray("AB")).Ok()) {
+    ++attached;
+  }
+  EXPECT_LT(attached, 10);
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("AB"))
+                  .Raised(Exception::kIo));
+  internal_payload->Close();
+}
+
+TEST(InternalPayloadFactoryTest, ShutdownFailsUnreadIncomingStream) {
+  IncomingStreamWriters stream_writers;
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateBoundedIncomingStream(stream_writers, /*max_buffered_bytes=*/6);
+  ASSERT_NE(internal_payload, nullptr);
+  Payload payload = internal_payload->ReleasePayload();
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("ABCD")).Ok());
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("EF")).Ok());
+
+  stream_writers.Shutdown();
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("GH"))
+                  .Raised(Exception::kIo));
+}
+
+TEST(InternalPayloadFactoryTest, IncomingStreamFailsAfterShutdown) {
+  IncomingStreamWriters stream_writers;
+  stream_writers.Shutdown();
+  std::unique_ptr<InternalPayload> internal_payload =
+      CreateBoundedIncomingStream(stream_writers, /*max_buffered_bytes=*/6);
+  ASSERT_NE(internal_payload, nullptr);
+
+  EXPECT_TRUE(internal_payload->AttachNextChunk(ByteArray("AB"))
+                  .Raised(Exception::kIo));
+}
+
 TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromFileMessage) {
+  IncomingStreamWriters stream_writers;
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
   frame.set_packet_type(PayloadTransferFrame::DATA);
@@ -127,7 +220,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromFileMessage) {
   header.set_id(12345);
   header.set_total_size(512);
   std::unique_ptr<InternalPayload> internal_payload =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, path, stream_writers);
   EXPECT_NE(internal_payload, nullptr);
   Payload payload = internal_payload->ReleasePayload();
   EXPECT_NE(payload.AsFile(), nullptr);
@@ -138,6 +231,7 @@ TEST(InternalPayloadFactoryTest, CanCreateInternalPayloadFromFileMessage) {
 
 TEST(InternalPayloadFactoryTest,
      InternalPayloadFromFileMessageWithoutIdReturnsNullptr) {
+  IncomingStreamWriters stream_writers;
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
   frame.set_packet_type(PayloadTransferFrame::DATA);
@@ -145,12 +239,13 @@ TEST(InternalPayloadFactoryTest,
   header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
   header.set_total_size(512);
   std::unique_ptr<InternalPayload> internal_payload =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, path, stream_writers);
   EXPECT_EQ(internal_payload, nullptr);
 }
 
 TEST(InternalPayloadFactoryTest,
      CanCreateInternalPayloadFromFileMessageWithFileNameNotSet) {
+  IncomingStreamWriters stream_writers;
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
   frame.set_packet_type(PayloadTransferFrame::DATA);
@@ -159,13 +254,14 @@ TEST(InternalPayloadFactoryTest,
   header.set_id(12345);
   header.set_total_size(512);
   std::unique_ptr<InternalPayload> internal_payload =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, path, stream_writers);
   EXPECT_NE(internal_payload, nullptr);
   Payload payload = internal_payload->ReleasePayload();
   EXPECT_EQ(payload.GetFileName(), "12345");
 }
 TEST(InternalPayloadFactoryTest,
      CanCreateInternalPayloadFromFileMessageWithFileNameSet) {
+  IncomingStreamWriters stream_writers;
   PayloadTransferFrame frame;
   std::string path = "C:\\Downloads";
   frame.set_packet_type(PayloadTransferFrame::DATA);
@@ -175,7 +271,7 @@ TEST(InternalPayloadFactoryTest,
   header.set_total_size(512);
   header.set_file_name("test.file.name");
   std::unique_ptr<InternalPayload> internal_payload =
-      CreateIncomingInternalPayload(frame, path);
+      CreateIncomingInternalPayload(frame, path, stream_writers);
   EXPECT_NE(internal_payload, nullptr);
   auto test = internal_payload->GetFileName();
   Payload payload = internal_payload->ReleasePayload();
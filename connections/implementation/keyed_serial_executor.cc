@@ -0,0 +1,123 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/keyed_serial_executor.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "internal/platform/cached_thread_pool.h"
+#include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace connections {
+
+KeyedSerialExecutor::KeyedSerialExecutor(int max_parallelism)
+    : KeyedSerialExecutor(max_parallelism, /*thread_per_task=*/false) {}
+
+std::unique_ptr<KeyedSerialExecutor>
+KeyedSerialExecutor::CreateWithThreadPerTask(int max_idle_threads) {
+  return std::unique_ptr<KeyedSerialExecutor>(
+      new KeyedSerialExecutor(max_idle_threads, /*thread_per_task=*/true));
+}
+
+KeyedSerialExecutor::KeyedSerialExecutor(int max_parallelism,
+                                         bool thread_per_task) {
+  if (thread_per_task) {
+    thread_pool_ = std::make_unique<CachedThreadPool>(max_parallelism);
+  } else {
+    executor_ = std::make_unique<MultiThreadExecutor>(max_parallelism);
+  }
+}
+
+KeyedSerialExecutor::~KeyedSerialExecutor() { Shutdown(); }
+
+void KeyedSerialExecutor::Execute(const std::string& key,
+                                  const std::string& name,
+                                  Runnable&& runnable) {
+  Execute(std::vector<std::string>{key}, name, std::move(runnable));
+}
+
+void KeyedSerialExecutor::Execute(const std::vector<std::string>& keys,
+                                  const std::string& name,
+                                  Runnable&& runnable) {
+  MutexLock lock(&mutex_);
+  if (shutdown_ || keys.empty()) return;
+  auto task = std::make_shared<Task>();
+  task->name = name;
+  task->keys = keys;
+  task->runnable = std::move(runnable);
+  for (const std::string& key : keys) queues_[key].push_back(task);
+  MaybeScheduleLocked(task);
+}
+
+void KeyedSerialExecutor::Shutdown() {
+  {
+    MutexLock lock(&mutex_);
+    shutdown_ = true;
+    queues_.clear();
+  }
+  if (executor_) executor_->Shutdown();
+  if (thread_pool_) thread_pool_->Shutdown();
+}
+
+void KeyedSerialExecutor::MaybeScheduleLocked(
+    const std::shared_ptr<Task>& task) {
+  if (task->scheduled) return;
+  for (const std::string& key : task->keys) {
+    auto it = queues_.find(key);
+    if (it == queues_.end() || it->second.front() != task) return;
+  }
+  task->scheduled = true;
+  if (executor_) {
+    executor_->Execute(task->name, [this, task]() { Run(task); });
+  } else {
+    thread_pool_->Execute(task->name, [this, task]() { Run(task); });
+  }
+}
+
+void KeyedSerialExecutor::Run(const std::shared_ptr<Task>& task) {
+  Runnable runnable;
+  {
+    MutexLock lock(&mutex_);
+    if (shutdown_) return;
+    runnable = std::move(task->runnable);
+  }
+
+  runnable();
+
+  MutexLock lock(&mutex_);
+  if (shutdown_) return;
+  std::vector<std::shared_ptr<Task>> next_tasks;
+  for (const std::string& key : task->keys) {
+    auto it = queues_.find(key);
+    if (it == queues_.end()) continue;
+    it->second.pop_front();
+    if (it->second.empty()) {
+      queues_.erase(it);
+    } else {
+      next_tasks.push_back(it->second.front());
+    }
+  }
+  for (const std::shared_ptr<Task>& next_task : next_tasks) {
+    MaybeScheduleLocked(next_task);
+  }
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,96 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_KEYED_SERIAL_EXECUTOR_H_
+#define CORE_INTERNAL_KEYED_SERIAL_EXECUTOR_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "internal/platform/cached_thread_pool.h"
+#include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/runnable.h"
+
+namespace nearby {
+namespace connections {
+
+// Runs tasks on a shared pool of threads. Tasks posted with the same key run
+// one at a time, in the order they were posted; tasks with different keys run
+// in parallel, up to the size of the pool. A task may have several keys, such
+// as a frame sent to several endpoints; it then runs after every task posted
+// before it under any of them, and before every task posted after it.
+//
+// After each task its keys go to the back of the pool's queue, so busy keys
+// take turns instead of one of them holding on to a thread.
+class KeyedSerialExecutor {
+ public:
+  // Runs tasks on up to `max_parallelism` threads.
+  explicit KeyedSerialExecutor(int max_parallelism);
+  // Runs each task on a thread of its own, so a task blocked on I/O only holds
+  // up the tasks that share a key with it. As those never run at once, there
+  // is at most one thread per key. Keeps up to `max_idle_threads` threads
+  // between tasks.
+  static std::unique_ptr<KeyedSerialExecutor> CreateWithThreadPerTask(
+      int max_idle_threads);
+  KeyedSerialExecutor(const KeyedSerialExecutor&) = delete;
+  KeyedSerialExecutor& operator=(const KeyedSerialExecutor&) = delete;
+  ~KeyedSerialExecutor();
+
+  // Posts `runnable` to the queue of `key`. Ignored after Shutdown().
+  void Execute(const std::string& key, const std::string& name,
+               Runnable&& runnable) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Posts `runnable` to the queues of all of `keys`. Ignored after Shutdown()
+  // or if `keys` is empty.
+  void Execute(const std::vector<std::string>& keys, const std::string& name,
+               Runnable&& runnable) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Drops the tasks that have not started yet and waits for the running ones.
+  void Shutdown() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Task {
+    std::string name;
+    std::vector<std::string> keys;
+    Runnable runnable;
+    bool scheduled = false;
+  };
+
+  KeyedSerialExecutor(int max_parallelism, bool thread_per_task);
+
+  // Schedules `task` if it is first in the queues of all of its keys.
+  void MaybeScheduleLocked(const std::shared_ptr<Task>& task)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void Run(const std::shared_ptr<Task>& task) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  Mutex mutex_;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  // Holds a key for as long as it has tasks, the first of which is running or
+  // waiting for the tasks of its other keys.
+  absl::flat_hash_map<std::string, std::deque<std::shared_ptr<Task>>> queues_
+      ABSL_GUARDED_BY(mutex_);
+  // One of these runs the tasks.
+  std::unique_ptr<MultiThreadExecutor> executor_;
+  std::unique_ptr<CachedThreadPool> thread_pool_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_KEYED_SERIAL_EXECUTOR_H_
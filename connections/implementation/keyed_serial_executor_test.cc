@@ -0,0 +1,176 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/keyed_serial_executor.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+class TaskLog {
+ public:
+  void Add(const std::string& task) {
+    absl::MutexLock lock(&mutex_);
+    tasks_.push_back(task);
+  }
+  std::vector<std::string> tasks() {
+    absl::MutexLock lock(&mutex_);
+    return tasks_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<std::string> tasks_;
+};
+
+TEST(KeyedSerialExecutorTest, RunsTasksWithSameKeyInOrder) {
+  KeyedSerialExecutor executor(/*max_parallelism=*/4);
+  TaskLog log;
+  CountDownLatch done(3);
+
+  for (const char* task : {"1", "2", "3"}) {
+    executor.Execute("endpoint", "task", [&log, &done, task]() {
+      log.Add(task);
+      done.CountDown();
+    });
+  }
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+  EXPECT_THAT(log.tasks(), ElementsAre("1", "2", "3"));
+}
+
+TEST(KeyedSerialExecutorTest, RunsTasksWithDifferentKeysInParallel) {
+  KeyedSerialExecutor executor(/*max_parallelism=*/2);
+  CountDownLatch both_started(2);
+  CountDownLatch done(2);
+
+  // Each task waits for the other one to start, which only works if they run
+  // at the same time.
+  for (const char* key : {"endpoint_a", "endpoint_b"}) {
+    executor.Execute(key, "task", [&both_started, &done]() {
+      both_started.CountDown();
+      if (both_started.Await(kTimeout).result()) done.CountDown();
+    });
+  }
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+}
+
+TEST(KeyedSerialExecutorTest, KeysTakeTurns) {
+  KeyedSerialExecutor executor(/*max_parallelism=*/1);
+  TaskLog log;
+  CountDownLatch all_posted(1);
+  CountDownLatch done(4);
+
+  executor.Execute("endpoint_a", "task", [&]() {
+    all_posted.Await(kTimeout);
+    log.Add("a1");
+    done.CountDown();
+  });
+  executor.Execute("endpoint_a", "task", [&]() {
+    log.Add("a2");
+    done.CountDown();
+  });
+  executor.Execute("endpoint_b", "task", [&]() {
+    log.Add("b1");
+    done.CountDown();
+  });
+  executor.Execute("endpoint_b", "task", [&]() {
+    log.Add("b2");
+    done.CountDown();
+  });
+  all_posted.CountDown();
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+  EXPECT_THAT(log.tasks(), ElementsAre("a1", "b1", "a2", "b2"));
+}
+
+TEST(KeyedSerialExecutorTest, TaskWithSeveralKeysWaitsForEachOfThem) {
+  KeyedSerialExecutor executor(/*max_parallelism=*/4);
+  TaskLog log;
+  CountDownLatch release_b(1);
+  CountDownLatch done(4);
+
+  executor.Execute("endpoint_a", "task", [&]() {
+    log.Add("a");
+    done.CountDown();
+  });
+  executor.Execute("endpoint_b", "task", [&]() {
+    release_b.Await(kTimeout);
+    log.Add("b");
+    done.CountDown();
+  });
+  executor.Execute(std::vector<std::string>{"endpoint_a", "endpoint_b"},
+                   "task", [&]() {
+                     log.Add("ab");
+                     done.CountDown();
+                   });
+  // Posted after "ab", so it doesn't overtake it on endpoint_a.
+  executor.Execute("endpoint_a", "task", [&]() {
+    log.Add("a2");
+    done.CountDown();
+  });
+  release_b.CountDown();
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+  EXPECT_THAT(log.tasks(), ElementsAre("a", "b", "ab", "a2"));
+}
+
+TEST(KeyedSerialExecutorTest, BlockedTasksDontHoldUpOtherKeys) {
+  std::unique_ptr<KeyedSerialExecutor> executor =
+      KeyedSerialExecutor::CreateWithThreadPerTask(/*max_idle_threads=*/1);
+  CountDownLatch release(1);
+  CountDownLatch blocked_started(2);
+  CountDownLatch done(1);
+
+  for (const char* key : {"endpoint_a", "endpoint_b"}) {
+    executor->Execute(key, "task", [&release, &blocked_started]() {
+      blocked_started.CountDown();
+      release.Await(kTimeout);
+    });
+  }
+  EXPECT_TRUE(blocked_started.Await(kTimeout).result());
+  executor->Execute("endpoint_c", "task", [&done]() { done.CountDown(); });
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+  release.CountDown();
+}
+
+TEST(KeyedSerialExecutorTest, IgnoresTasksAfterShutdown) {
+  KeyedSerialExecutor executor(/*max_parallelism=*/1);
+  TaskLog log;
+
+  executor.Shutdown();
+  executor.Execute("endpoint", "task", [&log]() { log.Add("task"); });
+
+  EXPECT_TRUE(log.tasks().empty());
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
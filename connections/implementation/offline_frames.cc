@@ -14,18 +14,26 @@
 
 #include "connections/implementation/offline_frames.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "google/protobuf/io/coded_stream.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/offline_frames_validator.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/status.h"
 #include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
+#include "internal/platform/feature_flags.h"
 
 namespace nearby {
 namespace connections {
@@ -51,12 +59,218 @@ ByteArray ToBytes(OfflineFrame&& frame) {
   return bytes;
 }
 
+// Appends the tag and length of a length-delimited field holding `size` bytes.
+// Returns the size of the field.
+size_t AppendLengthDelimitedField(int field_number, size_t size,
+                                  std::string& out) {
+  using ::google::protobuf::io::CodedOutputStream;
+  // Wire type 2 is length-delimited.
+  std::uint32_t tag = (field_number << 3) | 2;
+  // Room for two varint32s of up to 5 bytes each.
+  std::uint8_t buffer[10];
+  std::uint8_t* end = CodedOutputStream::WriteVarint32ToArray(tag, buffer);
+  end = CodedOutputStream::WriteVarint32ToArray(size, end);
+  out.append(reinterpret_cast<const char*>(buffer), end - buffer);
+  return (end - buffer) + size;
+}
+
+// Reads a base 128 varint of at most 64 bits from the front of `in`.
+bool ReadVarint(absl::string_view& in, std::uint64_t& value) {
+  value = 0;
+  for (int i = 0; i < 10 && i < in.size(); ++i) {
+    std::uint8_t byte = in[i];
+    // The 10th byte holds the 64th bit only.
+    if (i == 9 && byte > 1) return false;
+    value |= static_cast<std::uint64_t>(byte & 0x7f) << (7 * i);
+    if ((byte & 0x80) == 0) {
+      in.remove_prefix(i + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+// One field of a message: its number, and either its varint value or its
+// length-delimited contents. Other wire types are not handled.
+struct Field {
+  std::uint32_t number = 0;
+  bool is_length_delimited = false;
+  std::uint64_t varint = 0;
+  absl::string_view contents;
+};
+
+bool ReadField(absl::string_view& in, Field& field) {
+  std::uint64_t tag;
+  if (!ReadVarint(in, tag) || tag > 0xffffffff) return false;
+  field.number = tag >> 3;
+  if (field.number == 0) return false;
+  switch (tag & 7) {
+    case 0:
+      field.is_length_delimited = false;
+      return ReadVarint(in, field.varint);
+    case 2: {
+      std::uint64_t length;
+      if (!ReadVarint(in, length) || length > in.size() ||
+          length > std::numeric_limits<std::int32_t>::max()) {
+        return false;
+      }
+      field.is_length_delimited = true;
+      field.contents = in.substr(0, length);
+      in.remove_prefix(length);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// The Decode*() functions below merge fields into their message the way the
+// protobuf parser does: later scalars win and repeated messages are merged.
+// They return false on anything but the fields of a DATA frame.
+
+bool DecodePayloadChunk(absl::string_view in,
+                        PayloadTransferFrame::PayloadChunk& chunk,
+                        std::optional<absl::string_view>& body) {
+  Field field;
+  while (!in.empty()) {
+    if (!ReadField(in, field)) return false;
+    switch (field.number) {
+      case PayloadTransferFrame::PayloadChunk::kFlagsFieldNumber:
+        if (field.is_length_delimited) return false;
+        chunk.set_flags(static_cast<std::int32_t>(field.varint));
+        break;
+      case PayloadTransferFrame::PayloadChunk::kOffsetFieldNumber:
+        if (field.is_length_delimited) return false;
+        chunk.set_offset(static_cast<std::int64_t>(field.varint));
+        break;
+      case PayloadTransferFrame::PayloadChunk::kBodyFieldNumber:
+        if (!field.is_length_delimited) return false;
+        // Copied once the whole frame is decoded.
+        body = field.contents;
+        break;
+      case PayloadTransferFrame::PayloadChunk::kIndexFieldNumber:
+        if (field.is_length_delimited) return false;
+        chunk.set_index(static_cast<std::int32_t>(field.varint));
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool DecodePayloadTransfer(absl::string_view in, PayloadTransferFrame& frame,
+                           std::optional<absl::string_view>& body) {
+  Field field;
+  while (!in.empty()) {
+    if (!ReadField(in, field)) return false;
+    switch (field.number) {
+      case PayloadTransferFrame::kPacketTypeFieldNumber:
+        if (field.is_length_delimited ||
+            field.varint != PayloadTransferFrame::DATA) {
+          return false;
+        }
+        frame.set_packet_type(PayloadTransferFrame::DATA);
+        break;
+      case PayloadTransferFrame::kPayloadHeaderFieldNumber: {
+        // The header is small; the generic parser is fine for it.
+        if (!field.is_length_delimited) return false;
+        ::google::protobuf::io::CodedInputStream stream(
+            reinterpret_cast<const std::uint8_t*>(field.contents.data()),
+            field.contents.size());
+        if (!frame.mutable_payload_header()->MergeFromCodedStream(&stream) ||
+            !stream.ConsumedEntireMessage()) {
+          return false;
+        }
+        break;
+      }
+      case PayloadTransferFrame::kPayloadChunkFieldNumber:
+        if (!field.is_length_delimited ||
+            !DecodePayloadChunk(field.contents, *frame.mutable_payload_chunk(),
+                                body)) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool DecodeV1Frame(absl::string_view in, V1Frame& frame,
+                   std::optional<absl::string_view>& body) {
+  Field field;
+  while (!in.empty()) {
+    if (!ReadField(in, field)) return false;
+    switch (field.number) {
+      case V1Frame::kTypeFieldNumber:
+        if (field.is_length_delimited ||
+            field.varint != V1Frame::PAYLOAD_TRANSFER) {
+          return false;
+        }
+        frame.set_type(V1Frame::PAYLOAD_TRANSFER);
+        break;
+      case V1Frame::kPayloadTransferFieldNumber:
+        if (!field.is_length_delimited ||
+            !DecodePayloadTransfer(field.contents,
+                                   *frame.mutable_payload_transfer(), body)) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
+bool TryDecodeDataPayloadTransfer(absl::string_view bytes,
+                                  OfflineFrame& frame) {
+  frame.Clear();
+  std::optional<absl::string_view> body;
+  Field field;
+  while (!bytes.empty()) {
+    if (!ReadField(bytes, field)) return false;
+    switch (field.number) {
+      case OfflineFrame::kVersionFieldNumber:
+        if (field.is_length_delimited || field.varint != OfflineFrame::V1) {
+          return false;
+        }
+        frame.set_version(OfflineFrame::V1);
+        break;
+      case OfflineFrame::kV1FieldNumber:
+        if (!field.is_length_delimited ||
+            !DecodeV1Frame(field.contents, *frame.mutable_v1(), body)) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  if (frame.v1().payload_transfer().packet_type() !=
+      PayloadTransferFrame::DATA) {
+    return false;
+  }
+  if (body.has_value()) {
+    frame.mutable_v1()->mutable_payload_transfer()->mutable_payload_chunk()
+        ->set_body(std::string(*body));
+  }
+  return true;
+}
+
 ExceptionOrOfflineFrame FromBytes(const ByteArray& bytes) {
   OfflineFrame frame;
 
-  if (frame.ParseFromString(std::string(bytes))) {
+  bool parsed = TryDecodeDataPayloadTransfer(
+      absl::string_view(bytes.data(), bytes.size()), frame);
+  if (!parsed) {
+    parsed = frame.ParseFromString(std::string(bytes));
+  }
+  if (parsed) {
     Exception validation_exception = EnsureValidOfflineFrame(frame);
     if (validation_exception.Raised()) {
       return ExceptionOrOfflineFrame(validation_exception);
@@ -185,10 +399,23 @@ ByteArray ForConnectionResponse(
                               ? ConnectionResponseFrame::ACCEPT
                               : ConnectionResponseFrame::REJECT);
   *sub_frame->mutable_os_info() = os_info;
-  sub_frame->set_safe_to_disconnect_version(
+  std::int64_t safe_to_disconnect_version =
       NearbyFlags::GetInstance().GetInt64Flag(
           config_package_nearby::nearby_connections_feature::
-              kSafeToDisconnectVersion));
+              kSafeToDisconnectVersion);
+  // The version that supports resumable file transfers makes the remote
+  // endpoint ask before it sends a file, so only claim it if we can answer.
+  if (!NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableResumableFileTransfers)) {
+    safe_to_disconnect_version = std::min<std::int64_t>(
+        safe_to_disconnect_version,
+        FeatureFlags::GetInstance()
+                .GetFlags()
+                .min_nc_version_supports_resumable_file_transfers -
+            1);
+  }
+  sub_frame->set_safe_to_disconnect_version(safe_to_disconnect_version);
 
   return ToBytes(std::move(frame));
 }
@@ -209,6 +436,29 @@ ByteArray ForDataPayloadTransfer(
   return ToBytes(std::move(frame));
 }
 
+ByteBuffer ForDataPayloadTransfer(
+    const PayloadTransferFrame::PayloadHeader& header,
+    const PayloadTransferFrame::PayloadChunk& chunk, const ByteBuffer& body) {
+  ByteBuffer frame(ForDataPayloadTransfer(header, chunk));
+  if (body.Empty()) return frame;
+
+  // A second frame holding only v1.payload_transfer.payload_chunk.body. Its
+  // headers are written innermost first, then put in order.
+  std::string headers[4];
+  size_t size = AppendLengthDelimitedField(
+      PayloadTransferFrame::PayloadChunk::kBodyFieldNumber, body.size(),
+      headers[3]);
+  size = AppendLengthDelimitedField(
+      PayloadTransferFrame::kPayloadChunkFieldNumber, size, headers[2]);
+  size = AppendLengthDelimitedField(V1Frame::kPayloadTransferFieldNumber, size,
+                                    headers[1]);
+  AppendLengthDelimitedField(OfflineFrame::kV1FieldNumber, size, headers[0]);
+  frame.Append(ByteBuffer(absl::StrCat(headers[0], headers[1], headers[2],
+                                       headers[3])));
+  frame.Append(body);
+  return frame;
+}
+
 ByteArray ForControlPayloadTransfer(
     const PayloadTransferFrame::PayloadHeader& header,
     const PayloadTransferFrame::ControlMessage& control) {
@@ -19,9 +19,11 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
 #include "connections/connection_options.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/exception.h"
 
 namespace nearby {
@@ -39,6 +41,16 @@ using UpgradePathInfo = ::location::nearby::connections::
 ExceptionOr<location::nearby::connections::OfflineFrame> FromBytes(
     const ByteArray& offline_frame_bytes);
 
+// Decodes a PAYLOAD_TRANSFER DATA frame by hand, which is cheaper than the
+// generic protobuf parser: the input is not copied and the chunk body is copied
+// only once. `frame` ends up as the generic parser would have left it. Returns
+// false for any other frame, and for anything this decoder doesn't handle, such
+// as unknown fields; `frame` is then left unspecified. Does not validate the
+// frame. FromBytes() uses this first and falls back to the generic parser.
+bool TryDecodeDataPayloadTransfer(
+    absl::string_view offline_frame_bytes,
+    location::nearby::connections::OfflineFrame& frame);
+
 // Returns FrameType of a parsed message, or
 // V1Frame::UNKNOWN_FRAME_TYPE, if frame contents is not recognized.
 location::nearby::connections::V1Frame::FrameType GetFrameType(
@@ -61,6 +73,16 @@ ByteArray ForDataPayloadTransfer(
         header,
     const location::nearby::connections::PayloadTransferFrame::PayloadChunk&
         chunk);
+// Same frame as above with `body` as the chunk's body, which `chunk` must not
+// have. The body is not copied: the returned buffer shares it as its last
+// segment, behind the serialized rest of the frame. Parsers merge the two parts
+// into one message, so the frame reads the same as above.
+ByteBuffer ForDataPayloadTransfer(
+    const location::nearby::connections::PayloadTransferFrame::PayloadHeader&
+        header,
+    const location::nearby::connections::PayloadTransferFrame::PayloadChunk&
+        chunk,
+    const ByteBuffer& body);
 ByteArray ForControlPayloadTransfer(
     const location::nearby::connections::PayloadTransferFrame::PayloadHeader&
         header,
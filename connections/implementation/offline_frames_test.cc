@@ -24,8 +24,11 @@
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/proto/offline_wire_formats.pb.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 
 namespace nearby {
 namespace connections {
@@ -282,6 +285,33 @@ TEST(OfflineFramesTest, CanGenerateConnectionResponse) {
   EXPECT_THAT(message, EqualsProto(kExpected));
 }
 
+TEST(OfflineFramesTest,
+     ConnectionResponseClaimsResumableFileTransfersOnlyWhenEnabled) {
+  NearbyFlags::GetInstance().OverrideInt64FlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kSafeToDisconnectVersion,
+      6);
+  OsInfo os_info;
+  os_info.set_type(OsInfo::LINUX);
+
+  auto response = FromBytes(ForConnectionResponse(0, os_info));
+  ASSERT_TRUE(response.ok());
+  EXPECT_EQ(
+      response.result().v1().connection_response().safe_to_disconnect_version(),
+      5);
+
+  NearbyFlags::GetInstance().OverrideBoolFlagValue(
+      config_package_nearby::nearby_connections_feature::
+          kEnableResumableFileTransfers,
+      true);
+  response = FromBytes(ForConnectionResponse(0, os_info));
+  ASSERT_TRUE(response.ok());
+  EXPECT_EQ(
+      response.result().v1().connection_response().safe_to_disconnect_version(),
+      6);
+  NearbyFlags::GetInstance().ResetOverridedValues();
+}
+
 TEST(OfflineFramesTest, CanGenerateControlPayloadTransfer) {
   PayloadTransferFrame::PayloadHeader header;
   PayloadTransferFrame::ControlMessage control;
@@ -337,6 +367,65 @@ TEST(OfflineFramesTest, CanGenerateDataPayloadTransfer) {
   EXPECT_THAT(message, EqualsProto(kExpected));
 }
 
+TEST(OfflineFramesTest, CanGenerateDataPayloadTransferWithSharedBody) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  chunk.set_offset(150);
+  chunk.set_flags(0);
+  // Long enough for the lengths to take more than one byte.
+  ByteBuffer body(ByteArray(std::string(300, 'x')));
+
+  ByteBuffer bytes = ForDataPayloadTransfer(header, chunk, body);
+
+  chunk.set_body(std::string(300, 'x'));
+  auto response = FromBytes(bytes.Flatten());
+  ASSERT_TRUE(response.ok());
+  EXPECT_THAT(response.result(),
+              EqualsProto(FromBytes(ForDataPayloadTransfer(header, chunk))
+                              .result()));
+  // The body is shared, not copied.
+  EXPECT_EQ(bytes.GetSegment(bytes.segment_count() - 1).data(),
+            body.GetSegment(0).data());
+}
+
+TEST(OfflineFramesTest, CanDecodeDataPayloadTransferByHand) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::PayloadChunk chunk;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::FILE);
+  header.set_total_size(1024);
+  header.set_file_name("file");
+  chunk.set_offset(150);
+  chunk.set_flags(0);
+  ByteBuffer bytes = ForDataPayloadTransfer(
+      header, chunk, ByteBuffer(ByteArray(std::string(300, 'x'))));
+  std::string flat(bytes.Flatten());
+
+  OfflineFrame decoded;
+  ASSERT_TRUE(TryDecodeDataPayloadTransfer(flat, decoded));
+
+  OfflineFrame parsed;
+  ASSERT_TRUE(parsed.ParseFromString(flat));
+  EXPECT_THAT(decoded, EqualsProto(parsed));
+  EXPECT_EQ(decoded.v1().payload_transfer().payload_chunk().body(),
+            std::string(300, 'x'));
+}
+
+TEST(OfflineFramesTest, DoesNotDecodeControlPayloadTransferByHand) {
+  PayloadTransferFrame::PayloadHeader header;
+  PayloadTransferFrame::ControlMessage control;
+  header.set_id(12345);
+  header.set_type(PayloadTransferFrame::PayloadHeader::BYTES);
+  control.set_event(PayloadTransferFrame::ControlMessage::PAYLOAD_CANCELED);
+  ByteArray bytes = ForControlPayloadTransfer(header, control);
+
+  OfflineFrame decoded;
+  EXPECT_FALSE(TryDecodeDataPayloadTransfer(std::string(bytes), decoded));
+}
+
 TEST(OfflineFramesTest, CanGenerateBwuWifiHotspotPathAvailable) {
   constexpr absl::string_view kExpected =
       R"pb(
@@ -0,0 +1,200 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/partial_file_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/device_info_impl.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+namespace {
+constexpr char kDirectoryName[] = "nearby_connections_partial_files";
+constexpr absl::string_view kFileExtension = ".partial";
+
+constexpr std::uint32_t kAdler32Modulus = 65521;
+// The most bytes that can be summed before the sums must be reduced, so they
+// don't overflow 32 bits.
+constexpr std::size_t kAdler32BlockSize = 5552;
+// How many bytes of a file are read at a time to compute its checksum.
+constexpr std::size_t kFileChecksumReadSize = 64 * 1024;
+}  // namespace
+
+std::uint32_t UpdateAdler32(std::uint32_t checksum, absl::string_view data) {
+  std::uint32_t a = checksum & 0xffff;
+  std::uint32_t b = checksum >> 16;
+  while (!data.empty()) {
+    std::size_t block_size = std::min(data.size(), kAdler32BlockSize);
+    for (unsigned char c : data.substr(0, block_size)) {
+      a += c;
+      b += a;
+    }
+    a %= kAdler32Modulus;
+    b %= kAdler32Modulus;
+    data.remove_prefix(block_size);
+  }
+  return (b << 16) | a;
+}
+
+// Same as zlib's adler32_combine().
+std::uint32_t CombineAdler32(std::uint32_t checksum1, std::uint32_t checksum2,
+                             std::int64_t size2) {
+  std::uint32_t remainder = static_cast<std::uint32_t>(size2 % kAdler32Modulus);
+  std::uint32_t a = checksum1 & 0xffff;
+  std::uint32_t b = (remainder * a) % kAdler32Modulus;
+  a += (checksum2 & 0xffff) + kAdler32Modulus - 1;
+  b += (checksum1 >> 16) + (checksum2 >> 16) + kAdler32Modulus - remainder;
+  if (a >= kAdler32Modulus) a -= kAdler32Modulus;
+  if (a >= kAdler32Modulus) a -= kAdler32Modulus;
+  if (b >= 2 * kAdler32Modulus) b -= 2 * kAdler32Modulus;
+  if (b >= kAdler32Modulus) b -= kAdler32Modulus;
+  return (b << 16) | a;
+}
+
+std::optional<std::uint32_t> ComputeFileChecksum(const std::string& file_path,
+                                                 std::int64_t size) {
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  std::uint32_t checksum = kInitialAdler32;
+  std::string data(kFileChecksumReadSize, '\0');
+  while (size > 0) {
+    std::int64_t read_size =
+        std::min<std::int64_t>(size, kFileChecksumReadSize);
+    if (!file.read(data.data(), read_size)) {
+      return std::nullopt;
+    }
+    checksum =
+        UpdateAdler32(checksum, absl::string_view(data.data(), read_size));
+    size -= read_size;
+  }
+  return checksum;
+}
+
+std::filesystem::path PartialFileStore::GetDefaultDirectory() {
+  return DeviceInfoImpl().GetAppDataPath() / kDirectoryName;
+}
+
+PartialFileStore::PartialFileStore(std::filesystem::path directory,
+                                   absl::Duration max_age)
+    : directory_(std::move(directory)) {
+  std::error_code error;
+  auto oldest_write_time = std::filesystem::file_time_type::clock::now() -
+                           absl::ToChronoSeconds(max_age);
+  for (const auto& entry :
+       std::filesystem::directory_iterator(directory_, error)) {
+    if (entry.path().extension().string() != kFileExtension) continue;
+    std::filesystem::file_time_type write_time =
+        std::filesystem::last_write_time(entry.path(), error);
+    if (error || write_time > oldest_write_time) continue;
+    NEARBY_LOGS(INFO) << "Forgetting expired partial file record "
+                      << entry.path().string();
+    std::filesystem::remove(entry.path(), error);
+  }
+}
+
+void PartialFileStore::Save(const PartialFile& partial_file) {
+  MutexLock lock(&mutex_);
+  std::filesystem::path record_path = GetRecordPath(partial_file.payload_id);
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  // Write to a temporary file first, so a crash can't leave a partial record.
+  std::filesystem::path temp_path = record_path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::trunc);
+    file << partial_file.payload_id << "\n"
+         << partial_file.total_size << "\n"
+         << partial_file.offset << "\n"
+         << partial_file.checksum << "\n"
+         << partial_file.file_path << "\n";
+    if (!file.good()) {
+      NEARBY_LOGS(WARNING) << "Failed to write partial file record to "
+                           << temp_path.string();
+      return;
+    }
+  }
+  std::filesystem::rename(temp_path, record_path, error);
+  if (error) {
+    NEARBY_LOGS(WARNING) << "Failed to write partial file record to "
+                         << record_path.string() << ": " << error.message();
+  }
+}
+
+std::optional<PartialFile> PartialFileStore::Load(
+    Payload::Id payload_id) const {
+  MutexLock lock(&mutex_);
+  std::ifstream file(GetRecordPath(payload_id));
+  if (!file.is_open()) {
+    return std::nullopt;
+  }
+  std::string payload_id_line;
+  std::string total_size_line;
+  std::string offset_line;
+  std::string checksum_line;
+  PartialFile partial_file;
+  if (!std::getline(file, payload_id_line) ||
+      !std::getline(file, total_size_line) ||
+      !std::getline(file, offset_line) || !std::getline(file, checksum_line) ||
+      !std::getline(file, partial_file.file_path) ||
+      !absl::SimpleAtoi(payload_id_line, &partial_file.payload_id) ||
+      !absl::SimpleAtoi(total_size_line, &partial_file.total_size) ||
+      !absl::SimpleAtoi(offset_line, &partial_file.offset) ||
+      !absl::SimpleAtoi(checksum_line, &partial_file.checksum) ||
+      partial_file.payload_id != payload_id || partial_file.offset < 0 ||
+      partial_file.offset > partial_file.total_size) {
+    NEARBY_LOGS(WARNING) << "Failed to parse partial file record of payload "
+                         << payload_id;
+    return std::nullopt;
+  }
+
+  std::error_code error;
+  std::uintmax_t file_size =
+      std::filesystem::file_size(partial_file.file_path, error);
+  if (error || file_size < static_cast<std::uintmax_t>(partial_file.offset)) {
+    NEARBY_LOGS(INFO) << "Partial file of payload " << payload_id
+                      << " is gone or shorter than its record.";
+    return std::nullopt;
+  }
+  return partial_file;
+}
+
+void PartialFileStore::Remove(Payload::Id payload_id) {
+  MutexLock lock(&mutex_);
+  std::error_code error;
+  std::filesystem::remove(GetRecordPath(payload_id), error);
+}
+
+std::filesystem::path PartialFileStore::GetRecordPath(
+    Payload::Id payload_id) const {
+  return directory_ / absl::StrCat(payload_id, kFileExtension);
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,99 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PARTIAL_FILE_STORE_H_
+#define CORE_INTERNAL_PARTIAL_FILE_STORE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "connections/payload.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// Adler-32 checksum (RFC 1950) of no data.
+constexpr std::uint32_t kInitialAdler32 = 1;
+
+// Returns the Adler-32 checksum of the data `checksum` was computed for,
+// followed by `data`.
+std::uint32_t UpdateAdler32(std::uint32_t checksum, absl::string_view data);
+
+// Returns the Adler-32 checksum of the data `checksum1` was computed for,
+// followed by the `size2` bytes `checksum2` was computed for.
+std::uint32_t CombineAdler32(std::uint32_t checksum1, std::uint32_t checksum2,
+                             std::int64_t size2);
+
+// Returns the checksum of the first `size` bytes of `file_path`, or nullopt if
+// they can't be read.
+std::optional<std::uint32_t> ComputeFileChecksum(const std::string& file_path,
+                                                 std::int64_t size);
+
+// The part of an incoming file payload that the receiver got before the
+// transfer stopped.
+struct PartialFile {
+  Payload::Id payload_id = 0;
+  std::string file_path;
+  std::int64_t total_size = 0;
+  // The first `offset` bytes of the payload are in the file.
+  std::int64_t offset = 0;
+  // Adler-32 checksum of those bytes, kept up to date as they are received.
+  std::uint32_t checksum = kInitialAdler32;
+};
+
+// Keeps PartialFiles in a directory, a small file each, so that they outlive
+// the process. Thread-safe.
+class PartialFileStore {
+ public:
+  // How long a PartialFile is kept by default. The same payload is rarely sent
+  // again after that.
+  static constexpr absl::Duration kDefaultMaxAge = absl::Hours(24);
+
+  // Returns the directory under the app data path where PayloadManager keeps
+  // its partial files.
+  static std::filesystem::path GetDefaultDirectory();
+
+  // Forgets the PartialFiles in `directory` that were saved more than
+  // `max_age` ago. Their files are left to the app, which was told that those
+  // payloads failed.
+  explicit PartialFileStore(std::filesystem::path directory,
+                            absl::Duration max_age = kDefaultMaxAge);
+
+  // Replaces what is kept for `partial_file.payload_id`.
+  void Save(const PartialFile& partial_file) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Returns what is kept for `payload_id`, unless its file has since become
+  // shorter than the offset.
+  std::optional<PartialFile> Load(Payload::Id payload_id) const
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  void Remove(Payload::Id payload_id) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  std::filesystem::path GetRecordPath(Payload::Id payload_id) const;
+
+  mutable Mutex mutex_;
+  const std::filesystem::path directory_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PARTIAL_FILE_STORE_H_
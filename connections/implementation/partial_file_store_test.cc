@@ -0,0 +1,152 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/partial_file_store.h"
+
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+class PartialFileStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    directory_ =
+        std::filesystem::temp_directory_path() /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directories(directory_);
+    file_path_ = (directory_ / "file").string();
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  void WriteFile(const std::string& contents) {
+    std::ofstream file(file_path_, std::ios::binary | std::ios::trunc);
+    file << contents;
+  }
+
+  PartialFile MakePartialFile(const std::string& received) {
+    PartialFile partial_file;
+    partial_file.payload_id = 1234;
+    partial_file.file_path = file_path_;
+    partial_file.total_size = 10;
+    partial_file.offset = received.size();
+    partial_file.checksum = UpdateAdler32(kInitialAdler32, received);
+    return partial_file;
+  }
+
+  std::filesystem::path directory_;
+  std::string file_path_;
+};
+
+TEST(Adler32Test, MatchesKnownChecksum) {
+  EXPECT_EQ(UpdateAdler32(kInitialAdler32, ""), 1u);
+  EXPECT_EQ(UpdateAdler32(kInitialAdler32, "Wikipedia"), 0x11E60398u);
+}
+
+TEST(Adler32Test, CanBeComputedPiecewise) {
+  std::string data(100000, '\xff');
+  EXPECT_EQ(UpdateAdler32(UpdateAdler32(kInitialAdler32, data.substr(0, 7)),
+                          data.substr(7)),
+            UpdateAdler32(kInitialAdler32, data));
+}
+
+TEST(Adler32Test, CanBeCombined) {
+  std::string data(100000, '\xff');
+  data[5] = 'a';
+  for (std::size_t split : {0, 7, 65521, 70000, 100000}) {
+    EXPECT_EQ(CombineAdler32(
+                  UpdateAdler32(kInitialAdler32, data.substr(0, split)),
+                  UpdateAdler32(kInitialAdler32, data.substr(split)),
+                  data.size() - split),
+              UpdateAdler32(kInitialAdler32, data));
+  }
+}
+
+TEST_F(PartialFileStoreTest, LoadsSavedPartialFile) {
+  WriteFile("abcd");
+  PartialFileStore store(directory_ / "records");
+
+  store.Save(MakePartialFile("abcd"));
+  std::optional<PartialFile> loaded = store.Load(1234);
+
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->payload_id, 1234);
+  EXPECT_EQ(loaded->file_path, file_path_);
+  EXPECT_EQ(loaded->total_size, 10);
+  EXPECT_EQ(loaded->offset, 4);
+  EXPECT_EQ(loaded->checksum, UpdateAdler32(kInitialAdler32, "abcd"));
+  EXPECT_FALSE(store.Load(5678).has_value());
+}
+
+TEST_F(PartialFileStoreTest, DoesNotLoadRemovedPartialFile) {
+  WriteFile("abcd");
+  PartialFileStore store(directory_ / "records");
+
+  store.Save(MakePartialFile("abcd"));
+  store.Remove(1234);
+
+  EXPECT_FALSE(store.Load(1234).has_value());
+}
+
+TEST_F(PartialFileStoreTest, DoesNotLoadTruncatedPartialFile) {
+  WriteFile("ab");
+  PartialFileStore store(directory_ / "records");
+
+  store.Save(MakePartialFile("abcd"));
+
+  EXPECT_FALSE(store.Load(1234).has_value());
+}
+
+TEST_F(PartialFileStoreTest, ForgetsExpiredPartialFiles) {
+  WriteFile("abcd");
+  {
+    PartialFileStore store(directory_ / "records");
+    store.Save(MakePartialFile("abcd"));
+  }
+
+  EXPECT_TRUE(PartialFileStore(directory_ / "records").Load(1234).has_value());
+  PartialFileStore store(directory_ / "records", absl::ZeroDuration());
+  EXPECT_FALSE(store.Load(1234).has_value());
+}
+
+TEST_F(PartialFileStoreTest, ComputesFileChecksum) {
+  std::string contents(200000, 'a');
+  contents[150000] = 'b';
+  WriteFile(contents);
+
+  EXPECT_EQ(ComputeFileChecksum(file_path_, 160000),
+            UpdateAdler32(kInitialAdler32, contents.substr(0, 160000)));
+  EXPECT_EQ(ComputeFileChecksum(file_path_, 0), kInitialAdler32);
+}
+
+TEST_F(PartialFileStoreTest, CannotComputeChecksumOfMissingBytes) {
+  WriteFile("ab");
+
+  EXPECT_FALSE(ComputeFileChecksum(file_path_, 4).has_value());
+  EXPECT_FALSE(ComputeFileChecksum(file_path_ + ".missing", 0).has_value());
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
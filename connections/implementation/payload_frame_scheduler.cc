@@ -0,0 +1,66 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_frame_scheduler.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+void PayloadFrameScheduler::StartHighPriorityWrite(
+    const std::vector<std::string>& endpoint_ids) {
+  MutexLock lock(&mutex_);
+  for (const auto& endpoint_id : endpoint_ids) {
+    ++high_priority_writes_[endpoint_id];
+  }
+}
+
+void PayloadFrameScheduler::FinishHighPriorityWrite(
+    const std::vector<std::string>& endpoint_ids) {
+  MutexLock lock(&mutex_);
+  for (const auto& endpoint_id : endpoint_ids) {
+    auto it = high_priority_writes_.find(endpoint_id);
+    if (it == high_priority_writes_.end()) continue;
+    if (--it->second <= 0) high_priority_writes_.erase(it);
+  }
+  writes_finished_.Notify();
+}
+
+void PayloadFrameScheduler::WaitForHighPriorityWrites(
+    const std::vector<std::string>& endpoint_ids, absl::Duration max_wait) {
+  absl::Time deadline = absl::Now() + max_wait;
+  MutexLock lock(&mutex_);
+  while (HasHighPriorityWritesLocked(endpoint_ids)) {
+    absl::Duration timeout = deadline - absl::Now();
+    if (timeout <= absl::ZeroDuration()) return;
+    writes_finished_.Wait(timeout);
+  }
+}
+
+bool PayloadFrameScheduler::HasHighPriorityWritesLocked(
+    const std::vector<std::string>& endpoint_ids) const {
+  for (const auto& endpoint_id : endpoint_ids) {
+    if (high_priority_writes_.contains(endpoint_id)) return true;
+  }
+  return false;
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,66 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_PAYLOAD_FRAME_SCHEDULER_H_
+#define CORE_INTERNAL_PAYLOAD_FRAME_SCHEDULER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/time/time.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+
+namespace nearby {
+namespace connections {
+
+// Orders the payload frames written to each endpoint by priority.
+//
+// Senders of high-priority frames bracket their writes with
+// StartHighPriorityWrite() and FinishHighPriorityWrite(). Senders of normal
+// frames call WaitForHighPriorityWrites() before each write, and so step aside
+// until the high-priority frames to the same endpoints are out. A normal
+// sender never waits longer than `max_wait`, so a steady stream of
+// high-priority frames slows bulk transfers down but cannot stall them.
+class PayloadFrameScheduler {
+ public:
+  void StartHighPriorityWrite(const std::vector<std::string>& endpoint_ids)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void FinishHighPriorityWrite(const std::vector<std::string>& endpoint_ids)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Blocks while a high-priority write to any of `endpoint_ids` is pending, up
+  // to `max_wait`. Returns right away if there is none.
+  void WaitForHighPriorityWrites(const std::vector<std::string>& endpoint_ids,
+                                 absl::Duration max_wait)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  bool HasHighPriorityWritesLocked(
+      const std::vector<std::string>& endpoint_ids) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Mutex mutex_;
+  ConditionVariable writes_finished_{&mutex_};
+  // Number of high-priority writes in progress, per endpoint.
+  absl::flat_hash_map<std::string, int> high_priority_writes_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_PAYLOAD_FRAME_SCHEDULER_H_
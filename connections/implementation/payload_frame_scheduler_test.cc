@@ -0,0 +1,78 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/payload_frame_scheduler.h"
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(PayloadFrameSchedulerTest, DoesNotWaitWithoutHighPriorityWrites) {
+  PayloadFrameScheduler scheduler;
+  absl::Time start = absl::Now();
+
+  scheduler.WaitForHighPriorityWrites({"endpoint"}, kTimeout);
+
+  EXPECT_LT(absl::Now() - start, kTimeout);
+}
+
+TEST(PayloadFrameSchedulerTest, DoesNotWaitForOtherEndpoints) {
+  PayloadFrameScheduler scheduler;
+  scheduler.StartHighPriorityWrite({"endpoint_a"});
+  absl::Time start = absl::Now();
+
+  scheduler.WaitForHighPriorityWrites({"endpoint_b"}, kTimeout);
+
+  EXPECT_LT(absl::Now() - start, kTimeout);
+  scheduler.FinishHighPriorityWrite({"endpoint_a"});
+}
+
+TEST(PayloadFrameSchedulerTest, WaitsUntilHighPriorityWriteFinishes) {
+  PayloadFrameScheduler scheduler;
+  SingleThreadExecutor executor;
+  CountDownLatch done(1);
+  scheduler.StartHighPriorityWrite({"endpoint_a", "endpoint_b"});
+
+  executor.Execute([&scheduler, &done]() {
+    scheduler.WaitForHighPriorityWrites({"endpoint_b"}, kTimeout);
+    done.CountDown();
+  });
+  EXPECT_FALSE(done.Await(absl::Milliseconds(100)).result());
+
+  scheduler.FinishHighPriorityWrite({"endpoint_a", "endpoint_b"});
+  EXPECT_TRUE(done.Await(kTimeout).result());
+}
+
+TEST(PayloadFrameSchedulerTest, StopsWaitingAfterMaxWait) {
+  PayloadFrameScheduler scheduler;
+  scheduler.StartHighPriorityWrite({"endpoint"});
+  absl::Time start = absl::Now();
+
+  scheduler.WaitForHighPriorityWrites({"endpoint"}, absl::Milliseconds(50));
+
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(50));
+  scheduler.FinishHighPriorityWrite({"endpoint"});
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -32,8 +33,10 @@
 #include "connections/implementation/endpoint_channel_manager.h"
 #include "connections/implementation/flags/nearby_connections_feature_flags.h"
 #include "connections/implementation/internal_payload_factory.h"
+#include "connections/implementation/partial_file_store.h"
 #include "connections/payload_type.h"
 #include "internal/flags/nearby_flags.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/feature_flags.h"
@@ -55,11 +58,15 @@ using ::nearby::connections::PayloadDirection;
 // C++14 requires to declare this.
 // TODO(apolyudov): remove when migration to c++17 is possible.
 constexpr absl::Duration PayloadManager::kWaitCloseTimeout;
+constexpr absl::Duration PayloadManager::kMaxHighPriorityFrameDelay;
+constexpr absl::Duration PayloadManager::kResumeQueryTimeout;
+constexpr std::int64_t PayloadManager::kMinResumableFileSize;
 
 bool PayloadManager::SendPayloadLoop(
     ClientProxy* client, PendingPayload& pending_payload,
     PayloadTransferFrame::PayloadHeader& payload_header,
-    std::int64_t& next_chunk_offset, size_t resume_offset) {
+    std::int64_t& next_chunk_offset, size_t resume_offset,
+    ChunkReadAhead* read_ahead) {
   // in lieu of structured binding:
   auto pair = GetAvailableAndUnavailableEndpoints(pending_payload);
   const EndpointIds& available_endpoint_ids =
@@ -127,13 +134,17 @@ bool PayloadManager::SendPayloadLoop(
   // This will block if there is no data to transfer.
   // It will resume when new data arrives, or if Close() is called.
   int chunk_size = GetOptimalChunkSize(available_endpoint_ids);
+  packet_meta_data.SetChunkSize(chunk_size);
   packet_meta_data.StartFileIo();
   ByteArray next_chunk =
-      pending_payload.GetInternalPayload()->DetachNextChunk(chunk_size);
+      read_ahead != nullptr
+          ? read_ahead->DetachNextChunk(chunk_size)
+          : pending_payload.GetInternalPayload()->DetachNextChunk(chunk_size);
   packet_meta_data.StopFileIo();
   if (shutdown_.Get()) return false;
   // Save chunk size. We'll need it after we move next_chunk.
   auto next_chunk_size = next_chunk.size();
+  packet_meta_data.SetChunkBodySize(next_chunk_size);
   if (!next_chunk_size &&
       pending_payload.GetInternalPayload()->GetTotalSize() > 0 &&
       pending_payload.GetInternalPayload()->GetTotalSize() <
@@ -150,10 +161,27 @@ bool PayloadManager::SendPayloadLoop(
   // used to decide if the received chunk is the initial payload chunk.
   // In other cases, the offset should only be used in both side logs when error
   // happened.
-  PayloadTransferFrame::PayloadChunk payload_chunk(CreatePayloadChunk(
-      next_chunk_offset - resume_offset, std::move(next_chunk)));
+  PayloadTransferFrame::PayloadChunk payload_chunk(
+      CreatePayloadChunk(next_chunk_offset - resume_offset, next_chunk_size));
+  ByteBuffer payload_chunk_body(std::move(next_chunk));
+  // Frames of high-priority bytes payloads go out between the chunks of any
+  // bulk transfer to the same endpoints.
+  bool is_high_priority =
+      payload_header.type() == PayloadTransferFrame::PayloadHeader::BYTES &&
+      pending_payload.GetInternalPayload()->GetPriority() ==
+          PayloadPriority::kHigh;
+  if (is_high_priority) {
+    frame_scheduler_.StartHighPriorityWrite(available_endpoint_ids);
+  } else {
+    frame_scheduler_.WaitForHighPriorityWrites(available_endpoint_ids,
+                                               kMaxHighPriorityFrameDelay);
+  }
   const EndpointIds& failed_endpoint_ids = endpoint_manager_->SendPayloadChunk(
-      payload_header, payload_chunk, available_endpoint_ids, packet_meta_data);
+      payload_header, payload_chunk, payload_chunk_body,
+      available_endpoint_ids, packet_meta_data);
+  if (is_high_priority) {
+    frame_scheduler_.FinishHighPriorityWrite(available_endpoint_ids);
+  }
   // Check whether at least one endpoint failed.
   if (!failed_endpoint_ids.empty()) {
     NEARBY_LOGS(INFO) << "Payload xfer: endpoints failed: payload_id="
@@ -180,7 +208,7 @@ bool PayloadManager::SendPayloadLoop(
 
         HandleSuccessfulOutgoingChunk(
             client, endpoint_id, payload_header, payload_chunk.flags(),
-            payload_chunk.offset(), payload_chunk.body().size());
+            payload_chunk.offset(), next_chunk_size, chunk_size);
       }
     }
     NEARBY_LOGS(VERBOSE) << "PayloadManager done sending chunk at offset "
@@ -307,6 +335,19 @@ PayloadManager::PayloadManager(EndpointManager& endpoint_manager)
     : endpoint_manager_(&endpoint_manager) {
   endpoint_manager_->RegisterFrameProcessor(V1Frame::PAYLOAD_TRANSFER, this);
   custom_save_path_ = "";
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableParallelFilePayloads)) {
+    parallel_file_executor_ = KeyedSerialExecutor::CreateWithThreadPerTask(
+        kMaxIdleFilePayloadThreads);
+  }
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          config_package_nearby::nearby_connections_feature::
+              kEnableResumableFileTransfers)) {
+    partial_file_store_ = std::make_unique<PartialFileStore>(
+        PartialFileStore::GetDefaultDirectory());
+    alarm_executor_ = std::make_unique<ScheduledExecutor>();
+  }
 }
 
 void PayloadManager::CancelAllPayloads() {
@@ -343,12 +384,22 @@ PayloadManager::~PayloadManager() {
   NEARBY_LOG(INFO, "PayloadManager: going down; self=%p", this);
   ThroughputRecorderContainer::GetInstance().Shutdown();
   DisconnectFromEndpointManager();
+  // Payloads waiting for a PAYLOAD_RESUME_OFFSET are not sent anymore.
+  if (alarm_executor_) alarm_executor_->Shutdown();
+  {
+    MutexLock lock(&partial_files_mutex_);
+    resume_queries_.clear();
+  }
   CancelAllPayloads();
   NEARBY_LOG(INFO, "PayloadManager: turn down payload executors; self=%p",
              this);
   bytes_payload_executor_.Shutdown();
+  high_priority_payload_executor_.Shutdown();
   stream_payload_executor_.Shutdown();
   file_payload_executor_.Shutdown();
+  if (parallel_file_executor_) parallel_file_executor_->Shutdown();
+  // Fails the incoming streams the apps haven't read yet.
+  incoming_stream_writers_.Shutdown();
 
   CountDownLatch stop_latch(1);
   // Clear our tracked pending payloads.
@@ -402,7 +453,8 @@ void PayloadManager::SendPayload(ClientProxy* client,
       break;
   }
 
-  auto executor = GetOutgoingPayloadExecutor(payload.GetType());
+  auto executor =
+      GetOutgoingPayloadExecutor(payload.GetType(), payload.GetPriority());
   // The |executor| will be null if the payload is of a type we cannot work
   // with. This should never be reached since the ServiceControllerRouter has
   // already checked whether or not we can work with this Payload type.
@@ -421,6 +473,8 @@ void PayloadManager::SendPayload(ClientProxy* client,
   // other payload of the same type from even starting until this one is
   // completely done with. If we ever want to provide isolation across
   // ClientProxy objects this will need to be significantly re-architected.
+  // With kEnableParallelFilePayloads, file payloads are instead queued per
+  // endpoint, see parallel_file_executor_.
   PayloadType payload_type = payload.GetType();
   size_t resume_offset =
       FeatureFlags::GetInstance().GetFlags().enable_send_payload_offset
@@ -429,57 +483,149 @@ void PayloadManager::SendPayload(ClientProxy* client,
 
   Payload::Id payload_id =
       CreateOutgoingPayload(std::move(payload), endpoint_ids);
-  executor->Execute(
-      "send-payload", [this, client, endpoint_ids, payload_id, payload_type,
-                       resume_offset, payload_total_size]() {
-        if (shutdown_.Get()) return;
-        PendingPayloadHandle pending_payload = GetPayload(payload_id);
-        if (!pending_payload) {
-          RecordInvalidPayloadAnalytics(client, endpoint_ids, payload_id,
-                                        payload_type, resume_offset,
-                                        payload_total_size);
-          NEARBY_LOGS(INFO)
-              << "PayloadManager failed to create InternalPayload for outgoing "
-                 "payload_id="
-              << payload_id << ", payload_type=" << ToString(payload_type)
-              << ", aborting sendPayload().";
-          return;
-        }
-        auto* internal_payload = pending_payload->GetInternalPayload();
-        if (!internal_payload) return;
-
-        RecordPayloadStartedAnalytics(client, endpoint_ids, payload_id,
-                                      payload_type, resume_offset,
-                                      internal_payload->GetTotalSize());
-
-        PayloadTransferFrame::PayloadHeader payload_header{
-            CreatePayloadHeader(*internal_payload, resume_offset,
-                                internal_payload->GetParentFolder(),
-                                internal_payload->GetFileName())};
-
-        bool should_continue = true;
-        std::int64_t next_chunk_offset = 0;
-
-        ThroughputRecorderContainer::GetInstance()
-            .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
-            ->Start(payload_type, PayloadDirection::OUTGOING_PAYLOAD);
-        while (should_continue && !shutdown_.Get()) {
-          should_continue =
-              SendPayloadLoop(client, *pending_payload, payload_header,
-                              next_chunk_offset, resume_offset);
-        }
-
-        RunOnStatusUpdateThread("destroy-payload",
-                                [this, payload_id]()
-                                    RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
-                                      DestroyPendingPayload(payload_id);
-                                    });
-      });
+  ScheduleOutgoingTransfer(executor, client, endpoint_ids, payload_id,
+                           payload_type, resume_offset, payload_total_size,
+                           std::nullopt);
   NEARBY_LOGS(INFO) << "PayloadManager: xfer scheduled: self=" << this
                     << "; payload_id=" << payload_id
                     << ", payload_type=" << ToString(payload_type);
 }
 
+void PayloadManager::ScheduleOutgoingTransfer(
+    SingleThreadExecutor* executor, ClientProxy* client,
+    const EndpointIds& endpoint_ids, Payload::Id payload_id,
+    PayloadType payload_type, size_t resume_offset,
+    std::int64_t payload_total_size, std::optional<ResumeOffset> resume) {
+  // A file the receiver got part of before is sent from where it stopped,
+  // once the receiver said where that is.
+  auto start_transfer = [this, executor, client, endpoint_ids, payload_id,
+                         payload_type, resume_offset, payload_total_size,
+                         resume]() -> std::shared_ptr<OutgoingTransfer> {
+    size_t offset = resume_offset;
+    if (resume.has_value()) {
+      offset = ConfirmResumeOffset(payload_id, *resume);
+    } else if (QueryResumeOffset(executor, client, endpoint_ids, payload_id,
+                                 payload_type, resume_offset,
+                                 payload_total_size)) {
+      return nullptr;
+    }
+    return StartOutgoingTransfer(client, endpoint_ids, payload_id,
+                                 payload_type, offset, payload_total_size);
+  };
+  if (payload_type == PayloadType::kFile && parallel_file_executor_) {
+    // Transfers to different endpoints run in parallel, and transfers to the
+    // same endpoint take turns sending a chunk each.
+    parallel_file_executor_->Execute(
+        endpoint_ids, "send-payload",
+        [this, endpoint_ids, start_transfer = std::move(start_transfer)]() {
+          std::shared_ptr<OutgoingTransfer> transfer = start_transfer();
+          if (transfer) {
+            SendNextOutgoingChunk(endpoint_ids, std::move(transfer));
+          }
+        });
+  } else {
+    executor->Execute(
+        "send-payload",
+        [this, start_transfer = std::move(start_transfer)]() {
+          std::shared_ptr<OutgoingTransfer> transfer = start_transfer();
+          if (!transfer) return;
+          bool should_continue = true;
+          while (should_continue && !shutdown_.Get()) {
+            should_continue = SendPayloadLoop(
+                transfer->client, *transfer->pending_payload,
+                transfer->payload_header, transfer->next_chunk_offset,
+                transfer->resume_offset, transfer->read_ahead.get());
+          }
+          FinishOutgoingTransfer(*transfer);
+        });
+  }
+}
+
+std::shared_ptr<PayloadManager::OutgoingTransfer>
+PayloadManager::StartOutgoingTransfer(ClientProxy* client,
+                                      const EndpointIds& endpoint_ids,
+                                      Payload::Id payload_id,
+                                      PayloadType payload_type,
+                                      size_t resume_offset,
+                                      std::int64_t payload_total_size) {
+  if (shutdown_.Get()) return nullptr;
+  PendingPayloadHandle pending_payload = GetPayload(payload_id);
+  if (!pending_payload) {
+    RecordInvalidPayloadAnalytics(client, endpoint_ids, payload_id,
+                                  payload_type, resume_offset,
+                                  payload_total_size);
+    NEARBY_LOGS(INFO)
+        << "PayloadManager failed to create InternalPayload for outgoing "
+           "payload_id="
+        << payload_id << ", payload_type=" << ToString(payload_type)
+        << ", aborting sendPayload().";
+    return nullptr;
+  }
+  auto* internal_payload = pending_payload->GetInternalPayload();
+  if (!internal_payload) return nullptr;
+
+  RecordPayloadStartedAnalytics(client, endpoint_ids, payload_id, payload_type,
+                                resume_offset,
+                                internal_payload->GetTotalSize());
+
+  auto transfer = std::make_shared<OutgoingTransfer>();
+  transfer->client = client;
+  transfer->payload_header =
+      CreatePayloadHeader(*internal_payload, resume_offset,
+                          internal_payload->GetParentFolder(),
+                          internal_payload->GetFileName());
+  transfer->resume_offset = resume_offset;
+
+  // Reading file chunks ahead lets the disk reads overlap with encrypting and
+  // writing the previous chunks.
+  std::int64_t read_ahead_chunks = NearbyFlags::GetInstance().GetInt64Flag(
+      config_package_nearby::nearby_connections_feature::
+          kPayloadReadAheadChunks);
+  if (payload_type == PayloadType::kFile && read_ahead_chunks > 0) {
+    transfer->read_ahead =
+        std::make_unique<ChunkReadAhead>(internal_payload, read_ahead_chunks);
+  }
+  transfer->pending_payload = std::move(pending_payload);
+
+  ThroughputRecorderContainer::GetInstance()
+      .GetTPRecorder(payload_id, PayloadDirection::OUTGOING_PAYLOAD)
+      ->Start(payload_type, PayloadDirection::OUTGOING_PAYLOAD);
+  return transfer;
+}
+
+void PayloadManager::SendNextOutgoingChunk(
+    const EndpointIds& endpoint_ids,
+    std::shared_ptr<OutgoingTransfer> transfer) {
+  bool should_continue =
+      !shutdown_.Get() &&
+      SendPayloadLoop(transfer->client, *transfer->pending_payload,
+                      transfer->payload_header, transfer->next_chunk_offset,
+                      transfer->resume_offset, transfer->read_ahead.get());
+  if (!should_continue) {
+    FinishOutgoingTransfer(*transfer);
+    return;
+  }
+  // Go to the back of the endpoints' queue, so other payloads to the same
+  // endpoints get their turn.
+  parallel_file_executor_->Execute(
+      endpoint_ids, "send-payload-chunk",
+      [this, endpoint_ids, transfer]() mutable {
+        SendNextOutgoingChunk(endpoint_ids, std::move(transfer));
+      });
+}
+
+void PayloadManager::FinishOutgoingTransfer(OutgoingTransfer& transfer) {
+  // Stop reading ahead before the payload is destroyed.
+  transfer.read_ahead.reset();
+
+  Payload::Id payload_id = transfer.pending_payload->GetId();
+  RunOnStatusUpdateThread("destroy-payload",
+                          [this, payload_id]()
+                              RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+                                DestroyPendingPayload(payload_id);
+                              });
+}
+
 PayloadManager::PendingPayloadHandle PayloadManager::GetPayload(
     Payload::Id payload_id) const {
   return pending_payloads_.GetPayload(payload_id);
@@ -546,57 +692,73 @@ void PayloadManager::OnEndpointDisconnect(ClientProxy* client,
       "payload-manager-on-disconnect",
       [this, client, endpoint_id,
        barrier, reason]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() mutable {
-        // Iterate through all our payloads and look for payloads associated
-        // with this endpoint.
-        MutexLock lock(&mutex_);
-        pending_payloads_.ForEachPayload([&](PendingPayload* pending_payload) {
-          auto endpoint_info = pending_payload->GetEndpoint(endpoint_id);
-          if (!endpoint_info) return;
-          std::int64_t endpoint_offset = endpoint_info->offset;
-          // Stop tracking the endpoint for this payload.
-          pending_payload->RemoveEndpoints({endpoint_id});
-          // |endpoint_info| is longer valid after calling
-          // RemoveEndpoints.
-          endpoint_info = nullptr;
-
-          std::int64_t payload_total_size =
-              pending_payload->GetInternalPayload()->GetTotalSize();
-
-          // If no endpoints are left for this payload, close it.
-          if (pending_payload->GetEndpoints().empty()) {
-            pending_payload->Close();
-          }
-          // Create the payload transfer update.
-          PayloadProgressInfo update{pending_payload->GetId(),
-                                     PayloadProgressInfo::Status::kFailure,
-                                     payload_total_size, endpoint_offset};
-
-          // Send a client notification of a payload transfer failure.
-          client->OnPayloadProgress(endpoint_id, update);
-
-              PayloadStatus payload_status;
-              switch (reason) {
-                case DisconnectionReason::LOCAL_DISCONNECTION:
-                  payload_status = PayloadStatus::LOCAL_CLIENT_DISCONNECTION;
-                  break;
-                case DisconnectionReason::REMOTE_DISCONNECTION:
-                  payload_status = PayloadStatus::REMOTE_CLIENT_DISCONNECTION;
-                  break;
-                case DisconnectionReason::IO_ERROR:
-                default:
-                  payload_status = PayloadStatus::ENDPOINT_IO_ERROR;
-                  break;
-              }
-
-
-          if (pending_payload->IsIncoming()) {
-            client->GetAnalyticsRecorder().OnIncomingPayloadDone(
-                endpoint_id, pending_payload->GetId(), payload_status);
-          } else {
-            client->GetAnalyticsRecorder().OnOutgoingPayloadDone(
-                endpoint_id, pending_payload->GetId(), payload_status);
-          }
-        });
+        // What was received of closed incoming files, saved once mutex_ is
+        // released.
+        std::vector<PartialFile> partial_files;
+        {
+          // Iterate through all our payloads and look for payloads associated
+          // with this endpoint.
+          MutexLock lock(&mutex_);
+          pending_payloads_.ForEachPayload(
+              [&](PendingPayload* pending_payload) {
+                auto endpoint_info = pending_payload->GetEndpoint(endpoint_id);
+                if (!endpoint_info) return;
+                std::int64_t endpoint_offset = endpoint_info->offset;
+                // Stop tracking the endpoint for this payload.
+                pending_payload->RemoveEndpoints({endpoint_id});
+                // |endpoint_info| is longer valid after calling
+                // RemoveEndpoints.
+                endpoint_info = nullptr;
+
+                std::int64_t payload_total_size =
+                    pending_payload->GetInternalPayload()->GetTotalSize();
+
+                // If no endpoints are left for this payload, close it.
+                if (pending_payload->GetEndpoints().empty()) {
+                  pending_payload->Close();
+                  if (partial_file_store_ && pending_payload->IsIncoming()) {
+                    std::optional<PartialFile> partial_file =
+                        ReleaseIncomingPartialFile(pending_payload->GetId());
+                    if (partial_file.has_value()) {
+                      partial_files.push_back(*std::move(partial_file));
+                    }
+                  }
+                }
+                // Create the payload transfer update.
+                PayloadProgressInfo update{
+                    pending_payload->GetId(),
+                    PayloadProgressInfo::Status::kFailure, payload_total_size,
+                    endpoint_offset};
+
+                // Send a client notification of a payload transfer failure.
+                client->OnPayloadProgress(endpoint_id, update);
+
+                PayloadStatus payload_status;
+                switch (reason) {
+                  case DisconnectionReason::LOCAL_DISCONNECTION:
+                    payload_status = PayloadStatus::LOCAL_CLIENT_DISCONNECTION;
+                    break;
+                  case DisconnectionReason::REMOTE_DISCONNECTION:
+                    payload_status = PayloadStatus::REMOTE_CLIENT_DISCONNECTION;
+                    break;
+                  case DisconnectionReason::IO_ERROR:
+                  default:
+                    payload_status = PayloadStatus::ENDPOINT_IO_ERROR;
+                    break;
+                }
+
+                if (pending_payload->IsIncoming()) {
+                  client->GetAnalyticsRecorder().OnIncomingPayloadDone(
+                      endpoint_id, pending_payload->GetId(), payload_status);
+                } else {
+                  client->GetAnalyticsRecorder().OnOutgoingPayloadDone(
+                      endpoint_id, pending_payload->GetId(), payload_status);
+                }
+              });
+        }
+        for (const PartialFile& partial_file : partial_files) {
+          partial_file_store_->Save(partial_file);
+        }
 
         barrier.CountDown();
       });
@@ -649,10 +811,12 @@ PayloadProgressInfo::Status PayloadManager::PayloadStatusToTransferUpdateStatus(
 }
 
 SingleThreadExecutor* PayloadManager::GetOutgoingPayloadExecutor(
-    PayloadType payload_type) {
+    PayloadType payload_type, PayloadPriority priority) {
   switch (payload_type) {
     case PayloadType::kBytes:
-      return &bytes_payload_executor_;
+      return priority == PayloadPriority::kHigh
+                 ? &high_priority_payload_executor_
+                 : &bytes_payload_executor_;
     case PayloadType::kFile:
       return &file_payload_executor_;
     case PayloadType::kStream:
@@ -663,10 +827,16 @@ SingleThreadExecutor* PayloadManager::GetOutgoingPayloadExecutor(
 }
 
 int PayloadManager::GetOptimalChunkSize(EndpointIds endpoint_ids) {
+  bool adaptive_chunk_size = NearbyFlags::GetInstance().GetBoolFlag(
+      config_package_nearby::nearby_connections_feature::
+          kEnableAdaptiveChunkSize);
   int minChunkSize = std::numeric_limits<int>::max();
   for (const auto& endpoint_id : endpoint_ids) {
     minChunkSize = std::min(
-        minChunkSize, endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id));
+        minChunkSize,
+        adaptive_chunk_size
+            ? endpoint_manager_->GetOptimalChunkSize(endpoint_id)
+            : endpoint_manager_->GetMaxTransmitPacketSize(endpoint_id));
   }
   return minChunkSize;
 }
@@ -694,14 +864,12 @@ PayloadTransferFrame::PayloadHeader PayloadManager::CreatePayloadHeader(
 }
 
 PayloadTransferFrame::PayloadChunk PayloadManager::CreatePayloadChunk(
-    std::int64_t payload_chunk_offset, ByteArray payload_chunk_body) {
+    std::int64_t payload_chunk_offset, size_t payload_chunk_body_size) {
   PayloadTransferFrame::PayloadChunk payload_chunk;
 
   payload_chunk.set_offset(payload_chunk_offset);
   payload_chunk.set_flags(0);
-  if (!payload_chunk_body.Empty()) {
-    payload_chunk.set_body(std::string(std::move(payload_chunk_body)));
-  } else {
+  if (payload_chunk_body_size == 0) {
     payload_chunk.set_flags(payload_chunk.flags() |
                             PayloadTransferFrame::PayloadChunk::LAST_CHUNK);
   }
@@ -711,13 +879,61 @@ PayloadTransferFrame::PayloadChunk PayloadManager::CreatePayloadChunk(
 
 PayloadManager::PendingPayloadHandle PayloadManager::CreateIncomingPayload(
     const PayloadTransferFrame& frame, const std::string& endpoint_id) {
-  auto internal_payload =
-      CreateIncomingInternalPayload(frame, custom_save_path_);
+  bool is_resumable = partial_file_store_ &&
+                      frame.payload_header().type() ==
+                          PayloadTransferFrame::PayloadHeader::FILE;
+  std::unique_ptr<InternalPayload> internal_payload;
+  IncomingPartialFile incoming_partial_file;
+  if (is_resumable) {
+    std::optional<PartialFile> offered;
+    {
+      MutexLock lock(&partial_files_mutex_);
+      auto it = offered_resumes_.find(frame.payload_header().id());
+      if (it != offered_resumes_.end()) {
+        offered = std::move(it->second);
+        offered_resumes_.erase(it);
+      }
+    }
+    // The sender took up the offer if it left out what we have.
+    if (offered.has_value() && frame.payload_header().total_size() ==
+                                   offered->total_size - offered->offset) {
+      // The sender confirmed the checksum of what we have before leaving it
+      // out.
+      internal_payload = CreateResumedIncomingInternalPayload(
+          frame, offered->file_path, offered->offset, offered->total_size);
+      if (!internal_payload) {
+        NEARBY_LOGS(WARNING)
+            << "CreateIncomingPayload: cannot resume payload_id="
+            << offered->payload_id;
+        partial_file_store_->Remove(offered->payload_id);
+        return PendingPayloadHandle();
+      }
+      incoming_partial_file = {*offered, offered->offset};
+    } else {
+      partial_file_store_->Remove(frame.payload_header().id());
+    }
+  }
+
   if (!internal_payload) {
-    return PendingPayloadHandle();
+    internal_payload = CreateIncomingInternalPayload(
+        frame, custom_save_path_, incoming_stream_writers_);
+    if (!internal_payload) {
+      return PendingPayloadHandle();
+    }
+    if (is_resumable) {
+      incoming_partial_file.partial_file.payload_id = internal_payload->GetId();
+      incoming_partial_file.partial_file.file_path =
+          internal_payload->GetFilePath();
+      incoming_partial_file.partial_file.total_size =
+          internal_payload->GetTotalSize();
+    }
   }
 
   Payload::Id payload_id = internal_payload->GetId();
+  if (!incoming_partial_file.partial_file.file_path.empty()) {
+    MutexLock lock(&partial_files_mutex_);
+    incoming_partial_files_[payload_id] = std::move(incoming_partial_file);
+  }
   NEARBY_LOGS(INFO) << "CreateIncomingPayload: payload_id=" << payload_id;
   pending_payloads_.StartTrackingPayload(
       payload_id,
@@ -975,6 +1191,7 @@ void PayloadManager::HandleFinishedIncomingPayload(
     const PayloadTransferFrame::PayloadHeader& payload_header,
     std::int64_t offset_bytes,
     location::nearby::proto::connections::PayloadStatus status) {
+  if (partial_file_store_) DropIncomingPartialFile(payload_header.id());
   SendClientCallbacksForFinishedIncomingPayload(
       client, endpoint_id, payload_header, offset_bytes, status);
 
@@ -1001,7 +1218,7 @@ void PayloadManager::HandleSuccessfulOutgoingChunk(
     ClientProxy* client, const std::string& endpoint_id,
     const PayloadTransferFrame::PayloadHeader& payload_header,
     std::int32_t payload_chunk_flags, std::int64_t payload_chunk_offset,
-    std::int64_t payload_chunk_body_size) {
+    std::int64_t payload_chunk_body_size, int chunk_size) {
   if (NearbyFlags::GetInstance().GetBoolFlag(
           config_package_nearby::nearby_connections_feature::
               kEnablePayloadManagerToSkipChunkUpdate)) {
@@ -1011,8 +1228,8 @@ void PayloadManager::HandleSuccessfulOutgoingChunk(
   RunOnStatusUpdateThread(
       "outgoing-chunk-success",
       [this, client, endpoint_id, payload_header, payload_chunk_flags,
-       payload_chunk_offset,
-       payload_chunk_body_size]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
+       payload_chunk_offset, payload_chunk_body_size,
+       chunk_size]() RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD() {
         // Make sure we're still tracking this payload and its associated
         // endpoint.
         bool is_last_chunk =
@@ -1032,7 +1249,8 @@ void PayloadManager::HandleSuccessfulOutgoingChunk(
               NEARBY_LOGS(INFO) << "Skip the outgoing chunk update with offset="
                                 << payload_chunk_offset;
               client->GetAnalyticsRecorder().OnPayloadChunkSent(
-                  endpoint_id, payload_header.id(), payload_chunk_body_size);
+                  endpoint_id, payload_header.id(), payload_chunk_body_size,
+                  chunk_size);
               return;
             }
           }
@@ -1072,7 +1290,8 @@ void PayloadManager::HandleSuccessfulOutgoingChunk(
           }
         } else {
           client->GetAnalyticsRecorder().OnPayloadChunkSent(
-              endpoint_id, payload_header.id(), payload_chunk_body_size);
+              endpoint_id, payload_header.id(), payload_chunk_body_size,
+              chunk_size);
         }
       });
 }
@@ -1239,11 +1458,23 @@ void PayloadManager::ProcessDataPacket(
   // report back to the client. For the sake of accuracy, we update the
   // pending payload here because it's after all payload terminating events
   // are handled, but right before we actually start attaching the next chunk.
-  pending_payload->SetOffsetForEndpoint(from_endpoint_id,
-                                        payload_chunk.offset());
+  // Offsets of a resumed transfer count from where it was resumed.
+  std::int64_t resumed_bytes =
+      partial_file_store_ ? GetResumedBytes(payload_id) : 0;
+  pending_payload->SetOffsetForEndpoint(
+      from_endpoint_id, resumed_bytes + payload_chunk.offset());
 
   // Save size of packet before we move it.
   std::int64_t payload_body_size = payload_chunk.body().size();
+  packet_meta_data.SetChunkSize(payload_body_size);
+  // What was received so far is checksummed as it arrives, so it can be
+  // confirmed by the sender when the transfer resumes without reading it back.
+  std::uint32_t chunk_checksum = kInitialAdler32;
+  if (partial_file_store_ &&
+      payload_header.type() == PayloadTransferFrame::PayloadHeader::FILE &&
+      resumed_bytes + payload_header.total_size() >= kMinResumableFileSize) {
+    chunk_checksum = UpdateAdler32(kInitialAdler32, payload_chunk.body());
+  }
 
   packet_meta_data.StartFileIo();
   if (pending_payload->GetInternalPayload()
@@ -1260,13 +1491,27 @@ void PayloadManager::ProcessDataPacket(
   packet_meta_data.StopFileIo();
   bool is_last_chunk = (payload_chunk.flags() &
                         PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0;
+  if (partial_file_store_) {
+    UpdateIncomingPartialFile(payload_id, payload_body_size, chunk_checksum,
+                              is_last_chunk);
+  }
   SendPayloadReceivedAck(
       to_client, *pending_payload, from_endpoint_id, payload_header,
       payload_chunk.offset() + payload_body_size, is_last_chunk);
 
-  HandleSuccessfulIncomingChunk(to_client, from_endpoint_id, payload_header,
-                                payload_chunk.flags(), payload_chunk.offset(),
-                                payload_body_size);
+  if (resumed_bytes > 0) {
+    // The client sees the progress of the whole payload.
+    PayloadTransferFrame::PayloadHeader resumed_header = payload_header;
+    resumed_header.set_total_size(resumed_bytes + payload_header.total_size());
+    HandleSuccessfulIncomingChunk(to_client, from_endpoint_id, resumed_header,
+                                  payload_chunk.flags(),
+                                  resumed_bytes + payload_chunk.offset(),
+                                  payload_body_size);
+  } else {
+    HandleSuccessfulIncomingChunk(to_client, from_endpoint_id, payload_header,
+                                  payload_chunk.flags(), payload_chunk.offset(),
+                                  payload_body_size);
+  }
 
   ThroughputRecorderContainer::GetInstance()
       .GetTPRecorder(payload_header.id(), PayloadDirection::INCOMING_PAYLOAD)
@@ -1286,6 +1531,19 @@ void PayloadManager::ProcessControlPacket(
       payload_transfer_frame.payload_header();
   const PayloadTransferFrame::ControlMessage& control_message =
       payload_transfer_frame.control_message();
+  // These come before the transfer, so there may be no payload yet.
+  if (control_message.event() ==
+      PayloadTransferFrame::ControlMessage::PAYLOAD_RESUME_QUERY) {
+    ProcessResumeQuery(from_endpoint_id, payload_header);
+    return;
+  }
+  if (control_message.event() ==
+      PayloadTransferFrame::ControlMessage::PAYLOAD_RESUME_OFFSET) {
+    ProcessResumeOffset(payload_header.id(),
+                        ResumeOffset{control_message.offset(),
+                                     control_message.checksum()});
+    return;
+  }
   PendingPayloadHandle pending_payload = GetPayload(payload_header.id());
   if (!pending_payload) {
     NEARBY_LOGS(INFO) << "Got ControlMessage for unknown payload_id="
@@ -1349,6 +1607,162 @@ void PayloadManager::ProcessControlPacket(
   }
 }
 
+bool PayloadManager::QueryResumeOffset(
+    SingleThreadExecutor* executor, ClientProxy* client,
+    const EndpointIds& endpoint_ids, Payload::Id payload_id,
+    PayloadType payload_type, size_t resume_offset,
+    std::int64_t payload_total_size) {
+  // Not if the client asked for an offset itself. Only receivers that said
+  // they have resuming enabled when the connection was set up are asked, and
+  // only about files large enough for them to keep.
+  if (!partial_file_store_ || shutdown_.Get() ||
+      payload_type != PayloadType::kFile || resume_offset != 0 ||
+      endpoint_ids.size() != 1 || payload_total_size < kMinResumableFileSize ||
+      !client->IsResumableFileTransferEnabled(endpoint_ids.front())) {
+    return false;
+  }
+  PendingPayloadHandle pending_payload = GetPayload(payload_id);
+  if (!pending_payload || !pending_payload->GetInternalPayload()) return false;
+  InternalPayload& internal_payload = *pending_payload->GetInternalPayload();
+  PayloadTransferFrame::PayloadHeader payload_header =
+      CreatePayloadHeader(internal_payload, 0,
+                          internal_payload.GetParentFolder(),
+                          internal_payload.GetFileName());
+
+  {
+    MutexLock lock(&partial_files_mutex_);
+    ResumeQuery& query = resume_queries_[payload_id];
+    query.on_answer = [this, executor, client, endpoint_ids, payload_id,
+                       payload_type, payload_total_size](
+                          const ResumeOffset& resume) {
+      ScheduleOutgoingTransfer(executor, client, endpoint_ids, payload_id,
+                               payload_type, 0, payload_total_size, resume);
+    };
+    // Receivers that lost the query are not waited for forever.
+    query.timeout_alarm = std::make_unique<CancelableAlarm>(
+        "PayloadManager.resume_query_timeout",
+        [this, payload_id]() { ProcessResumeOffset(payload_id, {}); },
+        kResumeQueryTimeout, alarm_executor_.get());
+  }
+  SendControlMessage(
+      endpoint_ids, payload_header, 0,
+      PayloadTransferFrame::ControlMessage::PAYLOAD_RESUME_QUERY);
+  return true;
+}
+
+size_t PayloadManager::ConfirmResumeOffset(Payload::Id payload_id,
+                                           const ResumeOffset& resume) {
+  if (resume.offset <= 0) return 0;
+  PendingPayloadHandle pending_payload = GetPayload(payload_id);
+  if (!pending_payload || !pending_payload->GetInternalPayload()) return 0;
+  InternalPayload& internal_payload = *pending_payload->GetInternalPayload();
+  if (resume.offset > internal_payload.GetTotalSize()) return 0;
+  // The bytes the receiver has must be the ones we'd send.
+  std::optional<std::uint32_t> checksum =
+      ComputeFileChecksum(internal_payload.GetFilePath(), resume.offset);
+  if (!checksum.has_value() || *checksum != resume.checksum) {
+    NEARBY_LOGS(WARNING) << "PayloadManager not resuming payload_id="
+                         << payload_id << ": checksum of the first "
+                         << resume.offset << " bytes doesn't match";
+    return 0;
+  }
+  NEARBY_LOGS(INFO) << "PayloadManager resuming payload_id=" << payload_id
+                    << " at offset " << resume.offset;
+  return resume.offset;
+}
+
+// @EndpointManagerDataPool
+void PayloadManager::ProcessResumeQuery(
+    const std::string& from_endpoint_id,
+    const PayloadTransferFrame::PayloadHeader& payload_header) {
+  PayloadTransferFrame::ControlMessage control_message;
+  control_message.set_event(
+      PayloadTransferFrame::ControlMessage::PAYLOAD_RESUME_OFFSET);
+  control_message.set_offset(0);
+  if (partial_file_store_ &&
+      payload_header.type() == PayloadTransferFrame::PayloadHeader::FILE) {
+    std::optional<PartialFile> partial_file =
+        partial_file_store_->Load(payload_header.id());
+    if (partial_file.has_value() &&
+        partial_file->total_size == payload_header.total_size() &&
+        partial_file->offset > 0) {
+      control_message.set_offset(partial_file->offset);
+      control_message.set_checksum(partial_file->checksum);
+      MutexLock lock(&partial_files_mutex_);
+      offered_resumes_[payload_header.id()] = *std::move(partial_file);
+    }
+  }
+  NEARBY_LOGS(INFO) << "PayloadManager offering to resume payload_id="
+                    << payload_header.id() << " at offset "
+                    << control_message.offset()
+                    << " to endpoint_id=" << from_endpoint_id;
+  endpoint_manager_->SendControlMessage(payload_header, control_message,
+                                        {from_endpoint_id});
+}
+
+// @EndpointManagerDataPool
+void PayloadManager::ProcessResumeOffset(Payload::Id payload_id,
+                                         const ResumeOffset& resume) {
+  ResumeQuery query;
+  {
+    MutexLock lock(&partial_files_mutex_);
+    auto it = resume_queries_.find(payload_id);
+    // Already answered, or timed out.
+    if (it == resume_queries_.end()) return;
+    query = std::move(it->second);
+    resume_queries_.erase(it);
+  }
+  query.timeout_alarm->Cancel();
+  query.on_answer(resume);
+}
+
+std::int64_t PayloadManager::GetResumedBytes(Payload::Id payload_id) const {
+  MutexLock lock(&partial_files_mutex_);
+  auto it = incoming_partial_files_.find(payload_id);
+  return it != incoming_partial_files_.end() ? it->second.resumed_bytes : 0;
+}
+
+void PayloadManager::UpdateIncomingPartialFile(Payload::Id payload_id,
+                                               std::int64_t chunk_size,
+                                               std::uint32_t chunk_checksum,
+                                               bool is_last_chunk) {
+  if (is_last_chunk) {
+    DropIncomingPartialFile(payload_id);
+    return;
+  }
+  MutexLock lock(&partial_files_mutex_);
+  auto it = incoming_partial_files_.find(payload_id);
+  if (it == incoming_partial_files_.end()) return;
+  PartialFile& partial_file = it->second.partial_file;
+  partial_file.checksum =
+      CombineAdler32(partial_file.checksum, chunk_checksum, chunk_size);
+  partial_file.offset += chunk_size;
+}
+
+std::optional<PartialFile> PayloadManager::ReleaseIncomingPartialFile(
+    Payload::Id payload_id) {
+  MutexLock lock(&partial_files_mutex_);
+  auto it = incoming_partial_files_.find(payload_id);
+  if (it == incoming_partial_files_.end()) return std::nullopt;
+  PartialFile partial_file = std::move(it->second.partial_file);
+  incoming_partial_files_.erase(it);
+  // Senders don't ask about smaller files.
+  if (partial_file.offset <= 0 ||
+      partial_file.total_size < kMinResumableFileSize) {
+    return std::nullopt;
+  }
+  return partial_file;
+}
+
+void PayloadManager::DropIncomingPartialFile(Payload::Id payload_id) {
+  bool was_tracked;
+  {
+    MutexLock lock(&partial_files_mutex_);
+    was_tracked = incoming_partial_files_.erase(payload_id) > 0;
+  }
+  if (was_tracked) partial_file_store_->Remove(payload_id);
+}
+
 // @PayloadManagerStatusUpdateThread
 void PayloadManager::NotifyClientOfIncomingPayloadProgressInfo(
     ClientProxy* client, const std::string& endpoint_id,
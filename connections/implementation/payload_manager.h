@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -26,18 +27,25 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
 #include "connections/implementation/analytics/packet_meta_data.h"
+#include "connections/implementation/chunk_read_ahead.h"
 #include "connections/implementation/client_proxy.h"
 #include "connections/implementation/endpoint_manager.h"
 #include "connections/implementation/internal_payload.h"
+#include "connections/implementation/internal_payload_factory.h"
+#include "connections/implementation/keyed_serial_executor.h"
+#include "connections/implementation/partial_file_store.h"
+#include "connections/implementation/payload_frame_scheduler.h"
 #include "connections/listeners.h"
 #include "connections/payload.h"
 #include "connections/status.h"
 #include "internal/platform/atomic_boolean.h"
 #include "internal/platform/atomic_reference.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/cancelable_alarm.h"
 #include "internal/platform/condition_variable.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/mutex.h"
+#include "internal/platform/scheduled_executor.h"
 
 namespace nearby {
 namespace connections {
@@ -53,6 +61,23 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   using EndpointIds = std::vector<std::string>;
   constexpr static const absl::Duration kWaitCloseTimeout =
       absl::Milliseconds(5000);
+  // Threads kept between chunks for sending file payloads when
+  // kEnableParallelFilePayloads is on. More are started while chunks to
+  // different endpoints are being sent, one per endpoint at most.
+  constexpr static int kMaxIdleFilePayloadThreads = 4;
+  // Longest time a chunk of a normal payload waits for high-priority frames
+  // to the same endpoints to go out first.
+  constexpr static const absl::Duration kMaxHighPriorityFrameDelay =
+      absl::Milliseconds(100);
+  // Longest time a file payload waits for the receiver to say how much of it
+  // it already has, with kEnableResumableFileTransfers. No thread waits for
+  // the answer. Only receivers that have resuming enabled are asked, so this
+  // only runs out if the answer is lost.
+  constexpr static const absl::Duration kResumeQueryTimeout =
+      absl::Seconds(2);
+  // Smallest file payload that is kept for resuming, and that senders ask
+  // about. Resending smaller files costs less than the round trip.
+  constexpr static const std::int64_t kMinResumableFileSize = 1024 * 1024;
 
   explicit PayloadManager(EndpointManager& endpoint_manager);
   ~PayloadManager() override;
@@ -268,9 +293,34 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   // Returns list of endpoint ids.
   static EndpointIds EndpointsToEndpointIds(const Endpoints& endpoints);
 
+  // State of an outgoing payload while it is being sent.
+  struct OutgoingTransfer {
+    ClientProxy* client = nullptr;
+    PendingPayloadHandle pending_payload;
+    PayloadTransferFrame::PayloadHeader payload_header;
+    std::int64_t next_chunk_offset = 0;
+    size_t resume_offset = 0;
+    std::unique_ptr<ChunkReadAhead> read_ahead;
+  };
+
+  // Looks up the payload and records the start of its transfer. Returns null
+  // if the payload can not be sent.
+  std::shared_ptr<OutgoingTransfer> StartOutgoingTransfer(
+      ClientProxy* client, const EndpointIds& endpoint_ids,
+      Payload::Id payload_id, PayloadType payload_type, size_t resume_offset,
+      std::int64_t payload_total_size);
+  // Sends one chunk of `transfer` on parallel_file_executor_, then queues the
+  // next one behind the other tasks for `endpoint_ids`.
+  void SendNextOutgoingChunk(const EndpointIds& endpoint_ids,
+                             std::shared_ptr<OutgoingTransfer> transfer);
+  void FinishOutgoingTransfer(OutgoingTransfer& transfer);
+
+  // Sends the next chunk of `pending_payload`. Chunks are taken from
+  // `read_ahead` if it is not null, or read directly from the payload.
   bool SendPayloadLoop(ClientProxy* client, PendingPayload& pending_payload,
                        PayloadTransferFrame::PayloadHeader& payload_header,
-                       std::int64_t& next_chunk_offset, size_t resume_offset);
+                       std::int64_t& next_chunk_offset, size_t resume_offset,
+                       ChunkReadAhead* read_ahead);
   void SendClientCallbacksForFinishedIncomingPayloadRunnable(
       ClientProxy* client, const std::string& endpoint_id,
       const PayloadTransferFrame::PayloadHeader& payload_header,
@@ -297,8 +347,9 @@ class PayloadManager : public EndpointManager::FrameProcessor {
       const InternalPayload& internal_payload, size_t offset,
       const std::string& parent_folder, const std::string& file_name);
 
+  // Creates the chunk without its body, which is sent alongside it.
   PayloadTransferFrame::PayloadChunk CreatePayloadChunk(std::int64_t offset,
-                                                        ByteArray body);
+                                                        size_t body_size);
   bool IsLastChunk(PayloadTransferFrame::PayloadChunk payload_chunk) {
     return ((payload_chunk.flags() &
              PayloadTransferFrame::PayloadChunk::LAST_CHUNK) != 0);
@@ -362,7 +413,7 @@ class PayloadManager : public EndpointManager::FrameProcessor {
       ClientProxy* client, const std::string& endpoint_id,
       const PayloadTransferFrame::PayloadHeader& payload_header,
       std::int32_t payload_chunk_flags, std::int64_t payload_chunk_offset,
-      std::int64_t payload_chunk_body_size);
+      std::int64_t payload_chunk_body_size, int chunk_size);
   void HandleSuccessfulIncomingChunk(
       ClientProxy* client, const std::string& endpoint_id,
       const PayloadTransferFrame::PayloadHeader& payload_header,
@@ -378,12 +429,69 @@ class PayloadManager : public EndpointManager::FrameProcessor {
                             const std::string& from_endpoint_id,
                             PayloadTransferFrame& payload_transfer_frame);
 
+  // The receiver's answer to a PAYLOAD_RESUME_QUERY.
+  struct ResumeOffset {
+    std::int64_t offset = 0;
+    // Of the first `offset` bytes.
+    std::uint32_t checksum = kInitialAdler32;
+  };
+  // Sends `payload_id` on `executor`, or on parallel_file_executor_. Unless
+  // `resume` holds the receiver's answer, a file the receiver may have part of
+  // is not sent yet, but asked about first.
+  void ScheduleOutgoingTransfer(SingleThreadExecutor* executor,
+                                ClientProxy* client,
+                                const EndpointIds& endpoint_ids,
+                                Payload::Id payload_id,
+                                PayloadType payload_type, size_t resume_offset,
+                                std::int64_t payload_total_size,
+                                std::optional<ResumeOffset> resume);
+  // Asks the receiver of `payload_id` how much of it it already has from an
+  // earlier transfer, if it may have some, and returns true if it did. The
+  // transfer is scheduled again once the receiver answers, or after
+  // kResumeQueryTimeout.
+  bool QueryResumeOffset(SingleThreadExecutor* executor, ClientProxy* client,
+                         const EndpointIds& endpoint_ids,
+                         Payload::Id payload_id, PayloadType payload_type,
+                         size_t resume_offset, std::int64_t payload_total_size)
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+  // Returns `resume.offset` if the first that many bytes of outgoing
+  // `payload_id` have `resume.checksum`, or 0. Reads those bytes.
+  size_t ConfirmResumeOffset(Payload::Id payload_id,
+                             const ResumeOffset& resume);
+  // Answers a PAYLOAD_RESUME_QUERY, and offers the partial file the answer is
+  // based on to the transfer that follows.
+  void ProcessResumeQuery(
+      const std::string& from_endpoint_id,
+      const PayloadTransferFrame::PayloadHeader& payload_header)
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+  void ProcessResumeOffset(Payload::Id payload_id, const ResumeOffset& resume)
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+  // Returns how many bytes of incoming `payload_id` were received before its
+  // transfer was resumed.
+  std::int64_t GetResumedBytes(Payload::Id payload_id) const
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+  // Adds a chunk of `chunk_size` bytes with `chunk_checksum` to what was
+  // received of incoming `payload_id`.
+  void UpdateIncomingPartialFile(Payload::Id payload_id,
+                                 std::int64_t chunk_size,
+                                 std::uint32_t chunk_checksum,
+                                 bool is_last_chunk)
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+  // Stops tracking incoming `payload_id`, and returns what was received of it
+  // if a later transfer may resume it. The caller saves it to
+  // partial_file_store_.
+  std::optional<PartialFile> ReleaseIncomingPartialFile(Payload::Id payload_id)
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+  void DropIncomingPartialFile(Payload::Id payload_id)
+      ABSL_LOCKS_EXCLUDED(partial_files_mutex_);
+
   void NotifyClientOfIncomingPayloadProgressInfo(
       ClientProxy* client, const std::string& endpoint_id,
       const PayloadProgressInfo& payload_transfer_update)
       RUN_ON_PAYLOAD_STATUS_UPDATE_THREAD();
 
-  SingleThreadExecutor* GetOutgoingPayloadExecutor(PayloadType payload_type);
+  SingleThreadExecutor* GetOutgoingPayloadExecutor(PayloadType payload_type,
+                                                   PayloadPriority priority);
 
   void RunOnStatusUpdateThread(const std::string& name,
                                absl::AnyInvocable<void()> runnable);
@@ -417,9 +525,23 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   std::unique_ptr<CountDownLatch> shutdown_barrier_;
   int send_payload_count_ = 0;
   SingleThreadExecutor bytes_payload_executor_;
+  // Sends high-priority bytes payloads, so they don't queue up behind normal
+  // ones.
+  SingleThreadExecutor high_priority_payload_executor_;
   SingleThreadExecutor file_payload_executor_;
   SingleThreadExecutor stream_payload_executor_;
   SingleThreadExecutor payload_status_update_executor_;
+  // Sends file payloads to different endpoints in parallel, keyed by endpoint
+  // ID: a payload sent to several endpoints takes its turn on each of them, so
+  // each endpoint has at most one chunk in flight. Each chunk has a thread of
+  // its own, so one blocked on a slow write or on a payload ack doesn't hold
+  // up other endpoints. Only created when kEnableParallelFilePayloads is on;
+  // file_payload_executor_ is used otherwise.
+  std::unique_ptr<KeyedSerialExecutor> parallel_file_executor_;
+  // Writes incoming stream payloads when kIncomingStreamBufferBytes bounds
+  // them.
+  IncomingStreamWriters incoming_stream_writers_;
+  PayloadFrameScheduler frame_scheduler_;
   PendingPayloads pending_payloads_;
   EndpointManager* endpoint_manager_;
 
@@ -430,6 +552,31 @@ class PayloadManager : public EndpointManager::FrameProcessor {
   mutable Mutex chunk_update_mutex_;
   int outgoing_chunk_update_count_ ABSL_GUARDED_BY(chunk_update_mutex_) = 0;
   int incoming_chunk_update_count_ ABSL_GUARDED_BY(chunk_update_mutex_) = 0;
+
+  // A PAYLOAD_RESUME_QUERY waiting for its answer.
+  struct ResumeQuery {
+    // Schedules the transfer with the answer.
+    absl::AnyInvocable<void(const ResumeOffset&)> on_answer;
+    std::unique_ptr<CancelableAlarm> timeout_alarm;
+  };
+  // An incoming file payload, and how many of its bytes came from an earlier
+  // transfer.
+  struct IncomingPartialFile {
+    PartialFile partial_file;
+    std::int64_t resumed_bytes = 0;
+  };
+  // Only created when kEnableResumableFileTransfers is on.
+  std::unique_ptr<PartialFileStore> partial_file_store_;
+  // Times out PAYLOAD_RESUME_QUERYs. Created with partial_file_store_.
+  std::unique_ptr<ScheduledExecutor> alarm_executor_;
+  // Separate from mutex_, which is held while endpoints disconnect.
+  mutable Mutex partial_files_mutex_;
+  absl::flat_hash_map<Payload::Id, ResumeQuery> resume_queries_
+      ABSL_GUARDED_BY(partial_files_mutex_);
+  absl::flat_hash_map<Payload::Id, PartialFile> offered_resumes_
+      ABSL_GUARDED_BY(partial_files_mutex_);
+  absl::flat_hash_map<Payload::Id, IncomingPartialFile> incoming_partial_files_
+      ABSL_GUARDED_BY(partial_files_mutex_);
 };
 
 }  // namespace connections
@@ -15,19 +15,27 @@
 #include "connections/implementation/payload_manager.h"
 
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <utility>
 
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "connections/implementation/flags/nearby_connections_feature_flags.h"
+#include "connections/implementation/partial_file_store.h"
 #include "connections/implementation/simulation_user.h"
 #include "connections/listeners.h"
 #include "connections/medium_selector.h"
 #include "connections/payload.h"
 #include "connections/status.h"
+#include "internal/flags/nearby_flags.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/count_down_latch.h"
+#include "internal/platform/file.h"
 #include "internal/platform/logging.h"
 #include "internal/platform/medium_environment.h"
 #include "internal/platform/pipe.h"
@@ -369,8 +377,208 @@ TEST_P(PayloadManagerTest, SendPayloadWithSkip_StreamPayload) {
   env_.Stop();
 }
 
+// Turns on resumable file transfers on both sides, and removes what a test
+// leaves behind even if it fails part way.
+class PayloadManagerResumeTest : public PayloadManagerTest {
+ protected:
+  static constexpr Payload::Id kPayloadId = 1234567;
+
+  void SetUp() override {
+    NearbyFlags::GetInstance().OverrideBoolFlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kEnableResumableFileTransfers,
+        true);
+    NearbyFlags::GetInstance().OverrideInt64FlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kSafeToDisconnectVersion,
+        6);
+  }
+
+  void TearDown() override {
+    NearbyFlags::GetInstance().ResetOverridedValues();
+    PartialFileStore(PartialFileStore::GetDefaultDirectory())
+        .Remove(kPayloadId);
+    std::filesystem::remove(source_path_);
+    std::filesystem::remove(received_path_);
+  }
+
+  const std::filesystem::path temp_dir_ =
+      std::filesystem::temp_directory_path();
+  const std::string source_path_ = (temp_dir_ / "resumed_file_source").string();
+  // Where the receiver saves "resumed_file" on this platform.
+  const std::string received_path_ = (temp_dir_ / "resumed_file").string();
+};
+
+TEST_P(PayloadManagerResumeTest, ResumesFilePayloadReceivedInPart) {
+  constexpr std::int64_t kFileSize =
+      PayloadManager::kMinResumableFileSize + 3 * kChunkSize;
+  constexpr std::int64_t kReceivedSize = kFileSize / 2 + 100;
+  std::string contents;
+  for (std::int64_t i = 0; i < kFileSize; ++i) contents.push_back('a' + i % 26);
+  std::ofstream(source_path_, std::ios::binary) << contents;
+  // What the receiver kept differs from the source, so the received file shows
+  // which bytes were sent again. Its record says it got the source's bytes.
+  std::string kept(kReceivedSize, 'x');
+  std::ofstream(received_path_, std::ios::binary) << kept;
+  PartialFile partial_file;
+  partial_file.payload_id = kPayloadId;
+  partial_file.file_path = received_path_;
+  partial_file.total_size = kFileSize;
+  partial_file.offset = kReceivedSize;
+  partial_file.checksum = UpdateAdler32(
+      kInitialAdler32, absl::string_view(contents).substr(0, kReceivedSize));
+  PartialFileStore(PartialFileStore::GetDefaultDirectory()).Save(partial_file);
+
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  user_a.ExpectPayload(payload_latch_);
+  user_b.SendPayload(Payload(kPayloadId, "", "resumed_file",
+                             InputFile(source_path_, kFileSize)));
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [&](const PayloadProgressInfo& info) {
+        return info.status == PayloadProgressInfo::Status::kSuccess &&
+               info.total_bytes == kFileSize &&
+               info.bytes_transferred == kFileSize;
+      },
+      absl::Seconds(5)));
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+
+  std::ifstream received(received_path_, std::ios::binary);
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(received), {}),
+            kept + contents.substr(kReceivedSize));
+}
+
+TEST_P(PayloadManagerResumeTest, SendsWholeFileIfChecksumDiffers) {
+  constexpr std::int64_t kFileSize =
+      PayloadManager::kMinResumableFileSize + 3 * kChunkSize;
+  constexpr std::int64_t kReceivedSize = kFileSize / 2 + 100;
+  std::string contents;
+  for (std::int64_t i = 0; i < kFileSize; ++i) contents.push_back('a' + i % 26);
+  std::ofstream(source_path_, std::ios::binary) << contents;
+  // The receiver's record is of some other file with the same payload id.
+  PartialFile partial_file;
+  partial_file.payload_id = kPayloadId;
+  partial_file.file_path = (temp_dir_ / "other_resumed_file").string();
+  partial_file.total_size = kFileSize;
+  partial_file.offset = kReceivedSize;
+  partial_file.checksum =
+      UpdateAdler32(kInitialAdler32, std::string(kReceivedSize, 'x'));
+  PartialFileStore(PartialFileStore::GetDefaultDirectory()).Save(partial_file);
+
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  user_a.ExpectPayload(payload_latch_);
+  user_b.SendPayload(Payload(kPayloadId, "", "resumed_file",
+                             InputFile(source_path_, kFileSize)));
+  ASSERT_TRUE(payload_latch_.Await(kDefaultTimeout).result());
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [&](const PayloadProgressInfo& info) {
+        return info.status == PayloadProgressInfo::Status::kSuccess &&
+               info.bytes_transferred == kFileSize;
+      },
+      absl::Seconds(5)));
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+
+  std::ifstream received(received_path_, std::ios::binary);
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(received), {}),
+            contents);
+}
+
+// Turns on parallel file payloads on both sides, and removes what a test leaves
+// behind even if it fails part way.
+class PayloadManagerParallelFileTest : public PayloadManagerTest {
+ protected:
+  void SetUp() override {
+    NearbyFlags::GetInstance().OverrideBoolFlagValue(
+        config_package_nearby::nearby_connections_feature::
+            kEnableParallelFilePayloads,
+        true);
+  }
+
+  void TearDown() override {
+    NearbyFlags::GetInstance().ResetOverridedValues();
+    for (const std::string& name : {"parallel_file_1", "parallel_file_2"}) {
+      std::filesystem::remove(temp_dir_ / (name + "_source"));
+      std::filesystem::remove(temp_dir_ / name);
+    }
+  }
+
+  // Writes a file of `size` bytes to send as `name`, and returns its contents.
+  std::string WriteSourceFile(const std::string& name, std::int64_t size,
+                              char first) {
+    std::string contents;
+    for (std::int64_t i = 0; i < size; ++i) contents.push_back(first + i % 26);
+    std::ofstream(temp_dir_ / (name + "_source"), std::ios::binary) << contents;
+    return contents;
+  }
+
+  // Returns what the receiver saved as `name` on this platform.
+  std::string ReadReceivedFile(const std::string& name) {
+    std::ifstream received(temp_dir_ / name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(received), {});
+  }
+
+  const std::filesystem::path temp_dir_ =
+      std::filesystem::temp_directory_path();
+};
+
+TEST_P(PayloadManagerParallelFileTest, FilePayloadsToSameEndpointTakeTurns) {
+  // The first file is shorter, so taking turns sending a chunk each finishes it
+  // first.
+  constexpr std::int64_t kFirstFileSize = 2 * kChunkSize + 100;
+  constexpr std::int64_t kSecondFileSize = 4 * kChunkSize + 200;
+  std::string first_contents =
+      WriteSourceFile("parallel_file_1", kFirstFileSize, 'a');
+  std::string second_contents =
+      WriteSourceFile("parallel_file_2", kSecondFileSize, 'A');
+  CountDownLatch payloads_latch(2);
+
+  env_.Start();
+  PayloadSimulationUser user_a(kDeviceA, GetParam());
+  PayloadSimulationUser user_b(kDeviceB, GetParam());
+  ASSERT_TRUE(SetupConnection(user_a, user_b));
+  user_a.ExpectPayload(payloads_latch);
+  user_b.SendPayload(Payload(
+      1001, "", "parallel_file_1",
+      InputFile((temp_dir_ / "parallel_file_1_source").string(),
+                kFirstFileSize)));
+  user_b.SendPayload(Payload(
+      1002, "", "parallel_file_2",
+      InputFile((temp_dir_ / "parallel_file_2_source").string(),
+                kSecondFileSize)));
+  ASSERT_TRUE(payloads_latch.Await(kDefaultTimeout).result());
+  EXPECT_TRUE(user_a.WaitForProgress(
+      [&](const PayloadProgressInfo& info) {
+        return info.payload_id == 1002 &&
+               info.status == PayloadProgressInfo::Status::kSuccess &&
+               info.bytes_transferred == kSecondFileSize;
+      },
+      absl::Seconds(5)));
+  user_a.Stop();
+  user_b.Stop();
+  env_.Stop();
+
+  EXPECT_EQ(ReadReceivedFile("parallel_file_1"), first_contents);
+  EXPECT_EQ(ReadReceivedFile("parallel_file_2"), second_contents);
+}
+
 INSTANTIATE_TEST_SUITE_P(ParametrisedPayloadManagerTest, PayloadManagerTest,
                          ::testing::ValuesIn(kTestCases));
+INSTANTIATE_TEST_SUITE_P(ParametrisedPayloadManagerResumeTest,
+                         PayloadManagerResumeTest,
+                         ::testing::ValuesIn(kTestCases));
+INSTANTIATE_TEST_SUITE_P(ParametrisedPayloadManagerParallelFileTest,
+                         PayloadManagerParallelFileTest,
+                         ::testing::ValuesIn(kTestCases));
 
 }  // namespace
 }  // namespace connections
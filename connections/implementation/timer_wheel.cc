@@ -0,0 +1,152 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/timer_wheel.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
+
+namespace nearby {
+namespace connections {
+
+TimerWheel::TimerWheel(absl::Duration tick, int slot_count,
+                       int max_idle_callback_threads)
+    : tick_(tick),
+      start_time_(SystemClock::ElapsedRealtime()),
+      slots_(slot_count),
+      callback_threads_(max_idle_callback_threads) {
+  tick_thread_.Execute("timer-wheel", [this]() { RunTicks(); });
+}
+
+TimerWheel::~TimerWheel() { Shutdown(); }
+
+void TimerWheel::Schedule(const std::string& key, absl::Duration delay,
+                          Callback callback) {
+  MutexLock lock(&mutex_);
+  if (shutdown_) return;
+  Timer& timer = timers_[key];
+  timer = Timer();
+  timer.id = next_id_++;
+  timer.callback = std::move(callback);
+  AddToWheelLocked(key, timer, delay);
+}
+
+void TimerWheel::Cancel(const std::string& key) {
+  MutexLock lock(&mutex_);
+  auto it = timers_.find(key);
+  if (it == timers_.end()) return;
+  std::uint64_t id = it->second.id;
+  it->second.canceled = true;
+  while (it != timers_.end() && it->second.id == id && it->second.running) {
+    changed_.Wait();
+    it = timers_.find(key);
+  }
+  if (it != timers_.end() && it->second.id == id) timers_.erase(it);
+}
+
+void TimerWheel::Shutdown() {
+  {
+    MutexLock lock(&mutex_);
+    if (shutdown_) return;
+    shutdown_ = true;
+    for (auto& [key, timer] : timers_) timer.canceled = true;
+    changed_.Notify();
+  }
+  tick_thread_.Shutdown();
+  callback_threads_.Shutdown();
+
+  MutexLock lock(&mutex_);
+  timers_.clear();
+  for (auto& slot : slots_) slot.clear();
+}
+
+void TimerWheel::AddToWheelLocked(const std::string& key, Timer& timer,
+                                  absl::Duration delay) {
+  std::int64_t slot_count = slots_.size();
+  std::int64_t ticks = std::max<std::int64_t>(delay / tick_, 0);
+  timer.rounds = ticks / slot_count;
+  slots_[(current_tick_ + ticks) % slot_count].emplace_back(key, timer.id);
+}
+
+void TimerWheel::RunTicks() {
+  MutexLock lock(&mutex_);
+  while (!shutdown_) {
+    // Catch up on every tick that passed, in case the thread was held up.
+    std::int64_t due_tick =
+        (SystemClock::ElapsedRealtime() - start_time_) / tick_;
+    while (current_tick_ < due_tick) {
+      ProcessSlotLocked(current_tick_);
+      ++current_tick_;
+    }
+    changed_.Wait(start_time_ + (current_tick_ + 1) * tick_ -
+                  SystemClock::ElapsedRealtime());
+  }
+}
+
+void TimerWheel::ProcessSlotLocked(std::int64_t tick) {
+  std::vector<std::pair<std::string, std::uint64_t>>& slot =
+      slots_[tick % slots_.size()];
+  std::vector<std::pair<std::string, std::uint64_t>> not_due;
+  for (auto& [key, id] : slot) {
+    auto it = timers_.find(key);
+    if (it == timers_.end() || it->second.id != id) continue;
+
+    Timer& timer = it->second;
+    if (timer.rounds > 0) {
+      --timer.rounds;
+      not_due.emplace_back(std::move(key), id);
+      continue;
+    }
+    timer.running = true;
+    callback_threads_.Execute(
+        "timer-callback",
+        [this, key = key, id = id,
+         callback = std::move(timer.callback)]() mutable {
+          RunCallback(key, id, std::move(callback));
+        });
+  }
+  slot.swap(not_due);
+}
+
+void TimerWheel::RunCallback(const std::string& key, std::uint64_t id,
+                             Callback callback) {
+  std::optional<absl::Duration> next_delay = callback();
+
+  MutexLock lock(&mutex_);
+  auto it = timers_.find(key);
+  if (it == timers_.end() || it->second.id != id) return;
+
+  Timer& timer = it->second;
+  timer.running = false;
+  changed_.Notify();
+  // Cancel() removes the timer itself, once it sees it's no longer running.
+  if (timer.canceled) return;
+  if (!next_delay.has_value()) {
+    timers_.erase(it);
+    return;
+  }
+  timer.callback = std::move(callback);
+  AddToWheelLocked(key, timer, *next_delay);
+}
+
+}  // namespace connections
+}  // namespace nearby
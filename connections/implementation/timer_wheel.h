@@ -0,0 +1,114 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_TIMER_WHEEL_H_
+#define CORE_INTERNAL_TIMER_WHEEL_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/time/time.h"
+#include "internal/platform/cached_thread_pool.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+
+// Runs many recurring timers, such as one KeepAlive timer per endpoint, off a
+// single ticking thread.
+//
+// Timers are kept in a hashed wheel of `slot_count` slots, one per `tick`: on
+// each tick only the timers in the current slot are looked at, so the cost of
+// a tick is in the number of timers that are due, not in the number of
+// timers. Due timers run on a pool that starts a new thread whenever all of
+// its threads are busy, so a callback blocked on I/O never holds up the
+// others; as a timer's callback never runs twice at once, the pool has at
+// most one thread per timer. Up to `max_idle_callback_threads` threads are
+// kept between callbacks. Timers fire with a precision of one tick.
+class TimerWheel {
+ public:
+  // Runs when the timer is due. Returns the delay until the timer is due
+  // again, or std::nullopt to remove it.
+  using Callback = absl::AnyInvocable<std::optional<absl::Duration>()>;
+
+  TimerWheel(absl::Duration tick, int slot_count,
+             int max_idle_callback_threads);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  ~TimerWheel();
+
+  // Starts a timer under `key`, replacing the one already there, if any.
+  // Ignored after Shutdown().
+  void Schedule(const std::string& key, absl::Duration delay,
+                Callback callback) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Removes the timer under `key`. If its callback is running, waits for it
+  // to return. Must not be called from a callback.
+  void Cancel(const std::string& key) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Removes all timers, and waits for running callbacks to return.
+  void Shutdown() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Timer {
+    // Tells a timer apart from an earlier one under the same key, whose
+    // entries may still be in the wheel.
+    std::uint64_t id = 0;
+    Callback callback;
+    // Full turns of the wheel left before the timer is due.
+    std::int64_t rounds = 0;
+    bool running = false;
+    bool canceled = false;
+  };
+
+  void AddToWheelLocked(const std::string& key, Timer& timer,
+                        absl::Duration delay)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void RunTicks() ABSL_LOCKS_EXCLUDED(mutex_);
+  void ProcessSlotLocked(std::int64_t tick)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void RunCallback(const std::string& key, std::uint64_t id,
+                   Callback callback) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const absl::Duration tick_;
+  const absl::Time start_time_;
+
+  Mutex mutex_;
+  ConditionVariable changed_{&mutex_};
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  std::uint64_t next_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  // The tick whose slot is processed next.
+  std::int64_t current_tick_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<std::string, Timer> timers_ ABSL_GUARDED_BY(mutex_);
+  // (key, id) of the timers due in each slot. Entries of canceled or
+  // replaced timers are dropped when their slot comes up.
+  std::vector<std::vector<std::pair<std::string, std::uint64_t>>> slots_
+      ABSL_GUARDED_BY(mutex_);
+
+  CachedThreadPool callback_threads_;
+  SingleThreadExecutor tick_thread_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_TIMER_WHEEL_H_
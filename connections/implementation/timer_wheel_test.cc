@@ -0,0 +1,161 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/timer_wheel.h"
+
+#include <atomic>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+constexpr absl::Duration kTick = absl::Milliseconds(10);
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(TimerWheelTest, RunsTimerAfterDelay) {
+  TimerWheel wheel(kTick, /*slot_count=*/8, /*max_idle_callback_threads=*/1);
+  CountDownLatch fired(1);
+  absl::Time start = absl::Now();
+
+  wheel.Schedule("endpoint", absl::Milliseconds(50),
+                 [&fired]() -> std::optional<absl::Duration> {
+                   fired.CountDown();
+                   return std::nullopt;
+                 });
+
+  EXPECT_TRUE(fired.Await(kTimeout).result());
+  // Timers may fire up to a tick early.
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(50) - kTick);
+}
+
+TEST(TimerWheelTest, RunsTimerLongerThanOneTurnOfTheWheel) {
+  TimerWheel wheel(kTick, /*slot_count=*/4, /*max_idle_callback_threads=*/1);
+  CountDownLatch fired(1);
+  absl::Time start = absl::Now();
+
+  wheel.Schedule("endpoint", absl::Milliseconds(100),
+                 [&fired]() -> std::optional<absl::Duration> {
+                   fired.CountDown();
+                   return std::nullopt;
+                 });
+
+  EXPECT_TRUE(fired.Await(kTimeout).result());
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(100) - kTick);
+}
+
+TEST(TimerWheelTest, ReschedulesWithReturnedDelay) {
+  TimerWheel wheel(kTick, /*slot_count=*/8, /*max_idle_callback_threads=*/1);
+  CountDownLatch fired(3);
+  std::atomic<int> runs = 0;
+
+  wheel.Schedule("endpoint", absl::ZeroDuration(),
+                 [&]() -> std::optional<absl::Duration> {
+                   fired.CountDown();
+                   if (++runs == 3) return std::nullopt;
+                   return absl::Milliseconds(20);
+                 });
+
+  EXPECT_TRUE(fired.Await(kTimeout).result());
+  absl::SleepFor(absl::Milliseconds(100));
+  EXPECT_EQ(runs, 3);
+}
+
+TEST(TimerWheelTest, CanceledTimerDoesNotRun) {
+  TimerWheel wheel(kTick, /*slot_count=*/8, /*max_idle_callback_threads=*/1);
+  std::atomic<bool> ran = false;
+
+  wheel.Schedule("endpoint", absl::Milliseconds(50),
+                 [&ran]() -> std::optional<absl::Duration> {
+                   ran = true;
+                   return std::nullopt;
+                 });
+  wheel.Cancel("endpoint");
+  absl::SleepFor(absl::Milliseconds(100));
+
+  EXPECT_FALSE(ran);
+}
+
+TEST(TimerWheelTest, CancelWaitsForRunningCallback) {
+  TimerWheel wheel(kTick, /*slot_count=*/8, /*max_idle_callback_threads=*/1);
+  CountDownLatch started(1);
+  std::atomic<bool> finished = false;
+
+  wheel.Schedule("endpoint", absl::ZeroDuration(),
+                 [&]() -> std::optional<absl::Duration> {
+                   started.CountDown();
+                   absl::SleepFor(absl::Milliseconds(50));
+                   finished = true;
+                   return absl::ZeroDuration();
+                 });
+  ASSERT_TRUE(started.Await(kTimeout).result());
+  wheel.Cancel("endpoint");
+
+  EXPECT_TRUE(finished);
+}
+
+TEST(TimerWheelTest, SlowCallbackDoesNotHoldUpOthers) {
+  TimerWheel wheel(kTick, /*slot_count=*/8, /*max_idle_callback_threads=*/2);
+  CountDownLatch release(1);
+  CountDownLatch fast_fired(1);
+
+  wheel.Schedule("slow", absl::ZeroDuration(),
+                 [&release]() -> std::optional<absl::Duration> {
+                   release.Await(kTimeout);
+                   return std::nullopt;
+                 });
+  wheel.Schedule("fast", absl::Milliseconds(20),
+                 [&fast_fired]() -> std::optional<absl::Duration> {
+                   fast_fired.CountDown();
+                   return std::nullopt;
+                 });
+
+  EXPECT_TRUE(fast_fired.Await(kTimeout).result());
+  release.CountDown();
+}
+
+TEST(TimerWheelTest, SlowCallbacksBeyondIdleThreadsDoNotHoldUpOthers) {
+  TimerWheel wheel(kTick, /*slot_count=*/8, /*max_idle_callback_threads=*/1);
+  CountDownLatch release(1);
+  CountDownLatch slow_started(3);
+  CountDownLatch fast_fired(1);
+
+  for (const char* key : {"slow1", "slow2", "slow3"}) {
+    wheel.Schedule(
+        key, absl::ZeroDuration(),
+        [&release, &slow_started]() -> std::optional<absl::Duration> {
+          slow_started.CountDown();
+          release.Await(kTimeout);
+          return std::nullopt;
+        });
+  }
+  wheel.Schedule("fast", absl::Milliseconds(20),
+                 [&fast_fired]() -> std::optional<absl::Duration> {
+                   fast_fired.CountDown();
+                   return std::nullopt;
+                 });
+
+  EXPECT_TRUE(slow_started.Await(kTimeout).result());
+  EXPECT_TRUE(fast_fired.Await(kTimeout).result());
+  release.CountDown();
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,116 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/write_behind_output_file.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/file.h"
+#include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
+
+namespace nearby {
+namespace connections {
+
+WriteBehindOutputFile::WriteBehindOutputFile(OutputFile output_file,
+                                             std::int64_t total_size,
+                                             std::int64_t max_buffered_bytes,
+                                             std::int64_t sync_interval_bytes)
+    : output_file_(std::move(output_file)),
+      max_buffered_bytes_(max_buffered_bytes),
+      sync_interval_bytes_(sync_interval_bytes) {
+  if (total_size > 0) {
+    executor_.Execute("preallocate-file", [this, total_size]() {
+      // Running out of space is reported by the writes; a failed reservation
+      // alone shouldn't fail the transfer.
+      if (output_file_.Preallocate(total_size).Raised()) {
+        NEARBY_LOGS(WARNING) << "Failed to preallocate " << total_size
+                             << " bytes for incoming file";
+      }
+    });
+  }
+}
+
+WriteBehindOutputFile::~WriteBehindOutputFile() { Close(); }
+
+Exception WriteBehindOutputFile::Write(ByteArray data) {
+  std::int64_t size = data.size();
+  MutexLock lock(&mutex_);
+  // A chunk bigger than the whole buffer still goes through once the buffer
+  // is empty.
+  while (!closed_ && !result_.Raised() && buffered_bytes_ > 0 &&
+         buffered_bytes_ + size > max_buffered_bytes_) {
+    buffer_drained_.Wait();
+  }
+  if (closed_ || result_.Raised()) return {Exception::kIo};
+
+  buffered_bytes_ += size;
+  executor_.Execute("write-file", [this, data = std::move(data)]() mutable {
+    WriteQueued(std::move(data));
+  });
+  return {Exception::kSuccess};
+}
+
+Exception WriteBehindOutputFile::Close() {
+  {
+    MutexLock lock(&mutex_);
+    if (closed_) return result_;
+    closed_ = true;
+    while (buffered_bytes_ > 0) {
+      buffer_drained_.Wait();
+    }
+  }
+  executor_.Shutdown();
+
+  Exception result = {Exception::kSuccess};
+  if (sync_interval_bytes_ > 0) result = output_file_.Sync();
+  Exception close_result = output_file_.Close();
+  if (!result.Raised()) result = close_result;
+
+  MutexLock lock(&mutex_);
+  if (!result_.Raised()) result_ = result;
+  return result_;
+}
+
+void WriteBehindOutputFile::WriteQueued(ByteArray data) {
+  std::int64_t size = data.size();
+  bool failed;
+  {
+    MutexLock lock(&mutex_);
+    failed = result_.Raised();
+  }
+
+  // Once a write failed, the rest of the queue is dropped.
+  Exception result = {Exception::kSuccess};
+  if (!failed) {
+    result = output_file_.Write(data);
+    unsynced_bytes_ += size;
+    if (result.Ok() && sync_interval_bytes_ > 0 &&
+        unsynced_bytes_ >= sync_interval_bytes_) {
+      result = output_file_.Sync();
+      unsynced_bytes_ = 0;
+    }
+  }
+
+  MutexLock lock(&mutex_);
+  buffered_bytes_ -= size;
+  if (result.Raised() && !result_.Raised()) result_ = result;
+  buffer_drained_.Notify();
+}
+
+}  // namespace connections
+}  // namespace nearby
@@ -0,0 +1,78 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CORE_INTERNAL_WRITE_BEHIND_OUTPUT_FILE_H_
+#define CORE_INTERNAL_WRITE_BEHIND_OUTPUT_FILE_H_
+
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/file.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+namespace connections {
+
+// Writes an incoming file on a thread of its own, so that a slow disk only
+// holds up the endpoint's read loop once `max_buffered_bytes` of received
+// chunks are waiting to be written.
+//
+// Storage for `total_size` bytes is reserved before the first write. With a
+// non-zero `sync_interval_bytes`, the written data is synced to the storage
+// device every that many bytes and on Close(); otherwise the file is only
+// flushed, and the OS decides when to write it back.
+class WriteBehindOutputFile {
+ public:
+  WriteBehindOutputFile(OutputFile output_file, std::int64_t total_size,
+                        std::int64_t max_buffered_bytes,
+                        std::int64_t sync_interval_bytes);
+  WriteBehindOutputFile(const WriteBehindOutputFile&) = delete;
+  WriteBehindOutputFile& operator=(const WriteBehindOutputFile&) = delete;
+  ~WriteBehindOutputFile();
+
+  // Queues `data` to be written; callers move it in, so it isn't copied.
+  // Blocks while the buffer is full. Returns Exception::kIo if an earlier
+  // write failed, or after Close().
+  Exception Write(ByteArray data) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Writes out what is still queued, and closes the file. Returns
+  // Exception::kIo if any of the writes failed.
+  Exception Close() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void WriteQueued(ByteArray data) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Only used on `executor_`, and by Close() once `executor_` is shut down.
+  OutputFile output_file_;
+  const std::int64_t max_buffered_bytes_;
+  const std::int64_t sync_interval_bytes_;
+  std::int64_t unsynced_bytes_ = 0;
+
+  Mutex mutex_;
+  ConditionVariable buffer_drained_{&mutex_};
+  std::int64_t buffered_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  Exception result_ ABSL_GUARDED_BY(mutex_) = {Exception::kSuccess};
+  bool closed_ ABSL_GUARDED_BY(mutex_) = false;
+
+  SingleThreadExecutor executor_;
+};
+
+}  // namespace connections
+}  // namespace nearby
+
+#endif  // CORE_INTERNAL_WRITE_BEHIND_OUTPUT_FILE_H_
@@ -0,0 +1,75 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "connections/implementation/write_behind_output_file.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "connections/payload.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/file.h"
+
+namespace nearby {
+namespace connections {
+namespace {
+
+std::string ReadFile(Payload::Id payload_id, std::int64_t size) {
+  InputFile file(payload_id, size);
+  ExceptionOr<ByteArray> contents = file.GetInputStream().ReadExactly(size);
+  file.Close();
+  return contents.ok() ? std::string(contents.result()) : "";
+}
+
+TEST(WriteBehindOutputFileTest, WritesChunksInOrder) {
+  Payload::Id payload_id = Payload::GenerateId();
+  WriteBehindOutputFile file(OutputFile(payload_id), /*total_size=*/10,
+                             /*max_buffered_bytes=*/4,
+                             /*sync_interval_bytes=*/0);
+
+  EXPECT_TRUE(file.Write(ByteArray("0123")).Ok());
+  EXPECT_TRUE(file.Write(ByteArray("4567")).Ok());
+  EXPECT_TRUE(file.Write(ByteArray("89")).Ok());
+  EXPECT_TRUE(file.Close().Ok());
+
+  EXPECT_EQ(ReadFile(payload_id, 10), "0123456789");
+}
+
+TEST(WriteBehindOutputFileTest, AcceptsChunksBiggerThanTheBuffer) {
+  Payload::Id payload_id = Payload::GenerateId();
+  WriteBehindOutputFile file(OutputFile(payload_id), /*total_size=*/10,
+                             /*max_buffered_bytes=*/1,
+                             /*sync_interval_bytes=*/3);
+
+  EXPECT_TRUE(file.Write(ByteArray("01234")).Ok());
+  EXPECT_TRUE(file.Write(ByteArray("56789")).Ok());
+  EXPECT_TRUE(file.Close().Ok());
+
+  EXPECT_EQ(ReadFile(payload_id, 10), "0123456789");
+}
+
+TEST(WriteBehindOutputFileTest, WriteFailsAfterClose) {
+  WriteBehindOutputFile file(OutputFile(Payload::GenerateId()),
+                             /*total_size=*/0, /*max_buffered_bytes=*/4,
+                             /*sync_interval_bytes=*/0);
+
+  EXPECT_TRUE(file.Close().Ok());
+
+  EXPECT_TRUE(file.Write(ByteArray("0123")).Raised(Exception::kIo));
+}
+
+}  // namespace
+}  // namespace connections
+}  // namespace nearby
@@ -100,6 +100,13 @@ class Payload {
 
   size_t GetOffset();
 
+  // Sets the priority of an outgoing payload. Meant for small, latency
+  // sensitive bytes payloads, whose frames then go out between the chunks of
+  // normal payloads to the same endpoints instead of after them. Ignored for
+  // file and stream payloads.
+  void SetPriority(PayloadPriority priority) { priority_ = priority; }
+  PayloadPriority GetPriority() const { return priority_; }
+
   // Generate Payload Id; to be passed to outgoing file constructor.
   static Id GenerateId();
 
@@ -111,6 +118,7 @@ class Payload {
 
   Id id_{GenerateId()};
   size_t offset_{0};
+  PayloadPriority priority_{PayloadPriority::kNormal};
 
   std::string parent_folder_;
   std::string file_name_;
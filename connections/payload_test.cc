@@ -128,6 +128,15 @@ TEST(PayloadTest, PayloadHasUniqueId) {
   EXPECT_NE(payload1.GetId(), payload2.GetId());
 }
 
+TEST(PayloadTest, PriorityIsNormalByDefaultAndMovesWithPayload) {
+  Payload payload(ByteArray("control"));
+  EXPECT_EQ(payload.GetPriority(), PayloadPriority::kNormal);
+
+  payload.SetPriority(PayloadPriority::kHigh);
+  Payload moved(std::move(payload));
+  EXPECT_EQ(moved.GetPriority(), PayloadPriority::kHigh);
+}
+
 TEST(PayloadTest, PayloadIsNotCopyable) {
   EXPECT_FALSE(std::is_copy_constructible_v<Payload>);
   EXPECT_FALSE(std::is_copy_assignable_v<Payload>);
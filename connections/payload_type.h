@@ -19,6 +19,9 @@ namespace nearby {
 namespace connections {
 
 enum class PayloadType { kUnknown = 0, kBytes = 1, kStream = 2, kFile = 3 };
+// Outgoing frames of kHigh payloads are written ahead of the kNormal ones
+// queued for the same endpoints.
+enum class PayloadPriority { kNormal = 0, kHigh = 1 };
 enum PayloadDirection {
   UNKNOWN_DIRECTION_PAYLOAD = 0,
   INCOMING_PAYLOAD = 1,
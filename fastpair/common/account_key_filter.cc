@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "fastpair/common/battery_notification.h"
 #include "fastpair/common/non_discoverable_advertisement.h"
 #include "internal/crypto_cros/sha2.h"
@@ -40,28 +41,27 @@ constexpr uint8_t kInUseByte = 0x06;
 constexpr uint8_t kShowUi = 0b00110011;
 constexpr uint8_t kHideUi = 0b00110100;
 
-// Helper to AccountKeyFilter::IsAccountKeyInFilter().
+// Helper to AccountKeyFilter::IsSaltedKeyPossiblyInSet().
 // Performs the test to see if |data| is in |bit_sets|, a Bloom filter.
-bool AccountKeyFilterChecker(const std::vector<uint8_t>& data,
+bool AccountKeyFilterChecker(absl::Span<const uint8_t> data,
                              const std::vector<uint8_t>& bit_sets) {
   std::array<uint8_t, 32> hashed = crypto::SHA256Hash(data);
 
   // Iterate over the hashed input in 4 byte increments, combine those 4
   // bytes into an unsigned int and use it as the index into our
   // |bit_sets|.
+  size_t num_bits = bit_sets.size() * kBitsInByte;
   for (size_t i = 0; i < hashed.size(); i += 4) {
     uint32_t hash = uint32_t{hashed[i]} << 24 | uint32_t{hashed[i + 1]} << 16 |
                     uint32_t{hashed[i + 2]} << 8 | hashed[i + 3];
 
-    size_t num_bits = bit_sets.size() * kBitsInByte;
     size_t n = hash % num_bits;
-    size_t byte_index = floor(n / kBitsInByte);
+    size_t byte_index = n / kBitsInByte;
     size_t bit_index = n % kBitsInByte;
     bool is_set = (bit_sets[byte_index] >> bit_index) & 0x01;
 
     if (!is_set) return false;
   }
-  NEARBY_LOGS(INFO) << __func__ << " The accountkey is possibly in set.";
   return true;
 }
 
@@ -95,7 +95,7 @@ AccountKeyFilter::AccountKeyFilter(
     const std::vector<uint8_t>& salt_values)
     : bit_sets_(account_key_filter_bytes), salt_values_(salt_values) {}
 
-bool AccountKeyFilter::IsPossiblyInSet(const AccountKey& account_key) {
+bool AccountKeyFilter::IsPossiblyInSet(const AccountKey& account_key) const {
   if (!account_key.Ok()) {
     NEARBY_LOGS(INFO) << __func__ << " Invalid account key.";
     return false;
@@ -107,18 +107,27 @@ bool AccountKeyFilter::IsPossiblyInSet(const AccountKey& account_key) {
                             account_key.GetAsBytes().end());
   for (auto& byte : salt_values_) data.push_back(byte);
 
+  if (IsSaltedKeyPossiblyInSet(absl::MakeSpan(data))) {
+    NEARBY_LOGS(INFO) << __func__ << " The accountkey is possibly in set.";
+    return true;
+  }
+  return false;
+}
+
+bool AccountKeyFilter::IsSaltedKeyPossiblyInSet(
+    absl::Span<uint8_t> salted_key) const {
+  if (AccountKeyFilterChecker(salted_key, bit_sets_)) {
+    return true;
+  }
   // We need to try account keys with different first bytes in case
   // the peripheral is SASS per
   // https://developers.google.com/nearby/fast-pair/early-access/specifications/extensions/sass#SassAdvertisingPayload
-  if (AccountKeyFilterChecker(data, bit_sets_)) {
-    return true;
-  }
-  data[0] = kRecentlyUsedByte;
-  if (AccountKeyFilterChecker(data, bit_sets_)) {
+  salted_key[0] = kRecentlyUsedByte;
+  if (AccountKeyFilterChecker(salted_key, bit_sets_)) {
     return true;
   }
-  data[0] = kInUseByte;
-  return AccountKeyFilterChecker(data, bit_sets_);
+  salted_key[0] = kInUseByte;
+  return AccountKeyFilterChecker(salted_key, bit_sets_);
 }
 
 }  // namespace fastpair
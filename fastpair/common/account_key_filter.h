@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "fastpair/common/account_key.h"
 #include "fastpair/common/non_discoverable_advertisement.h"
 
@@ -36,9 +37,16 @@ class AccountKeyFilter {
   // Returns true if the `account_key` is possibly in the account key set
   // defined by the filter.
   // Return false if `account_key` is definitely not in set.
-  bool IsPossiblyInSet(const AccountKey& account_key);
+  bool IsPossiblyInSet(const AccountKey& account_key) const;
 
  private:
+  friend class AccountKeyMatcher;
+
+  // Returns true if `salted_key`, an account key followed by the salt values,
+  // is possibly in the set. Also tries the SASS variants of the key's first
+  // byte, which it overwrites.
+  bool IsSaltedKeyPossiblyInSet(absl::Span<uint8_t> salted_key) const;
+
   std::vector<uint8_t> bit_sets_;
   std::vector<uint8_t> salt_values_;
 };
@@ -0,0 +1,72 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/common/account_key_matcher.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+#include "fastpair/common/constant.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace fastpair {
+
+AccountKeyMatcher::AccountKeyMatcher(
+    const std::vector<AccountKey>& account_keys) {
+  keys_.reserve(account_keys.size());
+  for (size_t i = 0; i < account_keys.size(); ++i) {
+    if (!account_keys[i].Ok()) {
+      continue;
+    }
+    Key key{.index = i};
+    memcpy(key.bytes.data(), account_keys[i].GetAsBytes().data(),
+           kAccountKeySize);
+    keys_.push_back(key);
+  }
+}
+
+std::vector<size_t> AccountKeyMatcher::FindMatches(
+    const AccountKeyFilter& filter) const {
+  std::vector<size_t> matches;
+  // Every key sets some bits, so an empty filter can't hold any of them.
+  if (keys_.empty() ||
+      std::none_of(filter.bit_sets_.begin(), filter.bit_sets_.end(),
+                   [](uint8_t byte) { return byte != 0; })) {
+    return matches;
+  }
+  // We first need to append the salt value to the input (see
+  // https://developers.google.com/nearby/fast-pair/spec#AccountKeyFilter).
+  std::vector<uint8_t> salted_key(kAccountKeySize);
+  salted_key.insert(salted_key.end(), filter.salt_values_.begin(),
+                    filter.salt_values_.end());
+  for (const Key& key : keys_) {
+    memcpy(salted_key.data(), key.bytes.data(), kAccountKeySize);
+    if (filter.IsSaltedKeyPossiblyInSet(absl::MakeSpan(salted_key))) {
+      matches.push_back(key.index);
+    }
+  }
+  NEARBY_LOGS(VERBOSE) << __func__ << ": " << matches.size() << " of "
+                       << keys_.size() << " account keys possibly in set.";
+  return matches;
+}
+
+}  // namespace fastpair
+}  // namespace nearby
@@ -0,0 +1,59 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_FASTPAIR_COMMON_ACCOUNT_KEY_MATCHER_H_
+#define THIRD_PARTY_NEARBY_FASTPAIR_COMMON_ACCOUNT_KEY_MATCHER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+#include "fastpair/common/constant.h"
+
+namespace nearby {
+namespace fastpair {
+
+// Checks a fixed set of account keys, such as the ones saved to the user's
+// account, against the account key filters of advertisements.
+//
+// Build it once per set of keys and reuse it for every advertisement. All
+// keys are checked in one pass that shares one buffer for the salted key,
+// instead of building it for each key, and filters that can't hold any key
+// are rejected before hashing anything.
+class AccountKeyMatcher {
+ public:
+  // Invalid keys in `account_keys` are kept in place, but never match.
+  explicit AccountKeyMatcher(const std::vector<AccountKey>& account_keys);
+
+  // Returns the indexes in `account_keys` of the keys that are possibly in
+  // `filter`, in increasing order.
+  std::vector<size_t> FindMatches(const AccountKeyFilter& filter) const;
+
+ private:
+  struct Key {
+    // Index in the constructor's `account_keys`.
+    size_t index;
+    std::array<uint8_t, kAccountKeySize> bytes;
+  };
+
+  std::vector<Key> keys_;
+};
+
+}  // namespace fastpair
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_FASTPAIR_COMMON_ACCOUNT_KEY_MATCHER_H_
@@ -0,0 +1,113 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/common/account_key_matcher.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Test data comes from:
+// https://developers.google.com/nearby/fast-pair/specifications/appendix/testcases#test_cases
+const std::vector<uint8_t> kSalt{0xC7, 0xC8};
+const std::vector<uint8_t> kAccountKey1{0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                        0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                        0xCC, 0xDD, 0xEE, 0xFF};
+const std::vector<uint8_t> kAccountKey2{0x11, 0x11, 0x22, 0x22, 0x33, 0x33,
+                                        0x44, 0x44, 0x55, 0x55, 0x66, 0x66,
+                                        0x77, 0x77, 0x88, 0x88};
+const std::vector<uint8_t> kMissingAccountKey{0x12, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                              0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                              0xCC, 0xDD, 0xEE, 0xFF};
+const std::vector<uint8_t> kFilter1{0x02, 0x0C, 0x80, 0x2A};
+const std::vector<uint8_t> kFilter1And2{0x84, 0x4A, 0x62, 0x20, 0x8B};
+
+TEST(AccountKeyMatcherTest, FindsSingleKey) {
+  AccountKeyMatcher matcher({AccountKey(kMissingAccountKey),
+                             AccountKey(kAccountKey1)});
+
+  EXPECT_THAT(matcher.FindMatches(AccountKeyFilter(kFilter1, kSalt)),
+              ElementsAre(1));
+}
+
+TEST(AccountKeyMatcherTest, FindsAllKeys) {
+  AccountKeyMatcher matcher({AccountKey(kAccountKey1),
+                             AccountKey(kMissingAccountKey),
+                             AccountKey(kAccountKey2)});
+
+  EXPECT_THAT(matcher.FindMatches(AccountKeyFilter(kFilter1And2, kSalt)),
+              ElementsAre(0, 2));
+}
+
+TEST(AccountKeyMatcherTest, SassEnabledPeripheral) {
+  // Same data as AccountKeyFilterTest.SassEnabledPeripheral.
+  const std::vector<uint8_t> account_key{0x06, 0x3F, 0xC1, 0x8C, 0x63, 0xDC,
+                                         0x75, 0x1A, 0xE8, 0x1A, 0xCF, 0x65,
+                                         0x10, 0x15, 0x1D, 0xB0};
+  const std::vector<uint8_t> filter{0x19, 0x23, 0x50, 0xE8, 0x37,
+                                    0x68, 0xF0, 0x65, 0x22};
+  const std::vector<uint8_t> salt_values{0xD7, 0xDE, 0x33, 0xE4, 0xE4, 0x64};
+  AccountKeyMatcher matcher(
+      {AccountKey(kAccountKey1), AccountKey(account_key)});
+
+  EXPECT_THAT(matcher.FindMatches(AccountKeyFilter(filter, salt_values)),
+              ElementsAre(1));
+}
+
+TEST(AccountKeyMatcherTest, InvalidKeysNeverMatch) {
+  AccountKeyMatcher matcher({AccountKey(""), AccountKey(kAccountKey1)});
+
+  EXPECT_THAT(matcher.FindMatches(AccountKeyFilter(kFilter1, kSalt)),
+              ElementsAre(1));
+}
+
+TEST(AccountKeyMatcherTest, EmptyFilter) {
+  AccountKeyMatcher matcher({AccountKey(kAccountKey1)});
+
+  EXPECT_THAT(matcher.FindMatches(AccountKeyFilter({}, kSalt)), IsEmpty());
+  EXPECT_THAT(matcher.FindMatches(AccountKeyFilter({0, 0, 0, 0}, kSalt)),
+              IsEmpty());
+}
+
+TEST(AccountKeyMatcherTest, AgreesWithAccountKeyFilter) {
+  std::vector<AccountKey> account_keys;
+  for (int i = 0; i < 64; ++i) {
+    account_keys.push_back(AccountKey::CreateRandomKey());
+  }
+  account_keys.push_back(AccountKey(kAccountKey1));
+  AccountKeyMatcher matcher(account_keys);
+  AccountKeyFilter filter(kFilter1And2, kSalt);
+
+  std::vector<size_t> expected;
+  for (size_t i = 0; i < account_keys.size(); ++i) {
+    if (filter.IsPossiblyInSet(account_keys[i])) expected.push_back(i);
+  }
+
+  EXPECT_EQ(matcher.FindMatches(filter), expected);
+}
+
+}  // namespace
+}  // namespace fastpair
+}  // namespace nearby
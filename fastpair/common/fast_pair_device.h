@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/strings/string_view.h"
 #include "fastpair/common/account_key.h"
 #include "fastpair/common/device_metadata.h"
@@ -36,6 +37,11 @@ namespace fastpair {
 // system to represent a device.
 class FastPairDevice {
  public:
+  // Called after the model ID, an address or the account key of the device
+  // has changed.
+  using IdentifiersChangedCallback =
+      absl::AnyInvocable<void(const FastPairDevice& device)>;
+
   explicit FastPairDevice(Protocol protocol) : protocol_(protocol) {}
   FastPairDevice(absl::string_view model_id, absl::string_view ble_address,
                  Protocol protocol)
@@ -53,6 +59,7 @@ class FastPairDevice {
 
   void SetPublicAddress(absl::string_view address) {
     public_address_ = std::string(address);
+    OnIdentifiersChanged();
   }
 
   std::optional<std::string> GetDisplayName() const { return display_name_; }
@@ -70,16 +77,21 @@ class FastPairDevice {
 
   const AccountKey& GetAccountKey() const { return account_key_; }
 
-  void SetAccountKey(AccountKey account_key) { account_key_ = account_key; }
+  void SetAccountKey(AccountKey account_key) {
+    account_key_ = account_key;
+    OnIdentifiersChanged();
+  }
 
   void SetModelId(absl::string_view model_id) {
     model_id_ = std::string(model_id);
+    OnIdentifiersChanged();
   }
 
   absl::string_view GetModelId() const { return model_id_; }
 
   void SetBleAddress(absl::string_view address) {
     ble_address_ = std::string(address);
+    OnIdentifiersChanged();
   }
 
   absl::string_view GetBleAddress() const { return ble_address_; }
@@ -111,7 +123,18 @@ class FastPairDevice {
 
   bool HasStartedPairing() const { return has_started_pairing_; }
 
+  // Lets the owner of the device, which looks devices up by their
+  // identifiers, keep its lookup tables up to date. There is at most one
+  // callback; setting another one replaces it.
+  void SetIdentifiersChangedCallback(IdentifiersChangedCallback callback) {
+    identifiers_changed_callback_ = std::move(callback);
+  }
+
  private:
+  void OnIdentifiersChanged() {
+    if (identifiers_changed_callback_) identifiers_changed_callback_(*this);
+  }
+
   std::string model_id_;
 
   // Bluetooth LE address of the device.
@@ -142,6 +165,7 @@ class FastPairDevice {
   std::optional<DeviceMetadata> metadata_;
   std::optional<bool> should_show_ui_notification_;
   bool has_started_pairing_ = false;
+  IdentifiersChangedCallback identifiers_changed_callback_;
 };
 
 std::ostream& operator<<(std::ostream& stream, const FastPairDevice& device);
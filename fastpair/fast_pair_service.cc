@@ -41,6 +41,8 @@ namespace fastpair {
 
 namespace {
 constexpr char kFastPairPreferencesFilePath[] = "Google/Nearby/FastPair";
+constexpr char kSavedDevicesDirectoryName[] = "saved_devices";
+constexpr char kDeviceMetadataDirectoryName[] = "device_metadata";
 constexpr FeatureFlags::Flags fast_pair_feature_flags = FeatureFlags::Flags{
     .enable_scan_for_fast_pair_advertisement = true,
     .skip_service_discovery_before_connecting_to_rfcomm = true,
@@ -69,8 +71,12 @@ FastPairService::FastPairService(
       fast_pair_client_(std::make_unique<FastPairClientImpl>(
           authentication_manager_.get(), account_manager_.get(),
           http_client_.get(), &fast_pair_http_notifier_, device_info_.get())),
-      fast_pair_repository_(
-          std::make_unique<FastPairRepositoryImpl>(fast_pair_client_.get())),
+      fast_pair_repository_(std::make_unique<FastPairRepositoryImpl>(
+          fast_pair_client_.get(), account_manager_.get(),
+          device_info_->GetAppDataPath() / kFastPairPreferencesFilePath /
+              kSavedDevicesDirectoryName,
+          device_info_->GetAppDataPath() / kFastPairPreferencesFilePath /
+              kDeviceMetadataDirectoryName)),
       on_device_destroyed_callback_(
           [this](const FastPairDevice& device) { OnDeviceDestroyed(device); }) {
   NearbyFlags::GetInstance().OverrideBoolFlagValue(
@@ -0,0 +1,166 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastpair/repository/device_metadata_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "fastpair/common/device_metadata.h"
+#include "fastpair/proto/cache.proto.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace fastpair {
+
+namespace {
+constexpr absl::string_view kFileExtension = ".pb";
+}  // namespace
+
+std::string DeviceMetadataCache::NormalizeModelId(
+    absl::string_view hex_model_id) {
+  std::string model_id(hex_model_id);
+  absl::AsciiStrToUpper(&model_id);
+  return model_id;
+}
+
+DeviceMetadataCache::DeviceMetadataCache(size_t max_entries)
+    : max_entries_(std::max<size_t>(max_entries, 1)) {}
+
+DeviceMetadataCache::DeviceMetadataCache(std::filesystem::path directory,
+                                         size_t max_entries)
+    : directory_(std::move(directory)),
+      max_entries_(std::max<size_t>(max_entries, 1)) {}
+
+const DeviceMetadataCache::Entry* DeviceMetadataCache::Get(
+    absl::string_view hex_model_id) {
+  std::string model_id = NormalizeModelId(hex_model_id);
+  auto it = entries_.find(model_id);
+  if (it != entries_.end()) {
+    it->second.last_use = ++use_count_;
+    return it->second.entry.get();
+  }
+  std::unique_ptr<Entry> entry = Load(model_id);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  return &Insert(std::move(model_id), std::move(entry));
+}
+
+const DeviceMetadataCache::Entry& DeviceMetadataCache::Put(
+    absl::string_view hex_model_id, proto::GetObservedDeviceResponse response,
+    absl::Time fetch_time) {
+  std::string model_id = NormalizeModelId(hex_model_id);
+  auto entry = std::make_unique<Entry>(
+      Entry{DeviceMetadata(std::move(response)), fetch_time});
+  Save(model_id, *entry);
+  return Insert(std::move(model_id), std::move(entry));
+}
+
+const DeviceMetadataCache::Entry& DeviceMetadataCache::Insert(
+    std::string model_id, std::unique_ptr<Entry> entry) {
+  Slot& slot = entries_[model_id];
+  slot.entry = std::move(entry);
+  slot.last_use = ++use_count_;
+  const Entry& inserted = *slot.entry;
+  if (entries_.size() > max_entries_) {
+    auto least_recently_used = absl::c_min_element(
+        entries_, [](const auto& a, const auto& b) {
+          return a.second.last_use < b.second.last_use;
+        });
+    entries_.erase(least_recently_used);
+  }
+  return inserted;
+}
+
+std::optional<std::filesystem::path> DeviceMetadataCache::GetFilePath(
+    absl::string_view hex_model_id) const {
+  // The model ID becomes a file name, so it must not be able to name a path.
+  if (!directory_.has_value() || hex_model_id.empty() ||
+      !absl::c_all_of(hex_model_id, absl::ascii_isxdigit)) {
+    return std::nullopt;
+  }
+  return *directory_ / absl::StrCat(hex_model_id, kFileExtension);
+}
+
+std::unique_ptr<DeviceMetadataCache::Entry> DeviceMetadataCache::Load(
+    absl::string_view hex_model_id) const {
+  std::optional<std::filesystem::path> file_path = GetFilePath(hex_model_id);
+  if (!file_path.has_value()) {
+    return nullptr;
+  }
+  std::ifstream file(*file_path, std::ios::binary);
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  proto::StoredDeviceMetadata stored;
+  if (!stored.ParseFromIstream(&file) ||
+      stored.hex_model_id() != hex_model_id) {
+    NEARBY_LOGS(WARNING) << "Failed to parse device metadata from "
+                         << file_path->string();
+    return nullptr;
+  }
+  NEARBY_LOGS(VERBOSE) << "Loaded device metadata of model " << hex_model_id;
+  return std::make_unique<Entry>(
+      Entry{DeviceMetadata(std::move(*stored.mutable_response())),
+            absl::FromUnixMillis(stored.fetch_timestamp_millis())});
+}
+
+void DeviceMetadataCache::Save(absl::string_view hex_model_id,
+                               const Entry& entry) const {
+  std::optional<std::filesystem::path> file_path = GetFilePath(hex_model_id);
+  if (!file_path.has_value()) {
+    return;
+  }
+  proto::StoredDeviceMetadata stored;
+  stored.set_hex_model_id(std::string(hex_model_id));
+  *stored.mutable_response() = entry.metadata.GetResponse();
+  stored.set_fetch_timestamp_millis(absl::ToUnixMillis(entry.fetch_time));
+
+  std::error_code error;
+  std::filesystem::create_directories(*directory_, error);
+  // Write to a temporary file first, so a crash can't leave a partial file.
+  std::filesystem::path temp_path = *file_path;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !stored.SerializeToOstream(&file)) {
+      NEARBY_LOGS(WARNING) << "Failed to write device metadata to "
+                           << temp_path.string();
+      return;
+    }
+  }
+  std::filesystem::rename(temp_path, *file_path, error);
+  if (error) {
+    NEARBY_LOGS(WARNING) << "Failed to write device metadata to "
+                         << file_path->string() << ": " << error.message();
+  }
+}
+
+}  // namespace fastpair
+}  // namespace nearby
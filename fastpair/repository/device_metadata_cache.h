@@ -0,0 +1,106 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_DEVICE_METADATA_CACHE_H_
+#define THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_DEVICE_METADATA_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "fastpair/common/device_metadata.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+
+namespace nearby {
+namespace fastpair {
+
+// Metadata of Fast Pair device models, image included, as last fetched from
+// the server, keyed by hex model ID.
+//
+// When given a directory, the metadata of each model is written to a file of
+// its own there, and read back the first time the model is looked up, so it
+// doesn't have to be fetched again after a restart. How long cached metadata
+// stays usable is up to the caller.
+//
+// At most `max_entries` models are kept in memory; the least recently used
+// one is dropped to make room for another. A dropped model is read back from
+// its file, if any, the next time it is looked up.
+//
+// Not thread-safe.
+class DeviceMetadataCache {
+ public:
+  struct Entry {
+    DeviceMetadata metadata;
+    // When the metadata was received from the server.
+    absl::Time fetch_time;
+  };
+
+  static constexpr size_t kDefaultMaxEntries = 32;
+
+  // Returns the hex model ID the way the cache keys models: in upper case.
+  static std::string NormalizeModelId(absl::string_view hex_model_id);
+
+  // Creates a cache that is only kept in memory.
+  explicit DeviceMetadataCache(size_t max_entries = kDefaultMaxEntries);
+  // Creates a cache that is also kept in `directory`.
+  explicit DeviceMetadataCache(std::filesystem::path directory,
+                               size_t max_entries = kDefaultMaxEntries);
+  DeviceMetadataCache(const DeviceMetadataCache&) = delete;
+  DeviceMetadataCache& operator=(const DeviceMetadataCache&) = delete;
+
+  // Returns the cached metadata of the model, or nullptr. The entry is valid
+  // until the next `Get()` of another model, or the next `Put()`.
+  const Entry* Get(absl::string_view hex_model_id);
+
+  // Caches `response`, received from the server at `fetch_time`, replacing
+  // the metadata cached for the model before.
+  const Entry& Put(absl::string_view hex_model_id,
+                   proto::GetObservedDeviceResponse response,
+                   absl::Time fetch_time);
+
+ private:
+  // Returns the file the model is kept in, if any.
+  std::optional<std::filesystem::path> GetFilePath(
+      absl::string_view hex_model_id) const;
+  std::unique_ptr<Entry> Load(absl::string_view hex_model_id) const;
+  void Save(absl::string_view hex_model_id, const Entry& entry) const;
+
+  struct Slot {
+    std::unique_ptr<Entry> entry;
+    // Value of `use_count_` when the entry was last looked up or put.
+    uint64_t last_use = 0;
+  };
+
+  // Adds `entry` as the most recently used one, and drops the least recently
+  // used one if that makes too many.
+  const Entry& Insert(std::string model_id, std::unique_ptr<Entry> entry);
+
+  const std::optional<std::filesystem::path> directory_;
+  const size_t max_entries_;
+  // Upper case hex model ID to entry.
+  absl::flat_hash_map<std::string, Slot> entries_;
+  uint64_t use_count_ = 0;
+};
+
+}  // namespace fastpair
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_DEVICE_METADATA_CACHE_H_
@@ -0,0 +1,146 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "fastpair/repository/device_metadata_cache.h"
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <string>
+
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+constexpr absl::string_view kHexModelId = "718C17";
+constexpr absl::string_view kImage = "\x89PNG image";
+constexpr absl::string_view kName = "Test Device";
+
+proto::GetObservedDeviceResponse CreateResponse(absl::string_view name) {
+  proto::GetObservedDeviceResponse response;
+  response.mutable_device()->set_id(0x718C17);
+  response.mutable_device()->set_name(std::string(name));
+  response.set_image(std::string(kImage));
+  return response;
+}
+
+std::filesystem::path GetTestDirectory(absl::string_view name) {
+  std::filesystem::path path = std::filesystem::temp_directory_path() /
+                               "device_metadata_cache_test" /
+                               std::string(name);
+  std::filesystem::remove_all(path);
+  return path;
+}
+
+TEST(DeviceMetadataCacheTest, ReturnsNullForUnknownModel) {
+  DeviceMetadataCache cache;
+
+  EXPECT_EQ(cache.Get(kHexModelId), nullptr);
+}
+
+TEST(DeviceMetadataCacheTest, ReturnsCachedMetadata) {
+  DeviceMetadataCache cache;
+  absl::Time fetch_time = absl::FromUnixMillis(1000);
+
+  cache.Put(kHexModelId, CreateResponse(kName), fetch_time);
+
+  const DeviceMetadataCache::Entry* entry = cache.Get(kHexModelId);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->metadata.GetDetails().name(), kName);
+  EXPECT_EQ(entry->metadata.GetResponse().image(), kImage);
+  EXPECT_EQ(entry->fetch_time, fetch_time);
+}
+
+TEST(DeviceMetadataCacheTest, ModelIdIsCaseInsensitive) {
+  DeviceMetadataCache cache;
+
+  cache.Put("718c17", CreateResponse(kName), absl::FromUnixMillis(1000));
+
+  EXPECT_NE(cache.Get("718C17"), nullptr);
+}
+
+TEST(DeviceMetadataCacheTest, PutReplacesMetadata) {
+  DeviceMetadataCache cache;
+  cache.Put(kHexModelId, CreateResponse(kName), absl::FromUnixMillis(1000));
+
+  cache.Put(kHexModelId, CreateResponse("New Name"),
+            absl::FromUnixMillis(2000));
+
+  const DeviceMetadataCache::Entry* entry = cache.Get(kHexModelId);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->metadata.GetDetails().name(), "New Name");
+  EXPECT_EQ(entry->fetch_time, absl::FromUnixMillis(2000));
+}
+
+TEST(DeviceMetadataCacheTest, DropsLeastRecentlyUsedModel) {
+  DeviceMetadataCache cache(/*max_entries=*/2);
+  cache.Put("000001", CreateResponse("First"), absl::FromUnixMillis(1000));
+  cache.Put("000002", CreateResponse("Second"), absl::FromUnixMillis(1000));
+  ASSERT_NE(cache.Get("000001"), nullptr);
+
+  cache.Put("000003", CreateResponse("Third"), absl::FromUnixMillis(1000));
+
+  EXPECT_NE(cache.Get("000001"), nullptr);
+  EXPECT_EQ(cache.Get("000002"), nullptr);
+  EXPECT_NE(cache.Get("000003"), nullptr);
+}
+
+TEST(DeviceMetadataCacheTest, LoadsDroppedModelFromDirectory) {
+  std::filesystem::path directory = GetTestDirectory("dropped");
+  DeviceMetadataCache cache(directory, /*max_entries=*/1);
+  cache.Put(kHexModelId, CreateResponse(kName), absl::FromUnixMillis(1000));
+  cache.Put("000002", CreateResponse("Second"), absl::FromUnixMillis(1000));
+
+  const DeviceMetadataCache::Entry* entry = cache.Get(kHexModelId);
+
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->metadata.GetDetails().name(), kName);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(DeviceMetadataCacheTest, LoadsMetadataFromDirectory) {
+  std::filesystem::path directory = GetTestDirectory("load");
+  absl::Time fetch_time = absl::FromUnixMillis(1000);
+  {
+    DeviceMetadataCache cache(directory);
+    cache.Put(kHexModelId, CreateResponse(kName), fetch_time);
+  }
+
+  DeviceMetadataCache cache(directory);
+
+  const DeviceMetadataCache::Entry* entry = cache.Get(kHexModelId);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->metadata.GetDetails().name(), kName);
+  EXPECT_EQ(entry->metadata.GetResponse().image(), kImage);
+  EXPECT_EQ(entry->fetch_time, fetch_time);
+  std::filesystem::remove_all(directory);
+}
+
+TEST(DeviceMetadataCacheTest, DoesNotWriteFilesForInvalidModelIds) {
+  std::filesystem::path directory = GetTestDirectory("invalid");
+  DeviceMetadataCache cache(directory);
+
+  cache.Put("../718C17", CreateResponse(kName), absl::FromUnixMillis(1000));
+
+  EXPECT_NE(cache.Get("../718C17"), nullptr);
+  EXPECT_FALSE(std::filesystem::exists(directory));
+}
+
+}  // namespace
+}  // namespace fastpair
+}  // namespace nearby
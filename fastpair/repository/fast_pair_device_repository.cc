@@ -17,7 +17,9 @@
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "fastpair/common/account_key.h"
 #include "fastpair/common/fast_pair_device.h"
@@ -26,21 +28,57 @@
 
 namespace nearby {
 namespace fastpair {
+namespace {
+
+void AddToIndex(absl::flat_hash_map<std::string, std::vector<FastPairDevice*>>&
+                    index,
+                const std::string& key, FastPairDevice* device) {
+  if (key.empty()) return;
+  index[key].push_back(device);
+}
+
+void RemoveFromIndex(
+    absl::flat_hash_map<std::string, std::vector<FastPairDevice*>>& index,
+    const std::string& key, FastPairDevice* device) {
+  auto it = index.find(key);
+  if (it == index.end()) return;
+  std::vector<FastPairDevice*>& devices = it->second;
+  devices.erase(std::remove(devices.begin(), devices.end(), device),
+                devices.end());
+  if (devices.empty()) index.erase(it);
+}
+
+std::optional<FastPairDevice*> FindFirst(
+    const absl::flat_hash_map<std::string, std::vector<FastPairDevice*>>& index,
+    absl::string_view key) {
+  if (key.empty()) return std::nullopt;
+  auto it = index.find(key);
+  if (it == index.end()) return std::nullopt;
+  return it->second.front();
+}
+
+}  // namespace
 
 FastPairDevice* FastPairDeviceRepository::AddDevice(
     std::unique_ptr<FastPairDevice> device) {
-  const auto& id = device->GetUniqueId();
   MutexLock lock(&mutex_);
-  for (auto& item : devices_) {
-    if (item->GetUniqueId() == id) {
-      // Overwrite the existing object.
-      *item = std::move(*device);
-      return item.get();
-    }
+  FastPairDevice* item = FindDeviceByUniqueIdLocked(device->GetUniqueId());
+  if (item != nullptr) {
+    // Overwrite the existing object.
+    IndexedDevice& entry = devices_[item];
+    UnindexLocked(entry);
+    *item = std::move(*device);
+    IndexLocked(entry);
+  } else {
+    item = device.get();
+    IndexedDevice& entry = devices_[item];
+    entry.device = std::move(device);
+    IndexLocked(entry);
   }
-  FastPairDevice* ptr = device.get();
-  devices_.push_back(std::move(device));
-  return ptr;
+  // The move assignment above drops the callback of the existing object.
+  item->SetIdentifiersChangedCallback(
+      [this](const FastPairDevice& device) { OnIdentifiersChanged(device); });
+  return item;
 }
 
 void FastPairDeviceRepository::RemoveDevice(const FastPairDevice* device) {
@@ -60,44 +98,85 @@ void FastPairDeviceRepository::RemoveDevice(const FastPairDevice* device) {
 std::optional<FastPairDevice*> FastPairDeviceRepository::FindDevice(
     absl::string_view mac_address) {
   MutexLock lock(&mutex_);
-  auto it = std::find_if(devices_.begin(), devices_.end(),
-                         [&](const std::unique_ptr<FastPairDevice>& device) {
-                           return device->GetBleAddress() == mac_address ||
-                                  device->GetPublicAddress() == mac_address;
-                         });
-  if (it != devices_.end()) {
-    return it->get();
-  } else {
-    return std::nullopt;
-  }
+  std::optional<FastPairDevice*> device =
+      FindFirst(devices_by_ble_address_, mac_address);
+  if (device.has_value()) return device;
+  return FindFirst(devices_by_public_address_, mac_address);
 }
 
 std::optional<FastPairDevice*> FastPairDeviceRepository::FindDevice(
     const AccountKey& account_key) {
   MutexLock lock(&mutex_);
-  auto it = std::find_if(devices_.begin(), devices_.end(),
-                         [&](const std::unique_ptr<FastPairDevice>& device) {
-                           return device->GetAccountKey() == account_key;
-                         });
-  if (it != devices_.end()) {
-    return it->get();
-  } else {
-    return std::nullopt;
-  }
+  return FindFirst(devices_by_account_key_, account_key.GetAsBytes());
+}
+
+std::vector<FastPairDevice*> FastPairDeviceRepository::FindDevicesWithModelId(
+    absl::string_view model_id) {
+  MutexLock lock(&mutex_);
+  auto it = devices_by_model_id_.find(model_id);
+  if (it == devices_by_model_id_.end()) return {};
+  return it->second;
 }
 
 std::unique_ptr<FastPairDevice> FastPairDeviceRepository::ExtractDevice(
     const FastPairDevice* device) {
   MutexLock lock(&mutex_);
-  auto it = std::find_if(devices_.begin(), devices_.end(),
-                         [&](const std::unique_ptr<FastPairDevice>& item) {
-                           return item.get() == device;
-                         });
+  auto it = devices_.find(device);
   if (it == devices_.end()) return nullptr;
-  std::unique_ptr<FastPairDevice> fast_pair_device = std::move(*it);
+  UnindexLocked(it->second);
+  std::unique_ptr<FastPairDevice> fast_pair_device =
+      std::move(it->second.device);
   devices_.erase(it);
+  fast_pair_device->SetIdentifiersChangedCallback(nullptr);
   return fast_pair_device;
 }
 
+FastPairDevice* FastPairDeviceRepository::FindDeviceByUniqueIdLocked(
+    absl::string_view id) {
+  if (id.empty()) return nullptr;
+  // The unique ID is the public address, or the BLE address when the public
+  // address is unknown.
+  if (auto it = devices_by_public_address_.find(id);
+      it != devices_by_public_address_.end()) {
+    return it->second.front();
+  }
+  if (auto it = devices_by_ble_address_.find(id);
+      it != devices_by_ble_address_.end()) {
+    for (FastPairDevice* device : it->second) {
+      if (!device->GetPublicAddress().has_value()) return device;
+    }
+  }
+  return nullptr;
+}
+
+void FastPairDeviceRepository::OnIdentifiersChanged(
+    const FastPairDevice& device) {
+  MutexLock lock(&mutex_);
+  auto it = devices_.find(&device);
+  if (it == devices_.end()) return;
+  UnindexLocked(it->second);
+  IndexLocked(it->second);
+}
+
+void FastPairDeviceRepository::IndexLocked(IndexedDevice& entry) {
+  FastPairDevice* device = entry.device.get();
+  entry.ble_address = std::string(device->GetBleAddress());
+  entry.public_address = device->GetPublicAddress().value_or("");
+  entry.model_id = std::string(device->GetModelId());
+  entry.account_key = std::string(device->GetAccountKey().GetAsBytes());
+  AddToIndex(devices_by_ble_address_, entry.ble_address, device);
+  AddToIndex(devices_by_public_address_, entry.public_address, device);
+  AddToIndex(devices_by_model_id_, entry.model_id, device);
+  AddToIndex(devices_by_account_key_, entry.account_key, device);
+}
+
+void FastPairDeviceRepository::UnindexLocked(IndexedDevice& entry) {
+  FastPairDevice* device = entry.device.get();
+  RemoveFromIndex(devices_by_ble_address_, entry.ble_address, device);
+  RemoveFromIndex(devices_by_public_address_, entry.public_address, device);
+  RemoveFromIndex(devices_by_model_id_, entry.model_id, device);
+  RemoveFromIndex(devices_by_account_key_, entry.account_key, device);
+}
+
 }  // namespace fastpair
 }  // namespace nearby
@@ -17,9 +17,14 @@
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
+#include "fastpair/common/account_key.h"
 #include "fastpair/common/fast_pair_device.h"
 #include "internal/base/observer_list.h"
 #include "internal/platform/mutex.h"
@@ -29,6 +34,11 @@ namespace nearby {
 namespace fastpair {
 
 // Owner of `FastPairDevice` instances.
+//
+// Devices are indexed by their BLE address, public address, model ID and
+// account key, so lookups don't scan the whole repository. The indexes follow
+// changes made to a device through its setters after it has been added.
+// Empty identifiers are not indexed and never match.
 class FastPairDeviceRepository {
  public:
   // Called on the background thread right before `device` is destroyed.
@@ -57,6 +67,10 @@ class FastPairDeviceRepository {
   // Finds a device matching the account key.
   std::optional<FastPairDevice*> FindDevice(const AccountKey& account_key);
 
+  // Finds all devices with the model ID, in the order they were indexed.
+  std::vector<FastPairDevice*> FindDevicesWithModelId(
+      absl::string_view model_id);
+
   void AddObserver(RemoveDeviceCallback* observer) {
     observers_.AddObserver(observer);
   }
@@ -65,11 +79,35 @@ class FastPairDeviceRepository {
   }
 
  private:
+  // Identifiers a device is currently indexed by.
+  struct IndexedDevice {
+    std::unique_ptr<FastPairDevice> device;
+    std::string ble_address;
+    std::string public_address;
+    std::string model_id;
+    std::string account_key;
+  };
+  using Index = absl::flat_hash_map<std::string, std::vector<FastPairDevice*>>;
+
   // Removes `device` from `devices_`.
   std::unique_ptr<FastPairDevice> ExtractDevice(const FastPairDevice* device);
+  // Returns the device with the unique ID, or nullptr.
+  FastPairDevice* FindDeviceByUniqueIdLocked(absl::string_view id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void OnIdentifiersChanged(const FastPairDevice& device)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+  void IndexLocked(IndexedDevice& entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void UnindexLocked(IndexedDevice& entry)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   Mutex mutex_;
   SingleThreadExecutor* executor_;
-  std::vector<std::unique_ptr<FastPairDevice>> devices_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<const FastPairDevice*, IndexedDevice> devices_
+      ABSL_GUARDED_BY(mutex_);
+  Index devices_by_ble_address_ ABSL_GUARDED_BY(mutex_);
+  Index devices_by_public_address_ ABSL_GUARDED_BY(mutex_);
+  Index devices_by_model_id_ ABSL_GUARDED_BY(mutex_);
+  Index devices_by_account_key_ ABSL_GUARDED_BY(mutex_);
   ObserverList<RemoveDeviceCallback> observers_;
 };
 
@@ -17,6 +17,7 @@
 #include <memory>
 #include <utility>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
 #include "fastpair/common/account_key.h"
@@ -33,6 +34,9 @@ constexpr absl::string_view kBleAddress = "AA:BB:CC:DD:EE:FF";
 constexpr absl::string_view kBtAddress = "12:34:56:78:90:AB";
 constexpr absl::string_view kAccountKey = "04b85786180add47fb81a04a8ce6b0de";
 
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
 TEST(FastPairDeviceRepositoryTest, AddDevice) {
   SingleThreadExecutor executor;
   FastPairDeviceRepository repo(&executor);
@@ -138,6 +142,74 @@ TEST(FastPairDeviceRepositoryTest, RemovingDeviceCallsCallback) {
   executor.Shutdown();
 }
 
+TEST(FastPairDeviceRepositoryTest, FindDeviceAfterAddressChanges) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+
+  device->SetPublicAddress(kBtAddress);
+  device->SetBleAddress("11:22:33:44:55:66");
+
+  EXPECT_FALSE(repo.FindDevice(kBleAddress).has_value());
+  EXPECT_EQ(repo.FindDevice("11:22:33:44:55:66"), device);
+  EXPECT_EQ(repo.FindDevice(kBtAddress), device);
+  executor.Shutdown();
+}
+
+TEST(FastPairDeviceRepositoryTest, FindDeviceAfterAccountKeyChanges) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+  EXPECT_FALSE(repo.FindDevice(AccountKey(kAccountKey)).has_value());
+
+  device->SetAccountKey(AccountKey(kAccountKey));
+
+  EXPECT_EQ(repo.FindDevice(AccountKey(kAccountKey)), device);
+  executor.Shutdown();
+}
+
+TEST(FastPairDeviceRepositoryTest, AddDeviceWithSameAddressReplacesDevice) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+  device->SetAccountKey(AccountKey(kAccountKey));
+
+  FastPairDevice* replacement =
+      repo.AddDevice(std::make_unique<FastPairDevice>(
+          "654321", kBleAddress, Protocol::kFastPairInitialPairing));
+
+  EXPECT_EQ(replacement, device);
+  EXPECT_FALSE(repo.FindDevice(AccountKey(kAccountKey)).has_value());
+  EXPECT_THAT(repo.FindDevicesWithModelId(kModelId), IsEmpty());
+  EXPECT_THAT(repo.FindDevicesWithModelId("654321"), ElementsAre(device));
+  // The replacement is still indexed when it changes.
+  replacement->SetPublicAddress(kBtAddress);
+  EXPECT_EQ(repo.FindDevice(kBtAddress), device);
+  executor.Shutdown();
+}
+
+TEST(FastPairDeviceRepositoryTest, FindDevicesWithModelId) {
+  SingleThreadExecutor executor;
+  FastPairDeviceRepository repo(&executor);
+  FastPairDevice* device_1 = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, kBleAddress, Protocol::kFastPairInitialPairing));
+  FastPairDevice* device_2 = repo.AddDevice(std::make_unique<FastPairDevice>(
+      kModelId, "11:22:33:44:55:66", Protocol::kFastPairInitialPairing));
+  repo.AddDevice(std::make_unique<FastPairDevice>(
+      "654321", "22:33:44:55:66:77", Protocol::kFastPairInitialPairing));
+
+  EXPECT_THAT(repo.FindDevicesWithModelId(kModelId),
+              ElementsAre(device_1, device_2));
+
+  repo.RemoveDevice(device_1);
+
+  EXPECT_THAT(repo.FindDevicesWithModelId(kModelId), ElementsAre(device_2));
+  executor.Shutdown();
+}
+
 }  // namespace
 
 }  // namespace fastpair
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "fastpair/common/account_key.h"
 #include "fastpair/common/account_key_filter.h"
@@ -47,6 +48,13 @@ class FastPairRepository {
     virtual void OnGetUserSavedDevices(
         const proto::OptInStatus& opt_in_status,
         const std::vector<proto::FastPairDevice>& devices) = 0;
+
+    // Called when reading the user's saved devices from the server finds
+    // devices that were added or changed since the last read, or that are
+    // no longer saved to the account.
+    virtual void OnSavedDevicesChanged(
+        const std::vector<proto::FastPairDevice>& updated_devices,
+        const std::vector<AccountKey>& removed_account_keys) {}
   };
 
   static FastPairRepository* Get();
@@ -14,67 +14,73 @@
 
 #include "fastpair/repository/fast_pair_repository_impl.h"
 
+#include <filesystem>  // NOLINT(build/c++17)
 #include <memory>
 #include <optional>
 #include <string>
+#include <system_error>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "fastpair/common/device_metadata.h"
 #include "fastpair/proto/data.proto.h"
 #include "fastpair/proto/enum.proto.h"
 #include "fastpair/proto/proto_builder.h"
+#include "fastpair/repository/device_metadata_cache.h"
+#include "fastpair/repository/saved_device_index.h"
+#include "internal/account/account_manager.h"
 #include "internal/platform/logging.h"
+#include "internal/platform/mutex_lock.h"
 #include "internal/platform/single_thread_executor.h"
+#include "internal/platform/system_clock.h"
 
 namespace nearby {
 namespace fastpair {
 
 namespace {
-// This forget pattern is defined in the Android codebase as FORGET_PREFIX_BYTE
-// and FORGET_PREFIX_LENGTH_IN_BYTES. Currently, those values evaluate to the
-// string of bytes defined below, which is used as the prefix for the sha256
-// field of the device.
-constexpr absl::string_view kForgetPattern = "\xf0\xf0\xf0\xf0";
+// How long the local copy of the user's saved devices is used before it is
+// read from the server again, even if it has the device being looked for. An
+// older copy isn't matched against while the server can't be reached, as the
+// devices may have been removed from the account meanwhile.
+constexpr absl::Duration kSavedDevicesMaxAge = absl::Minutes(30);
 
-// For all intents and purposes, a device that has the "Forget pattern" is no
-// longer associated to the user's account, and should be treated as removed.
-bool DoesDeviceHaveForgetPattern(const proto::FastPairDevice& device) {
-  // The device info is modified to have no account key upon removal from
-  // Fast Pair Saved Devices
-  if (device.account_key().empty() ||
-      device.sha256_account_key_public_address().empty()) {
-    return true;
-  }
-
-  // To match Android behavior, we check if the SHA256 of a device begins with
-  // the Forget pattern, defined in Android Fast Pair code. When a device is
-  // forgotten from Android Bluetooth Settings, the SHA256 hash is modified to
-  // contain this pattern.
-  return (device.sha256_account_key_public_address().compare(
-              0, kForgetPattern.length(), kForgetPattern) == 0);
-}
+// The saved devices of an account are kept in a file named after the account.
+constexpr absl::string_view kSavedDevicesFilePrefix = "saved_devices_";
+constexpr absl::string_view kSavedDevicesFileExtension = ".pb";
 
-// Checks if the mac address of a FastPairDevice is the same as the given
-// |mac_address| by checking if the SHA256 from the given |device| equals to
-// SHA256(concat(account_key of |device|, |mac_address|)).
-bool IsDeviceSha256Matched(const proto::FastPairDevice& device,
-                           absl::string_view mac_address) {
-  if (DoesDeviceHaveForgetPattern(device)) {
-    return false;
-  }
+// How often the user's saved devices may be read from the server because an
+// advertisement didn't match any of them. Advertisements of devices that
+// aren't saved to the account never match, and there may be many of them.
+constexpr absl::Duration kMinSavedDevicesReadInterval = absl::Minutes(1);
 
-  return device.sha256_account_key_public_address() ==
-         FastPairRepository::GenerateSha256OfAccountKeyAndMacAddress(
-             AccountKey(device.account_key()), mac_address);
-}
+// How long cached device metadata is used before it is fetched from the server
+// again. Expired metadata is still used while the server can't be reached.
+constexpr absl::Duration kDeviceMetadataMaxAge = absl::Hours(24);
 }  // namespace
 
 FastPairRepositoryImpl::FastPairRepositoryImpl(FastPairClient* fast_pair_client)
     : fast_pair_client_(fast_pair_client) {}
 
+FastPairRepositoryImpl::FastPairRepositoryImpl(
+    FastPairClient* fast_pair_client, AccountManager* account_manager,
+    std::filesystem::path saved_devices_directory,
+    std::filesystem::path device_metadata_directory)
+    : fast_pair_client_(fast_pair_client),
+      account_manager_(account_manager),
+      saved_devices_directory_(std::move(saved_devices_directory)),
+      device_metadata_(std::move(device_metadata_directory)) {}
+
+FastPairRepositoryImpl::~FastPairRepositoryImpl() {
+  // Tasks in flight use the members declared after `executor_`.
+  executor_.Shutdown();
+}
+
 void FastPairRepositoryImpl::AddObserver(Observer* observer) {
   observers_.AddObserver(observer);
 }
@@ -86,27 +92,33 @@ void FastPairRepositoryImpl::RemoveObserver(Observer* observer) {
 void FastPairRepositoryImpl::GetDeviceMetadata(
     absl::string_view hex_model_id, DeviceMetadataCallback callback) {
   NEARBY_LOGS(INFO) << __func__ << " with model id= " << hex_model_id;
+  // Lookups of the same model in another case join each other, like they
+  // share the cached metadata.
+  std::string model_id = DeviceMetadataCache::NormalizeModelId(hex_model_id);
+  {
+    MutexLock lock(&metadata_callbacks_mutex_);
+    std::vector<DeviceMetadataCallback>& callbacks =
+        metadata_callbacks_[model_id];
+    callbacks.push_back(std::move(callback));
+    if (callbacks.size() > 1) {
+      NEARBY_LOGS(VERBOSE) << __func__ << ": Joined the lookup in flight.";
+      return;
+    }
+  }
   executor_.Execute(
-      "Get Device Metadata", [this, hex_model_id = std::string(hex_model_id),
-                              callback = std::move(callback)]() mutable {
-        NEARBY_LOGS(INFO) << __func__ << ": Start to get devic metadata.";
-        proto::GetObservedDeviceRequest request;
-        int64_t device_id;
-        CHECK(absl::SimpleHexAtoi(hex_model_id, &device_id));
-        request.set_device_id(device_id);
-        request.set_mode(proto::GetObservedDeviceRequest::MODE_RELEASE);
-        absl::StatusOr<proto::GetObservedDeviceResponse> response =
-            fast_pair_client_->GetObservedDevice(request);
-        if (response.ok()) {
-          NEARBY_LOGS(WARNING) << "Got GetObservedDeviceResponse from backend.";
-          metadata_cache_[hex_model_id] =
-              std::make_unique<DeviceMetadata>(response.value());
-          // TODO(b/289139378) : save device's metadata in local cache.
-          callback(*metadata_cache_[hex_model_id]);
-        } else {
-          NEARBY_LOGS(WARNING)
-              << "Failed to get GetObservedDeviceResponse from backend.";
-          callback(std::nullopt);
+      "Get Device Metadata",
+      [this, model_id = std::move(model_id)]() {
+        std::optional<DeviceMetadata> device_metadata =
+            LookUpDeviceMetadata(model_id);
+        std::vector<DeviceMetadataCallback> callbacks;
+        {
+          MutexLock lock(&metadata_callbacks_mutex_);
+          auto it = metadata_callbacks_.find(model_id);
+          callbacks = std::move(it->second);
+          metadata_callbacks_.erase(it);
+        }
+        for (DeviceMetadataCallback& callback : callbacks) {
+          callback(device_metadata);
         }
       });
 }
@@ -127,6 +139,8 @@ void FastPairRepositoryImpl::WriteAccountAssociationToFootprints(
         if (response.ok()) {
           NEARBY_LOGS(INFO)
               << __func__ << "Got GetWriteDeviceResponse from backend.";
+          // Let the next lookup read the new device from the server.
+          saved_devices_read_time_ = absl::InfinitePast();
           std::move(callback)(absl::OkStatus());
         } else {
           NEARBY_LOGS(WARNING)
@@ -143,11 +157,12 @@ void FastPairRepositoryImpl::DeleteAssociatedDeviceByAccountKey(
   absl::AsciiStrToUpper(&hex_string);
   executor_.Execute(
       "Delete associated device",
-      [this, hex_account_key = std::move(hex_string),
+      [this, account_key, hex_account_key = std::move(hex_string),
        callback = std::move(callback)]() mutable {
         NEARBY_LOGS(INFO)
             << __func__
             << ": Start to delete account associated device from footprints";
+        UpdateSavedDevicesAccount();
         proto::UserDeleteDeviceRequest request;
         request.set_hex_account_key(hex_account_key);
         absl::StatusOr<proto::UserDeleteDeviceResponse> response =
@@ -156,6 +171,7 @@ void FastPairRepositoryImpl::DeleteAssociatedDeviceByAccountKey(
           if (response->success()) {
             NEARBY_LOGS(INFO)
                 << __func__ << "Successfully deleted associated device.";
+            saved_devices_.Remove(account_key);
             std::move(callback)(absl::OkStatus());
           } else {
             NEARBY_LOGS(WARNING) << __func__ << "Failed to delete device.";
@@ -175,36 +191,17 @@ void FastPairRepositoryImpl::GetUserSavedDevices() {
   executor_.Execute("Get associated devices", [this]() mutable {
     NEARBY_LOGS(INFO) << __func__
                       << ": Start to get all account associated devices.";
-    proto::UserReadDevicesRequest request;
-    absl::StatusOr<proto::UserReadDevicesResponse> response =
-        fast_pair_client_->UserReadDevices(request);
-    if (!response.ok()) {
-      NEARBY_LOGS(WARNING)
-          << __func__ << "Failed to get UserReadDevicesResponse from backend.";
+    UpdateSavedDevicesAccount();
+    if (!ReadSavedDevices().ok()) {
       return;
     }
-    NEARBY_LOGS(INFO) << __func__
-                      << "Got UserReadDevicesResponse from backend.";
-    proto::OptInStatus opt_in_status =
-        proto::OptInStatus::OPT_IN_STATUS_UNKNOWN;
-    std::vector<proto::FastPairDevice> saved_devices;
-    for (const auto& info : response->fast_pair_info()) {
-      if (info.has_opt_in_status()) {
-        opt_in_status = info.opt_in_status();
-      }
-      // We have to check that the devices in Footprints don't use the
-      // "forget pattern" which Android uses in some cases to mark a device
-      // as removed from the user's account.
-      if (!info.has_device() || DoesDeviceHaveForgetPattern(info.device())) {
-        continue;
-      }
-      saved_devices.push_back(info.device());
-    }
+    std::vector<proto::FastPairDevice> saved_devices =
+        saved_devices_.GetSavedDevices();
     NEARBY_LOGS(INFO) << __func__ << ": Got " << saved_devices.size()
                       << " saved devices.";
-    // TODO(b/289139378) : save device's in local cache.
     for (auto& observer : observers_.GetObservers()) {
-      observer->OnGetUserSavedDevices(opt_in_status, saved_devices);
+      observer->OnGetUserSavedDevices(saved_devices_.opt_in_status(),
+                                      saved_devices);
     }
   });
 }
@@ -218,26 +215,21 @@ void FastPairRepositoryImpl::CheckIfAssociatedWithCurrentAccount(
                                                  callback)]() mutable {
     NEARBY_LOGS(INFO) << __func__
                       << ": Start to check if associated with current account.";
-    proto::UserReadDevicesRequest request;
-    absl::StatusOr<proto::UserReadDevicesResponse> response =
-        fast_pair_client_->UserReadDevices(request);
-    if (response.ok()) {
-      for (const auto& info : response->fast_pair_info()) {
-        if (!info.has_device()) {
-          continue;
-        }
-        AccountKey account_key(info.device().account_key());
-        if (!account_key_filter.IsPossiblyInSet(account_key)) {
-          continue;
-        }
-        proto::StoredDiscoveryItem device;
-        if (device.ParseFromString(info.device().discovery_item_bytes())) {
-          NEARBY_LOGS(INFO)
-              << "Account key matched with a paired device: " << device.title();
-          std::move(callback)(account_key, device.id());
-          return;
-        }
-      }
+    UpdateSavedDevicesAccount();
+    std::optional<SavedDeviceIndex::Match> match =
+        saved_devices_.FindMatch(account_key_filter);
+    if (ShouldReadSavedDevices(match.has_value()) &&
+        ReadSavedDevices().ok()) {
+      match = saved_devices_.FindMatch(account_key_filter);
+    }
+    if (match.has_value() && !AreSavedDevicesFresh()) {
+      NEARBY_LOGS(INFO) << __func__
+                        << ": Ignoring a match with outdated saved devices.";
+      match = std::nullopt;
+    }
+    if (match.has_value()) {
+      std::move(callback)(match->account_key, match->model_id);
+      return;
     }
     NEARBY_LOGS(INFO) << "Account key does not match any paired devices.";
     std::move(callback)(std::nullopt, std::nullopt);
@@ -252,30 +244,145 @@ void FastPairRepositoryImpl::IsDeviceSavedToAccount(
        callback = std::move(callback)]() mutable {
         NEARBY_LOGS(INFO) << __func__
                           << ": Start to check is device saved to account.";
-        proto::UserReadDevicesRequest request;
-        absl::StatusOr<proto::UserReadDevicesResponse> response =
-            fast_pair_client_->UserReadDevices(request);
-        if (!response.ok()) {
-          NEARBY_LOGS(WARNING)
-              << __func__
-              << "Failed to get UserDeleteDeviceResponse from backend.";
-          std::move(callback)(response.status());
-          return;
+        UpdateSavedDevicesAccount();
+        bool found = saved_devices_.ContainsMacAddress(mac_address);
+        absl::Status status = absl::OkStatus();
+        if (ShouldReadSavedDevices(found)) {
+          status = ReadSavedDevices();
+          found = saved_devices_.ContainsMacAddress(mac_address);
         }
-        for (const auto& info : response->fast_pair_info()) {
-          if (info.has_device() &&
-              IsDeviceSha256Matched(info.device(), mac_address)) {
-            NEARBY_LOGS(VERBOSE)
-                << __func__ << ": found a SHA256 match for device at address = "
-                << mac_address;
-            std::move(callback)(absl::OkStatus());
-            return;
+        if (!AreSavedDevicesFresh()) {
+          found = false;
+          if (status.ok()) {
+            status = absl::UnavailableError("Saved devices are outdated.");
           }
         }
+        if (found) {
+          NEARBY_LOGS(VERBOSE)
+              << __func__ << ": found a SHA256 match for device at address = "
+              << mac_address;
+          std::move(callback)(absl::OkStatus());
+          return;
+        }
+        if (!status.ok()) {
+          std::move(callback)(status);
+          return;
+        }
         std::move(callback)(absl::NotFoundError("Device " + mac_address +
                                                 " is not saved to account."));
       });
 }
 
+std::string FastPairRepositoryImpl::GetCurrentAccountId() const {
+  std::optional<AccountManager::Account> account =
+      account_manager_->GetCurrentAccount();
+  return account.has_value() ? account->id : std::string();
+}
+
+void FastPairRepositoryImpl::UpdateSavedDevicesAccount() {
+  if (account_manager_ == nullptr) {
+    return;
+  }
+  std::string account_id = GetCurrentAccountId();
+  if (saved_devices_account_id_ == account_id) {
+    return;
+  }
+  NEARBY_LOGS(INFO) << __func__ << ": Switching saved devices to "
+                    << (account_id.empty() ? "no account" : "a new account");
+  saved_devices_account_id_ = account_id;
+  std::optional<std::filesystem::path> file_path;
+  if (!account_id.empty()) {
+    file_path = *saved_devices_directory_ /
+                absl::StrCat(kSavedDevicesFilePrefix,
+                             absl::BytesToHexString(account_id),
+                             kSavedDevicesFileExtension);
+  }
+  // Files of accounts signed out of in an earlier run aren't needed anymore.
+  std::error_code error;
+  for (const auto& entry : std::filesystem::directory_iterator(
+           *saved_devices_directory_, error)) {
+    if (!file_path.has_value() || entry.path() != *file_path) {
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+  SavedDeviceIndex::Changes changes = saved_devices_.SetFile(file_path);
+  saved_devices_read_time_ = absl::InfinitePast();
+  if (!changes.empty()) {
+    for (auto& observer : observers_.GetObservers()) {
+      observer->OnSavedDevicesChanged(changes.updated_devices,
+                                      changes.removed_account_keys);
+    }
+  }
+}
+
+absl::Status FastPairRepositoryImpl::ReadSavedDevices() {
+  saved_devices_read_time_ = SystemClock::ElapsedRealtime();
+  proto::UserReadDevicesRequest request;
+  absl::StatusOr<proto::UserReadDevicesResponse> response =
+      fast_pair_client_->UserReadDevices(request);
+  if (!response.ok()) {
+    NEARBY_LOGS(WARNING) << __func__
+                         << ": Failed to get UserReadDevicesResponse from "
+                            "backend.";
+    return response.status();
+  }
+  if (account_manager_ != nullptr &&
+      saved_devices_account_id_ != GetCurrentAccountId()) {
+    // The response may be of the new account; the next lookup reads again.
+    NEARBY_LOGS(INFO) << __func__ << ": Account changed while reading.";
+    saved_devices_read_time_ = absl::InfinitePast();
+    return absl::AbortedError("Account changed while reading saved devices.");
+  }
+  NEARBY_LOGS(INFO) << __func__ << ": Got UserReadDevicesResponse from backend.";
+  SavedDeviceIndex::Changes changes = saved_devices_.Update(*response);
+  if (!changes.empty()) {
+    for (auto& observer : observers_.GetObservers()) {
+      observer->OnSavedDevicesChanged(changes.updated_devices,
+                                      changes.removed_account_keys);
+    }
+  }
+  return absl::OkStatus();
+}
+
+std::optional<DeviceMetadata> FastPairRepositoryImpl::LookUpDeviceMetadata(
+    absl::string_view hex_model_id) {
+  absl::Time now = absl::Now();
+  const DeviceMetadataCache::Entry* cached = device_metadata_.Get(hex_model_id);
+  if (cached != nullptr && now - cached->fetch_time < kDeviceMetadataMaxAge) {
+    return cached->metadata;
+  }
+  NEARBY_LOGS(INFO) << __func__ << ": Start to get devic metadata.";
+  proto::GetObservedDeviceRequest request;
+  int64_t device_id;
+  CHECK(absl::SimpleHexAtoi(hex_model_id, &device_id));
+  request.set_device_id(device_id);
+  request.set_mode(proto::GetObservedDeviceRequest::MODE_RELEASE);
+  absl::StatusOr<proto::GetObservedDeviceResponse> response =
+      fast_pair_client_->GetObservedDevice(request);
+  if (response.ok()) {
+    NEARBY_LOGS(WARNING) << "Got GetObservedDeviceResponse from backend.";
+    return device_metadata_.Put(hex_model_id, *std::move(response), now)
+        .metadata;
+  }
+  NEARBY_LOGS(WARNING)
+      << "Failed to get GetObservedDeviceResponse from backend.";
+  if (cached != nullptr) {
+    NEARBY_LOGS(INFO) << __func__ << ": Using expired device metadata.";
+    return cached->metadata;
+  }
+  return std::nullopt;
+}
+
+bool FastPairRepositoryImpl::AreSavedDevicesFresh() const {
+  return absl::Now() - saved_devices_.update_time() < kSavedDevicesMaxAge;
+}
+
+bool FastPairRepositoryImpl::ShouldReadSavedDevices(bool found_match) const {
+  absl::Duration age =
+      SystemClock::ElapsedRealtime() - saved_devices_read_time_;
+  return age >= kSavedDevicesMaxAge ||
+         (!found_match && age >= kMinSavedDevicesReadInterval);
+}
+
 }  // namespace fastpair
 }  // namespace nearby
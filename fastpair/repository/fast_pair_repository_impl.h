@@ -15,14 +15,25 @@
 #ifndef THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_FAST_PAIR_REPOSITORY_IMPL_H_
 #define THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_FAST_PAIR_REPOSITORY_IMPL_H_
 
+#include <filesystem>  // NOLINT(build/c++17)
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "fastpair/common/device_metadata.h"
+#include "fastpair/repository/device_metadata_cache.h"
 #include "fastpair/repository/fast_pair_repository.h"
+#include "fastpair/repository/saved_device_index.h"
 #include "fastpair/server_access/fast_pair_client.h"
+#include "internal/account/account_manager.h"
 #include "internal/base/observer_list.h"
+#include "internal/platform/mutex.h"
 #include "internal/platform/single_thread_executor.h"
 
 namespace nearby {
@@ -30,11 +41,21 @@ namespace fastpair {
 
 class FastPairRepositoryImpl : public FastPairRepository {
  public:
+  // The user's saved devices and device metadata are only kept in memory.
   explicit FastPairRepositoryImpl(FastPairClient* fast_pair_client);
+  // The saved devices of the account signed in to `account_manager` are also
+  // kept in a file of that account in `saved_devices_directory`, and device
+  // metadata in `device_metadata_directory`, so neither has to be fetched from
+  // the server right after a restart. When the account changes, the saved
+  // devices of the previous account are forgotten.
+  FastPairRepositoryImpl(FastPairClient* fast_pair_client,
+                         AccountManager* account_manager,
+                         std::filesystem::path saved_devices_directory,
+                         std::filesystem::path device_metadata_directory);
 
   FastPairRepositoryImpl(const FastPairRepositoryImpl&) = delete;
   FastPairRepositoryImpl& operator=(const FastPairRepositoryImpl&) = delete;
-  ~FastPairRepositoryImpl() override = default;
+  ~FastPairRepositoryImpl() override;
 
   void AddObserver(Observer* observer) override;
   void RemoveObserver(Observer* observer) override;
@@ -58,11 +79,55 @@ class FastPairRepositoryImpl : public FastPairRepository {
                               OperationCallback callback) override;
 
  private:
+  // Returns the metadata of the model from `device_metadata_`, or from the
+  // server if it isn't cached or has expired. Runs on `executor_`.
+  std::optional<DeviceMetadata> LookUpDeviceMetadata(
+      absl::string_view hex_model_id);
+
+  // Returns the ID of the signed in account, or an empty string if there is
+  // none.
+  std::string GetCurrentAccountId() const;
+
+  // Switches `saved_devices_` to the file of the signed in account if the
+  // account changed, and tells the observers about the devices that were
+  // forgotten. Does nothing without `account_manager_`. Runs on `executor_`.
+  void UpdateSavedDevicesAccount();
+
+  // Reads the user's saved devices from the server into `saved_devices_`, and
+  // tells the observers what changed. Runs on `executor_`.
+  absl::Status ReadSavedDevices();
+
+  // Returns true if `saved_devices_` was read from the server recently enough
+  // to be matched against while the server can't be reached. Runs on
+  // `executor_`.
+  bool AreSavedDevicesFresh() const;
+
+  // Returns true if `saved_devices_` should be read from the server again
+  // before relying on it. `found_match` tells whether the local copy already
+  // had the device being looked for. Runs on `executor_`.
+  bool ShouldReadSavedDevices(bool found_match) const;
+
   // A thread for running blocking tasks.
   SingleThreadExecutor executor_;
   FastPairClient* fast_pair_client_;
-  absl::flat_hash_map<std::string, std::unique_ptr<DeviceMetadata>>
-      metadata_cache_;
+  AccountManager* account_manager_ = nullptr;
+  const std::optional<std::filesystem::path> saved_devices_directory_;
+  // Only accessed on `executor_`.
+  SavedDeviceIndex saved_devices_;
+  // The account `saved_devices_` belongs to; empty when signed out, unset
+  // before the account was first looked up.
+  std::optional<std::string> saved_devices_account_id_;
+  // When `saved_devices_` was last read from the server, successfully or not.
+  absl::Time saved_devices_read_time_ = absl::InfinitePast();
+  // Only accessed on `executor_`.
+  DeviceMetadataCache device_metadata_;
+  Mutex metadata_callbacks_mutex_;
+  // Callbacks waiting for the metadata of a model, by hex model ID normalized
+  // like `device_metadata_` does. A model has an entry while a lookup for it
+  // is scheduled on `executor_`; later calls for the model join that lookup
+  // instead of fetching again.
+  absl::flat_hash_map<std::string, std::vector<DeviceMetadataCallback>>
+      metadata_callbacks_ ABSL_GUARDED_BY(metadata_callbacks_mutex_);
   ObserverList<FastPairRepository::Observer> observers_;
 };
 }  // namespace fastpair
@@ -14,6 +14,9 @@
 
 #include "fastpair/repository/fast_pair_repository_impl.h"
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
 #include <memory>
 #include <optional>
 #include <string>
@@ -23,12 +26,19 @@
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "fastpair/common/device_metadata.h"
+#include "fastpair/common/fast_pair_prefs.h"
 #include "fastpair/proto/data.proto.h"
 #include "fastpair/proto/fast_pair_string.proto.h"
 #include "fastpair/proto/proto_builder.h"
 #include "fastpair/server_access/fake_fast_pair_client.h"
+#include "internal/account/account_manager.h"
+#include "internal/account/fake_account_manager.h"
 #include "internal/platform/count_down_latch.h"
+#include "internal/platform/task_runner_impl.h"
+#include "internal/preferences/preferences_manager.h"
+#include "internal/test/google3_only/fake_authentication_manager.h"
 
 namespace nearby {
 namespace fastpair {
@@ -43,6 +53,10 @@ constexpr absl::string_view kInitialPairingdescription =
 constexpr absl::string_view kExpectedSha256Hash =
     "6353c0075a35b7d81bb30a6190ab246da4b8c55a6111d387400579133c090ed8";
 constexpr absl::Duration kWaitTimeout = absl::Milliseconds(200);
+constexpr absl::string_view kFastPairPreferencesFilePath =
+    "Google/Nearby/FastPair";
+constexpr absl::string_view kTestAccountId = "test_account_id";
+constexpr absl::string_view kOtherTestAccountId = "other_test_account_id";
 
 // A gMock matcher to match proto values. Use this matcher like:
 // request/response proto, expected_proto;
@@ -72,9 +86,52 @@ class FastPairRepositoryObserver : public FastPairRepository::Observer {
     latch_->CountDown();
   }
 
+  void OnSavedDevicesChanged(
+      const std::vector<proto::FastPairDevice>& updated_devices,
+      const std::vector<AccountKey>& removed_account_keys) override {
+    updated_devices_ = updated_devices;
+    removed_account_keys_ = removed_account_keys;
+  }
+
   CountDownLatch* latch_ = nullptr;
   proto::OptInStatus opt_in_status_;
   std::vector<proto::FastPairDevice> devices_;
+  std::vector<proto::FastPairDevice> updated_devices_;
+  std::vector<AccountKey> removed_account_keys_;
+};
+
+// A FakeAccountManager with `kTestAccountId` signed in.
+class TestAccountManager {
+ public:
+  TestAccountManager() {
+    task_runner_ = std::make_unique<TaskRunnerImpl>(1);
+    preferences_manager_ = std::make_unique<preferences::PreferencesManager>(
+        kFastPairPreferencesFilePath);
+    authentication_manager_ = std::make_unique<FakeAuthenticationManager>();
+    account_manager_ = std::make_unique<FakeAccountManager>(
+        preferences_manager_.get(), prefs::kNearbyFastPairUsersName,
+        authentication_manager_.get(), task_runner_.get());
+    SetAccountId(kTestAccountId);
+  }
+
+  FakeAccountManager* get() { return account_manager_.get(); }
+
+  // Signs in the account with `account_id`, or signs out if it is nullopt.
+  void SetAccountId(std::optional<absl::string_view> account_id) {
+    if (!account_id.has_value()) {
+      account_manager_->SetAccount(std::nullopt);
+      return;
+    }
+    AccountManager::Account account;
+    account.id = std::string(*account_id);
+    account_manager_->SetAccount(account);
+  }
+
+ private:
+  std::unique_ptr<TaskRunner> task_runner_;
+  std::unique_ptr<preferences::PreferencesManager> preferences_manager_;
+  std::unique_ptr<auth::AuthenticationManager> authentication_manager_;
+  std::unique_ptr<FakeAccountManager> account_manager_;
 };
 
 TEST(FastPairRepositoryImplTest, MetadataDownloadSuccess) {
@@ -133,6 +190,91 @@ TEST(FastPairRepositoryImplTest, FailedToDownloadMetadata) {
   latch.Await();
 }
 
+TEST(FastPairRepositoryImplTest, FetchesMetadataOncePerModel) {
+  FakeFastPairClient fake_fast_pair_client;
+  FastPairRepositoryImpl fast_pair_repository(&fake_fast_pair_client);
+  proto::GetObservedDeviceResponse response_proto;
+  response_proto.mutable_strings()->set_initial_pairing_description(
+      kInitialPairingdescription);
+  fake_fast_pair_client.SetGetObservedDeviceResponse(response_proto);
+
+  // Concurrent lookups either join the one in flight or find the metadata in
+  // the cache.
+  CountDownLatch latch(3);
+  for (int i = 0; i < 3; ++i) {
+    fast_pair_repository.GetDeviceMetadata(
+        kHexModelId, [&](std::optional<DeviceMetadata> device_metadata) {
+          EXPECT_TRUE(device_metadata.has_value());
+          latch.CountDown();
+        });
+  }
+  latch.Await();
+
+  EXPECT_EQ(fake_fast_pair_client.get_observed_device_count(), 1);
+}
+
+TEST(FastPairRepositoryImplTest, ModelIdCaseDoesNotCauseAnotherFetch) {
+  FakeFastPairClient fake_fast_pair_client;
+  FastPairRepositoryImpl fast_pair_repository(&fake_fast_pair_client);
+  proto::GetObservedDeviceResponse response_proto;
+  fake_fast_pair_client.SetGetObservedDeviceResponse(response_proto);
+
+  CountDownLatch latch(2);
+  for (absl::string_view hex_model_id : {"718c17", "718C17"}) {
+    fast_pair_repository.GetDeviceMetadata(
+        hex_model_id, [&](std::optional<DeviceMetadata> device_metadata) {
+          EXPECT_TRUE(device_metadata.has_value());
+          latch.CountDown();
+        });
+  }
+  latch.Await();
+
+  EXPECT_EQ(fake_fast_pair_client.get_observed_device_count(), 1);
+}
+
+TEST(FastPairRepositoryImplTest, LoadsMetadataFromDirectory) {
+  std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                    "fast_pair_repository_impl_test" /
+                                    "device_metadata";
+  std::filesystem::remove_all(directory);
+  FakeFastPairClient fake_fast_pair_client;
+  proto::GetObservedDeviceResponse response_proto;
+  response_proto.set_image("image");
+  fake_fast_pair_client.SetGetObservedDeviceResponse(response_proto);
+  TestAccountManager account_manager;
+  std::filesystem::path saved_devices_directory =
+      directory.parent_path() / "saved_devices";
+  {
+    FastPairRepositoryImpl fast_pair_repository(
+        &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+        directory);
+    CountDownLatch latch(1);
+    fast_pair_repository.GetDeviceMetadata(
+        kHexModelId, [&](std::optional<DeviceMetadata> device_metadata) {
+          latch.CountDown();
+        });
+    latch.Await();
+  }
+
+  // After a restart, the metadata is there even while the server can't be
+  // reached.
+  fake_fast_pair_client.SetGetObservedDeviceResponse(
+      absl::InternalError("No response"));
+  FastPairRepositoryImpl fast_pair_repository(
+      &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+      directory);
+  CountDownLatch latch(1);
+  fast_pair_repository.GetDeviceMetadata(
+      kHexModelId, [&](std::optional<DeviceMetadata> device_metadata) {
+        ASSERT_TRUE(device_metadata.has_value());
+        EXPECT_EQ(device_metadata->GetResponse().image(), "image");
+        latch.CountDown();
+      });
+  latch.Await();
+  EXPECT_EQ(fake_fast_pair_client.get_observed_device_count(), 1);
+  std::filesystem::remove_all(directory);
+}
+
 TEST(FastPairRepositoryImplTest, GetUserSavedDevicesSuccess) {
   FakeFastPairClient fake_fast_pair_client;
   auto fast_pair_repository =
@@ -543,6 +685,262 @@ TEST(FastPairRepositoryImplTest, FailedToCheckDeviceIsSavedToCurrentAccount) {
                                                });
   latch.Await();
 }
+
+// Returns a response with a single device saved to the account.
+proto::UserReadDevicesResponse CreateUserReadDevicesResponse(
+    const std::vector<uint8_t>& account_key_bytes) {
+  proto::UserReadDevicesResponse response_proto;
+  FastPairDevice device(kHexModelId, kBleAddress,
+                        Protocol::kFastPairInitialPairing);
+  device.SetAccountKey(AccountKey(account_key_bytes));
+  device.SetPublicAddress(kPublicAddress);
+  device.SetDisplayName(kDisplayName);
+  proto::GetObservedDeviceResponse get_observed_device_response;
+  DeviceMetadata device_metadata(get_observed_device_response);
+  device.SetMetadata(device_metadata);
+  BuildFastPairInfo(response_proto.add_fast_pair_info(), device);
+  return response_proto;
+}
+
+// Returns the account key `CheckIfAssociatedWithCurrentAccount()` found.
+std::optional<AccountKey> CheckIfAssociated(
+    FastPairRepositoryImpl& fast_pair_repository,
+    AccountKeyFilter account_key_filter) {
+  std::optional<AccountKey> result;
+  CountDownLatch latch(1);
+  fast_pair_repository.CheckIfAssociatedWithCurrentAccount(
+      account_key_filter, [&](std::optional<AccountKey> cb_account_key,
+                              std::optional<absl::string_view> cb_model_id) {
+        result = cb_account_key;
+        latch.CountDown();
+      });
+  latch.Await();
+  return result;
+}
+
+TEST(FastPairRepositoryImplTest, ChecksAssociationWithoutReadingDevicesAgain) {
+  const std::vector<uint8_t> filter{0x02, 0x0C, 0x80, 0x2A};
+  const std::vector<uint8_t> salt{0xC7, 0xC8};
+  const std::vector<uint8_t> account_key_vec{0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                             0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                             0xCC, 0xDD, 0xEE, 0xFF};
+  FakeFastPairClient fake_fast_pair_client;
+  FastPairRepositoryImpl fast_pair_repository(&fake_fast_pair_client);
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(account_key_vec));
+
+  EXPECT_EQ(CheckIfAssociated(fast_pair_repository,
+                              AccountKeyFilter(filter, salt)),
+            AccountKey(account_key_vec));
+
+  // The saved devices are matched locally from now on.
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      absl::InternalError("No response"));
+  EXPECT_EQ(CheckIfAssociated(fast_pair_repository,
+                              AccountKeyFilter(filter, salt)),
+            AccountKey(account_key_vec));
+}
+
+TEST(FastPairRepositoryImplTest, ReadsDevicesAgainAfterWritingAssociation) {
+  const std::vector<uint8_t> filter{0x02, 0x0C, 0x80, 0x2A};
+  const std::vector<uint8_t> salt{0xC7, 0xC8};
+  const std::vector<uint8_t> account_key_vec{0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                             0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                             0xCC, 0xDD, 0xEE, 0xFF};
+  const std::vector<uint8_t> other_account_key_vec{
+      0x11, 0x11, 0x22, 0x22, 0x33, 0x33, 0x44, 0x44,
+      0x55, 0x55, 0x66, 0x66, 0x77, 0x77, 0x88, 0x88};
+  FakeFastPairClient fake_fast_pair_client;
+  FastPairRepositoryImpl fast_pair_repository(&fake_fast_pair_client);
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(other_account_key_vec));
+  EXPECT_FALSE(CheckIfAssociated(fast_pair_repository,
+                                 AccountKeyFilter(filter, salt))
+                   .has_value());
+
+  // A miss right after reading the devices doesn't read them again.
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(account_key_vec));
+  EXPECT_FALSE(CheckIfAssociated(fast_pair_repository,
+                                 AccountKeyFilter(filter, salt))
+                   .has_value());
+
+  // Saving a device to the account does.
+  fake_fast_pair_client.SetUserWriteDeviceResponse(
+      proto::UserWriteDeviceResponse());
+  FastPairDevice fast_pair_device(kHexModelId, kBleAddress,
+                                  Protocol::kFastPairInitialPairing);
+  fast_pair_device.SetAccountKey(AccountKey(account_key_vec));
+  fast_pair_device.SetPublicAddress(kPublicAddress);
+  fast_pair_device.SetMetadata(
+      DeviceMetadata(proto::GetObservedDeviceResponse()));
+  CountDownLatch latch(1);
+  fast_pair_repository.WriteAccountAssociationToFootprints(
+      fast_pair_device, [&](absl::Status status) {
+        EXPECT_OK(status);
+        latch.CountDown();
+      });
+  latch.Await();
+
+  EXPECT_EQ(CheckIfAssociated(fast_pair_repository,
+                              AccountKeyFilter(filter, salt)),
+            AccountKey(account_key_vec));
+}
+
+TEST(FastPairRepositoryImplTest, LoadsSavedDevicesFromFile) {
+  const std::vector<uint8_t> filter{0x02, 0x0C, 0x80, 0x2A};
+  const std::vector<uint8_t> salt{0xC7, 0xC8};
+  const std::vector<uint8_t> account_key_vec{0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                             0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                             0xCC, 0xDD, 0xEE, 0xFF};
+  std::filesystem::path saved_devices_directory =
+      std::filesystem::temp_directory_path() /
+      "fast_pair_repository_impl_test" / "saved_devices";
+  std::filesystem::path device_metadata_directory =
+      saved_devices_directory.parent_path() / "device_metadata";
+  std::filesystem::remove_all(saved_devices_directory);
+  TestAccountManager account_manager;
+  FakeFastPairClient fake_fast_pair_client;
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(account_key_vec));
+  {
+    FastPairRepositoryImpl fast_pair_repository(
+        &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+        device_metadata_directory);
+    EXPECT_TRUE(CheckIfAssociated(fast_pair_repository,
+                                  AccountKeyFilter(filter, salt))
+                    .has_value());
+  }
+
+  // After a restart, the device matches even while the server can't be
+  // reached.
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      absl::InternalError("No response"));
+  FastPairRepositoryImpl fast_pair_repository(
+      &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+      device_metadata_directory);
+  EXPECT_EQ(CheckIfAssociated(fast_pair_repository,
+                              AccountKeyFilter(filter, salt)),
+            AccountKey(account_key_vec));
+  std::filesystem::remove_all(saved_devices_directory);
+}
+
+TEST(FastPairRepositoryImplTest, IgnoresOutdatedSavedDevicesFile) {
+  const std::vector<uint8_t> filter{0x02, 0x0C, 0x80, 0x2A};
+  const std::vector<uint8_t> salt{0xC7, 0xC8};
+  const std::vector<uint8_t> account_key_vec{0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                             0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                             0xCC, 0xDD, 0xEE, 0xFF};
+  std::filesystem::path saved_devices_directory =
+      std::filesystem::temp_directory_path() /
+      "fast_pair_repository_impl_test" / "outdated_saved_devices";
+  std::filesystem::path device_metadata_directory =
+      saved_devices_directory.parent_path() / "device_metadata";
+  std::filesystem::remove_all(saved_devices_directory);
+  TestAccountManager account_manager;
+  FakeFastPairClient fake_fast_pair_client;
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(account_key_vec));
+  {
+    FastPairRepositoryImpl fast_pair_repository(
+        &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+        device_metadata_directory);
+    EXPECT_TRUE(CheckIfAssociated(fast_pair_repository,
+                                  AccountKeyFilter(filter, salt))
+                    .has_value());
+  }
+  for (const auto& entry :
+       std::filesystem::directory_iterator(saved_devices_directory)) {
+    std::filesystem::last_write_time(
+        entry.path(),
+        std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+  }
+
+  // The devices may have been removed from the account since.
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      absl::InternalError("No response"));
+  FastPairRepositoryImpl fast_pair_repository(
+      &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+      device_metadata_directory);
+  EXPECT_FALSE(CheckIfAssociated(fast_pair_repository,
+                                 AccountKeyFilter(filter, salt))
+                   .has_value());
+  CountDownLatch latch(1);
+  fast_pair_repository.IsDeviceSavedToAccount(
+      kPublicAddress, [&](absl::Status status) {
+        EXPECT_FALSE(status.ok());
+        latch.CountDown();
+      });
+  latch.Await();
+  std::filesystem::remove_all(saved_devices_directory);
+}
+
+TEST(FastPairRepositoryImplTest, ForgetsSavedDevicesOfPreviousAccount) {
+  const std::vector<uint8_t> filter{0x02, 0x0C, 0x80, 0x2A};
+  const std::vector<uint8_t> salt{0xC7, 0xC8};
+  const std::vector<uint8_t> account_key_vec{0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                                             0x77, 0x88, 0x99, 0x00, 0xAA, 0xBB,
+                                             0xCC, 0xDD, 0xEE, 0xFF};
+  std::filesystem::path saved_devices_directory =
+      std::filesystem::temp_directory_path() /
+      "fast_pair_repository_impl_test" / "account_saved_devices";
+  std::filesystem::path device_metadata_directory =
+      saved_devices_directory.parent_path() / "device_metadata";
+  std::filesystem::remove_all(saved_devices_directory);
+  TestAccountManager account_manager;
+  FakeFastPairClient fake_fast_pair_client;
+  FastPairRepositoryImpl fast_pair_repository(
+      &fake_fast_pair_client, account_manager.get(), saved_devices_directory,
+      device_metadata_directory);
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(account_key_vec));
+  EXPECT_TRUE(CheckIfAssociated(fast_pair_repository,
+                                AccountKeyFilter(filter, salt))
+                  .has_value());
+
+  // After signing out, the server can't be asked, and the previous account's
+  // devices don't match anymore.
+  CountDownLatch latch(1);
+  FastPairRepositoryObserver observer(&latch);
+  fast_pair_repository.AddObserver(&observer);
+  account_manager.SetAccountId(std::nullopt);
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      absl::InternalError("No account"));
+  EXPECT_FALSE(CheckIfAssociated(fast_pair_repository,
+                                 AccountKeyFilter(filter, salt))
+                   .has_value());
+  fast_pair_repository.RemoveObserver(&observer);
+  EXPECT_THAT(observer.removed_account_keys_,
+              testing::ElementsAre(AccountKey(account_key_vec)));
+  EXPECT_TRUE(std::filesystem::is_empty(saved_devices_directory));
+
+  // Another account starts without them too.
+  account_manager.SetAccountId(kOtherTestAccountId);
+  EXPECT_FALSE(CheckIfAssociated(fast_pair_repository,
+                                 AccountKeyFilter(filter, salt))
+                   .has_value());
+  std::filesystem::remove_all(saved_devices_directory);
+}
+
+TEST(FastPairRepositoryImplTest, NotifiesSavedDevicesChanges) {
+  FakeFastPairClient fake_fast_pair_client;
+  FastPairRepositoryImpl fast_pair_repository(&fake_fast_pair_client);
+  CountDownLatch latch(1);
+  FastPairRepositoryObserver observer(&latch);
+  fast_pair_repository.AddObserver(&observer);
+  fake_fast_pair_client.SetUserReadDevicesResponse(
+      CreateUserReadDevicesResponse(
+          std::vector<uint8_t>(kAccountKeySize, 0x11)));
+
+  fast_pair_repository.GetUserSavedDevices();
+  latch.Await();
+  fast_pair_repository.RemoveObserver(&observer);
+
+  ASSERT_EQ(observer.updated_devices_.size(), 1);
+  EXPECT_EQ(observer.updated_devices_[0].account_key(),
+            std::string(kAccountKeySize, 0x11));
+  EXPECT_TRUE(observer.removed_account_keys_.empty());
+}
 }  // namespace
 }  // namespace fastpair
 }  // namespace nearby
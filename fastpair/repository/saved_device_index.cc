@@ -0,0 +1,280 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/repository/saved_device_index.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+#include "fastpair/common/account_key_matcher.h"
+#include "fastpair/proto/data.proto.h"
+#include "fastpair/proto/enum.proto.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+#include "fastpair/repository/fast_pair_repository.h"
+#include "internal/platform/logging.h"
+
+namespace nearby {
+namespace fastpair {
+
+namespace {
+// This forget pattern is defined in the Android codebase as FORGET_PREFIX_BYTE
+// and FORGET_PREFIX_LENGTH_IN_BYTES. Currently, those values evaluate to the
+// string of bytes defined below, which is used as the prefix for the sha256
+// field of the device.
+constexpr absl::string_view kForgetPattern = "\xf0\xf0\xf0\xf0";
+
+// For all intents and purposes, a device that has the "Forget pattern" is no
+// longer associated to the user's account, and should be treated as removed.
+bool DoesDeviceHaveForgetPattern(const proto::FastPairDevice& device) {
+  // The device info is modified to have no account key upon removal from
+  // Fast Pair Saved Devices
+  if (device.account_key().empty() ||
+      device.sha256_account_key_public_address().empty()) {
+    return true;
+  }
+
+  // To match Android behavior, we check if the SHA256 of a device begins with
+  // the Forget pattern, defined in Android Fast Pair code. When a device is
+  // forgotten from Android Bluetooth Settings, the SHA256 hash is modified to
+  // contain this pattern.
+  return (device.sha256_account_key_public_address().compare(
+              0, kForgetPattern.length(), kForgetPattern) == 0);
+}
+
+// Checks if the mac address of a FastPairDevice is the same as the given
+// |mac_address| by checking if the SHA256 from the given |device| equals to
+// SHA256(concat(account_key of |device|, |mac_address|)).
+bool IsDeviceSha256Matched(const proto::FastPairDevice& device,
+                           absl::string_view mac_address) {
+  if (DoesDeviceHaveForgetPattern(device)) {
+    return false;
+  }
+
+  return device.sha256_account_key_public_address() ==
+         FastPairRepository::GenerateSha256OfAccountKeyAndMacAddress(
+             AccountKey(device.account_key()), mac_address);
+}
+}  // namespace
+
+SavedDeviceIndex::SavedDeviceIndex(std::filesystem::path file_path)
+    : file_path_(std::move(file_path)) {
+  Load();
+}
+
+SavedDeviceIndex::Changes SavedDeviceIndex::SetFile(
+    std::optional<std::filesystem::path> file_path) {
+  Changes changes;
+  for (const proto::FastPairDevice& device : GetSavedDevices()) {
+    changes.removed_account_keys.push_back(AccountKey(device.account_key()));
+  }
+  if (file_path_.has_value()) {
+    std::error_code error;
+    std::filesystem::remove(*file_path_, error);
+  }
+  file_path_ = std::move(file_path);
+  response_.Clear();
+  update_time_ = absl::InfinitePast();
+  BuildIndex();
+  if (file_path_.has_value()) {
+    Load();
+  }
+  return changes;
+}
+
+SavedDeviceIndex::Changes SavedDeviceIndex::Update(
+    const proto::UserReadDevicesResponse& response) {
+  update_time_ = absl::Now();
+  absl::flat_hash_map<std::string, std::string> old_devices;
+  for (const proto::FastPairDevice& device : GetSavedDevices()) {
+    old_devices[device.account_key()] = device.SerializeAsString();
+  }
+  std::string old_response = response_.SerializeAsString();
+  response_ = response;
+  BuildIndex();
+
+  Changes changes;
+  for (proto::FastPairDevice& device : GetSavedDevices()) {
+    auto it = old_devices.find(device.account_key());
+    if (it == old_devices.end()) {
+      changes.updated_devices.push_back(std::move(device));
+      continue;
+    }
+    if (it->second != device.SerializeAsString()) {
+      changes.updated_devices.push_back(std::move(device));
+    }
+    old_devices.erase(it);
+  }
+  for (const auto& [account_key, device] : old_devices) {
+    changes.removed_account_keys.push_back(AccountKey(account_key));
+  }
+  if (response_.SerializeAsString() != old_response) {
+    Save();
+  } else if (file_path_.has_value()) {
+    // The file's modification time tells how old the devices are on load.
+    std::error_code error;
+    std::filesystem::last_write_time(
+        *file_path_, std::filesystem::file_time_type::clock::now(), error);
+  }
+  return changes;
+}
+
+void SavedDeviceIndex::Remove(const AccountKey& account_key) {
+  if (!index_.contains(account_key.GetAsBytes())) {
+    return;
+  }
+  auto* infos = response_.mutable_fast_pair_info();
+  for (auto it = infos->begin(); it != infos->end();) {
+    if (it->has_device() &&
+        it->device().account_key() == account_key.GetAsBytes()) {
+      it = infos->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  BuildIndex();
+  Save();
+}
+
+std::vector<proto::FastPairDevice> SavedDeviceIndex::GetSavedDevices() const {
+  std::vector<proto::FastPairDevice> devices;
+  for (const auto& info : response_.fast_pair_info()) {
+    // We have to check that the devices in Footprints don't use the
+    // "forget pattern" which Android uses in some cases to mark a device
+    // as removed from the user's account.
+    if (!info.has_device() || DoesDeviceHaveForgetPattern(info.device())) {
+      continue;
+    }
+    devices.push_back(info.device());
+  }
+  return devices;
+}
+
+std::optional<SavedDeviceIndex::Match> SavedDeviceIndex::FindMatch(
+    const AccountKeyFilter& account_key_filter) const {
+  for (size_t index : matcher_.FindMatches(account_key_filter)) {
+    const Entry& entry = entries_[index];
+    if (!entry.discovery_item.has_value()) {
+      continue;
+    }
+    NEARBY_LOGS(INFO) << "Account key matched with a paired device: "
+                      << entry.discovery_item->title();
+    return Match{.account_key = AccountKey(entry.device.account_key()),
+                 .model_id = entry.discovery_item->id()};
+  }
+  return std::nullopt;
+}
+
+bool SavedDeviceIndex::ContainsMacAddress(absl::string_view mac_address) const {
+  for (const Entry& entry : entries_) {
+    if (IsDeviceSha256Matched(entry.device, mac_address)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SavedDeviceIndex::BuildIndex() {
+  entries_.clear();
+  index_.clear();
+  opt_in_status_ = proto::OptInStatus::OPT_IN_STATUS_UNKNOWN;
+  for (const auto& info : response_.fast_pair_info()) {
+    if (info.has_opt_in_status()) {
+      opt_in_status_ = info.opt_in_status();
+    }
+    if (!info.has_device() || info.device().account_key().empty()) {
+      continue;
+    }
+    if (!index_.emplace(info.device().account_key(), entries_.size())
+             .second) {
+      continue;
+    }
+    Entry entry{.device = info.device()};
+    proto::StoredDiscoveryItem discovery_item;
+    if (discovery_item.ParseFromString(info.device().discovery_item_bytes())) {
+      entry.discovery_item = std::move(discovery_item);
+    }
+    entries_.push_back(std::move(entry));
+  }
+  std::vector<AccountKey> account_keys;
+  account_keys.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    account_keys.push_back(AccountKey(entry.device.account_key()));
+  }
+  matcher_ = AccountKeyMatcher(account_keys);
+}
+
+void SavedDeviceIndex::Load() {
+  std::ifstream file(*file_path_, std::ios::binary);
+  if (!file.is_open()) {
+    return;
+  }
+  if (!response_.ParseFromIstream(&file)) {
+    NEARBY_LOGS(WARNING) << "Failed to parse saved devices from "
+                         << file_path_->string();
+    response_.Clear();
+    return;
+  }
+  std::error_code error;
+  std::filesystem::file_time_type write_time =
+      std::filesystem::last_write_time(*file_path_, error);
+  if (!error) {
+    update_time_ =
+        absl::Now() - absl::FromChrono(std::chrono::duration_cast<
+                                       std::chrono::nanoseconds>(
+                          std::filesystem::file_time_type::clock::now() -
+                          write_time));
+  }
+  BuildIndex();
+  NEARBY_LOGS(INFO) << "Loaded " << entries_.size() << " saved devices.";
+}
+
+void SavedDeviceIndex::Save() const {
+  if (!file_path_.has_value()) {
+    return;
+  }
+  std::error_code error;
+  std::filesystem::create_directories(file_path_->parent_path(), error);
+  // Write to a temporary file first, so a crash can't leave a partial file.
+  std::filesystem::path temp_path = *file_path_;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !response_.SerializeToOstream(&file)) {
+      NEARBY_LOGS(WARNING) << "Failed to write saved devices to "
+                           << temp_path.string();
+      return;
+    }
+  }
+  std::filesystem::rename(temp_path, *file_path_, error);
+  if (error) {
+    NEARBY_LOGS(WARNING) << "Failed to write saved devices to "
+                         << file_path_->string() << ": " << error.message();
+  }
+}
+
+}  // namespace fastpair
+}  // namespace nearby
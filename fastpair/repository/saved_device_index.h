@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_SAVED_DEVICE_INDEX_H_
+#define THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_SAVED_DEVICE_INDEX_H_
+
+#include <filesystem>  // NOLINT(build/c++17)
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+#include "fastpair/common/account_key_matcher.h"
+#include "fastpair/proto/data.proto.h"
+#include "fastpair/proto/enum.proto.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+
+namespace nearby {
+namespace fastpair {
+
+// Local copy of the devices saved to the user's account, as last read from
+// the Footprints server, indexed by account key.
+//
+// Matching an advertisement against the saved devices is then an in-memory
+// operation; the stored discovery items are parsed once, when the devices are
+// read, instead of for every advertisement. When given a file, the index is
+// loaded from it on construction and written back whenever it changes, so
+// matching works right after a restart, before the server has been asked.
+//
+// Not thread-safe.
+class SavedDeviceIndex {
+ public:
+  struct Match {
+    AccountKey account_key;
+    // The model ID from the device's stored discovery item.
+    std::string model_id;
+  };
+
+  // What an `Update()` changed.
+  struct Changes {
+    // New devices and devices whose data changed.
+    std::vector<proto::FastPairDevice> updated_devices;
+    std::vector<AccountKey> removed_account_keys;
+
+    bool empty() const {
+      return updated_devices.empty() && removed_account_keys.empty();
+    }
+  };
+
+  // Creates an index that is only kept in memory.
+  SavedDeviceIndex() = default;
+  // Creates an index that is kept in `file_path`, starting with the devices
+  // stored there, if any.
+  explicit SavedDeviceIndex(std::filesystem::path file_path);
+  SavedDeviceIndex(const SavedDeviceIndex&) = delete;
+  SavedDeviceIndex& operator=(const SavedDeviceIndex&) = delete;
+
+  // Forgets the saved devices, deleting the file they were kept in, and
+  // switches to `file_path`, starting with the devices stored there, if any.
+  // Used when the user's account changes. Returns the devices that were
+  // forgotten as removed.
+  Changes SetFile(std::optional<std::filesystem::path> file_path);
+
+  // Replaces the saved devices with the ones in `response`, and returns the
+  // difference.
+  Changes Update(const proto::UserReadDevicesResponse& response);
+
+  // Removes the device with `account_key`, e.g. after it was deleted from the
+  // user's account.
+  void Remove(const AccountKey& account_key);
+
+  // Returns when the saved devices were last read from the server, or
+  // `absl::InfinitePast()` if they never were.
+  absl::Time update_time() const { return update_time_; }
+
+  // Returns the user's opt-in status from the last update.
+  proto::OptInStatus opt_in_status() const { return opt_in_status_; }
+
+  // Returns the saved devices, leaving out the ones that were forgotten.
+  std::vector<proto::FastPairDevice> GetSavedDevices() const;
+
+  // Returns the first saved device, in server order, whose account key may be
+  // in `account_key_filter`.
+  std::optional<Match> FindMatch(
+      const AccountKeyFilter& account_key_filter) const;
+
+  // Returns true if a device with `mac_address` is saved to the account.
+  bool ContainsMacAddress(absl::string_view mac_address) const;
+
+ private:
+  struct Entry {
+    proto::FastPairDevice device;
+    // Parsed from `device.discovery_item_bytes()`; empty if that failed.
+    std::optional<proto::StoredDiscoveryItem> discovery_item;
+  };
+
+  void Load();
+  void Save() const;
+  // Rebuilds `entries_` and `index_` from `response_`.
+  void BuildIndex();
+
+  std::optional<std::filesystem::path> file_path_;
+  // The saved devices and the opt-in status, as they are persisted.
+  proto::UserReadDevicesResponse response_;
+  // When `response_` was read from the server. Taken from the file's
+  // modification time when loaded from a file.
+  absl::Time update_time_ = absl::InfinitePast();
+  proto::OptInStatus opt_in_status_ = proto::OptInStatus::OPT_IN_STATUS_UNKNOWN;
+  // Saved devices with an account key, in server order.
+  std::vector<Entry> entries_;
+  // Account key bytes to index in `entries_`.
+  absl::flat_hash_map<std::string, size_t> index_;
+  // The account keys of `entries_`, in the same order.
+  AccountKeyMatcher matcher_{{}};
+};
+
+}  // namespace fastpair
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_FASTPAIR_REPOSITORY_SAVED_DEVICE_INDEX_H_
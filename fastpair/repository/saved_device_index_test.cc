@@ -0,0 +1,258 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fastpair/repository/saved_device_index.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "fastpair/common/account_key.h"
+#include "fastpair/common/account_key_filter.h"
+#include "fastpair/common/device_metadata.h"
+#include "fastpair/common/fast_pair_device.h"
+#include "fastpair/common/protocol.h"
+#include "fastpair/proto/data.proto.h"
+#include "fastpair/proto/enum.proto.h"
+#include "fastpair/proto/fastpair_rpcs.proto.h"
+#include "fastpair/proto/proto_builder.h"
+
+namespace nearby {
+namespace fastpair {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+constexpr absl::string_view kHexModelId = "718C17";
+constexpr absl::string_view kBleAddress = "11:22:33:44:55:66";
+constexpr absl::string_view kPublicAddress = "20:64:DE:40:F8:93";
+constexpr absl::string_view kOtherPublicAddress = "20:64:DE:40:F8:94";
+constexpr absl::string_view kDisplayName = "Test Device";
+constexpr absl::string_view kOtherDisplayName = "Other Device";
+// Test data comes from:
+// https://developers.google.com/nearby/fast-pair/specifications/appendix/testcases#test_cases
+const std::vector<uint8_t> kFilter{0x02, 0x0C, 0x80, 0x2A};
+const std::vector<uint8_t> kSalt{0xC7, 0xC8};
+const std::vector<uint8_t> kMatchingAccountKey{
+    0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88,
+    0x99, 0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+const std::vector<uint8_t> kOtherAccountKey{0x11, 0x11, 0x22, 0x22, 0x33, 0x33,
+                                            0x44, 0x44, 0x55, 0x55, 0x66, 0x66,
+                                            0x77, 0x77, 0x88, 0x88};
+
+void AddDevice(proto::UserReadDevicesResponse& response,
+               const AccountKey& account_key,
+               absl::string_view public_address,
+               absl::string_view display_name) {
+  FastPairDevice device(kHexModelId, kBleAddress,
+                        Protocol::kFastPairInitialPairing);
+  device.SetAccountKey(account_key);
+  device.SetPublicAddress(public_address);
+  device.SetDisplayName(display_name);
+  device.SetMetadata(DeviceMetadata(proto::GetObservedDeviceResponse()));
+  BuildFastPairInfo(response.add_fast_pair_info(), device);
+}
+
+std::filesystem::path GetTestFilePath(absl::string_view name) {
+  std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "saved_device_index_test" /
+      std::string(name);
+  std::filesystem::remove(path);
+  return path;
+}
+
+TEST(SavedDeviceIndexTest, FindsMatchingDevice) {
+  SavedDeviceIndex index;
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kOtherAccountKey), kOtherPublicAddress,
+            kOtherDisplayName);
+  AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kDisplayName);
+  index.Update(response);
+  AccountKeyFilter filter(kFilter, kSalt);
+
+  std::optional<SavedDeviceIndex::Match> match = index.FindMatch(filter);
+
+  ASSERT_TRUE(match.has_value());
+  EXPECT_EQ(match->account_key, AccountKey(kMatchingAccountKey));
+  EXPECT_EQ(match->model_id, kHexModelId);
+}
+
+TEST(SavedDeviceIndexTest, NoMatchingDevice) {
+  SavedDeviceIndex index;
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kOtherAccountKey), kOtherPublicAddress,
+            kOtherDisplayName);
+  index.Update(response);
+  AccountKeyFilter filter(kFilter, kSalt);
+
+  EXPECT_FALSE(index.FindMatch(filter).has_value());
+}
+
+TEST(SavedDeviceIndexTest, ContainsMacAddress) {
+  SavedDeviceIndex index;
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kDisplayName);
+  index.Update(response);
+
+  EXPECT_TRUE(index.ContainsMacAddress(kPublicAddress));
+  EXPECT_FALSE(index.ContainsMacAddress(kOtherPublicAddress));
+}
+
+TEST(SavedDeviceIndexTest, LeavesOutForgottenDevices) {
+  SavedDeviceIndex index;
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kDisplayName);
+  response.mutable_fast_pair_info(0)
+      ->mutable_device()
+      ->set_sha256_account_key_public_address("\xf0\xf0\xf0\xf0");
+  BuildFastPairInfo(response.add_fast_pair_info(),
+                    proto::OptInStatus::OPT_IN_STATUS_OPTED_IN);
+
+  SavedDeviceIndex::Changes changes = index.Update(response);
+
+  EXPECT_TRUE(changes.empty());
+  EXPECT_THAT(index.GetSavedDevices(), IsEmpty());
+  EXPECT_FALSE(index.ContainsMacAddress(kPublicAddress));
+  EXPECT_EQ(index.opt_in_status(), proto::OptInStatus::OPT_IN_STATUS_OPTED_IN);
+}
+
+TEST(SavedDeviceIndexTest, UpdateReturnsChanges) {
+  SavedDeviceIndex index;
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kDisplayName);
+  AddDevice(response, AccountKey(kOtherAccountKey), kOtherPublicAddress,
+            kOtherDisplayName);
+
+  SavedDeviceIndex::Changes changes = index.Update(response);
+
+  EXPECT_THAT(changes.updated_devices, SizeIs(2));
+  EXPECT_THAT(changes.removed_account_keys, IsEmpty());
+  EXPECT_TRUE(index.Update(response).empty());
+
+  proto::UserReadDevicesResponse new_response;
+  AddDevice(new_response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kOtherDisplayName);
+  changes = index.Update(new_response);
+
+  ASSERT_THAT(changes.updated_devices, SizeIs(1));
+  EXPECT_EQ(changes.updated_devices[0].account_key(),
+            AccountKey(kMatchingAccountKey).GetAsBytes());
+  EXPECT_THAT(changes.removed_account_keys,
+              ElementsAre(AccountKey(kOtherAccountKey)));
+}
+
+TEST(SavedDeviceIndexTest, RemoveDevice) {
+  SavedDeviceIndex index;
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kDisplayName);
+  index.Update(response);
+
+  index.Remove(AccountKey(kMatchingAccountKey));
+
+  EXPECT_THAT(index.GetSavedDevices(), IsEmpty());
+  EXPECT_FALSE(index.ContainsMacAddress(kPublicAddress));
+}
+
+TEST(SavedDeviceIndexTest, LoadsSavedDevicesFromFile) {
+  std::filesystem::path path = GetTestFilePath("load_test.pb");
+  {
+    SavedDeviceIndex index(path);
+    proto::UserReadDevicesResponse response;
+    AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+              kDisplayName);
+    BuildFastPairInfo(response.add_fast_pair_info(),
+                      proto::OptInStatus::OPT_IN_STATUS_OPTED_IN);
+    index.Update(response);
+  }
+
+  SavedDeviceIndex index(path);
+  AccountKeyFilter filter(kFilter, kSalt);
+
+  EXPECT_THAT(index.GetSavedDevices(), SizeIs(1));
+  EXPECT_TRUE(index.FindMatch(filter).has_value());
+  EXPECT_TRUE(index.ContainsMacAddress(kPublicAddress));
+  EXPECT_EQ(index.opt_in_status(), proto::OptInStatus::OPT_IN_STATUS_OPTED_IN);
+  std::filesystem::remove(path);
+}
+
+TEST(SavedDeviceIndexTest, TakesUpdateTimeFromFile) {
+  std::filesystem::path path = GetTestFilePath("update_time_test.pb");
+  {
+    SavedDeviceIndex index(path);
+    EXPECT_EQ(index.update_time(), absl::InfinitePast());
+    proto::UserReadDevicesResponse response;
+    AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+              kDisplayName);
+    index.Update(response);
+    EXPECT_LE(absl::Now() - index.update_time(), absl::Minutes(1));
+  }
+  std::filesystem::last_write_time(
+      path,
+      std::filesystem::file_time_type::clock::now() - std::chrono::hours(2));
+
+  SavedDeviceIndex index(path);
+
+  EXPECT_GE(absl::Now() - index.update_time(), absl::Hours(2));
+  EXPECT_LT(absl::Now() - index.update_time(), absl::Hours(3));
+  std::filesystem::remove(path);
+}
+
+TEST(SavedDeviceIndexTest, SetFileForgetsSavedDevices) {
+  std::filesystem::path path = GetTestFilePath("set_file_test.pb");
+  std::filesystem::path other_path = GetTestFilePath("set_file_other.pb");
+  SavedDeviceIndex index(path);
+  proto::UserReadDevicesResponse response;
+  AddDevice(response, AccountKey(kMatchingAccountKey), kPublicAddress,
+            kDisplayName);
+  index.Update(response);
+  ASSERT_TRUE(std::filesystem::exists(path));
+
+  SavedDeviceIndex::Changes changes = index.SetFile(other_path);
+
+  EXPECT_THAT(changes.updated_devices, IsEmpty());
+  EXPECT_THAT(changes.removed_account_keys,
+              ElementsAre(AccountKey(kMatchingAccountKey)));
+  EXPECT_FALSE(std::filesystem::exists(path));
+  EXPECT_THAT(index.GetSavedDevices(), IsEmpty());
+  EXPECT_FALSE(index.ContainsMacAddress(kPublicAddress));
+  EXPECT_EQ(index.update_time(), absl::InfinitePast());
+  std::filesystem::remove(other_path);
+}
+
+TEST(SavedDeviceIndexTest, IgnoresMissingFile) {
+  SavedDeviceIndex index(GetTestFilePath("missing.pb"));
+
+  EXPECT_THAT(index.GetSavedDevices(), IsEmpty());
+  EXPECT_EQ(index.opt_in_status(), proto::OptInStatus::OPT_IN_STATUS_UNKNOWN);
+}
+
+}  // namespace
+}  // namespace fastpair
+}  // namespace nearby
@@ -37,6 +37,8 @@ class FakeFastPairClient : public FastPairClient {
     return get_observer_device_response_.value();
   }
 
+  int get_observed_device_count() const { return get_observed_device_count_; }
+
   proto::UserReadDevicesRequest& read_devices_request() {
     return read_devices_request_.value();
   }
@@ -79,6 +81,7 @@ class FakeFastPairClient : public FastPairClient {
   absl::StatusOr<proto::GetObservedDeviceResponse> GetObservedDevice(
       const proto::GetObservedDeviceRequest& request) override {
     get_observer_device_request_ = request;
+    get_observed_device_count_++;
     return get_observer_device_response_;
   }
 
@@ -110,6 +113,7 @@ class FakeFastPairClient : public FastPairClient {
   std::optional<proto::GetObservedDeviceRequest> get_observer_device_request_;
   absl::StatusOr<proto::GetObservedDeviceResponse>
       get_observer_device_response_;
+  int get_observed_device_count_ = 0;
   std::optional<proto::UserReadDevicesRequest> read_devices_request_;
   absl::StatusOr<proto::UserReadDevicesResponse> read_devices_response_;
   std::optional<proto::UserWriteDeviceRequest> write_device_request_;
@@ -0,0 +1,170 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/byte_buffer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+
+ByteBuffer::ByteBuffer(ByteArray&& bytes) {
+  size_t size = bytes.size();
+  AppendSegment(
+      {std::make_shared<ByteArray>(std::move(bytes)), /*offset=*/0, size});
+}
+
+ByteBuffer::ByteBuffer(std::string&& bytes)
+    : ByteBuffer(ByteArray(std::move(bytes))) {}
+
+ByteBuffer::ByteBuffer(const ByteArray& bytes) : ByteBuffer(ByteArray(bytes)) {}
+
+ByteBuffer ByteBuffer::Borrow(const ByteArray& bytes) {
+  ByteBuffer result;
+  // A pointer that owns nothing. Its use count is 0, so Flatten() && never
+  // moves the bytes out.
+  result.AppendSegment({std::shared_ptr<ByteArray>(
+                            std::shared_ptr<ByteArray>(),
+                            const_cast<ByteArray*>(&bytes)),  // NOLINT
+                        /*offset=*/0, bytes.size()});
+  return result;
+}
+
+std::vector<absl::string_view> ByteBuffer::Segments() const {
+  std::vector<absl::string_view> result;
+  result.reserve(segments_.size());
+  for (const Segment& segment : segments_) {
+    result.push_back(segment.view());
+  }
+  return result;
+}
+
+const ByteArray* ByteBuffer::GetWholeSegment(size_t index) const {
+  const Segment& segment = segments_[index];
+  if (segment.offset != 0 || segment.size != segment.data->size()) {
+    return nullptr;
+  }
+  return segment.data.get();
+}
+
+void ByteBuffer::Append(const ByteBuffer& other) {
+  segments_.reserve(segments_.size() + other.segments_.size());
+  for (const Segment& segment : other.segments_) {
+    AppendSegment(segment);
+  }
+}
+
+void ByteBuffer::Prepend(const ByteBuffer& other) {
+  if (other.Empty()) return;
+  segments_.insert(segments_.begin(), other.segments_.begin(),
+                   other.segments_.end());
+  size_ += other.size_;
+}
+
+void ByteBuffer::Append(ByteArray&& bytes) {
+  Append(ByteBuffer(std::move(bytes)));
+}
+
+void ByteBuffer::Prepend(ByteArray&& bytes) {
+  Prepend(ByteBuffer(std::move(bytes)));
+}
+
+ByteBuffer ByteBuffer::Slice(size_t offset, size_t length) const {
+  ByteBuffer result;
+  if (offset >= size_) return result;
+  length = std::min(length, size_ - offset);
+  for (const Segment& segment : segments_) {
+    if (length == 0) break;
+    if (offset >= segment.size) {
+      offset -= segment.size;
+      continue;
+    }
+    size_t taken = std::min(length, segment.size - offset);
+    result.AppendSegment({segment.data, segment.offset + offset, taken});
+    length -= taken;
+    offset = 0;
+  }
+  return result;
+}
+
+ByteArray ByteBuffer::Flatten() const& {
+  ByteArray result(size_);
+  size_t position = 0;
+  for (const Segment& segment : segments_) {
+    memcpy(result.data() + position, segment.data->data() + segment.offset,
+           segment.size);
+    position += segment.size;
+  }
+  return result;
+}
+
+ByteArray ByteBuffer::Flatten() && {
+  if (segments_.size() == 1) {
+    Segment& segment = segments_.front();
+    if (segment.offset == 0 && segment.size == segment.data->size() &&
+        segment.data.use_count() == 1) {
+      ByteArray result = std::move(*segment.data);
+      segments_.clear();
+      size_ = 0;
+      return result;
+    }
+  }
+  return static_cast<const ByteBuffer&>(*this).Flatten();
+}
+
+void ByteBuffer::AppendSegment(Segment segment) {
+  if (segment.size == 0) return;
+  size_ += segment.size;
+  segments_.push_back(std::move(segment));
+}
+
+bool operator==(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+  if (lhs.size() != rhs.size()) return false;
+  // Compare segment by segment, without flattening either side.
+  std::vector<absl::string_view> left = lhs.Segments();
+  std::vector<absl::string_view> right = rhs.Segments();
+  auto left_it = left.begin();
+  auto right_it = right.begin();
+  absl::string_view left_view;
+  absl::string_view right_view;
+  while (true) {
+    while (left_view.empty() && left_it != left.end()) left_view = *left_it++;
+    while (right_view.empty() && right_it != right.end()) {
+      right_view = *right_it++;
+    }
+    if (left_view.empty() || right_view.empty()) {
+      return left_view.empty() && right_view.empty();
+    }
+    size_t length = std::min(left_view.size(), right_view.size());
+    if (left_view.substr(0, length) != right_view.substr(0, length)) {
+      return false;
+    }
+    left_view.remove_prefix(length);
+    right_view.remove_prefix(length);
+  }
+}
+
+bool operator!=(const ByteBuffer& lhs, const ByteBuffer& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace nearby
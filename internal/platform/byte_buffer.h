@@ -0,0 +1,117 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_BASE_BYTE_BUFFER_H_
+#define PLATFORM_BASE_BYTE_BUFFER_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+
+// An immutable, reference counted sequence of bytes stored as a chain of
+// ByteArray segments.
+//
+// Copying, slicing, appending and prepending a ByteBuffer never copies the
+// underlying bytes; only the (small) list of segment references is copied.
+// This makes ByteBuffer suitable for passing large payload chunks through
+// several layers (framing, encryption, stream IO) without paying for a memcpy
+// at every step. Use Flatten() only when a contiguous ByteArray is really
+// required.
+class ByteBuffer {
+ public:
+  ByteBuffer() = default;
+  ByteBuffer(const ByteBuffer&) = default;
+  ByteBuffer& operator=(const ByteBuffer&) = default;
+  ByteBuffer(ByteBuffer&&) = default;
+  ByteBuffer& operator=(ByteBuffer&&) = default;
+
+  // Takes ownership of the bytes without copying them.
+  explicit ByteBuffer(ByteArray&& bytes);
+  explicit ByteBuffer(std::string&& bytes);
+
+  // Creates a ByteBuffer with a copy of `bytes`.
+  explicit ByteBuffer(const ByteArray& bytes);
+
+  // Returns a buffer referring to `bytes` without copying or owning them.
+  // `bytes` must outlive the returned buffer and every buffer sharing its
+  // segments, and must not change in the meantime.
+  static ByteBuffer Borrow(const ByteArray& bytes);
+
+  // Returns the total number of bytes in all segments.
+  size_t size() const { return size_; }
+  bool Empty() const { return size_ == 0; }
+
+  // Returns the number of segments in the chain.
+  size_t segment_count() const { return segments_.size(); }
+
+  // Returns views of all segments, in order. The views stay valid as long as
+  // this ByteBuffer (or any other ByteBuffer sharing the segments) is alive.
+  std::vector<absl::string_view> Segments() const;
+
+  // Returns a view of the segment at `index`.
+  absl::string_view GetSegment(size_t index) const {
+    return segments_[index].view();
+  }
+
+  // Returns the ByteArray backing the segment at `index` if the segment spans
+  // all of it, or nullptr if the segment is a slice. Lets callers hand whole
+  // segments to ByteArray based APIs without copying them.
+  const ByteArray* GetWholeSegment(size_t index) const;
+
+  // Appends/prepends the contents of `other`, sharing its segments.
+  void Append(const ByteBuffer& other);
+  void Prepend(const ByteBuffer& other);
+
+  // Appends/prepends `bytes`, taking ownership without copying.
+  void Append(ByteArray&& bytes);
+  void Prepend(ByteArray&& bytes);
+
+  // Returns a buffer referring to `length` bytes starting at `offset`. The
+  // range is clamped to the size of this buffer.
+  ByteBuffer Slice(size_t offset, size_t length) const;
+
+  // Returns the contents as a single contiguous ByteArray. This copies, unless
+  // the buffer consists of one segment that is not shared with anybody else.
+  ByteArray Flatten() const&;
+  ByteArray Flatten() &&;
+
+  friend bool operator==(const ByteBuffer& lhs, const ByteBuffer& rhs);
+  friend bool operator!=(const ByteBuffer& lhs, const ByteBuffer& rhs);
+
+ private:
+  struct Segment {
+    std::shared_ptr<ByteArray> data;
+    size_t offset = 0;
+    size_t size = 0;
+
+    absl::string_view view() const {
+      return absl::string_view(data->data() + offset, size);
+    }
+  };
+
+  void AppendSegment(Segment segment);
+
+  std::vector<Segment> segments_;
+  size_t size_ = 0;
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_BASE_BYTE_BUFFER_H_
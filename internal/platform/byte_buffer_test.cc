@@ -0,0 +1,134 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/byte_buffer.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+
+namespace nearby {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(ByteBufferTest, DefaultIsEmpty) {
+  ByteBuffer buffer;
+  EXPECT_TRUE(buffer.Empty());
+  EXPECT_EQ(buffer.size(), 0);
+  EXPECT_EQ(buffer.segment_count(), 0);
+  EXPECT_TRUE(buffer.Flatten().Empty());
+}
+
+TEST(ByteBufferTest, TakesOwnershipWithoutCopy) {
+  std::string data(1024, 'x');
+  const char* raw = data.data();
+  ByteBuffer buffer(std::move(data));
+  ASSERT_EQ(buffer.segment_count(), 1);
+  EXPECT_EQ(buffer.Segments()[0].data(), raw);
+}
+
+TEST(ByteBufferTest, BorrowsWithoutCopy) {
+  ByteArray data("borrowed");
+  ByteBuffer buffer = ByteBuffer::Borrow(data);
+
+  ASSERT_EQ(buffer.segment_count(), 1);
+  EXPECT_EQ(buffer.GetWholeSegment(0), &data);
+  EXPECT_EQ(std::move(buffer).Flatten(), data);
+  EXPECT_EQ(data, ByteArray("borrowed"));
+}
+
+TEST(ByteBufferTest, PrependAndAppendShareSegments) {
+  ByteBuffer body(ByteArray("body"));
+  ByteBuffer frame;
+  frame.Append(body);
+  frame.Prepend(ByteArray("head"));
+  frame.Append(ByteArray("tail"));
+
+  EXPECT_EQ(frame.size(), 12);
+  EXPECT_THAT(frame.Segments(), ElementsAre("head", "body", "tail"));
+  EXPECT_EQ(frame.Segments()[1].data(), body.Segments()[0].data());
+  EXPECT_EQ(frame.Flatten(), ByteArray("headbodytail"));
+}
+
+TEST(ByteBufferTest, EmptyArraysAreNotAdded) {
+  ByteBuffer buffer;
+  buffer.Append(ByteArray());
+  buffer.Prepend(ByteArray());
+  EXPECT_EQ(buffer.segment_count(), 0);
+}
+
+TEST(ByteBufferTest, SliceAcrossSegments) {
+  ByteBuffer buffer(ByteArray("0123"));
+  buffer.Append(ByteArray("4567"));
+  buffer.Append(ByteArray("89"));
+
+  ByteBuffer slice = buffer.Slice(2, 5);
+  EXPECT_THAT(slice.Segments(), ElementsAre("23", "456"));
+  EXPECT_EQ(slice.Segments()[0].data(), buffer.Segments()[0].data() + 2);
+}
+
+TEST(ByteBufferTest, WholeSegmentIsOnlyReturnedForUnslicedSegments) {
+  ByteBuffer buffer(ByteArray("0123"));
+  buffer.Append(ByteArray("4567"));
+
+  ASSERT_NE(buffer.GetWholeSegment(0), nullptr);
+  EXPECT_EQ(*buffer.GetWholeSegment(0), ByteArray("0123"));
+  ByteBuffer slice = buffer.Slice(1, 6);
+  EXPECT_EQ(slice.GetWholeSegment(0), nullptr);
+  EXPECT_EQ(slice.GetWholeSegment(1), nullptr);
+  EXPECT_EQ(slice.GetSegment(1), "456");
+}
+
+TEST(ByteBufferTest, SliceIsClamped) {
+  ByteBuffer buffer(ByteArray("0123"));
+  EXPECT_EQ(buffer.Slice(2, 100).Flatten(), ByteArray("23"));
+  EXPECT_TRUE(buffer.Slice(4, 1).Empty());
+}
+
+TEST(ByteBufferTest, FlattenMovesUniqueSegment) {
+  std::string data(1024, 'x');
+  const char* raw = data.data();
+  ByteBuffer buffer(std::move(data));
+  ByteArray flat = std::move(buffer).Flatten();
+  EXPECT_EQ(flat.data(), raw);
+  EXPECT_EQ(flat.size(), 1024);
+}
+
+TEST(ByteBufferTest, FlattenCopiesSharedSegment) {
+  ByteBuffer buffer(std::string(1024, 'x'));
+  ByteBuffer copy = buffer;
+  ByteArray flat = std::move(buffer).Flatten();
+  EXPECT_NE(flat.data(), copy.Segments()[0].data());
+  EXPECT_EQ(flat, copy.Flatten());
+}
+
+TEST(ByteBufferTest, EqualityIgnoresSegmentation) {
+  ByteBuffer lhs(ByteArray("abc"));
+  lhs.Append(ByteArray("def"));
+  ByteBuffer rhs(ByteArray("a"));
+  rhs.Append(ByteArray("bcde"));
+  rhs.Append(ByteArray("f"));
+  EXPECT_EQ(lhs, rhs);
+  EXPECT_NE(lhs, ByteBuffer(ByteArray("abcdeg")));
+  EXPECT_NE(lhs, ByteBuffer(ByteArray("abcde")));
+}
+
+}  // namespace
+}  // namespace nearby
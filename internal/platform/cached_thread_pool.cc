@@ -0,0 +1,89 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/cached_thread_pool.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/runnable.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+
+CachedThreadPool::CachedThreadPool(int max_idle_threads)
+    : max_idle_threads_(max_idle_threads) {}
+
+CachedThreadPool::~CachedThreadPool() { Shutdown(); }
+
+void CachedThreadPool::Execute(const std::string& name, Runnable&& runnable) {
+  std::vector<std::unique_ptr<SingleThreadExecutor>> retired_threads;
+  {
+    MutexLock lock(&mutex_);
+    if (shutdown_) return;
+    retired_threads.swap(retired_threads_);
+
+    std::unique_ptr<SingleThreadExecutor> thread;
+    if (idle_threads_.empty()) {
+      thread = std::make_unique<SingleThreadExecutor>();
+    } else {
+      thread = std::move(idle_threads_.back());
+      idle_threads_.pop_back();
+    }
+    SingleThreadExecutor* thread_ptr = thread.get();
+    busy_threads_.emplace(thread_ptr, std::move(thread));
+    thread_ptr->Execute(
+        name, [this, thread_ptr, runnable = std::move(runnable)]() mutable {
+          runnable();
+          OnTaskDone(thread_ptr);
+        });
+  }
+  for (auto& thread : retired_threads) thread->Shutdown();
+}
+
+void CachedThreadPool::Shutdown() {
+  std::vector<std::unique_ptr<SingleThreadExecutor>> threads;
+  {
+    MutexLock lock(&mutex_);
+    shutdown_ = true;
+    threads.swap(idle_threads_);
+    for (auto& thread : retired_threads_) threads.push_back(std::move(thread));
+    retired_threads_.clear();
+    for (auto& [thread_ptr, thread] : busy_threads_) {
+      threads.push_back(std::move(thread));
+    }
+    busy_threads_.clear();
+  }
+  for (auto& thread : threads) thread->Shutdown();
+}
+
+void CachedThreadPool::OnTaskDone(SingleThreadExecutor* thread_ptr) {
+  MutexLock lock(&mutex_);
+  auto it = busy_threads_.find(thread_ptr);
+  // Shutdown() took over the thread.
+  if (it == busy_threads_.end()) return;
+
+  std::unique_ptr<SingleThreadExecutor> thread = std::move(it->second);
+  busy_threads_.erase(it);
+  if (static_cast<int>(idle_threads_.size()) < max_idle_threads_) {
+    idle_threads_.push_back(std::move(thread));
+  } else {
+    retired_threads_.push_back(std::move(thread));
+  }
+}
+
+}  // namespace nearby
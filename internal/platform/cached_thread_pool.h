@@ -0,0 +1,72 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_PUBLIC_CACHED_THREAD_POOL_H_
+#define PLATFORM_PUBLIC_CACHED_THREAD_POOL_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "internal/platform/mutex.h"
+#include "internal/platform/runnable.h"
+#include "internal/platform/single_thread_executor.h"
+
+namespace nearby {
+
+// An Executor that runs each task on a thread of its own, and keeps up to
+// `max_idle_threads` threads around once their tasks are done so the next
+// tasks don't have to start new ones. Suits tasks that may block for long.
+//
+// Unlike MultiThreadExecutor, a task never waits for another task to finish:
+// when no idle thread is left, a new one is started. Callers that must bound
+// the number of threads have to bound the number of tasks they hand it.
+//
+// https://docs.oracle.com/javase/8/docs/api/java/util/concurrent/Executors.html#newCachedThreadPool--
+class CachedThreadPool {
+ public:
+  explicit CachedThreadPool(int max_idle_threads);
+  CachedThreadPool(const CachedThreadPool&) = delete;
+  CachedThreadPool& operator=(const CachedThreadPool&) = delete;
+  ~CachedThreadPool();
+
+  // Starts `runnable` right away. Ignored after Shutdown().
+  void Execute(const std::string& name, Runnable&& runnable)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Waits for the running tasks to finish, and stops all threads.
+  void Shutdown() ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  void OnTaskDone(SingleThreadExecutor* thread) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  const int max_idle_threads_;
+  Mutex mutex_;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+  std::vector<std::unique_ptr<SingleThreadExecutor>> idle_threads_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<SingleThreadExecutor*,
+                      std::unique_ptr<SingleThreadExecutor>>
+      busy_threads_ ABSL_GUARDED_BY(mutex_);
+  // Threads beyond `max_idle_threads_`. A thread can't stop itself, so they
+  // are stopped by the next Execute() or Shutdown().
+  std::vector<std::unique_ptr<SingleThreadExecutor>> retired_threads_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace nearby
+
+#endif  // PLATFORM_PUBLIC_CACHED_THREAD_POOL_H_
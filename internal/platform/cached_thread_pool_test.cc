@@ -0,0 +1,101 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/cached_thread_pool.h"
+
+#include <thread>  // NOLINT
+
+#include "gtest/gtest.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "internal/platform/count_down_latch.h"
+
+namespace nearby {
+namespace {
+
+constexpr absl::Duration kTimeout = absl::Seconds(5);
+
+TEST(CachedThreadPoolTest, RunsBlockingTasksAtTheSameTime) {
+  CachedThreadPool pool(/*max_idle_threads=*/1);
+  CountDownLatch all_started(3);
+  CountDownLatch done(3);
+
+  // Each task waits for the other ones to start, which only works if none of
+  // them waits for a thread.
+  for (int i = 0; i < 3; ++i) {
+    pool.Execute("task", [&all_started, &done]() {
+      all_started.CountDown();
+      if (all_started.Await(kTimeout).result()) done.CountDown();
+    });
+  }
+
+  EXPECT_TRUE(done.Await(kTimeout).result());
+}
+
+TEST(CachedThreadPoolTest, ReusesIdleThreads) {
+  CachedThreadPool pool(/*max_idle_threads=*/1);
+  absl::Mutex mutex;
+  std::thread::id first_thread;
+  std::thread::id second_thread;
+  CountDownLatch first_done(1);
+  CountDownLatch second_done(1);
+
+  pool.Execute("task", [&]() {
+    absl::MutexLock lock(&mutex);
+    first_thread = std::this_thread::get_id();
+    first_done.CountDown();
+  });
+  ASSERT_TRUE(first_done.Await(kTimeout).result());
+  // Give the thread time to go back to the pool after the task returns.
+  absl::SleepFor(absl::Milliseconds(100));
+  pool.Execute("task", [&]() {
+    absl::MutexLock lock(&mutex);
+    second_thread = std::this_thread::get_id();
+    second_done.CountDown();
+  });
+  ASSERT_TRUE(second_done.Await(kTimeout).result());
+
+  absl::MutexLock lock(&mutex);
+  EXPECT_EQ(first_thread, second_thread);
+}
+
+TEST(CachedThreadPoolTest, ShutdownWaitsForRunningTasks) {
+  CachedThreadPool pool(/*max_idle_threads=*/0);
+  CountDownLatch started(1);
+  bool finished = false;
+
+  pool.Execute("task", [&started, &finished]() {
+    started.CountDown();
+    absl::SleepFor(absl::Milliseconds(50));
+    finished = true;
+  });
+  ASSERT_TRUE(started.Await(kTimeout).result());
+  pool.Shutdown();
+
+  EXPECT_TRUE(finished);
+}
+
+TEST(CachedThreadPoolTest, IgnoresTasksAfterShutdown) {
+  CachedThreadPool pool(/*max_idle_threads=*/1);
+  bool ran = false;
+
+  pool.Shutdown();
+  pool.Execute("task", [&ran]() { ran = true; });
+
+  EXPECT_FALSE(ran);
+}
+
+}  // namespace
+}  // namespace nearby
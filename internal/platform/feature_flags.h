@@ -67,6 +67,9 @@ class FeatureFlags {
     // in near future, so change "payload_received_ack" version from "2" to "5"
     // after auto-reconnect and auto-resume.
     std::int32_t min_nc_version_supports_payload_received_ack = 5;
+    // Peers from this version on answer PAYLOAD_RESUME_QUERY, so a sender
+    // only asks them whether a file payload can resume.
+    std::int32_t min_nc_version_supports_resumable_file_transfers = 6;
     // If the other part doesn't ack the safe_to_disconnect request, the
     // initiator will end the connection in 30s.
     absl::Duration safe_to_disconnect_ack_delay_millis =
@@ -57,6 +57,8 @@ InputStream& InputFile::GetInputStream() { return *impl_; }
 OutputFile::OutputFile(std::string file_path)
     : impl_(Platform::CreateOutputFile(file_path)) {}
 OutputFile::OutputFile(PayloadId id) : impl_(Platform::CreateOutputFile(id)) {}
+OutputFile::OutputFile(std::string file_path, std::int64_t offset)
+    : impl_(Platform::CreateOutputFile(file_path, offset)) {}
 OutputFile::~OutputFile() = default;
 OutputFile::OutputFile(OutputFile&&) noexcept = default;
 OutputFile& OutputFile::operator=(OutputFile&&) = default;
@@ -71,6 +73,15 @@ Exception OutputFile::Write(const ByteArray& data) {
 // down to the applicable transport layer.
 Exception OutputFile::Flush() { return impl_->Flush(); }
 
+// Reserves storage for a file of `size` bytes, without changing its size.
+Exception OutputFile::Preallocate(std::int64_t size) {
+  return impl_->Preallocate(size);
+}
+
+// Flushes all data written so far, and waits until it reaches the storage
+// device.
+Exception OutputFile::Sync() { return impl_->Sync(); }
+
 // Disallows further writes to the file and frees system resources,
 // associated with it.
 Exception OutputFile::Close() { return impl_->Close(); }
@@ -73,6 +73,10 @@ class OutputFile final {
   using Platform = api::ImplementationPlatform;
   explicit OutputFile(PayloadId payload_id);
   explicit OutputFile(std::string file_path);
+  // Opens the existing file at `file_path` to write after its first `offset`
+  // bytes; anything past them is dropped. The result is not valid if the file
+  // is shorter than `offset`.
+  OutputFile(std::string file_path, std::int64_t offset);
   ~OutputFile();
   OutputFile(OutputFile&&) noexcept;
   OutputFile& operator=(OutputFile&&);
@@ -85,6 +89,15 @@ class OutputFile final {
   // down to the applicable transport layer.
   Exception Flush();
 
+  // Reserves storage for a file of `size` bytes, without changing its size.
+  // Returns Exception::kIo on error.
+  Exception Preallocate(std::int64_t size);
+
+  // Flushes all data written so far, and waits until it reaches the storage
+  // device.
+  // Returns Exception::kIo on error, Exception::kSuccess otherwise.
+  Exception Sync();
+
   // Disallows further writes to the file and frees system resources,
   // associated with it.
   Exception Close();
@@ -98,6 +111,8 @@ class OutputFile final {
   // versa.
   OutputStream& GetOutputStream();
 
+  bool IsValid() const { return impl_ != nullptr; }
+
  private:
   std::unique_ptr<api::OutputFile> impl_;
 };
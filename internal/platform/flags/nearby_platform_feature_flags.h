@@ -69,6 +69,11 @@ constexpr auto kWifiHotspotConnectionTimeoutMillis =
 constexpr auto kEnableIntelPieSdk =
     flags::Flag<bool>(kConfigPackage, "45428547", false);
 
+// Enable/Disable reading outgoing files through a memory mapping on POSIX
+// platforms.
+constexpr auto kEnableMmapInputFile =
+    flags::Flag<bool>(kConfigPackage, "45428548", false);
+
 }  // namespace nearby_platform_feature
 }  // namespace config_package_nearby
 }  // namespace platform
@@ -54,6 +54,18 @@
  */
 - (BOOL)write:(NSData *)data error:(NSError **_Nullable)error;
 
+/**
+ * Writes the given dispatch data to the connection with a single send.
+ *
+ * A dispatch data object may be a concatenation of several non-contiguous regions, which are sent
+ * without being copied into one buffer. Blocks execution until the bytes have been successfully
+ * written or an error occurs.
+ *
+ * @param data The data to write.
+ * @param[out] error Error that will be populated on failure.
+ */
+- (BOOL)writeDispatchData:(dispatch_data_t)data error:(NSError **_Nullable)error;
+
 /**
  * Gracefully closes the connection to remote endpoint.
  *
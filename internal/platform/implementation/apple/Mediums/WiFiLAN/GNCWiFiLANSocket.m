@@ -75,17 +75,6 @@
 }
 
 - (BOOL)write:(NSData *)data error:(NSError **)error {
-  __strong nw_connection_t connection = self.connection;
-  if (connection == nil) {
-    return NO;
-  }
-
-  NSCondition *condition = [[NSCondition alloc] init];
-  [condition lock];
-
-  __block BOOL blockResult = NO;
-  __block NSError *blockError = nil;
-
   __block NSData *blockData = [data copy];
   dispatch_data_t dispatchData =
       dispatch_data_create(blockData.bytes, blockData.length, dispatch_get_main_queue(), ^{
@@ -96,8 +85,22 @@
         // See: b/280525159
         blockData = nil;
       });
+  return [self writeDispatchData:dispatchData error:error];
+}
+
+- (BOOL)writeDispatchData:(dispatch_data_t)data error:(NSError **)error {
+  __strong nw_connection_t connection = self.connection;
+  if (connection == nil) {
+    return NO;
+  }
+
+  NSCondition *condition = [[NSCondition alloc] init];
+  [condition lock];
+
+  __block BOOL blockResult = NO;
+  __block NSError *blockError = nil;
 
-  nw_connection_send(connection, dispatchData, NW_CONNECTION_DEFAULT_MESSAGE_CONTEXT, false,
+  nw_connection_send(connection, data, NW_CONNECTION_DEFAULT_MESSAGE_CONTEXT, false,
                      ^(nw_error_t error) {
                        [condition lock];
                        blockResult = error == nil;
@@ -135,6 +135,11 @@ std::unique_ptr<OutputFile> ImplementationPlatform::CreateOutputFile(const std::
   return shared::IOFile::CreateOutputFile(file_path);
 }
 
+std::unique_ptr<OutputFile> ImplementationPlatform::CreateOutputFile(const std::string& file_path,
+                                                                     std::int64_t offset) {
+  return shared::IOFile::CreateOutputFile(file_path, offset);
+}
+
 std::unique_ptr<LogMessage> ImplementationPlatform::CreateLogMessage(
     const char* file, int line, LogMessage::Severity severity) {
   return std::make_unique<apple::LogMessage>(file, line, severity);
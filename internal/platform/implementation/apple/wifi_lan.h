@@ -57,6 +57,8 @@ class WifiLanOutputStream : public OutputStream {
   ~WifiLanOutputStream() override = default;
 
   Exception Write(const ByteArray& data) override;
+  // Sends all segments with a single send, without copying them.
+  Exception WriteBuffer(const ByteBuffer& data) override;
   Exception Flush() override;
   Exception Close() override;
 
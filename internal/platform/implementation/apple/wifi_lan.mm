@@ -19,6 +19,9 @@
 #include <string>
 #include <utility>
 
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_buffer.h"
+
 #import "internal/platform/implementation/apple/Mediums/WiFiLAN/GNCIPv4Address.h"
 #import "internal/platform/implementation/apple/Mediums/WiFiLAN/GNCWiFiLANMedium.h"
 #import "internal/platform/implementation/apple/Mediums/WiFiLAN/GNCWiFiLANServerSocket.h"
@@ -62,6 +65,27 @@ Exception WifiLanOutputStream::Write(const ByteArray& data) {
   return {Exception::kSuccess};
 }
 
+Exception WifiLanOutputStream::WriteBuffer(const ByteBuffer& data) {
+  dispatch_data_t dispatchData = dispatch_data_empty;
+  for (absl::string_view segment : data.Segments()) {
+    // Each region keeps its own reference to the segments, so they outlive the send without being
+    // copied.
+    __block ByteBuffer blockBuffer = data;
+    dispatch_data_t region =
+        dispatch_data_create(segment.data(), segment.size(), dispatch_get_main_queue(), ^{
+          blockBuffer = ByteBuffer();
+        });
+    dispatchData = dispatch_data_create_concat(dispatchData, region);
+  }
+  NSError* error = nil;
+  BOOL result = [socket_ writeDispatchData:dispatchData error:&error];
+  if (!result) {
+    GTMLoggerError(@"Error writing socket: %@", error);
+    return {Exception::kIo};
+  }
+  return {Exception::kSuccess};
+}
+
 Exception WifiLanOutputStream::Flush() {
   // Write blocks until the data has successfully been written/received, so no more work is needed
   // to flush.
@@ -25,6 +25,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
+#include "internal/flags/nearby_flags.h"
+#include "internal/platform/flags/nearby_platform_feature_flags.h"
 #include "internal/platform/implementation/atomic_boolean.h"
 #include "internal/platform/implementation/atomic_reference.h"
 #include "internal/platform/implementation/bluetooth_adapter.h"
@@ -62,6 +64,7 @@
 #include "internal/platform/implementation/g3/wifi_hotspot.h"
 #include "internal/platform/implementation/g3/wifi_lan.h"
 #include "internal/platform/implementation/shared/file.h"
+#include "internal/platform/implementation/shared/mmap_input_file.h"
 #include "internal/platform/implementation/wifi.h"
 #include "internal/platform/medium_environment.h"
 
@@ -133,6 +136,16 @@ std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(
 
 std::unique_ptr<InputFile> ImplementationPlatform::CreateInputFile(
     const std::string& file_path, size_t size) {
+  // Outgoing files may be read through a memory mapping, which saves a copy
+  // per chunk. Files that can't be mapped (such as empty ones) fall back to a
+  // stream.
+  if (NearbyFlags::GetInstance().GetBoolFlag(
+          platform::config_package_nearby::nearby_platform_feature::
+              kEnableMmapInputFile)) {
+    if (auto mmap_file = shared::MmapInputFile::Create(file_path, size)) {
+      return mmap_file;
+    }
+  }
   return shared::IOFile::CreateInputFile(file_path, size);
 }
 
@@ -151,6 +164,11 @@ std::unique_ptr<OutputFile> ImplementationPlatform::CreateOutputFile(
   return shared::IOFile::CreateOutputFile(file_path);
 }
 
+std::unique_ptr<OutputFile> ImplementationPlatform::CreateOutputFile(
+    const std::string& file_path, std::int64_t offset) {
+  return shared::IOFile::CreateOutputFile(file_path, offset);
+}
+
 std::unique_ptr<LogMessage> ImplementationPlatform::CreateLogMessage(
     const char* file, int line, LogMessage::Severity severity) {
   return std::make_unique<g3::LogMessage>(file, line, severity);
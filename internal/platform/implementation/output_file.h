@@ -15,6 +15,8 @@
 #ifndef PLATFORM_API_OUTPUT_FILE_H_
 #define PLATFORM_API_OUTPUT_FILE_H_
 
+#include <cstdint>
+
 #include "internal/platform/byte_array.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/output_stream.h"
@@ -26,6 +28,18 @@ namespace api {
 class OutputFile : public OutputStream {
  public:
   ~OutputFile() override = default;
+
+  // Reserves storage for a file of `size` bytes up front, so that writing it
+  // doesn't fail halfway for lack of space, and its blocks are laid out in
+  // one piece. Doesn't change the size of the file. Optional; the default
+  // does nothing.
+  virtual Exception Preallocate(std::int64_t size) {
+    return {Exception::kSuccess};
+  }
+
+  // Flushes the data written so far and waits until it reaches the storage
+  // device. The default only flushes.
+  virtual Exception Sync() { return Flush(); }
 };
 
 }  // namespace api
@@ -116,6 +116,11 @@ class ImplementationPlatform {
 
   static std::unique_ptr<OutputFile> CreateOutputFile(const std::string&);
 
+  // Opens an existing file to write after its first `offset` bytes; anything
+  // past them is dropped. Returns null if the file is shorter than `offset`.
+  static std::unique_ptr<OutputFile> CreateOutputFile(
+      const std::string& file_path, std::int64_t offset);
+
   static std::unique_ptr<LogMessage> CreateLogMessage(
       const char* file, int line, LogMessage::Severity severity);
 
@@ -14,11 +14,20 @@
 
 #include "internal/platform/implementation/shared/file.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 #include <algorithm>
+#include <cerrno>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
 #include <ios>
 #include <memory>
 #include <string>
+#include <system_error>  // NOLINT(build/c++11)
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -45,9 +54,30 @@ std::unique_ptr<IOFile> IOFile::CreateOutputFile(const absl::string_view path) {
   return std::unique_ptr<IOFile>(new IOFile(path));
 }
 
+std::unique_ptr<IOFile> IOFile::CreateOutputFile(const absl::string_view path,
+                                                 std::int64_t offset) {
+  std::error_code error;
+  std::filesystem::path file_path(std::string(path.data(), path.size()));
+  std::uintmax_t size = std::filesystem::file_size(file_path, error);
+  if (error || offset < 0 || size < static_cast<std::uintmax_t>(offset)) {
+    return nullptr;
+  }
+  if (size > static_cast<std::uintmax_t>(offset)) {
+    std::filesystem::resize_file(file_path, offset, error);
+    if (error) return nullptr;
+  }
+  auto file = absl::WrapUnique(
+      new IOFile(path, std::ios::binary | std::ios::out | std::ios::app));
+  if (!file->file_.is_open()) return nullptr;
+  return file;
+}
+
 IOFile::IOFile(const absl::string_view file_path)
+    : IOFile(file_path, std::ios::binary | std::ios::out) {}
+
+IOFile::IOFile(const absl::string_view file_path, std::ios_base::openmode mode)
     : file_(), path_(file_path), total_size_(0) {
-  file_.open(path_, std::ios::binary | std::ios::out);
+  file_.open(path_, mode);
 }
 
 ExceptionOr<ByteArray> IOFile::Read(std::int64_t size) {
@@ -100,5 +130,44 @@ Exception IOFile::Flush() {
   return {file_.good() ? Exception::kSuccess : Exception::kIo};
 }
 
+// fstream doesn't expose its file descriptor, so the two calls below open the
+// file once more. Both act on the file rather than on the descriptor.
+Exception IOFile::Preallocate(std::int64_t size) {
+#ifdef __linux__
+  if (!file_.is_open()) {
+    return {Exception::kIo};
+  }
+  int fd = open(path_.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return {Exception::kIo};
+  }
+  int error = fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, size) == 0 ? 0 : errno;
+  close(fd);
+  // Not every file system supports preallocation; it's only a hint then.
+  if (error != 0 && error != EOPNOTSUPP) {
+    return {Exception::kIo};
+  }
+#endif  // __linux__
+  return {Exception::kSuccess};
+}
+
+Exception IOFile::Sync() {
+  Exception flush = Flush();
+#ifdef _WIN32
+  return flush;
+#else
+  if (flush.Raised()) {
+    return flush;
+  }
+  int fd = open(path_.c_str(), O_WRONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return {Exception::kIo};
+  }
+  int result = fsync(fd);
+  close(fd);
+  return {result == 0 ? Exception::kSuccess : Exception::kIo};
+#endif  // _WIN32
+}
+
 }  // namespace shared
 }  // namespace nearby
@@ -34,6 +34,11 @@ class IOFile final : public api::InputFile, public api::OutputFile {
 
   static std::unique_ptr<IOFile> CreateOutputFile(const absl::string_view path);
 
+  // Opens the existing file at `path` to write after its first `offset` bytes;
+  // anything past them is dropped. Returns null if the file is shorter.
+  static std::unique_ptr<IOFile> CreateOutputFile(const absl::string_view path,
+                                                  std::int64_t offset);
+
   ExceptionOr<ByteArray> Read(std::int64_t size) override;
 
   std::string GetFilePath() const override { return path_; }
@@ -43,10 +48,13 @@ class IOFile final : public api::InputFile, public api::OutputFile {
 
   Exception Write(const ByteArray& data) override;
   Exception Flush() override;
+  Exception Preallocate(std::int64_t size) override;
+  Exception Sync() override;
 
  private:
   explicit IOFile(const absl::string_view file_path, size_t size);
   explicit IOFile(const absl::string_view file_path);
+  IOFile(const absl::string_view file_path, std::ios_base::openmode mode);
 
   std::fstream file_;
   std::string path_;
@@ -138,6 +138,37 @@ TEST_F(FileTest, IOFile_Write) {
   AssertEquals(io_file_input->Read(kMaxSize), "abc");
 }
 
+TEST_F(FileTest, IOFile_PreallocateKeepsSize) {
+  auto io_file_output = shared::IOFile::CreateOutputFile(path_);
+  EXPECT_EQ(io_file_output->Preallocate(1024 * 1024),
+            Exception{Exception::kSuccess});
+  EXPECT_EQ(io_file_output->Write(ByteArray("abc")),
+            Exception{Exception::kSuccess});
+  EXPECT_EQ(io_file_output->Sync(), Exception{Exception::kSuccess});
+  auto io_file_input = shared::IOFile::CreateInputFile(path_, GetSize());
+  EXPECT_EQ(io_file_input->GetTotalSize(), 3);
+  AssertEquals(io_file_input->Read(kMaxSize), "abc");
+}
+
+TEST_F(FileTest, IOFile_WriteAfterOffset) {
+  WriteToFile("abcdef");
+  auto io_file_output = shared::IOFile::CreateOutputFile(path_, 2);
+  ASSERT_NE(io_file_output, nullptr);
+  EXPECT_EQ(io_file_output->Write(ByteArray("xy")),
+            Exception{Exception::kSuccess});
+  EXPECT_EQ(io_file_output->Close(), Exception{Exception::kSuccess});
+  auto io_file_input = shared::IOFile::CreateInputFile(path_, 4);
+  EXPECT_EQ(io_file_input->GetTotalSize(), 4);
+  AssertEquals(io_file_input->Read(10), "abxy");
+}
+
+TEST_F(FileTest, IOFile_WriteAfterOffsetPastEndFails) {
+  WriteToFile("ab");
+  EXPECT_EQ(shared::IOFile::CreateOutputFile(path_, 3), nullptr);
+  EXPECT_EQ(shared::IOFile::CreateOutputFile("/not/a/valid/path.txt", 0),
+            nullptr);
+}
+
 TEST_F(FileTest, IOFile_CloseOutput) {
   auto io_file = shared::IOFile::CreateOutputFile(path_);
   io_file->Close();
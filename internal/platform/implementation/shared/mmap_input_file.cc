@@ -0,0 +1,172 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/mmap_input_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+// How far ahead of the read position pages are prefetched. Comfortably more
+// than a payload chunk, so the next chunks are in memory by the time they are
+// sent.
+constexpr std::int64_t kPrefetchSize = 4 * 1024 * 1024;
+
+std::int64_t PageSize() {
+  static const std::int64_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+}  // namespace
+
+std::unique_ptr<MmapInputFile> MmapInputFile::Create(
+    absl::string_view file_path, std::int64_t size) {
+  std::string path(file_path);
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+  std::int64_t total_size = std::min<std::int64_t>(size, file_stat.st_size);
+  if (total_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+
+  void* data =
+      mmap(nullptr, total_size, PROT_READ, MAP_SHARED, fd, /*offset=*/0);
+  if (data == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  madvise(data, total_size, MADV_SEQUENTIAL);
+
+  auto file = absl::WrapUnique(new MmapInputFile(
+      file_path, fd, static_cast<char*>(data), total_size));
+  file->AdviseAroundPosition();
+  return file;
+}
+
+MmapInputFile::MmapInputFile(absl::string_view file_path, int fd, char* data,
+                             std::int64_t total_size)
+    : path_(file_path), fd_(fd), data_(data), total_size_(total_size) {}
+
+MmapInputFile::~MmapInputFile() { Close(); }
+
+ExceptionOr<ByteArray> MmapInputFile::Read(std::int64_t size) {
+  if (fd_ < 0 || size < 0) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+
+  std::int64_t read_size = std::min(size, total_size_ - position_);
+  if (data_ == nullptr) return ReadWithoutMapping(read_size);
+  struct stat file_stat;
+  if (fstat(fd_, &file_stat) != 0) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+  if (file_stat.st_size < position_ + read_size) {
+    // The file shrank. The rest of it is read with pread(), so the mapping
+    // isn't touched again even if the file keeps changing.
+    Unmap();
+    return ReadWithoutMapping(read_size);
+  }
+  ByteArray bytes(data_ + position_, read_size);
+  position_ += read_size;
+  AdviseAroundPosition();
+  return ExceptionOr<ByteArray>(std::move(bytes));
+}
+
+ExceptionOr<ByteArray> MmapInputFile::ReadWithoutMapping(std::int64_t size) {
+  std::string bytes(size, '\0');
+  ssize_t read_size = pread(fd_, bytes.data(), size, position_);
+  if (read_size < 0) {
+    return ExceptionOr<ByteArray>{Exception::kIo};
+  }
+  bytes.resize(read_size);
+  position_ += read_size;
+  return ExceptionOr<ByteArray>(ByteArray(std::move(bytes)));
+}
+
+ExceptionOr<size_t> MmapInputFile::Skip(size_t offset) {
+  if (fd_ < 0) {
+    return ExceptionOr<size_t>{Exception::kIo};
+  }
+
+  std::int64_t skipped =
+      std::min<std::int64_t>(offset, total_size_ - position_);
+  position_ += skipped;
+  AdviseAroundPosition();
+  return ExceptionOr<size_t>(skipped);
+}
+
+Exception MmapInputFile::Close() {
+  Unmap();
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+  return {Exception::kSuccess};
+}
+
+void MmapInputFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, total_size_);
+    data_ = nullptr;
+  }
+}
+
+void MmapInputFile::AdviseAroundPosition() {
+  if (data_ == nullptr) return;
+  // madvise() takes page aligned addresses; the mapping itself starts on a
+  // page boundary.
+  std::int64_t page_start = position_ / PageSize() * PageSize();
+  if (page_start > released_until_) {
+    madvise(data_ + released_until_, page_start - released_until_,
+            MADV_DONTNEED);
+    released_until_ = page_start;
+  }
+
+  // Prefetch in steps of half the window, rather than a few pages per read.
+  prefetched_until_ = std::max(prefetched_until_, page_start);
+  if (prefetched_until_ - position_ < kPrefetchSize / 2 &&
+      prefetched_until_ < total_size_) {
+    std::int64_t end = std::min(position_ + kPrefetchSize, total_size_);
+    end = (end + PageSize() - 1) / PageSize() * PageSize();
+    madvise(data_ + prefetched_until_, end - prefetched_until_, MADV_WILLNEED);
+    prefetched_until_ = end;
+  }
+}
+
+}  // namespace shared
+}  // namespace nearby
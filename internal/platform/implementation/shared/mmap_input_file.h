@@ -0,0 +1,86 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PLATFORM_IMPL_SHARED_MMAP_INPUT_FILE_H_
+#define PLATFORM_IMPL_SHARED_MMAP_INPUT_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+#include "internal/platform/implementation/input_file.h"
+
+namespace nearby {
+namespace shared {
+
+// An InputFile that maps the whole file into memory, for POSIX platforms.
+//
+// Each Read() copies straight from the mapping into the returned ByteArray,
+// instead of going through an ifstream buffer and a scratch buffer. The
+// mapping is advised for sequential access, and the pages just ahead of the
+// read position are prefetched while the pages behind it are released.
+//
+// Touching a page past the end of a file that was truncated after it was
+// mapped raises SIGBUS. So each Read() first checks the file's current size.
+// Once the file is shorter than the mapping, the mapping is dropped and the
+// rest of the file is read with pread(). A truncation racing with a Read()
+// can still raise SIGBUS.
+class MmapInputFile final : public api::InputFile {
+ public:
+  // Maps at most `size` bytes of the file. Returns nullptr if the file can't
+  // be opened or mapped, e.g. when it is empty; callers are expected to fall
+  // back to IOFile then.
+  static std::unique_ptr<MmapInputFile> Create(absl::string_view file_path,
+                                               std::int64_t size);
+
+  ~MmapInputFile() override;
+
+  ExceptionOr<ByteArray> Read(std::int64_t size) override;
+  ExceptionOr<size_t> Skip(size_t offset) override;
+  Exception Close() override;
+
+  std::string GetFilePath() const override { return path_; }
+  std::int64_t GetTotalSize() const override { return total_size_; }
+
+ private:
+  MmapInputFile(absl::string_view file_path, int fd, char* data,
+                std::int64_t total_size);
+
+  // Prefetches the pages after `position_` and releases the ones before it.
+  void AdviseAroundPosition();
+  // Reads with pread(), for when the file has become shorter than the mapping.
+  ExceptionOr<ByteArray> ReadWithoutMapping(std::int64_t size);
+  // Drops the mapping. Reads go through pread() afterwards.
+  void Unmap();
+
+  const std::string path_;
+  int fd_;
+  // Null once unmapped.
+  char* data_;
+  const std::int64_t total_size_;
+  std::int64_t position_ = 0;
+  // Start of the pages not released yet.
+  std::int64_t released_until_ = 0;
+  // End of the pages prefetched so far.
+  std::int64_t prefetched_until_ = 0;
+};
+
+}  // namespace shared
+}  // namespace nearby
+
+#endif  // PLATFORM_IMPL_SHARED_MMAP_INPUT_FILE_H_
@@ -0,0 +1,171 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/implementation/shared/mmap_input_file.h"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "file/util/temp_path.h"
+#include "gtest/gtest.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+namespace shared {
+namespace {
+
+class MmapInputFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    temp_path_ = std::make_unique<TempPath>(TempPath::Local);
+    path_ = temp_path_->path() + "/file.txt";
+    std::ofstream output_file(path_);
+  }
+
+  void WriteToFile(absl::string_view text) {
+    std::ofstream file(path_, std::ios::binary | std::ios::app);
+    file << text;
+  }
+
+  void AssertEquals(const ExceptionOr<ByteArray>& bytes,
+                    const std::string& expected) {
+    EXPECT_TRUE(bytes.ok());
+    EXPECT_EQ(std::string(bytes.result()), expected);
+  }
+
+  void AssertEmpty(const ExceptionOr<ByteArray>& bytes) {
+    EXPECT_TRUE(bytes.ok());
+    EXPECT_TRUE(bytes.result().Empty());
+  }
+
+  std::unique_ptr<TempPath> temp_path_;
+  std::string path_;
+};
+
+TEST_F(MmapInputFileTest, NonExistentPath) {
+  EXPECT_EQ(MmapInputFile::Create("/not/a/valid/path.txt", 3), nullptr);
+}
+
+TEST_F(MmapInputFileTest, EmptyFileIsNotMapped) {
+  EXPECT_EQ(MmapInputFile::Create(path_, 3), nullptr);
+}
+
+TEST_F(MmapInputFileTest, GetFilePathAndTotalSize) {
+  WriteToFile("abc");
+  auto file = MmapInputFile::Create(path_, 3);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->GetFilePath(), path_);
+  EXPECT_EQ(file->GetTotalSize(), 3);
+}
+
+TEST_F(MmapInputFileTest, ReadWithSizeUntilEOF) {
+  WriteToFile("abc");
+  auto file = MmapInputFile::Create(path_, 3);
+  ASSERT_NE(file, nullptr);
+  AssertEquals(file->Read(2), "ab");
+  AssertEquals(file->Read(2), "c");
+  AssertEmpty(file->Read(2));
+}
+
+TEST_F(MmapInputFileTest, Skip) {
+  WriteToFile("abcdef");
+  auto file = MmapInputFile::Create(path_, 6);
+  ASSERT_NE(file, nullptr);
+  ExceptionOr<size_t> skipped = file->Skip(2);
+  ASSERT_TRUE(skipped.ok());
+  EXPECT_EQ(skipped.result(), 2);
+  AssertEquals(file->Read(2), "cd");
+  skipped = file->Skip(10);
+  ASSERT_TRUE(skipped.ok());
+  EXPECT_EQ(skipped.result(), 2);
+  AssertEmpty(file->Read(2));
+}
+
+TEST_F(MmapInputFileTest, ReadsLargeFileInChunks) {
+  std::string data;
+  for (int i = 0; data.size() < 10 * 1024 * 1024; ++i) {
+    data += std::to_string(i);
+  }
+  WriteToFile(data);
+  auto file = MmapInputFile::Create(path_, data.size());
+  ASSERT_NE(file, nullptr);
+
+  std::string read;
+  while (true) {
+    ExceptionOr<ByteArray> chunk = file->Read(65531);
+    ASSERT_TRUE(chunk.ok());
+    if (chunk.result().Empty()) break;
+    read += std::string(chunk.result());
+  }
+  EXPECT_EQ(read, data);
+}
+
+TEST_F(MmapInputFileTest, ReadsNoMoreThanSize) {
+  WriteToFile("abcdef");
+  auto file = MmapInputFile::Create(path_, 4);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->GetTotalSize(), 4);
+  AssertEquals(file->Read(10), "abcd");
+  AssertEmpty(file->Read(10));
+}
+
+TEST_F(MmapInputFileTest, ReadsFileTruncatedAfterMapping) {
+  std::string data(1024 * 1024, 'a');
+  WriteToFile(data);
+  auto file = MmapInputFile::Create(path_, data.size());
+  ASSERT_NE(file, nullptr);
+  AssertEquals(file->Read(3), "aaa");
+
+  std::ofstream(path_, std::ios::binary | std::ios::trunc) << "abcdef";
+
+  AssertEquals(file->Read(2), "de");
+  AssertEquals(file->Read(10), "f");
+  AssertEmpty(file->Read(10));
+}
+
+TEST_F(MmapInputFileTest, KeepsReadingAfterTruncatedFileGrowsBack) {
+  std::string data(1024 * 1024, 'a');
+  WriteToFile(data);
+  auto file = MmapInputFile::Create(path_, data.size());
+  ASSERT_NE(file, nullptr);
+  AssertEquals(file->Read(3), "aaa");
+  std::ofstream(path_, std::ios::binary | std::ios::trunc) << "abcdef";
+  AssertEquals(file->Read(2), "de");
+
+  std::ofstream(path_, std::ios::binary | std::ios::trunc)
+      << std::string(data.size(), 'b');
+
+  ExceptionOr<size_t> skipped = file->Skip(10);
+  ASSERT_TRUE(skipped.ok());
+  EXPECT_EQ(skipped.result(), 10);
+  AssertEquals(file->Read(3), "bbb");
+}
+
+TEST_F(MmapInputFileTest, Close) {
+  WriteToFile("abc");
+  auto file = MmapInputFile::Create(path_, 3);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->Close(), Exception{Exception::kSuccess});
+  ExceptionOr<ByteArray> read_result = file->Read(3);
+  EXPECT_FALSE(read_result.ok());
+  EXPECT_TRUE(read_result.GetException().Raised(Exception::kIo));
+}
+
+}  // namespace
+}  // namespace shared
+}  // namespace nearby
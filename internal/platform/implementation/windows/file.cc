@@ -16,9 +16,12 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
 #include <ios>
 #include <memory>
 #include <string>
+#include <system_error>  // NOLINT(build/c++11)
 
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
@@ -49,11 +52,32 @@ std::unique_ptr<IOFile> IOFile::CreateOutputFile(const absl::string_view path) {
   return std::unique_ptr<IOFile>(new IOFile(path));
 }
 
+std::unique_ptr<IOFile> IOFile::CreateOutputFile(const absl::string_view path,
+                                                 std::int64_t offset) {
+  std::error_code error;
+  std::filesystem::path file_path(string_to_wstring(std::string(path)));
+  std::uintmax_t size = std::filesystem::file_size(file_path, error);
+  if (error || offset < 0 || size < static_cast<std::uintmax_t>(offset)) {
+    return nullptr;
+  }
+  if (size > static_cast<std::uintmax_t>(offset)) {
+    std::filesystem::resize_file(file_path, offset, error);
+    if (error) return nullptr;
+  }
+  auto file = std::unique_ptr<IOFile>(
+      new IOFile(path, std::ios::binary | std::ios::out | std::ios::app));
+  if (!file->file_.is_open()) return nullptr;
+  return file;
+}
+
 IOFile::IOFile(const absl::string_view file_path)
+    : IOFile(file_path, std::ios::binary | std::ios::out) {}
+
+IOFile::IOFile(const absl::string_view file_path, std::ios_base::openmode mode)
     : file_(), path_(file_path), total_size_(0) {
   // Always open input file path as wide string on Windows platform.
   std::wstring wide_path = string_to_wstring(path_);
-  file_.open(wide_path, std::ios::binary | std::ios::out);
+  file_.open(wide_path, mode);
 }
 
 ExceptionOr<ByteArray> IOFile::Read(std::int64_t size) {
@@ -232,6 +232,11 @@ std::unique_ptr<OutputFile> ImplementationPlatform::CreateOutputFile(
   return windows::IOFile::CreateOutputFile(file_path);
 }
 
+std::unique_ptr<OutputFile> ImplementationPlatform::CreateOutputFile(
+    const std::string& file_path, std::int64_t offset) {
+  return windows::IOFile::CreateOutputFile(file_path, offset);
+}
+
 // TODO(b/184975123): replace with real implementation.
 std::unique_ptr<LogMessage> ImplementationPlatform::CreateLogMessage(
     const char* file, int line, LogMessage::Severity severity) {
@@ -26,6 +26,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 // Nearby connections headers
 #include "absl/base/thread_annotations.h"
@@ -34,6 +35,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/implementation/wifi_lan.h"
@@ -137,10 +139,16 @@ class WifiLanSocket : public api::WifiLanSocket {
     ~SocketOutputStream() = default;
 
     Exception Write(const ByteArray& data) override;
+    // Gathers all segments into one WinRT buffer, so a frame is sent with a
+    // single WriteAsync call.
+    Exception WriteBuffer(const ByteBuffer& data) override;
     Exception Flush() override;
     Exception Close() override;
 
    private:
+    Exception WriteSegments(const std::vector<absl::string_view>& segments,
+                            size_t size);
+
     IOutputStream output_stream_{nullptr};
   };
 
@@ -18,8 +18,11 @@
 #include <cstdint>
 #include <cstring>
 #include <exception>
+#include <vector>
 
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/implementation/windows/generated/winrt/Windows.Foundation.h"
 #include "internal/platform/implementation/windows/wifi_lan.h"
@@ -157,10 +160,25 @@ WifiLanSocket::SocketOutputStream::SocketOutputStream(
 }
 
 Exception WifiLanSocket::SocketOutputStream::Write(const ByteArray& data) {
+  return WriteSegments({absl::string_view(data.data(), data.size())},
+                       data.size());
+}
+
+Exception WifiLanSocket::SocketOutputStream::WriteBuffer(
+    const ByteBuffer& data) {
+  return WriteSegments(data.Segments(), data.size());
+}
+
+Exception WifiLanSocket::SocketOutputStream::WriteSegments(
+    const std::vector<absl::string_view>& segments, size_t size) {
   try {
-    Buffer buffer = Buffer(data.size());
-    std::memcpy(buffer.data(), data.data(), data.size());
-    buffer.Length(data.size());
+    Buffer buffer = Buffer(size);
+    size_t position = 0;
+    for (absl::string_view segment : segments) {
+      std::memcpy(buffer.data() + position, segment.data(), segment.size());
+      position += segment.size();
+    }
+    buffer.Length(size);
     uint32_t wrote_bytes = 0;
     auto write_async = output_stream_.WriteAsync(buffer);
 
@@ -181,9 +199,9 @@ Exception WifiLanSocket::SocketOutputStream::Write(const ByteArray& data) {
         return {Exception::kIo};
     }
 
-    if (wrote_bytes != data.size()) {
+    if (wrote_bytes != size) {
       NEARBY_LOGS(WARNING) << "Only wrote partial of data:[" << wrote_bytes
-                           << "/" << data.size() << "].";
+                           << "/" << size << "].";
     }
 
     return {Exception::kSuccess};
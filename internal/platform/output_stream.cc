@@ -0,0 +1,65 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/output_stream.h"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+
+Exception OutputStream::WriteBuffer(const ByteBuffer& data) {
+  if (data.segment_count() == 1 && data.GetWholeSegment(0) != nullptr) {
+    return Write(*data.GetWholeSegment(0));
+  }
+  if (data.size() <= kMaxCoalescedWriteSize) {
+    return Write(data.Flatten());
+  }
+
+  // Small segments are copied together; large ones go out on their own.
+  std::string pending;
+  auto write_pending = [this, &pending]() -> Exception {
+    if (pending.empty()) return {Exception::kSuccess};
+    Exception exception = Write(ByteArray(std::move(pending)));
+    pending.clear();
+    return exception;
+  };
+  for (size_t i = 0; i < data.segment_count(); ++i) {
+    absl::string_view segment = data.GetSegment(i);
+    if (segment.size() < kMaxCoalescedWriteSize) {
+      pending.append(segment.data(), segment.size());
+      if (pending.size() >= kMaxCoalescedWriteSize) {
+        Exception exception = write_pending();
+        if (exception.Raised()) return exception;
+      }
+      continue;
+    }
+    Exception exception = write_pending();
+    if (exception.Raised()) return exception;
+    const ByteArray* whole_segment = data.GetWholeSegment(i);
+    exception = whole_segment != nullptr
+                    ? Write(*whole_segment)
+                    : Write(ByteArray(segment.data(), segment.size()));
+    if (exception.Raised()) return exception;
+  }
+  return write_pending();
+}
+
+}  // namespace nearby
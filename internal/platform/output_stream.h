@@ -15,7 +15,11 @@
 #ifndef PLATFORM_BASE_OUTPUT_STREAM_H_
 #define PLATFORM_BASE_OUTPUT_STREAM_H_
 
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
 #include "internal/platform/exception.h"
 
 namespace nearby {
@@ -27,7 +31,22 @@ class OutputStream {
  public:
   virtual ~OutputStream() = default;
 
+  // The default WriteBuffer() copies segments smaller than this into one
+  // Write() with their neighbours, and writes a buffer up to this size with a
+  // single Write().
+  static constexpr size_t kMaxCoalescedWriteSize = 16 * 1024;
+
   virtual Exception Write(const ByteArray& data) = 0;  // throws Exception::kIo
+
+  // Writes all segments of `data`, e.g. a frame header and its body, in
+  // order. Streams that support vectored (gather) writes should override this
+  // to send them with a single write. The default implementation copies
+  // small segments together, so a frame header goes out in the same Write()
+  // as the small body it precedes; segments of kMaxCoalescedWriteSize or more
+  // are passed to Write() on their own, without copying whole segments.
+  // throws Exception::kIo
+  virtual Exception WriteBuffer(const ByteBuffer& data);
+
   virtual Exception Flush() = 0;                       // throws Exception::kIo
   virtual Exception Close() = 0;                       // throws Exception::kIo
 };
@@ -0,0 +1,107 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "internal/platform/output_stream.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "internal/platform/byte_array.h"
+#include "internal/platform/byte_buffer.h"
+#include "internal/platform/exception.h"
+
+namespace nearby {
+namespace {
+
+constexpr size_t kLargeSize = OutputStream::kMaxCoalescedWriteSize;
+
+// Records each Write(), and the address of the bytes it was given.
+class RecordingOutputStream : public OutputStream {
+ public:
+  Exception Write(const ByteArray& data) override {
+    writes_.push_back(std::string(data));
+    written_data_.push_back(data.data());
+    return {Exception::kSuccess};
+  }
+  Exception Flush() override { return {Exception::kSuccess}; }
+  Exception Close() override { return {Exception::kSuccess}; }
+
+  const std::vector<std::string>& writes() const { return writes_; }
+  const std::vector<const char*>& written_data() const {
+    return written_data_;
+  }
+
+ private:
+  std::vector<std::string> writes_;
+  std::vector<const char*> written_data_;
+};
+
+TEST(OutputStreamTest, WritesSmallBufferOnce) {
+  RecordingOutputStream output;
+  ByteBuffer data(ByteArray("head"));
+  data.Append(ByteArray("body"));
+
+  EXPECT_FALSE(output.WriteBuffer(data).Raised());
+
+  ASSERT_EQ(output.writes().size(), 1);
+  EXPECT_EQ(output.writes()[0], "headbody");
+}
+
+TEST(OutputStreamTest, PassesSingleSegmentThrough) {
+  RecordingOutputStream output;
+  ByteArray bytes(std::string(2 * kLargeSize, 'a'));
+  ByteBuffer data = ByteBuffer::Borrow(bytes);
+
+  EXPECT_FALSE(output.WriteBuffer(data).Raised());
+
+  ASSERT_EQ(output.written_data().size(), 1);
+  EXPECT_EQ(output.written_data()[0], bytes.data());
+}
+
+TEST(OutputStreamTest, WritesLargeSegmentsOnTheirOwn) {
+  RecordingOutputStream output;
+  ByteArray body(std::string(kLargeSize, 'b'));
+  ByteBuffer data(ByteArray("head"));
+  data.Append(ByteArray("er"));
+  data.Append(ByteBuffer::Borrow(body));
+  data.Append(ByteArray("tail"));
+  data.Append(ByteArray("s"));
+
+  EXPECT_FALSE(output.WriteBuffer(data).Raised());
+
+  ASSERT_EQ(output.writes().size(), 3);
+  EXPECT_EQ(output.writes()[0], "header");
+  EXPECT_EQ(output.written_data()[1], body.data());
+  EXPECT_EQ(output.writes()[2], "tails");
+}
+
+TEST(OutputStreamTest, WritesManySmallSegmentsInBoundedWrites) {
+  RecordingOutputStream output;
+  ByteBuffer data;
+  std::string expected;
+  for (int i = 0; i < 3; ++i) {
+    std::string segment(kLargeSize - 1, 'a' + i);
+    expected += segment;
+    data.Append(ByteArray(std::move(segment)));
+  }
+
+  EXPECT_FALSE(output.WriteBuffer(data).Raised());
+
+  ASSERT_EQ(output.writes().size(), 2);
+  EXPECT_EQ(output.writes()[0] + output.writes()[1], expected);
+}
+
+}  // namespace
+}  // namespace nearby
@@ -14,6 +14,7 @@
 
 #include "internal/platform/pipe.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
@@ -37,7 +38,8 @@ using Platform = api::ImplementationPlatform;
 
 class Pipe {
  public:
-  Pipe() {
+  explicit Pipe(size_t max_buffered_bytes)
+      : max_buffered_bytes_(max_buffered_bytes) {
 #pragma push_macro("CreateMutex")
 #undef CreateMutex
     mutex_ = Platform::CreateMutex(api::Mutex::Mode::kRegular);
@@ -96,7 +98,10 @@ class Pipe {
   bool output_stream_closed_ ABSL_GUARDED_BY(mutex_) = false;
   bool read_all_chunks_ ABSL_GUARDED_BY(mutex_) = false;
 
+  // 0 if unbounded.
+  const size_t max_buffered_bytes_;
   std::deque<ByteArray> ABSL_GUARDED_BY(mutex_) buffer_;
+  size_t buffered_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
   // Order of declaration matters:
   // - mutex must be defined before condvar;
   std::unique_ptr<api::Mutex> mutex_;
@@ -129,13 +134,18 @@ ExceptionOr<ByteArray> Pipe::Read(size_t size) {
     return ExceptionOr<ByteArray>{ByteArray{}};
   }
 
-  ByteArray first_chunk{buffer_.front()};
+  ByteArray first_chunk{std::move(buffer_.front())};
   buffer_.pop_front();
+  buffered_bytes_ -= std::min(first_chunk.size(), size);
+  if (max_buffered_bytes_ != 0) {
+    // Let a blocked writer see the room it's been waiting for.
+    cond_->Notify();
+  }
 
   // If first_chunk is small enough to not overshoot the requested 'size', just
   // return that.
   if (first_chunk.size() <= size) {
-    return ExceptionOr<ByteArray>{first_chunk};
+    return ExceptionOr<ByteArray>{std::move(first_chunk)};
   } else {
     // Break first_chunk into 2 parts -- the first one of which (next_chunk)
     // will be 'size' bytes long, and will be returned, and the second one of
@@ -151,6 +161,16 @@ ExceptionOr<ByteArray> Pipe::Read(size_t size) {
 Exception Pipe::Write(const ByteArray& data) {
   BaseMutexLock lock(mutex_.get());
 
+  if (max_buffered_bytes_ != 0) {
+    while (buffered_bytes_ != 0 &&
+           buffered_bytes_ + data.size() > max_buffered_bytes_ &&
+           !input_stream_closed_ && !output_stream_closed_) {
+      Exception wait_exception = cond_->Wait();
+      if (wait_exception.Raised()) {
+        return wait_exception;
+      }
+    }
+  }
   return WriteLocked(data);
 }
 
@@ -158,8 +178,8 @@ void Pipe::MarkInputStreamClosed() {
   BaseMutexLock lock(mutex_.get());
   if (input_stream_closed_) return;
   input_stream_closed_ = true;
-  // Trigger cond_ to unblock a potentially-blocked call to read(), and to let
-  // it know to return Exception::IO.
+  // Trigger cond_ to unblock a potentially-blocked call to read() or write(),
+  // and to let it know to return Exception::IO.
   cond_->Notify();
 }
 
@@ -169,6 +189,8 @@ void Pipe::MarkOutputStreamClosed() {
   // Write a sentinel null chunk before marking output_stream_closed as true.
   WriteLocked(ByteArray{});
   output_stream_closed_ = true;
+  // Fail a write blocked on a bounded pipe from another thread.
+  if (max_buffered_bytes_ != 0) cond_->Notify();
 }
 
 Exception Pipe::WriteLocked(const ByteArray& data) {
@@ -177,6 +199,7 @@ Exception Pipe::WriteLocked(const ByteArray& data) {
   }
 
   buffer_.push_back(data);
+  buffered_bytes_ += data.size();
   // Trigger cond_ to unblock a potentially-blocked call to read(), now that
   // there's more data for it to consume.
   cond_->Notify();
@@ -187,7 +210,12 @@ Exception Pipe::WriteLocked(const ByteArray& data) {
 
 std::pair<std::unique_ptr<InputStream>, std::unique_ptr<OutputStream>>
 CreatePipe() {
-  auto pipe = std::make_shared<Pipe>();
+  return CreatePipe(/*max_buffered_bytes=*/0);
+}
+
+std::pair<std::unique_ptr<InputStream>, std::unique_ptr<OutputStream>>
+CreatePipe(size_t max_buffered_bytes) {
+  auto pipe = std::make_shared<Pipe>(max_buffered_bytes);
   return std::make_pair(std::make_unique<Pipe::PipeInputStream>(pipe),
                         std::make_unique<Pipe::PipeOutputStream>(pipe));
 }
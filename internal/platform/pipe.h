@@ -15,6 +15,7 @@
 #ifndef PLATFORM_PUBLIC_PIPE_H_
 #define PLATFORM_PUBLIC_PIPE_H_
 
+#include <cstddef>
 #include <memory>
 #include <utility>
 
@@ -33,6 +34,19 @@ namespace nearby {
 std::pair<std::unique_ptr<InputStream>, std::unique_ptr<OutputStream>>
 CreatePipe();
 
+// Same as above, but bounded: Write() blocks while the data would take the
+// bytes written and not read yet past `max_buffered_bytes`, so a slow reader
+// holds back the writer instead of letting the pipe grow. Writes into an empty
+// pipe never block, so a chunk larger than the bound still goes through.
+// A blocked Write() fails with Exception::kIo once either end is closed.
+// 0 means unbounded.
+//
+// The bound only holds back this pipe's writer, not whoever feeds it. A caller
+// that must not block, like an endpoint's reader, has to queue writes on a
+// thread of its own and fail fast once too much of them is waiting.
+std::pair<std::unique_ptr<InputStream>, std::unique_ptr<OutputStream>>
+CreatePipe(size_t max_buffered_bytes);
+
 }  // namespace nearby
 
 #endif  // PLATFORM_PUBLIC_PIPE_H_
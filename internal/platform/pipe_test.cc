@@ -26,7 +26,10 @@
 
 #include "gtest/gtest.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
 #include "internal/platform/exception.h"
 #include "internal/platform/input_stream.h"
 #include "internal/platform/output_stream.h"
@@ -37,6 +40,10 @@ namespace nearby {
 
 namespace {
 constexpr size_t kChunkSize = 64 * 1024;
+// How long a bounded write is watched to make sure it stays blocked, and how
+// long it may take to return once it is unblocked.
+constexpr absl::Duration kBlockedTimeout = absl::Milliseconds(100);
+constexpr absl::Duration kUnblockedTimeout = absl::Seconds(5);
 }
 
 TEST(PipeTest, ConstructorDestructorWorks) {
@@ -337,4 +344,80 @@ TEST(PipeTest, ConcurrentWriteAndRead) {
   reader_thread.Join();
 }
 
+TEST(PipeTest, BoundedWriteBlockedUntilRead) {
+  auto [input_stream, output_stream] = CreatePipe(/*max_buffered_bytes=*/4);
+  EXPECT_TRUE(output_stream->Write(ByteArray("ABCD")).Ok());
+
+  CountDownLatch write_done(1);
+  Thread writer_thread;
+  writer_thread.Start([output = output_stream.get(), &write_done]() {
+    EXPECT_TRUE(output->Write(ByteArray("EF")).Ok());
+    write_done.CountDown();
+  });
+
+  EXPECT_FALSE(write_done.Await(kBlockedTimeout).result());
+
+  ExceptionOr<ByteArray> read_data = input_stream->Read(2);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(std::string(read_data.result()), "AB");
+  // "CDEF" fits now.
+  EXPECT_TRUE(write_done.Await(kUnblockedTimeout).result());
+  writer_thread.Join();
+
+  read_data = input_stream->Read(kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(std::string(read_data.result()), "CD");
+  read_data = input_stream->Read(kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(std::string(read_data.result()), "EF");
+}
+
+TEST(PipeTest, BoundedWriteLargerThanBoundToEmptyPipe) {
+  auto [input_stream, output_stream] = CreatePipe(/*max_buffered_bytes=*/2);
+
+  EXPECT_TRUE(output_stream->Write(ByteArray("ABCD")).Ok());
+
+  ExceptionOr<ByteArray> read_data = input_stream->Read(kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(std::string(read_data.result()), "ABCD");
+}
+
+TEST(PipeTest, BoundedWriteFailsWhenReadEndClosed) {
+  auto [input_stream, output_stream] = CreatePipe(/*max_buffered_bytes=*/4);
+  EXPECT_TRUE(output_stream->Write(ByteArray("ABCD")).Ok());
+
+  CountDownLatch write_done(1);
+  Thread writer_thread;
+  writer_thread.Start([output = output_stream.get(), &write_done]() {
+    EXPECT_TRUE(output->Write(ByteArray("EF")).Raised(Exception::kIo));
+    write_done.CountDown();
+  });
+
+  EXPECT_FALSE(write_done.Await(kBlockedTimeout).result());
+  EXPECT_TRUE(input_stream->Close().Ok());
+  EXPECT_TRUE(write_done.Await(kUnblockedTimeout).result());
+  writer_thread.Join();
+}
+
+TEST(PipeTest, BoundedWriteFailsWhenWriteEndClosed) {
+  auto [input_stream, output_stream] = CreatePipe(/*max_buffered_bytes=*/4);
+  EXPECT_TRUE(output_stream->Write(ByteArray("ABCD")).Ok());
+
+  CountDownLatch write_done(1);
+  Thread writer_thread;
+  writer_thread.Start([output = output_stream.get(), &write_done]() {
+    EXPECT_TRUE(output->Write(ByteArray("EF")).Raised(Exception::kIo));
+    write_done.CountDown();
+  });
+
+  EXPECT_FALSE(write_done.Await(kBlockedTimeout).result());
+  EXPECT_TRUE(output_stream->Close().Ok());
+  EXPECT_TRUE(write_done.Await(kUnblockedTimeout).result());
+  writer_thread.Join();
+
+  ExceptionOr<ByteArray> read_data = input_stream->Read(kChunkSize);
+  ASSERT_TRUE(read_data.ok());
+  EXPECT_EQ(std::string(read_data.result()), "ABCD");
+}
+
 }  // namespace nearby
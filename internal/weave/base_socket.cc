@@ -14,6 +14,7 @@
 
 #include "internal/weave/base_socket.h"
 
+#include <algorithm>
 #include <deque>
 #include <string>
 #include <utility>
@@ -104,9 +105,10 @@ void BaseSocket::TryWriteNextControl() {
   // one of three packets. ConnectionRequest, ConnectionConfirm, or Error.
   // In any case, we should not have any messages in the queue from the previous
   // connection.
-  current_message_ = nullptr;
-  message_request_queue_.clear();
-  WritePacket(current_control_->NextPacket(max_packet_size_));
+  ClearMessagesLocked();
+  PacketInFlight in_flight;
+  in_flight.is_control = true;
+  WritePacket(current_control_->NextPacket(max_packet_size_), in_flight);
 }
 
 void BaseSocket::TryWriteNextMessage() {
@@ -121,27 +123,60 @@ void BaseSocket::TryWriteNextMessage() {
     return;
   }
   bool connected = IsConnected();
+  if (!connected) {
+    return;
+  }
   MutexLock lock(&mutex_);
-  if (current_message_ == nullptr) {
-    if (!message_request_queue_.empty()) {
-      current_message_ = &message_request_queue_.front();
+  while (message_packets_in_flight_ < max_packets_in_flight_) {
+    if (current_message_ == nullptr || current_message_->IsFinished()) {
+      // Messages are sent in order, so the first unfinished one is next.
+      current_message_ = nullptr;
+      for (MessageWriteRequest& message : message_request_queue_) {
+        if (!message.IsFinished()) {
+          current_message_ = &message;
+          break;
+        }
+      }
+      if (current_message_ == nullptr) {
+        return;
+      }
+    }
+    absl::StatusOr<Packet> packet =
+        current_message_->NextPacket(max_packet_size_);
+    PacketInFlight in_flight;
+    if (current_message_->IsFinished()) {
+      in_flight.completed_message = current_message_;
+    }
+    if (!WritePacket(std::move(packet), in_flight)) {
+      return;
     }
   }
-  if (current_message_ == nullptr || current_message_->IsFinished() ||
-      !connected) {
-    return;
-  }
-  WritePacket(current_message_->NextPacket(max_packet_size_));
 }
 
-void BaseSocket::WritePacket(absl::StatusOr<Packet> packet) {
+bool BaseSocket::WritePacket(absl::StatusOr<Packet> packet,
+                             PacketInFlight in_flight) {
   if (!packet.ok()) {
     NEARBY_LOGS(WARNING) << "Packet status:" << packet.status();
-    return;
+    return false;
   }
   CHECK(packet->SetPacketCounter(packet_counter_generator_.Next()).ok());
+  packets_in_flight_.push_back(in_flight);
+  if (!in_flight.is_control) {
+    message_packets_in_flight_++;
+  }
   NEARBY_LOGS(INFO) << "transmitting packet";
-  connection_.Transmit(packet->GetBytes());
+  connection_.Transmit(packet->TakeBytes());
+  return true;
+}
+
+void BaseSocket::ClearMessagesLocked() {
+  current_message_ = nullptr;
+  message_request_queue_.clear();
+  // Packets of the dropped messages still take up the window until their
+  // writes complete.
+  for (PacketInFlight& in_flight : packets_in_flight_) {
+    in_flight.completed_message = nullptr;
+  }
 }
 
 void BaseSocket::OnWriteRequestWriteComplete(absl::Status status) {
@@ -151,19 +186,29 @@ void BaseSocket::OnWriteRequestWriteComplete(absl::Status status) {
           ABSL_LOCKS_EXCLUDED(mutex_) mutable {
             {
               MutexLock lock(&mutex_);
-              if (current_control_ != nullptr) {
-                current_control_ = nullptr;
-                control_request_queue_.pop_front();
-              } else if (current_message_ != nullptr) {
-                NEARBY_LOGS(INFO) << "OnWriteResult current is not null";
-                if (current_message_->IsFinished()) {
-                  NEARBY_LOGS(INFO) << "OnWriteResult current finished";
-                  current_message_->SetWriteStatus(status);
-                  if (!message_request_queue_.empty() &&
-                      current_message_ == &message_request_queue_.front()) {
-                    NEARBY_LOGS(INFO) << "remove message";
-                    message_request_queue_.pop_front();
-                    current_message_ = nullptr;
+              if (packets_in_flight_.empty()) {
+                NEARBY_LOGS(WARNING) << "No packet in flight to complete";
+              } else {
+                PacketInFlight in_flight = packets_in_flight_.front();
+                packets_in_flight_.pop_front();
+                if (in_flight.is_control) {
+                  if (current_control_ != nullptr) {
+                    current_control_ = nullptr;
+                    control_request_queue_.pop_front();
+                  }
+                } else {
+                  message_packets_in_flight_--;
+                  MessageWriteRequest* message = in_flight.completed_message;
+                  if (message != nullptr) {
+                    message->SetWriteStatus(status);
+                    if (!message_request_queue_.empty() &&
+                        message == &message_request_queue_.front()) {
+                      NEARBY_LOGS(INFO) << "remove message";
+                      message_request_queue_.pop_front();
+                      if (current_message_ == message) {
+                        current_message_ = nullptr;
+                      }
+                    }
                   }
                 }
               }
@@ -196,8 +241,7 @@ void BaseSocket::Disconnect() {
       WriteControlPacket(Packet::CreateErrorPacket());
       {
         MutexLock lock(&mutex_);
-        current_message_ = nullptr;
-        message_request_queue_.clear();
+        ClearMessagesLocked();
         state_ = SocketConnectionState::kDisconnecting;
       }
       DisconnectQuietly();
@@ -229,6 +273,8 @@ void BaseSocket::DisconnectQuietly() {
                             control_request_queue_.clear();
                             current_control_ = nullptr;
                             current_message_ = nullptr;
+                            packets_in_flight_.clear();
+                            message_packets_in_flight_ = 0;
                             state_ = SocketConnectionState::kDisconnected;
                           }
                           NEARBY_LOGS(INFO) << "Socket now disconnected.";
@@ -247,11 +293,11 @@ void BaseSocket::OnReceiveDataPacket(Packet packet) {
     DisconnectInternal(message.status());
     return;
   }
-  socket_callback_.on_receive_cb(message->string_data());
+  socket_callback_.on_receive_cb(std::string(*std::move(message)));
 }
 
 nearby::Future<absl::Status> BaseSocket::Write(ByteArray message) {
-  MessageWriteRequest request = MessageWriteRequest(message.string_data());
+  MessageWriteRequest request = MessageWriteRequest(std::move(message));
   nearby::Future<absl::Status> ret = request.GetWriteStatusFuture();
 
   RunOnSocketThread(
@@ -267,6 +313,16 @@ nearby::Future<absl::Status> BaseSocket::Write(ByteArray message) {
   return ret;
 }
 
+void BaseSocket::SetMaxPacketsInFlight(int max_packets_in_flight) {
+  RunOnSocketThread("SetMaxPacketsInFlight",
+                    [this, max_packets_in_flight]()
+                        ABSL_EXCLUSIVE_LOCKS_REQUIRED(executor_) {
+                          max_packets_in_flight_ =
+                              std::max(1, max_packets_in_flight);
+                          TryWriteNextMessage();
+                        });
+}
+
 void BaseSocket::WriteControlPacket(Packet packet) {
   ControlPacketWriteRequest request =
       ControlPacketWriteRequest(std::move(packet));
@@ -45,6 +45,11 @@ class BaseSocket {
   void Disconnect();
   nearby::Future<absl::Status> Write(ByteArray message);
   virtual void Connect() = 0;
+  // Sets how many message packets may be written to the connection before the
+  // first of them completes; 1, the default, sends one packet at a time. The
+  // connection must complete writes in the order they were issued. Control
+  // packets are not held back by the window.
+  void SetMaxPacketsInFlight(int max_packets_in_flight);
 
  protected:
   void OnConnected(int new_max_packet_size);
@@ -79,6 +84,14 @@ class BaseSocket {
     kConnected
   };
 
+  // A packet handed to the connection whose write has not completed yet.
+  struct PacketInFlight {
+    bool is_control = false;
+    // The message this packet is the last one of, or null if there is none
+    // or the message has been dropped since.
+    MessageWriteRequest* completed_message = nullptr;
+  };
+
   bool IsRemotePacketCounterExpected(int counter);
   void TryWriteNextControl() ABSL_EXCLUSIVE_LOCKS_REQUIRED(executor_)
       ABSL_LOCKS_EXCLUDED(mutex_);
@@ -86,7 +99,10 @@ class BaseSocket {
       ABSL_LOCKS_EXCLUDED(mutex_);
   void OnWriteRequestWriteComplete(absl::Status status)
       ABSL_LOCKS_EXCLUDED(executor_);
-  void WritePacket(absl::StatusOr<Packet> packet);
+  // Returns false if `packet` could not be written.
+  bool WritePacket(absl::StatusOr<Packet> packet, PacketInFlight in_flight)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ClearMessagesLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   Mutex mutex_;
   // Messages and controls are in two separate queues to separate their control
@@ -97,6 +113,10 @@ class BaseSocket {
       ABSL_GUARDED_BY(mutex_);
   ControlPacketWriteRequest* current_control_ = nullptr;
   MessageWriteRequest* current_message_ = nullptr;
+  // In the order they were written, which is the order they complete in.
+  std::deque<PacketInFlight> packets_in_flight_ ABSL_GUARDED_BY(mutex_);
+  int message_packets_in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+  int max_packets_in_flight_ = 1;
   SocketConnectionState state_ ABSL_GUARDED_BY(mutex_) =
       SocketConnectionState::kDisconnected;
   int max_packet_size_;
@@ -276,6 +276,67 @@ TEST_F(BaseSocketTest, TestWriteThreePackets) {
   EXPECT_TRUE(connection_.NoMorePackets());
 }
 
+TEST_F(BaseSocketTest, TestWriteWithSendWindow) {
+  connection_.SetInstantTransmit(false);
+  socket_.SetMaxPacketsInFlight(2);
+  socket_.OnConnectedProxy(kMaxPacketSize);
+  nearby::Future<absl::Status> status =
+      socket_.Write(ByteArray("\x01\x02\x03\x04\x05\x06\x07\x08"));
+  // sleep for 10 ms to allow for packet population
+  absl::SleepFor(absl::Milliseconds(10));
+  // Two packets go out before either write completes.
+  EXPECT_EQ(
+      connection_.PollWrittenPacket(),
+      CreateDataPacket(0, true, false, ByteArray("\x01\x02")).GetBytes());
+  EXPECT_EQ(
+      connection_.PollWrittenPacket(),
+      CreateDataPacket(1, false, false, ByteArray("\x03\x04")).GetBytes());
+  EXPECT_TRUE(connection_.NoMorePackets());
+
+  // Each completion makes room for one more packet.
+  connection_.OnTransmitProxy(absl::OkStatus());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(
+      connection_.PollWrittenPacket(),
+      CreateDataPacket(2, false, false, ByteArray("\x05\x06")).GetBytes());
+  EXPECT_TRUE(connection_.NoMorePackets());
+  connection_.OnTransmitProxy(absl::OkStatus());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(
+      connection_.PollWrittenPacket(),
+      CreateDataPacket(3, false, true, ByteArray("\x07\x08")).GetBytes());
+  EXPECT_TRUE(connection_.NoMorePackets());
+
+  // The message is done once its last packet completes.
+  connection_.OnTransmitProxy(absl::OkStatus());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_FALSE(status.IsSet());
+  connection_.OnTransmitProxy(absl::OkStatus());
+  EXPECT_OK(status.Get().GetResult());
+}
+
+TEST_F(BaseSocketTest, TestSendWindowSpansMessages) {
+  connection_.SetInstantTransmit(false);
+  socket_.SetMaxPacketsInFlight(4);
+  socket_.OnConnectedProxy(kMaxPacketSize);
+  nearby::Future<absl::Status> first = socket_.Write(ByteArray("\x01"));
+  nearby::Future<absl::Status> second = socket_.Write(ByteArray("\x02"));
+  // sleep for 10 ms to allow for packet population
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(connection_.PollWrittenPacket(),
+            CreateDataPacket(0, true, true, ByteArray("\x01")).GetBytes());
+  EXPECT_EQ(connection_.PollWrittenPacket(),
+            CreateDataPacket(1, true, true, ByteArray("\x02")).GetBytes());
+  EXPECT_TRUE(connection_.NoMorePackets());
+
+  connection_.OnTransmitProxy(absl::OkStatus());
+  EXPECT_OK(first.Get().GetResult());
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_FALSE(second.IsSet());
+  connection_.OnTransmitProxy(absl::OkStatus());
+  EXPECT_OK(second.Get().GetResult());
+}
+
 TEST_F(BaseSocketTest, TestWritePacketCounterRollover) {
   socket_.OnConnectedProxy(kMaxPacketSize);
   for (int i = 0; i <= Packet::kMaxPacketCounter; i++) {
@@ -16,8 +16,11 @@
 
 #include <algorithm>
 #include <string>
+#include <utility>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
 
 namespace nearby {
 namespace weave {
@@ -27,6 +30,11 @@ MessageWriteRequest::MessageWriteRequest(absl::string_view message) {
   position_ = 0;
 }
 
+MessageWriteRequest::MessageWriteRequest(ByteArray message) {
+  message_ = std::string(std::move(message));
+  position_ = 0;
+}
+
 bool MessageWriteRequest::IsStarted() const { return position_ != 0; }
 
 bool MessageWriteRequest::IsFinished() const {
@@ -50,10 +58,10 @@ absl::StatusOr<Packet> MessageWriteRequest::NextPacket(int max_packet_size) {
   bool is_first = !IsStarted();
   int next_packet_len = std::min(max_packet_size - Packet::kPacketHeaderLength,
                                  (int)message_.size() - position_);
-  auto next_packet_bytes = message_.substr(position_, next_packet_len);
+  absl::string_view next_packet_bytes =
+      absl::string_view(message_).substr(position_, next_packet_len);
   position_ += next_packet_len;
-  return Packet::CreateDataPacket(is_first, IsFinished(),
-                                  ByteArray(next_packet_bytes));
+  return Packet::CreateDataPacket(is_first, IsFinished(), next_packet_bytes);
 }
 
 }  // namespace weave
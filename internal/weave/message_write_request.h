@@ -17,6 +17,9 @@
 
 #include <string>
 
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
 #include "internal/platform/future.h"
 #include "internal/weave/packet.h"
 
@@ -31,12 +34,15 @@ namespace weave {
 class MessageWriteRequest {
  public:
   explicit MessageWriteRequest(absl::string_view message);
+  // Takes over the buffer of `message` instead of copying it.
+  explicit MessageWriteRequest(ByteArray message);
   MessageWriteRequest(MessageWriteRequest&& other) = default;
   MessageWriteRequest& operator=(MessageWriteRequest&& other) = default;
 
   bool IsStarted() const;
   bool IsFinished() const;
 
+  // Each packet's payload is copied straight from the message.
   absl::StatusOr<Packet> NextPacket(int max_packet_size);
 
   // Gets the future result, the socket will set this result in the future.
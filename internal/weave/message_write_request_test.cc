@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "internal/platform/byte_array.h"
 #include "internal/platform/future.h"
 #include "internal/weave/packet.h"
 
@@ -70,6 +71,14 @@ TEST(MessageWriteRequestTest, LongWriteRequestWorks) {
   EXPECT_TRUE(request.IsFinished());
 }
 
+TEST(MessageWriteRequestTest, ByteArrayWriteRequestWorks) {
+  MessageWriteRequest request =
+      MessageWriteRequest(ByteArray(std::string(kLongMessage)));
+  EXPECT_EQ(request.NextPacket(15)->GetPayload(), kLongFirstHalf);
+  EXPECT_EQ(request.NextPacket(15)->GetPayload(), kLongSecondHalf);
+  EXPECT_TRUE(request.IsFinished());
+}
+
 TEST(MessageWriteRequestTest, TestResourceExhaustionOnceMessageSent) {
   MessageWriteRequest request = MessageWriteRequest(kShortMessage);
   EXPECT_FALSE(request.IsFinished());
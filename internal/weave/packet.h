@@ -20,6 +20,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
 
 namespace nearby {
@@ -102,6 +103,10 @@ class Packet {
   }
   static Packet CreateDataPacket(bool is_first_packet, bool is_last_packet,
                                  ByteArray payload);
+  // Copies `payload` straight into the packet, e.g. a slice of a larger
+  // message, without an intermediate buffer.
+  static Packet CreateDataPacket(bool is_first_packet, bool is_last_packet,
+                                 absl::string_view payload);
   static absl::StatusOr<Packet> CreateConnectionRequestPacket(
       int16_t min_protocol_version, int16_t max_protocol_version,
       int16_t max_packet_size, absl::string_view extra_data);
@@ -128,8 +133,14 @@ class Packet {
   bool IsDataPacket() const;
   int GetPacketCounter() const;
   ControlPacketType GetControlCommandNumber() const;
-  std::string GetPayload() const { return bytes_.substr(kPacketHeaderLength); }
-  std::string GetBytes() const { return bytes_; }
+  // The returned views are valid for as long as the packet is alive and not
+  // modified.
+  absl::string_view GetPayload() const {
+    return absl::string_view(bytes_).substr(kPacketHeaderLength);
+  }
+  const std::string& GetBytes() const { return bytes_; }
+  // Moves the raw packet data out, leaving the packet empty.
+  std::string TakeBytes() { return std::move(bytes_); }
   absl::Status SetPacketCounter(int packetCounter);
   std::string ToString();
 
@@ -21,6 +21,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
 
 namespace nearby {
 namespace weave {
@@ -111,6 +112,20 @@ TEST(PacketTest, CreateDataPacketTest) {
   EXPECT_EQ(packet.GetPacketCounter(), 0);
 }
 
+TEST(PacketTest, CreateDataPacketFromSliceTest) {
+  absl::string_view message = "big payload";
+  Packet packet = Packet::CreateDataPacket(false, true, message.substr(4));
+  EXPECT_TRUE(packet.IsLastPacket());
+  EXPECT_EQ(packet.GetPayload(), "payload");
+}
+
+TEST(PacketTest, TakeBytesTest) {
+  Packet packet = Packet::CreateDataPacket(false, false, ByteArray("sample"));
+  std::string expected = packet.GetBytes();
+
+  EXPECT_EQ(packet.TakeBytes(), expected);
+}
+
 TEST(PacketTest, SetPacketCounterTest) {
   Packet packet = Packet::CreateDataPacket(false, false, ByteArray("sample"));
   EXPECT_OK(packet.SetPacketCounter(1));
@@ -14,9 +14,12 @@
 
 #include "internal/weave/packetizer.h"
 
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
 #include "internal/platform/mutex_lock.h"
 #include "internal/weave/packet.h"
@@ -31,19 +34,20 @@ absl::Status Packetizer::AddPacket(Packet packet) {
         "Call GetMessage() first to retrieve message before adding another "
         "packet.");
   }
-  if (pending_payloads_.empty() && !packet.IsFirstPacket()) {
+  if (pending_packets_.empty() && !packet.IsFirstPacket()) {
     return absl::InvalidArgumentError(
         "First packet added must be marked as the first packet.");
   }
-  if (!pending_payloads_.empty() && packet.IsFirstPacket()) {
+  if (!pending_packets_.empty() && packet.IsFirstPacket()) {
     return absl::InvalidArgumentError(
         "Packet marked as first packet cannot be added if there are existing "
         "packets.");
   }
-  absl::StrAppend(&pending_payloads_, packet.GetPayload());
   if (packet.IsLastPacket()) {
     is_message_complete_ = true;
   }
+  pending_payload_size_ += packet.GetPayload().size();
+  pending_packets_.push_back(std::move(packet));
   return absl::OkStatus();
 }
 
@@ -53,15 +57,29 @@ absl::StatusOr<ByteArray> Packetizer::TakeMessage() {
     return absl::UnavailableError(
         "Full message is not available, no last packet added yet.");
   }
-  ByteArray message = ByteArray(std::move(pending_payloads_));
-  pending_payloads_.clear();
+  std::string message;
+  if (pending_packets_.size() == 1) {
+    message = pending_packets_.front().TakeBytes();
+    message.erase(0, Packet::kPacketHeaderLength);
+  } else {
+    message.resize(pending_payload_size_);
+    size_t offset = 0;
+    for (const Packet& packet : pending_packets_) {
+      absl::string_view payload = packet.GetPayload();
+      payload.copy(message.data() + offset, payload.size());
+      offset += payload.size();
+    }
+  }
+  pending_packets_.clear();
+  pending_payload_size_ = 0;
   is_message_complete_ = false;
-  return message;
+  return ByteArray(std::move(message));
 }
 
 void Packetizer::Reset() {
   MutexLock lock(&mutex_);
-  pending_payloads_.clear();
+  pending_packets_.clear();
+  pending_payload_size_ = 0;
   is_message_complete_ = false;
 }
 
@@ -15,7 +15,8 @@
 #ifndef THIRD_PARTY_NEARBY_INTERNAL_WEAVE_PACKETIZER_H_
 #define THIRD_PARTY_NEARBY_INTERNAL_WEAVE_PACKETIZER_H_
 
-#include <string>
+#include <cstddef>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "internal/platform/byte_array.h"
@@ -26,6 +27,11 @@ namespace nearby {
 namespace weave {
 
 // Joins Weave packets to create messages.
+//
+// The packets of a message are kept as they were received until the message
+// is taken, and their payloads are then copied once into a buffer of the
+// message's size. A message that fits in a single packet reuses the packet's
+// buffer.
 class Packetizer {
  public:
   // Adds a Packet to an ongoing message, returning absl::OkStatus() on success.
@@ -47,7 +53,9 @@ class Packetizer {
 
  private:
   Mutex mutex_;
-  std::string pending_payloads_ ABSL_GUARDED_BY(mutex_);
+  std::vector<Packet> pending_packets_ ABSL_GUARDED_BY(mutex_);
+  // The sum of the payload sizes of `pending_packets_`.
+  size_t pending_payload_size_ ABSL_GUARDED_BY(mutex_) = 0;
   bool is_message_complete_ ABSL_GUARDED_BY(mutex_) = false;
 };
 }  // namespace weave
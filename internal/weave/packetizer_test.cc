@@ -116,6 +116,32 @@ TEST(PacketizerTest, TestAddTwoFirstPacketsFails) {
               StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST(PacketizerTest, TestSinglePacketMessage) {
+  Packet packet = Packet::CreateDataPacket(
+      /*is_first_packet=*/true, /*is_last_packet=*/true, ByteArray("hello"));
+  EXPECT_OK(packet.SetPacketCounter(1));
+
+  Packetizer packetizer;
+  EXPECT_OK(packetizer.AddPacket(std::move(packet)));
+  absl::StatusOr<ByteArray> message = packetizer.TakeMessage();
+  ASSERT_OK(message);
+  EXPECT_EQ(message->string_data(), "hello");
+}
+
+TEST(PacketizerTest, TestMessageWithEmptyPackets) {
+  Packetizer packetizer;
+  EXPECT_OK(packetizer.AddPacket(Packet::CreateDataPacket(
+      /*is_first_packet=*/true, /*is_last_packet=*/false, ByteArray())));
+  EXPECT_OK(packetizer.AddPacket(Packet::CreateDataPacket(
+      /*is_first_packet=*/false, /*is_last_packet=*/false, ByteArray("a"))));
+  EXPECT_OK(packetizer.AddPacket(Packet::CreateDataPacket(
+      /*is_first_packet=*/false, /*is_last_packet=*/true, ByteArray("bc"))));
+
+  absl::StatusOr<ByteArray> message = packetizer.TakeMessage();
+  ASSERT_OK(message);
+  EXPECT_EQ(message->string_data(), "abc");
+}
+
 }  // namespace
 }  // namespace weave
 }  // namespace nearby
@@ -20,6 +20,7 @@
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/strings/string_view.h"
 #include "internal/platform/logging.h"
 #include "internal/weave/base_socket.h"
 
@@ -100,7 +101,7 @@ void ServerSocket::OnReceiveControlPacket(Packet packet) {
         absl::InvalidArgumentError("Unexpected control packet type."));
     return;
   }
-  std::string packet_payload = packet.GetPayload();
+  absl::string_view packet_payload = packet.GetPayload();
   if (packet_payload.size() < kMinimumConnectionRequestLength) {
     GetSocketCallback().on_error_cb(absl::InvalidArgumentError(
         "Insufficient length connection request packet received."));
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -30,7 +31,7 @@
 #include "presence/data_element.h"
 #include "presence/implementation/action_factory.h"
 #include "presence/implementation/base_broadcast_request.h"
-#include "presence/implementation/ldt.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 
 namespace nearby {
 namespace presence {
@@ -184,10 +185,8 @@ bool ContainsAny(const std::vector<DataElement>& data_elements,
   return false;
 }
 
-}  // namespace
-
-void AdvertisementDecoder::DecodeBaseAction(
-    absl::string_view serialized_action) {
+void DecodeBaseAction(absl::string_view serialized_action,
+                      std::vector<DataElement>& data_elements) {
   if (serialized_action.empty() || serialized_action.size() > 3) {
     NEARBY_LOGS(WARNING) << "Base NP action \'"
                          << absl::BytesToHexString(serialized_action)
@@ -202,46 +201,39 @@ void AdvertisementDecoder::DecodeBaseAction(
     action.action |= serialized_action[i] << offset;
   }
 
-  ActionFactory::DecodeAction(action, decoded_advertisement_.data_elements);
+  ActionFactory::DecodeAction(action, data_elements);
 }
 
+}  // namespace
+
 absl::StatusOr<std::string> AdvertisementDecoder::DecryptLdt(
-    const std::vector<internal::SharedCredential>& credentials,
-    absl::string_view salt, absl::string_view data_elements) {
-  if (credentials.empty()) {
-    return absl::UnavailableError("No credentials");
+    const LdtDecryptorCache& decryptors, absl::string_view salt,
+    absl::string_view data_elements,
+    Advertisement& decoded_advertisement) const {
+  absl::StatusOr<LdtDecryptorCache::DecryptResult> result =
+      decryptors.DecryptAndVerify(salt, data_elements);
+  if (!result.ok()) {
+    return result.status();
   }
-  for (const auto& credential : credentials) {
-    absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
-        credential.key_seed(),
-        credential.metadata_encryption_key_tag_v0());
-    if (encryptor.ok()) {
-      absl::StatusOr<std::string> result =
-          encryptor->DecryptAndVerify(data_elements, salt);
-      if (result.ok() && result->size() > kBaseMetadataSize) {
-        decoded_advertisement_.public_credential = credential;
-        decoded_advertisement_.metadata_key =
-            result->substr(0, kBaseMetadataSize);
-        return result->substr(kBaseMetadataSize);
-      }
-    }
-  }
-  return absl::UnavailableError(
-      "Couldn't decrypt the message with any credentials");
+  decoded_advertisement.public_credential = std::move(result->credential);
+  decoded_advertisement.metadata_key =
+      result->decrypted.substr(0, kBaseMetadataSize);
+  return result->decrypted.substr(kBaseMetadataSize);
 }
 
 absl::Status AdvertisementDecoder::DecryptDataElements(
-    const DataElement& elem) {
+    const DataElement& elem, Advertisement& decoded_advertisement) const {
   if (elem.GetValue().size() <= kEncryptedIdentityAdditionalLength) {
     return absl::OutOfRangeError(absl::StrFormat(
         "Encrypted identity data element is too short - %d bytes",
         elem.GetValue().size()));
   }
   absl::string_view salt = elem.GetValue().substr(0, kSaltSize);
-  decoded_advertisement_.data_elements.emplace_back(DataElement::kSaltFieldType,
-                                                    salt);
+  decoded_advertisement.data_elements.emplace_back(DataElement::kSaltFieldType,
+                                                   salt);
   absl::string_view encrypted = elem.GetValue().substr(kSaltSize);
-  absl::StatusOr<std::string> decrypted = Decrypt(salt, encrypted);
+  absl::StatusOr<std::string> decrypted =
+      Decrypt(salt, encrypted, decoded_advertisement);
   if (!decrypted.ok()) {
     NEARBY_LOGS(WARNING) << "Failed to decrypt advertisement, status: "
                          << decrypted.status();
@@ -257,38 +249,48 @@ absl::Status AdvertisementDecoder::DecryptDataElements(
       return internal_elem.status();
     }
     if (internal_elem->GetType() == DataElement::kActionFieldType) {
-      DecodeBaseAction(internal_elem->GetValue());
+      DecodeBaseAction(internal_elem->GetValue(),
+                       decoded_advertisement.data_elements);
     } else {
-      decoded_advertisement_.data_elements.push_back(*std::move(internal_elem));
+      decoded_advertisement.data_elements.push_back(*std::move(internal_elem));
     }
   }
   return absl::OkStatus();
 }
 
 absl::StatusOr<std::string> AdvertisementDecoder::Decrypt(
-    absl::string_view salt, absl::string_view encrypted) {
-  for (const auto& scan_filter : scan_request_.scan_filters) {
-    if (!absl::holds_alternative<LegacyPresenceScanFilter>(scan_filter)) {
-      continue;
-    }
-    const std::vector<nearby::internal::SharedCredential>& credentials =
-        absl::get<LegacyPresenceScanFilter>(scan_filter)
-            .remote_public_credentials;
-    if (credentials.empty()) {
-      continue;
-    }
+    absl::string_view salt, absl::string_view encrypted,
+    Advertisement& decoded_advertisement) const {
+  for (const auto& decryptors : scan_filter_decryptors_) {
     absl::StatusOr<std::string> decrypted =
-        DecryptLdt(credentials, salt, encrypted);
+        DecryptLdt(*decryptors, salt, encrypted, decoded_advertisement);
     if (decrypted.ok()) {
       return decrypted;
     }
   }
-  if (credentials_ == nullptr) {
+  if (!has_decryptors_) {
     return absl::FailedPreconditionError("Missing credentials");
   }
+  auto it = decryptors_.find(decoded_advertisement.identity_type);
+  if (it == decryptors_.end()) {
+    return absl::UnavailableError("No credentials");
+  }
 
-  return DecryptLdt((*credentials_)[decoded_advertisement_.identity_type], salt,
-                    encrypted);
+  return DecryptLdt(*it->second, salt, encrypted, decoded_advertisement);
+}
+
+void AdvertisementDecoder::AddScanFilterDecryptors() {
+  for (const auto& scan_filter : scan_request_.scan_filters) {
+    if (!absl::holds_alternative<LegacyPresenceScanFilter>(scan_filter)) {
+      continue;
+    }
+    auto decryptors = std::make_shared<const LdtDecryptorCache>(
+        absl::get<LegacyPresenceScanFilter>(scan_filter)
+            .remote_public_credentials);
+    if (!decryptors->empty()) {
+      scan_filter_decryptors_.push_back(std::move(decryptors));
+    }
+  }
 }
 
 void AdvertisementDecoder::AddBannedDataTypes() {
@@ -321,11 +323,8 @@ void AdvertisementDecoder::AddBannedDataTypes() {
 }
 
 absl::StatusOr<Advertisement> AdvertisementDecoder::DecodeAdvertisement(
-    absl::string_view advertisement) {
-  // Let's keep the result advertisement in a member variable to avoid passing
-  // it around all the time.
-  decoded_advertisement_ = Advertisement{};
-  std::vector<DataElement> result;
+    absl::string_view advertisement) const {
+  Advertisement decoded_advertisement;
   NEARBY_LOGS(INFO) << "Advertisement: "
                     << absl::BytesToHexString(advertisement);
   if (advertisement.empty()) {
@@ -337,7 +336,7 @@ absl::StatusOr<Advertisement> AdvertisementDecoder::DecodeAdvertisement(
     return absl::UnimplementedError(absl::StrFormat(
         "Advertisement version (%d) is not supported", version));
   }
-  decoded_advertisement_.version = version;
+  decoded_advertisement.version = version;
   size_t index = 1;
   absl::StatusOr<std::string> decrypted;
   while (index < advertisement.size()) {
@@ -356,26 +355,26 @@ absl::StatusOr<Advertisement> AdvertisementDecoder::DecodeAdvertisement(
                           elem->GetType()));
     }
     if (IsIdentity(elem->GetType())) {
-      decoded_advertisement_.identity_type = GetIdentityType(elem->GetType());
+      decoded_advertisement.identity_type = GetIdentityType(elem->GetType());
     }
     if (IsEncryptedIdentity(elem->GetType())) {
-      absl::Status status = DecryptDataElements(*elem);
+      absl::Status status = DecryptDataElements(*elem, decoded_advertisement);
       if (!status.ok()) {
         return status;
       }
     } else {
       if (elem->GetType() == DataElement::kActionFieldType) {
-        DecodeBaseAction(elem->GetValue());
+        DecodeBaseAction(elem->GetValue(), decoded_advertisement.data_elements);
       } else {
-        decoded_advertisement_.data_elements.push_back(*std::move(elem));
+        decoded_advertisement.data_elements.push_back(*std::move(elem));
       }
     }
   }
-  return std::move(decoded_advertisement_);
+  return decoded_advertisement;
 }
 
 bool AdvertisementDecoder::MatchesScanFilter(
-    const std::vector<DataElement>& data_elements) {
+    const std::vector<DataElement>& data_elements) const {
   // The advertisement matches the scan request when it matches at least
   // one of the filters in the request.
   if (scan_request_.scan_filters.empty()) {
@@ -399,14 +398,14 @@ bool AdvertisementDecoder::MatchesScanFilter(
 
 bool AdvertisementDecoder::MatchesScanFilter(
     const std::vector<DataElement>& data_elements,
-    const PresenceScanFilter& filter) {
+    const PresenceScanFilter& filter) const {
   // The advertisement must contain all Data Elements in scan request.
   return ContainsAll(data_elements, filter.extended_properties);
 }
 
 bool AdvertisementDecoder::MatchesScanFilter(
     const std::vector<DataElement>& data_elements,
-    const LegacyPresenceScanFilter& filter) {
+    const LegacyPresenceScanFilter& filter) const {
   // The advertisement must:
   // * contain any Action from scan request,
   // * contain all Data Elements in scan request.
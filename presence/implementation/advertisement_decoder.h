@@ -15,7 +15,9 @@
 #ifndef THIRD_PARTY_NEARBY_PRESENCE_ADVERTISEMENT_DECODER_H_
 #define THIRD_PARTY_NEARBY_PRESENCE_ADVERTISEMENT_DECODER_H_
 
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -25,6 +27,7 @@
 #include "internal/platform/implementation/credential_callbacks.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_element.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 #include "presence/scan_request.h"
 
 namespace nearby {
@@ -39,58 +42,85 @@ struct Advertisement {
   std::string metadata_key;
 };
 
-// Decodes BLE NP advertisements
+// Decodes BLE NP advertisements.
+//
+// Decoding doesn't change the decoder, so one decoder can decode
+// advertisements on several threads at the same time.
 class AdvertisementDecoder {
  public:
   using IdentityType = ::nearby::internal::IdentityType;
+  using Decryptors =
+      absl::flat_hash_map<IdentityType,
+                          std::shared_ptr<const LdtDecryptorCache>>;
 
   AdvertisementDecoder(
       ScanRequest scan_request,
       absl::flat_hash_map<IdentityType,
                           std::vector<internal::SharedCredential>>* credentials)
-      : scan_request_(scan_request), credentials_(credentials) {
+      : scan_request_(scan_request), has_decryptors_(true) {
     AddBannedDataTypes();
+    AddScanFilterDecryptors();
+    for (const auto& [identity_type, identity_credentials] : *credentials) {
+      decryptors_[identity_type] =
+          std::make_shared<const LdtDecryptorCache>(identity_credentials);
+    }
   }
 
   explicit AdvertisementDecoder(ScanRequest scan_request)
       : scan_request_(scan_request) {
     AddBannedDataTypes();
+    AddScanFilterDecryptors();
   }
 
   static std::vector<CredentialSelector> GetCredentialSelectors(
       const ScanRequest& scan_request);
 
+  // Replaces the decryptors for the credentials of `identity_type`. Copies of
+  // this decoder share the decryptors, so a copy updated this way doesn't
+  // rebuild the others.
+  void UpdateDecryptors(IdentityType identity_type,
+                        std::shared_ptr<const LdtDecryptorCache> decryptors) {
+    decryptors_[identity_type] = std::move(decryptors);
+    has_decryptors_ = true;
+  }
+
   // Returns a list of Data Elements decoded from the advertisement.
   // Returns an error if the advertisement is misformatted or if it couldn't be
   // decrypted.
   absl::StatusOr<Advertisement> DecodeAdvertisement(
-      absl::string_view advertisement);
+      absl::string_view advertisement) const;
 
   // Returns true if the decoded advertisement in `data_elements` matches the
   // filters in `scan_request`.
-  bool MatchesScanFilter(const std::vector<DataElement>& data_elements);
+  bool MatchesScanFilter(const std::vector<DataElement>& data_elements) const;
 
  private:
   // Decrypts data elements stored inside encrypted `elem` and appends them to
-  // `decoded_advertisement_`.
-  absl::Status DecryptDataElements(const DataElement& elem);
-  absl::StatusOr<std::string> Decrypt(absl::string_view salt,
-                                      absl::string_view encrypted);
-  void DecodeBaseAction(absl::string_view serialized_action);
+  // `decoded_advertisement`.
+  absl::Status DecryptDataElements(const DataElement& elem,
+                                   Advertisement& decoded_advertisement) const;
+  absl::StatusOr<std::string> Decrypt(
+      absl::string_view salt, absl::string_view encrypted,
+      Advertisement& decoded_advertisement) const;
   absl::StatusOr<std::string> DecryptLdt(
-      const std::vector<internal::SharedCredential>& credentials,
-      absl::string_view salt, absl::string_view data_elements);
+      const LdtDecryptorCache& decryptors, absl::string_view salt,
+      absl::string_view data_elements,
+      Advertisement& decoded_advertisement) const;
   void AddBannedDataTypes();
+  void AddScanFilterDecryptors();
   bool MatchesScanFilter(const std::vector<DataElement>& data_elements,
-                         const PresenceScanFilter& filter);
+                         const PresenceScanFilter& filter) const;
   bool MatchesScanFilter(const std::vector<DataElement>& data_elements,
-                         const LegacyPresenceScanFilter& filter);
+                         const LegacyPresenceScanFilter& filter) const;
 
   ScanRequest scan_request_;
-  absl::flat_hash_map<IdentityType, std::vector<internal::SharedCredential>>*
-      credentials_ = nullptr;
+  // Decryptors for the credentials in the legacy scan filters.
+  std::vector<std::shared_ptr<const LdtDecryptorCache>> scan_filter_decryptors_;
+  // Decryptors for the credentials of each identity type. Without any,
+  // encrypted advertisements fail with a FailedPreconditionError.
+  Decryptors decryptors_;
+  bool has_decryptors_ = false;
   absl::flat_hash_set<int> banned_data_types_;
-  Advertisement decoded_advertisement_;
 };
 
 }  // namespace presence
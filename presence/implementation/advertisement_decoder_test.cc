@@ -15,6 +15,7 @@
 #include "presence/implementation/advertisement_decoder.h"
 
 #include <array>
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "internal/platform/byte_array.h"
+#include "internal/platform/count_down_latch.h"
+#include "internal/platform/multi_thread_executor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_element.h"
 #include "presence/scan_request.h"
@@ -221,6 +224,28 @@ TEST(AdvertisementDecoder, DecodeBaseNpPublicAdvertisement) {
                               absl::HexStringToBytes("EE"))));
 }
 
+TEST(AdvertisementDecoder, DecodesOnSeveralThreadsAtOnce) {
+  constexpr int kAdvertisements = 16;
+  const AdvertisementDecoder decoder(GetScanRequest());
+  const std::string advertisement =
+      absl::HexStringToBytes("002041420337C1C2C31BEE");
+  std::atomic<int> decoded = 0;
+  CountDownLatch done(kAdvertisements);
+  MultiThreadExecutor executor(4);
+
+  for (int i = 0; i < kAdvertisements; ++i) {
+    executor.Execute([&]() {
+      if (decoder.DecodeAdvertisement(advertisement).ok()) {
+        ++decoded;
+      }
+      done.CountDown();
+    });
+  }
+
+  EXPECT_TRUE(done.Await().Ok());
+  EXPECT_EQ(decoded, kAdvertisements);
+}
+
 TEST(AdvertisementDecoder, DecodeBaseNpWithTxAndActionFields) {
   std::string salt = "AB";
   AdvertisementDecoder decoder(GetScanRequest());
@@ -0,0 +1,77 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "presence/implementation/decoded_advertisement_cache.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "presence/implementation/advertisement_decoder.h"
+
+namespace nearby {
+namespace presence {
+
+std::optional<absl::StatusOr<Advertisement>> DecodedAdvertisementCache::Lookup(
+    absl::string_view remote_address, absl::string_view advertisement,
+    absl::Time now) {
+  auto it =
+      index_.find(Key{std::string(remote_address), std::string(advertisement)});
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  if (it->second->expires < now) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    return std::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->decoded;
+}
+
+void DecodedAdvertisementCache::Insert(absl::string_view remote_address,
+                                       absl::string_view advertisement,
+                                       absl::StatusOr<Advertisement> decoded,
+                                       absl::Time expires) {
+  if (capacity_ == 0) {
+    return;
+  }
+  Key key{std::string(remote_address), std::string(advertisement)};
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->decoded = std::move(decoded);
+    it->second->expires = expires;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+  if (entries_.size() >= capacity_) {
+    index_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+  entries_.push_front(
+      {.key = key, .decoded = std::move(decoded), .expires = expires});
+  index_.emplace(std::move(key), entries_.begin());
+}
+
+void DecodedAdvertisementCache::Clear() {
+  index_.clear();
+  entries_.clear();
+}
+
+}  // namespace presence
+}  // namespace nearby
@@ -0,0 +1,83 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_DECODED_ADVERTISEMENT_CACHE_H_
+#define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_DECODED_ADVERTISEMENT_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "presence/implementation/advertisement_decoder.h"
+
+namespace nearby {
+namespace presence {
+
+// Remembers what recently found advertisements decoded to, so that the same
+// advertisement found again from the same address is not decoded, and trial
+// decrypted, again. Failures are remembered too: an advertisement that no
+// credential could decrypt is not retried until its entry expires.
+//
+// Holds at most `capacity` advertisements, dropping the least recently used
+// one to make room. Not thread-safe.
+class DecodedAdvertisementCache {
+ public:
+  explicit DecodedAdvertisementCache(size_t capacity) : capacity_(capacity) {}
+  DecodedAdvertisementCache(const DecodedAdvertisementCache&) = delete;
+  DecodedAdvertisementCache& operator=(const DecodedAdvertisementCache&) =
+      delete;
+  DecodedAdvertisementCache(DecodedAdvertisementCache&&) = default;
+
+  // Returns what `advertisement` from `remote_address` decoded to, or
+  // std::nullopt if it isn't cached or its entry expired before `now`.
+  std::optional<absl::StatusOr<Advertisement>> Lookup(
+      absl::string_view remote_address, absl::string_view advertisement,
+      absl::Time now);
+
+  // Caches what `advertisement` from `remote_address` decoded to, until
+  // `expires`.
+  void Insert(absl::string_view remote_address,
+              absl::string_view advertisement,
+              absl::StatusOr<Advertisement> decoded, absl::Time expires);
+
+  // Drops all entries, for example because the credentials changed.
+  void Clear();
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  using Key = std::pair<std::string, std::string>;
+  struct Entry {
+    Key key;
+    absl::StatusOr<Advertisement> decoded;
+    absl::Time expires;
+  };
+
+  const size_t capacity_;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<Key, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace presence
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_DECODED_ADVERTISEMENT_CACHE_H_
@@ -0,0 +1,117 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "presence/implementation/decoded_advertisement_cache.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "protobuf-matchers/protocol-buffer-matchers.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "presence/implementation/advertisement_decoder.h"
+
+namespace nearby {
+namespace presence {
+
+namespace {
+using ::testing::Optional;
+using ::testing::status::StatusIs;
+
+constexpr absl::string_view kAddress = "11:22:33:44:55:66";
+constexpr absl::string_view kOtherAddress = "66:55:44:33:22:11";
+constexpr absl::string_view kAdvertisement = "advertisement";
+const absl::Time kNow = absl::FromUnixSeconds(1000);
+
+Advertisement MakeAdvertisement(std::string metadata_key) {
+  return Advertisement{.metadata_key = std::move(metadata_key)};
+}
+
+TEST(DecodedAdvertisementCache, ReturnsCachedAdvertisement) {
+  DecodedAdvertisementCache cache(/*capacity=*/4);
+
+  cache.Insert(kAddress, kAdvertisement, MakeAdvertisement("key"),
+               kNow + absl::Minutes(1));
+  std::optional<absl::StatusOr<Advertisement>> result =
+      cache.Lookup(kAddress, kAdvertisement, kNow);
+
+  ASSERT_TRUE(result.has_value());
+  ASSERT_OK(*result);
+  EXPECT_EQ((*result)->metadata_key, "key");
+}
+
+TEST(DecodedAdvertisementCache, ReturnsCachedFailure) {
+  DecodedAdvertisementCache cache(/*capacity=*/4);
+
+  cache.Insert(kAddress, kAdvertisement, absl::UnavailableError("no match"),
+               kNow + absl::Minutes(1));
+
+  EXPECT_THAT(cache.Lookup(kAddress, kAdvertisement, kNow),
+              Optional(StatusIs(absl::StatusCode::kUnavailable)));
+}
+
+TEST(DecodedAdvertisementCache, KeysOnAddressAndAdvertisement) {
+  DecodedAdvertisementCache cache(/*capacity=*/4);
+
+  cache.Insert(kAddress, kAdvertisement, MakeAdvertisement("key"),
+               kNow + absl::Minutes(1));
+
+  EXPECT_FALSE(cache.Lookup(kOtherAddress, kAdvertisement, kNow).has_value());
+  EXPECT_FALSE(cache.Lookup(kAddress, "other", kNow).has_value());
+}
+
+TEST(DecodedAdvertisementCache, ExpiredEntryIsDropped) {
+  DecodedAdvertisementCache cache(/*capacity=*/4);
+
+  cache.Insert(kAddress, kAdvertisement, MakeAdvertisement("key"),
+               kNow + absl::Minutes(1));
+
+  EXPECT_FALSE(
+      cache.Lookup(kAddress, kAdvertisement, kNow + absl::Minutes(2))
+          .has_value());
+  EXPECT_EQ(cache.size(), 0);
+}
+
+TEST(DecodedAdvertisementCache, DropsLeastRecentlyUsed) {
+  DecodedAdvertisementCache cache(/*capacity=*/2);
+  absl::Time expires = kNow + absl::Minutes(1);
+
+  cache.Insert(kAddress, "first", MakeAdvertisement("1"), expires);
+  cache.Insert(kAddress, "second", MakeAdvertisement("2"), expires);
+  // Makes "second" the least recently used.
+  EXPECT_TRUE(cache.Lookup(kAddress, "first", kNow).has_value());
+  cache.Insert(kAddress, "third", MakeAdvertisement("3"), expires);
+
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup(kAddress, "first", kNow).has_value());
+  EXPECT_FALSE(cache.Lookup(kAddress, "second", kNow).has_value());
+  EXPECT_TRUE(cache.Lookup(kAddress, "third", kNow).has_value());
+}
+
+TEST(DecodedAdvertisementCache, ClearDropsAllEntries) {
+  DecodedAdvertisementCache cache(/*capacity=*/4);
+
+  cache.Insert(kAddress, kAdvertisement, MakeAdvertisement("key"),
+               kNow + absl::Minutes(1));
+  cache.Clear();
+
+  EXPECT_FALSE(cache.Lookup(kAddress, kAdvertisement, kNow).has_value());
+}
+
+}  // namespace
+}  // namespace presence
+}  // namespace nearby
@@ -15,6 +15,9 @@
 #include "presence/implementation/ldt.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <optional>
 #include <string>
 
@@ -22,6 +25,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #ifdef USE_RUST_LDT
 #include "third_party/beto-core/src/nearby/presence/ldt_np_adv_ffi/include/np_ldt.h"
 #else
@@ -34,6 +38,9 @@ namespace presence {
 namespace {
 // NP LDT library says that 0 is returned when `NpLdtCreate()` fails.
 constexpr uint64_t kInvalidLdtHandle = 0;
+// LDT works on messages of 16 - 31 bytes.
+constexpr size_t kMinLdtDataSize = 16;
+constexpr size_t kMaxLdtDataSize = 31;
 
 template <class T>
 T FromStringView(absl::string_view data) {
@@ -93,7 +100,7 @@ absl::StatusOr<std::string> LdtEncryptor::Encrypt(absl::string_view data,
 }
 
 absl::StatusOr<std::string> LdtEncryptor::DecryptAndVerify(
-    absl::string_view data, absl::string_view salt) {
+    absl::string_view data, absl::string_view salt) const {
   std::string encrypted = std::string(data);
   NP_LDT_RESULT result = NpLdtDecryptAndVerify(
       ldt_decrypt_handle_, reinterpret_cast<uint8_t*>(encrypted.data()),
@@ -105,5 +112,31 @@ absl::StatusOr<std::string> LdtEncryptor::DecryptAndVerify(
       absl::StrFormat("LDT encryption failed, errorcode %d", result));
 }
 
+absl::StatusOr<LdtEncryptor::DecryptManyResult>
+LdtEncryptor::DecryptAndVerifyMany(
+    absl::Span<const LdtEncryptor* const> decryptors, absl::string_view data,
+    absl::string_view salt, size_t first) {
+  if (data.size() < kMinLdtDataSize || data.size() > kMaxLdtDataSize) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("LDT data is %d bytes long, expected %d - %d",
+                        data.size(), kMinLdtDataSize, kMaxLdtDataSize));
+  }
+  NpLdtSalt ldt_salt = FromStringView<NpLdtSalt>(salt);
+  // Decryption works in place, so the buffer is restored before every key.
+  uint8_t buffer[kMaxLdtDataSize];
+  for (size_t tried = 0; tried < decryptors.size(); ++tried) {
+    size_t i = (first + tried) % decryptors.size();
+    memcpy(buffer, data.data(), data.size());
+    if (NpLdtDecryptAndVerify(decryptors[i]->ldt_decrypt_handle_, buffer,
+                              data.size(), ldt_salt) == NP_LDT_SUCCESS) {
+      return DecryptManyResult{
+          .index = i,
+          .decrypted = std::string(reinterpret_cast<const char*>(buffer),
+                                   data.size())};
+    }
+  }
+  return absl::NotFoundError("None of the LDT decryptors verified the data");
+}
+
 }  // namespace presence
 }  // namespace nearby
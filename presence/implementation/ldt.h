@@ -15,11 +15,13 @@
 #ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_H_
 #define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_H_
 
+#include <cstddef>
 #include <string>
 #include <utility>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #ifdef USE_RUST_LDT
 #include "third_party/beto-core/src/nearby/presence/ldt_np_adv_ffi/include/np_ldt.h"
 #else
@@ -56,7 +58,22 @@ class LdtEncryptor {
   // Decrypts `data` and verifies if it was encrypted with a key generated from
   // `key_seed`.
   absl::StatusOr<std::string> DecryptAndVerify(absl::string_view data,
-                                               absl::string_view salt);
+                                               absl::string_view salt) const;
+
+  struct DecryptManyResult {
+    // Index in `decryptors` of the decryptor that verified the message.
+    size_t index;
+    std::string decrypted;
+  };
+
+  // Tries `decryptors` in order, starting at index `first` and wrapping
+  // around, and returns the first one that decrypts and verifies `data`. Same
+  // as calling `DecryptAndVerify()` on each of them, but the message is checked
+  // and the salt is converted only once, and all attempts share one buffer
+  // instead of copying the message for each key.
+  static absl::StatusOr<DecryptManyResult> DecryptAndVerifyMany(
+      absl::Span<const LdtEncryptor* const> decryptors, absl::string_view data,
+      absl::string_view salt, size_t first = 0);
 
  private:
   explicit LdtEncryptor(NpLdtEncryptHandle ldt_encrypt_handle,
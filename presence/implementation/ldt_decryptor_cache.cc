@@ -0,0 +1,106 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "presence/implementation/ldt_decryptor_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "internal/platform/logging.h"
+#include "internal/proto/credential.pb.h"
+#include "presence/implementation/base_broadcast_request.h"
+#include "presence/implementation/ldt.h"
+
+namespace nearby {
+namespace presence {
+
+namespace {
+// Sizes of `NpLdtKeySeed` and `NpMetadataKeyHmac`.
+constexpr size_t kKeySeedSize = 32;
+constexpr size_t kMetadataKeyTagSize = 32;
+// LDT works on 16 - 31 bytes, and the plaintext has to hold more than the
+// metadata key.
+constexpr size_t kMinEncryptedSize = std::max<size_t>(16, kBaseMetadataSize + 1);
+constexpr size_t kMaxEncryptedSize = 31;
+}  // namespace
+
+LdtDecryptorCache::LdtDecryptorCache(
+    const std::vector<internal::SharedCredential>& credentials) {
+  absl::flat_hash_set<std::string> keys;
+  entries_.reserve(credentials.size());
+  for (const internal::SharedCredential& credential : credentials) {
+    if (credential.key_seed().size() != kKeySeedSize ||
+        credential.metadata_encryption_key_tag_v0().size() !=
+            kMetadataKeyTagSize) {
+      continue;
+    }
+    if (!keys.insert(absl::StrCat(credential.key_seed(),
+                                  credential.metadata_encryption_key_tag_v0()))
+             .second) {
+      continue;
+    }
+    absl::StatusOr<LdtEncryptor> decryptor =
+        LdtEncryptor::Create(credential.key_seed(),
+                             credential.metadata_encryption_key_tag_v0());
+    if (!decryptor.ok()) {
+      NEARBY_LOGS(WARNING) << "Failed to create LDT decryptor, status: "
+                           << decryptor.status();
+      continue;
+    }
+    entries_.push_back({credential, *std::move(decryptor)});
+  }
+  decryptors_.reserve(entries_.size());
+  for (const Entry& entry : entries_) {
+    decryptors_.push_back(&entry.decryptor);
+  }
+}
+
+absl::StatusOr<LdtDecryptorCache::DecryptResult>
+LdtDecryptorCache::DecryptAndVerify(absl::string_view salt,
+                                    absl::string_view encrypted) const {
+  if (entries_.empty()) {
+    return absl::UnavailableError("No credentials");
+  }
+  if (encrypted.size() < kMinEncryptedSize ||
+      encrypted.size() > kMaxEncryptedSize) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Encrypted data is %d bytes long, expected %d - %d", encrypted.size(),
+        kMinEncryptedSize, kMaxEncryptedSize));
+  }
+  // Start with the last match, then go through the rest.
+  absl::StatusOr<LdtEncryptor::DecryptManyResult> result =
+      LdtEncryptor::DecryptAndVerifyMany(
+          decryptors_, encrypted, salt,
+          last_match_.load(std::memory_order_relaxed));
+  if (!result.ok()) {
+    return absl::UnavailableError(
+        "Couldn't decrypt the message with any credentials");
+  }
+  last_match_.store(result->index, std::memory_order_relaxed);
+  return DecryptResult{.credential = entries_[result->index].credential,
+                       .decrypted = std::move(result->decrypted)};
+}
+
+}  // namespace presence
+}  // namespace nearby
@@ -0,0 +1,85 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_DECRYPTOR_CACHE_H_
+#define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_DECRYPTOR_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "internal/proto/credential.pb.h"
+#include "presence/implementation/ldt.h"
+
+namespace nearby {
+namespace presence {
+
+// LDT decryptors for a list of credentials, created up front.
+//
+// Creating an `LdtEncryptor` derives its keys from the credential's key seed,
+// which costs more than the trial decryption itself. This class does it once,
+// when the credentials change, instead of for every received advertisement.
+//
+// Credentials that cannot verify any advertisement (with a key seed or a
+// metadata key tag of the wrong size) are left out, and so are duplicates.
+// The credential that verified last is tried first, because scan results keep
+// reporting the same nearby devices.
+//
+// Thread-safe: advertisements may be decrypted on several threads at once.
+class LdtDecryptorCache {
+ public:
+  struct DecryptResult {
+    internal::SharedCredential credential;
+    // The decrypted metadata key followed by the decrypted data elements.
+    std::string decrypted;
+  };
+
+  LdtDecryptorCache() = default;
+  explicit LdtDecryptorCache(
+      const std::vector<internal::SharedCredential>& credentials);
+  LdtDecryptorCache(const LdtDecryptorCache&) = delete;
+  LdtDecryptorCache& operator=(const LdtDecryptorCache&) = delete;
+
+  // Returns the number of credentials with a decryptor.
+  size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+  // Decrypts `encrypted` (the metadata key and the data elements) with the
+  // first credential that verifies it. Ciphertexts of a length LDT can't have
+  // produced are rejected without trying any credential.
+  absl::StatusOr<DecryptResult> DecryptAndVerify(
+      absl::string_view salt, absl::string_view encrypted) const;
+
+ private:
+  struct Entry {
+    internal::SharedCredential credential;
+    LdtEncryptor decryptor;
+  };
+
+  std::vector<Entry> entries_;
+  // The decryptors in `entries_`, in the same order, for
+  // `LdtEncryptor::DecryptAndVerifyMany()`.
+  std::vector<const LdtEncryptor*> decryptors_;
+  // Index in `entries_` of the credential that verified last.
+  mutable std::atomic<size_t> last_match_{0};
+};
+
+}  // namespace presence
+}  // namespace nearby
+
+#endif  // THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_LDT_DECRYPTOR_CACHE_H_
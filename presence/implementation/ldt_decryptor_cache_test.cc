@@ -0,0 +1,135 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "presence/implementation/ldt_decryptor_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "protobuf-matchers/protocol-buffer-matchers.h"
+#include "gtest/gtest.h"
+#include "absl/strings/escaping.h"
+#include "internal/platform/byte_array.h"
+#include "internal/proto/credential.pb.h"
+
+namespace nearby {
+namespace presence {
+
+namespace {
+using ::nearby::ByteArray;  // NOLINT
+using ::nearby::internal::SharedCredential;
+using ::protobuf_matchers::EqualsProto;
+using ::testing::status::StatusIs;
+
+TEST(LdtDecryptorCache, SkipsCredentialsWithWrongKeySizes) {
+  SharedCredential credential;
+  credential.set_key_seed("short seed");
+  credential.set_metadata_encryption_key_tag_v0("short tag");
+
+  LdtDecryptorCache cache({credential});
+
+  EXPECT_TRUE(cache.empty());
+}
+
+TEST(LdtDecryptorCache, EmptyCacheFails) {
+  LdtDecryptorCache cache;
+
+  EXPECT_THAT(cache.DecryptAndVerify("AB", std::string(20, 'x')),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
+#ifdef USE_RUST_LDT
+
+// Salt "AB" and encrypted metadata key and data elements of a private identity
+// advertisement created with `GetCredential()`.
+constexpr absl::string_view kSalt = "AB";
+constexpr absl::string_view kEncryptedBase16 =
+    "c2c30e79fee14599e36e34d5d42e49fc37b0df";
+
+SharedCredential GetCredential() {
+  // Values copied from LDT tests
+  ByteArray seed({204, 219, 36, 137, 233, 252, 172, 66, 179, 147, 72,
+                  184, 148, 30, 209, 154, 29,  54,  14, 117, 224, 152,
+                  200, 193, 94, 107, 28,  194, 182, 32, 205, 57});
+  ByteArray known_mac({223, 185, 10,  31,  155, 31, 226, 141, 24,  187, 204,
+                       165, 34,  64,  181, 204, 44, 203, 95,  141, 82,  137,
+                       163, 203, 100, 235, 53,  65, 202, 97,  75,  180});
+  SharedCredential credential;
+  credential.set_key_seed(seed.AsStringView());
+  credential.set_metadata_encryption_key_tag_v0(known_mac.AsStringView());
+  return credential;
+}
+
+SharedCredential GetOtherCredential() {
+  SharedCredential credential = GetCredential();
+  credential.set_key_seed(std::string(32, 'k'));
+  return credential;
+}
+
+TEST(LdtDecryptorCache, DecryptsWithMatchingCredential) {
+  ByteArray metadata_key(
+      {205, 104, 63, 225, 161, 209, 248, 70, 84, 61, 10, 19, 212, 174});
+  LdtDecryptorCache cache({GetOtherCredential(), GetCredential()});
+
+  absl::StatusOr<LdtDecryptorCache::DecryptResult> result =
+      cache.DecryptAndVerify(kSalt, absl::HexStringToBytes(kEncryptedBase16));
+
+  ASSERT_OK(result);
+  EXPECT_THAT(result->credential, EqualsProto(GetCredential()));
+  EXPECT_EQ(result->decrypted.substr(0, metadata_key.size()),
+            metadata_key.AsStringView());
+}
+
+TEST(LdtDecryptorCache, FailsWithoutMatchingCredential) {
+  LdtDecryptorCache cache({GetOtherCredential()});
+
+  EXPECT_THAT(
+      cache.DecryptAndVerify(kSalt, absl::HexStringToBytes(kEncryptedBase16)),
+      StatusIs(absl::StatusCode::kUnavailable));
+}
+
+TEST(LdtDecryptorCache, RejectsEncryptedDataOfWrongLength) {
+  LdtDecryptorCache cache({GetCredential()});
+
+  EXPECT_THAT(cache.DecryptAndVerify(kSalt, std::string(14, 'x')),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_THAT(cache.DecryptAndVerify(kSalt, std::string(32, 'x')),
+              StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(LdtDecryptorCache, SkipsDuplicateCredentials) {
+  LdtDecryptorCache cache({GetCredential(), GetCredential()});
+
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(LdtDecryptorCache, KeepsDecryptingAfterMatchingCredentialMovesFirst) {
+  LdtDecryptorCache cache({GetOtherCredential(), GetCredential()});
+
+  ASSERT_OK(
+      cache.DecryptAndVerify(kSalt, absl::HexStringToBytes(kEncryptedBase16)));
+  absl::StatusOr<LdtDecryptorCache::DecryptResult> result =
+      cache.DecryptAndVerify(kSalt, absl::HexStringToBytes(kEncryptedBase16));
+
+  ASSERT_OK(result);
+  EXPECT_THAT(result->credential, EqualsProto(GetCredential()));
+}
+
+#endif /*USE_RUST_LDT*/
+
+}  // namespace
+}  // namespace presence
+}  // namespace nearby
@@ -14,6 +14,7 @@
 #include "presence/implementation/ldt.h"
 
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
@@ -100,6 +101,79 @@ TEST(Ldt, DecryptAndroidData) {
   EXPECT_EQ(*decrypted, absl::HexStringToBytes(kPlainTextBase16));
 }
 
+TEST(Ldt, DecryptAndVerifyManyReturnsMatchingDecryptor) {
+  SharedCredential shared_credential;
+  ASSERT_TRUE(shared_credential.ParseFromString(
+      absl::HexStringToBytes(kSharedCredentialBase16)));
+  absl::StatusOr<LdtEncryptor> other1 = LdtEncryptor::Create(
+      std::string(32, 'a'), shared_credential.metadata_encryption_key_tag_v0());
+  absl::StatusOr<LdtEncryptor> other2 = LdtEncryptor::Create(
+      std::string(32, 'b'), shared_credential.metadata_encryption_key_tag_v0());
+  absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+      shared_credential.key_seed(),
+      shared_credential.metadata_encryption_key_tag_v0());
+  ASSERT_OK(other1);
+  ASSERT_OK(other2);
+  ASSERT_OK(encryptor);
+  std::vector<const LdtEncryptor*> decryptors = {&*other1, &*encryptor,
+                                                 &*other2};
+
+  absl::StatusOr<LdtEncryptor::DecryptManyResult> result =
+      LdtEncryptor::DecryptAndVerifyMany(
+          decryptors, absl::HexStringToBytes(kCipherTextBase16),
+          absl::HexStringToBytes(kSaltBase16));
+
+  ASSERT_OK(result);
+  EXPECT_EQ(result->index, 1);
+  EXPECT_EQ(result->decrypted, absl::HexStringToBytes(kPlainTextBase16));
+}
+
+TEST(Ldt, DecryptAndVerifyManyStartsAtFirstAndWrapsAround) {
+  SharedCredential shared_credential;
+  ASSERT_TRUE(shared_credential.ParseFromString(
+      absl::HexStringToBytes(kSharedCredentialBase16)));
+  absl::StatusOr<LdtEncryptor> other = LdtEncryptor::Create(
+      std::string(32, 'a'), shared_credential.metadata_encryption_key_tag_v0());
+  absl::StatusOr<LdtEncryptor> encryptor = LdtEncryptor::Create(
+      shared_credential.key_seed(),
+      shared_credential.metadata_encryption_key_tag_v0());
+  ASSERT_OK(other);
+  ASSERT_OK(encryptor);
+  std::vector<const LdtEncryptor*> decryptors = {&*encryptor, &*other,
+                                                 &*encryptor, &*other};
+
+  absl::StatusOr<LdtEncryptor::DecryptManyResult> result =
+      LdtEncryptor::DecryptAndVerifyMany(
+          decryptors, absl::HexStringToBytes(kCipherTextBase16),
+          absl::HexStringToBytes(kSaltBase16), /*first=*/1);
+  ASSERT_OK(result);
+  EXPECT_EQ(result->index, 2);
+
+  result = LdtEncryptor::DecryptAndVerifyMany(
+      decryptors, absl::HexStringToBytes(kCipherTextBase16),
+      absl::HexStringToBytes(kSaltBase16), /*first=*/3);
+  ASSERT_OK(result);
+  EXPECT_EQ(result->index, 0);
+  EXPECT_EQ(result->decrypted, absl::HexStringToBytes(kPlainTextBase16));
+}
+
+TEST(Ldt, DecryptAndVerifyManyNoMatch) {
+  SharedCredential shared_credential;
+  ASSERT_TRUE(shared_credential.ParseFromString(
+      absl::HexStringToBytes(kSharedCredentialBase16)));
+  absl::StatusOr<LdtEncryptor> other = LdtEncryptor::Create(
+      std::string(32, 'a'), shared_credential.metadata_encryption_key_tag_v0());
+  ASSERT_OK(other);
+  std::vector<const LdtEncryptor*> decryptors = {&*other};
+
+  EXPECT_EQ(LdtEncryptor::DecryptAndVerifyMany(
+                decryptors, absl::HexStringToBytes(kCipherTextBase16),
+                absl::HexStringToBytes(kSaltBase16))
+                .status()
+                .code(),
+            absl::StatusCode::kNotFound);
+}
+
 #else
 TEST(Ldt, LdtUnvailable) {
   ByteArray seed({204, 219, 36, 137, 233, 252, 172, 66, 179, 147, 72,
@@ -117,6 +191,17 @@ TEST(Ldt, LdtUnvailable) {
 }
 #endif
 
+TEST(Ldt, DecryptAndVerifyManyRejectsInvalidLength) {
+  EXPECT_EQ(LdtEncryptor::DecryptAndVerifyMany({}, std::string(15, 'a'), "ab")
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(LdtEncryptor::DecryptAndVerifyMany({}, std::string(32, 'a'), "ab")
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
 }  // namespace
 }  // namespace presence
 }  // namespace nearby
@@ -15,21 +15,29 @@
 #include "presence/implementation/scan_manager.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/variant.h"
+#include "internal/platform/byte_array.h"
 #include "internal/platform/implementation/crypto.h"
 #include "internal/platform/future.h"
 #include "internal/platform/implementation/ble_v2.h"
 #include "internal/platform/implementation/credential_callbacks.h"
+#include "internal/platform/mutex_lock.h"
+#include "internal/platform/system_clock.h"
 #include "internal/platform/uuid.h"
 #include "presence/data_types.h"
 #include "presence/implementation/advertisement_decoder.h"
+#include "presence/implementation/ldt_decryptor_cache.h"
 #include "presence/implementation/mediums/ble.h"
 #include "presence/presence_device.h"
 #include "presence/scan_request.h"
@@ -42,8 +50,48 @@ using BleAdvertisementData = ::nearby::api::ble_v2::BleAdvertisementData;
 using BlePeripheral = ::nearby::api::ble_v2::BlePeripheral;
 using ScanningSession = ::nearby::api::ble_v2::BleMedium::ScanningSession;
 using ScanningCallback = ::nearby::api::ble_v2::BleMedium::ScanningCallback;
+
+// Returns until when `advertisement`, decoded at `now`, may be cached. Both are
+// on the SystemClock::ElapsedRealtime() clock, while the credential's end time
+// is Unix time, so only the time left until it is taken from the wall clock.
+absl::Time GetCacheExpiry(const absl::StatusOr<Advertisement>& advertisement,
+                          absl::Time now) {
+  absl::Duration ttl = ScanManager::kDecodedAdvertisementTtl;
+  if (!advertisement.ok() || !advertisement->public_credential.ok()) {
+    return now + ttl;
+  }
+  int64_t credential_end_millis =
+      advertisement->public_credential->end_time_millis();
+  if (credential_end_millis > 0) {
+    ttl = std::clamp(absl::FromUnixMillis(credential_end_millis) - absl::Now(),
+                     absl::ZeroDuration(), ttl);
+  }
+  return now + ttl;
+}
 }  // namespace
 
+ScanManager::~ScanManager() {
+  decode_executor_.Shutdown();
+  MutexLock lock(&decodes_mutex_);
+  while (decodes_in_flight_ > 0) {
+    decodes_done_.Wait();
+  }
+}
+
+ScanManager::DecodeInFlight::DecodeInFlight(ScanManager* manager)
+    : manager_(manager) {
+  MutexLock lock(&manager_->decodes_mutex_);
+  ++manager_->decodes_in_flight_;
+}
+
+ScanManager::DecodeInFlight::~DecodeInFlight() {
+  if (manager_ == nullptr) return;
+  MutexLock lock(&manager_->decodes_mutex_);
+  if (--manager_->decodes_in_flight_ == 0) {
+    manager_->decodes_done_.Notify();
+  }
+}
+
 ScanSessionId ScanManager::StartScan(ScanRequest scan_request,
                                      ScanCallback cb) {
   ScanSessionId id = nearby::RandData<ScanSessionId>();
@@ -74,7 +122,9 @@ ScanSessionId ScanManager::StartScan(ScanRequest scan_request,
                 {id, ScanSessionState{
                          .request = scan_request,
                          .callback = std::move(scan_callback),
-                         .decoder = AdvertisementDecoder(scan_request),
+                         .decoder =
+                             std::make_shared<const AdvertisementDecoder>(
+                                 scan_request),
                          .scanning_session = mediums_->GetBle().StartScanning(
                              scan_request, std::move(callback))}});
           });
@@ -106,12 +156,95 @@ void ScanManager::NotifyFoundBle(ScanSessionId id, BleAdvertisementData data,
   if (it == scan_sessions_.end()) {
     return;
   }
-  auto advert = it->second.decoder.DecodeAdvertisement(advertisement_data);
+  ScanSessionState& session = it->second;
+  if (session.queued_advertisements.size() >= kMaxQueuedAdvertisements) {
+    NEARBY_LOGS(VERBOSE) << "Too many advertisements queued for decoding, "
+                            "dropping the one from "
+                         << remote_address;
+    return;
+  }
+  std::optional<absl::StatusOr<Advertisement>> cached =
+      session.decoded_advertisements.Lookup(remote_address, advertisement_data,
+                                            SystemClock::ElapsedRealtime());
+  if (cached.has_value()) {
+    if (session.queued_advertisements.empty()) {
+      NotifyDecodedAdvertisement(session, remote_address, *cached);
+    } else {
+      // Wait for the advertisements found before this one.
+      session.queued_advertisements.push_back(
+          {.remote_address = std::string(remote_address),
+           .advertisement = std::move(cached)});
+    }
+    return;
+  }
+  uint64_t sequence =
+      session.first_queued_sequence + session.queued_advertisements.size();
+  session.queued_advertisements.push_back(
+      {.remote_address = std::string(remote_address)});
+  decode_executor_.Execute(
+      "decode-advertisement",
+      [this, id, sequence, decoder = session.decoder,
+       advertisement = std::string(advertisement_data),
+       in_flight = DecodeInFlight(this)]() mutable {
+        absl::StatusOr<Advertisement> advert =
+            decoder->DecodeAdvertisement(advertisement);
+        RunOnServiceControllerThread(
+            "advertisement-decoded",
+            [this, id, sequence, decoder = std::move(decoder),
+             advertisement = std::move(advertisement),
+             advert = std::move(advert), in_flight = std::move(in_flight)]()
+                ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) mutable {
+                  OnAdvertisementDecoded(id, sequence, std::move(decoder),
+                                         advertisement, std::move(advert));
+                });
+      });
+}
+
+void ScanManager::OnAdvertisementDecoded(
+    ScanSessionId id, uint64_t sequence,
+    std::shared_ptr<const AdvertisementDecoder> decoder,
+    absl::string_view advertisement_data,
+    absl::StatusOr<Advertisement> advertisement) {
+  auto it = scan_sessions_.find(id);
+  if (it == scan_sessions_.end()) {
+    return;
+  }
+  ScanSessionState& session = it->second;
+  if (sequence < session.first_queued_sequence ||
+      sequence - session.first_queued_sequence >=
+          session.queued_advertisements.size()) {
+    return;
+  }
+  QueuedAdvertisement& decoded =
+      session.queued_advertisements[sequence - session.first_queued_sequence];
+  // Don't cache what an outdated decoder made of the advertisement.
+  if (decoder == session.decoder) {
+    absl::Time now = SystemClock::ElapsedRealtime();
+    session.decoded_advertisements.Insert(decoded.remote_address,
+                                          advertisement_data, advertisement,
+                                          GetCacheExpiry(advertisement, now));
+  }
+  decoded.advertisement = std::move(advertisement);
+  // Deliver in order: stop at the first advertisement still being decoded.
+  while (!session.queued_advertisements.empty() &&
+         session.queued_advertisements.front().advertisement.has_value()) {
+    QueuedAdvertisement queued =
+        std::move(session.queued_advertisements.front());
+    session.queued_advertisements.pop_front();
+    ++session.first_queued_sequence;
+    NotifyDecodedAdvertisement(session, queued.remote_address,
+                               *queued.advertisement);
+  }
+}
+
+void ScanManager::NotifyDecodedAdvertisement(
+    ScanSessionState& session, absl::string_view remote_address,
+    const absl::StatusOr<Advertisement>& advert) {
   if (!advert.ok()) {
     // This advertisement is not relevant to the current element, skip.
     return;
   }
-  if (it->second.decoder.MatchesScanFilter(advert->data_elements)) {
+  if (session.decoder->MatchesScanFilter(advert->data_elements)) {
     internal::Metadata metadata;
     metadata.set_bluetooth_mac_address(std::string(remote_address));
     PresenceDevice device(DeviceMotion(), metadata, advert->identity_type);
@@ -126,7 +259,7 @@ void ScanManager::NotifyFoundBle(ScanSessionId id, BleAdvertisementData data,
             static_cast<uint8_t>(data_element.GetValue()[0]))));
       }
     }
-    it->second.callback.on_discovered_cb(std::move(device));
+    session.callback.on_discovered_cb(std::move(device));
   }
 }
 
@@ -175,8 +308,11 @@ void ScanManager::UpdateCredentials(ScanSessionId id,
     return;
   }
   ScanSessionState& session = it->second;
-  session.credentials[identity_type] = std::move(credentials);
-  session.decoder = AdvertisementDecoder(session.request, &session.credentials);
+  auto decoder = std::make_shared<AdvertisementDecoder>(*session.decoder);
+  decoder->UpdateDecryptors(
+      identity_type, std::make_shared<const LdtDecryptorCache>(credentials));
+  session.decoder = std::move(decoder);
+  session.decoded_advertisements.Clear();
 }
 
 int ScanManager::ScanningCallbacksLengthForTest() {
@@ -188,5 +324,22 @@ int ScanManager::ScanningCallbacksLengthForTest() {
   return count.Get().GetResult();
 }
 
+void ScanManager::NotifyFoundBleForTest(
+    ScanSessionId id, absl::string_view advertisement,
+    std::vector<std::string> remote_addresses) {
+  RunOnServiceControllerThread(
+      "notify-found-ble-for-test",
+      [this, id, advertisement = std::string(advertisement),
+       remote_addresses = std::move(remote_addresses)]()
+          ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_) {
+            for (const std::string& remote_address : remote_addresses) {
+              BleAdvertisementData data;
+              data.service_data[kPresenceServiceUuid] =
+                  ByteArray(advertisement);
+              NotifyFoundBle(id, std::move(data), remote_address);
+            }
+          });
+}
+
 }  // namespace presence
 }  // namespace nearby
@@ -15,18 +15,29 @@
 #ifndef THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_SCAN_MANAGER_H_
 #define THIRD_PARTY_NEARBY_PRESENCE_IMPLEMENTATION_SCAN_MANAGER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "internal/platform/condition_variable.h"
+#include "internal/platform/multi_thread_executor.h"
+#include "internal/platform/mutex.h"
 #include "internal/platform/single_thread_executor.h"
 #include "internal/proto/credential.pb.h"
 #include "presence/data_types.h"
 #include "presence/implementation/advertisement_decoder.h"
 #include "presence/implementation/credential_manager.h"
+#include "presence/implementation/decoded_advertisement_cache.h"
 #include "presence/implementation/mediums/mediums.h"
 #include "presence/scan_request.h"
 
@@ -35,6 +46,13 @@ namespace presence {
 
 // The instance of ScanManager is owned by `ServiceControllerImpl`.
 // Helping service controller to manage scan requests and callbacks.
+//
+// Found advertisements are decoded on a pool of `kDecodeThreads` threads, so
+// that a burst of them isn't decrypted one by one on the service controller
+// thread. The results go back to their session in the order the
+// advertisements were found. Each session also caches what recently found
+// advertisements decoded to, since the same advertisement from the same
+// device is found many times a second.
 class ScanManager {
  public:
   using SingleThreadExecutor = ::nearby::SingleThreadExecutor;
@@ -46,31 +64,84 @@ class ScanManager {
   using SharedCredential = ::nearby::internal::SharedCredential;
   using IdentityType = ::nearby::internal::IdentityType;
 
+  static constexpr int kDecodeThreads = 4;
+  // Advertisements of a session waiting to be decoded or delivered. Newly
+  // found advertisements are dropped while the session has this many; BLE
+  // scanning reports them again.
+  static constexpr size_t kMaxQueuedAdvertisements = 64;
+  static constexpr size_t kDecodedAdvertisementCacheSize = 256;
+  // How long a decoded advertisement is cached, unless the credential that
+  // decrypted it expires sooner. Updating the credentials clears the cache.
+  static constexpr absl::Duration kDecodedAdvertisementTtl = absl::Minutes(1);
+
   ScanManager(Mediums& mediums, CredentialManager& credential_manager,
               SingleThreadExecutor& executor) {
     mediums_ = &mediums, credential_manager_ = &credential_manager;
     executor_ = &executor;
   }
-  ~ScanManager() = default;
+  // Waits for the advertisements being decoded.
+  ~ScanManager();
 
   ScanSessionId StartScan(ScanRequest scan_request, ScanCallback cb);
   void StopScan(ScanSessionId session_id);
   // Below functions are test only.
   // Reference: go/totw/135#augmenting-the-public-api-for-tests
   int ScanningCallbacksLengthForTest();
+  // Reports `advertisement` as found by the BLE scan of session `id` at each of
+  // `remote_addresses` in turn, all in one task on the service controller
+  // thread, like a burst of advertisements found faster than they're decoded.
+  void NotifyFoundBleForTest(ScanSessionId id, absl::string_view advertisement,
+                             std::vector<std::string> remote_addresses);
 
  private:
+  struct QueuedAdvertisement {
+    std::string remote_address;
+    // Set once decoded.
+    std::optional<absl::StatusOr<Advertisement>> advertisement;
+  };
   struct ScanSessionState {
     ScanRequest request;
     ScanCallback callback;
-    absl::flat_hash_map<IdentityType, std::vector<SharedCredential>>
-        credentials;
-    AdvertisementDecoder decoder;
+    // Replaced, not changed, when credentials are updated: advertisements
+    // being decoded hold on to the decoder they started with. Its LDT
+    // decryptors are rebuilt only for the identity type that was updated.
+    std::shared_ptr<const AdvertisementDecoder> decoder;
     std::unique_ptr<ScanningSession> scanning_session;
+    // Found advertisements, in the order they were found.
+    std::deque<QueuedAdvertisement> queued_advertisements;
+    // Sequence number of the front of `queued_advertisements`.
+    uint64_t first_queued_sequence = 0;
+    DecodedAdvertisementCache decoded_advertisements{
+        kDecodedAdvertisementCacheSize};
+  };
+  // Held by each advertisement on its way through `decode_executor_` and back
+  // to `executor_`. It is released when the decoded advertisement is
+  // delivered, or dropped by a shut down `executor_`.
+  class DecodeInFlight {
+   public:
+    explicit DecodeInFlight(ScanManager* manager);
+    DecodeInFlight(DecodeInFlight&& other)
+        : manager_(std::exchange(other.manager_, nullptr)) {}
+    DecodeInFlight& operator=(DecodeInFlight&&) = delete;
+    ~DecodeInFlight();
+
+   private:
+    ScanManager* manager_;
   };
+
   void NotifyFoundBle(ScanSessionId id, BleAdvertisementData data,
                       absl::string_view remote_address)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  void OnAdvertisementDecoded(
+      ScanSessionId id, uint64_t sequence,
+      std::shared_ptr<const AdvertisementDecoder> decoder,
+      absl::string_view advertisement_data,
+      absl::StatusOr<Advertisement> advertisement)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
+  void NotifyDecodedAdvertisement(ScanSessionState& session,
+                                  absl::string_view remote_address,
+                                  const absl::StatusOr<Advertisement>& advert)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
   void FetchCredentials(ScanSessionId id, const ScanRequest& scan_request)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(*executor_);
   void UpdateCredentials(ScanSessionId id, IdentityType identity_type,
@@ -84,6 +155,11 @@ class ScanManager {
   absl::flat_hash_map<ScanSessionId, ScanSessionState> scan_sessions_
       ABSL_GUARDED_BY(*executor_);
   SingleThreadExecutor* executor_;
+
+  Mutex decodes_mutex_;
+  ConditionVariable decodes_done_{&decodes_mutex_};
+  int decodes_in_flight_ ABSL_GUARDED_BY(decodes_mutex_) = 0;
+  MultiThreadExecutor decode_executor_{kDecodeThreads};
 };
 
 }  // namespace presence
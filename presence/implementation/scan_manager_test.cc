@@ -17,6 +17,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -25,6 +26,7 @@
 #include "gmock/gmock.h"
 #include "protobuf-matchers/protocol-buffer-matchers.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "internal/platform/bluetooth_adapter.h"
 #include "internal/platform/count_down_latch.h"
@@ -34,6 +36,7 @@
 #include "presence/implementation/advertisement_factory.h"
 #include "presence/implementation/base_broadcast_request.h"
 #include "presence/implementation/credential_manager_impl.h"
+#include "presence/implementation/mediums/advertisement_data.h"
 #include "presence/implementation/mediums/ble.h"
 #include "presence/implementation/mediums/mediums.h"
 
@@ -47,6 +50,11 @@ using AdvertisingCallback =
 using ::nearby::SingleThreadExecutor;
 
 using CountDownLatch = ::nearby::CountDownLatch;
+
+// How long to wait for advertisements to be found.
+constexpr absl::Duration kFoundTimeout = absl::Seconds(5);
+// How long to wait for an advertisement that should never be found.
+constexpr absl::Duration kNotFoundTimeout = absl::Milliseconds(100);
 // using ::testing::UnorderedElementsAre;
 using ::testing::Contains;
 
@@ -58,7 +66,7 @@ class ScanManagerTest : public testing::Test {
     env_.Stop();
   }
 
-  std::unique_ptr<AdvertisingSession> StartAdvertisingOn(Ble& ble) {
+  AdvertisementData MakeAdvertisement() {
     PresenceBroadcast::BroadcastSection section = {
         .identity = internal::IDENTITY_TYPE_PUBLIC,
         .extended_properties = MakeDefaultExtendedProperties(),
@@ -71,8 +79,12 @@ class ScanManagerTest : public testing::Test {
     absl::StatusOr<AdvertisementData> advertisement =
         AdvertisementFactory().CreateAdvertisement(request.value());
     EXPECT_OK(advertisement);
+    return advertisement.value();
+  }
+
+  std::unique_ptr<AdvertisingSession> StartAdvertisingOn(Ble& ble) {
     std::unique_ptr<AdvertisingSession> session = ble.StartAdvertising(
-        advertisement.value(), PowerMode::kLowPower,
+        MakeAdvertisement(), PowerMode::kLowPower,
         AdvertisingCallback{.start_advertising_result = [](absl::Status) {}});
     env_.Sync();
     return session;
@@ -114,6 +126,23 @@ class ScanManagerTest : public testing::Test {
   std::vector<DataElement> MakeDefaultExtendedProperties() {
     return {DataElement(ActionBit::kPresenceManagerAction)};
   }
+
+  // Returns `count` distinct remote addresses, so that none of them is found
+  // in the decoded advertisement cache.
+  std::vector<std::string> MakeRemoteAddresses(int count) {
+    std::vector<std::string> remote_addresses;
+    for (int i = 0; i < count; ++i) {
+      remote_addresses.push_back(absl::StrCat("address-", i));
+    }
+    return remote_addresses;
+  }
+
+  // Waits for the tasks posted to `executor_` so far.
+  void SyncExecutor() {
+    CountDownLatch synced(1);
+    executor_.Execute([&synced]() { synced.CountDown(); });
+    EXPECT_TRUE(synced.Await(kFoundTimeout).result());
+  }
   SingleThreadExecutor executor_;
   CredentialManagerImpl credential_manager_{&executor_};
   nearby::MediumEnvironment& env_ = {nearby::MediumEnvironment::Instance()};
@@ -324,6 +353,103 @@ TEST_F(ScanManagerTest, NoDeviceFoundAfterStopScan) {
   executor_.Shutdown();
 }
 
+TEST_F(ScanManagerTest, DecodedAdvertisementsAreDeliveredInOrderFound) {
+  constexpr int kAdvertisements = 40;
+  Mediums mediums;
+  ScanManager manager(mediums, credential_manager_, executor_);
+  std::vector<std::string> remote_addresses =
+      MakeRemoteAddresses(kAdvertisements);
+  std::vector<std::string> found;
+  CountDownLatch found_all(kAdvertisements);
+  ScanSessionId scan_session = manager.StartScan(
+      MakeDefaultScanRequest(),
+      ScanCallback{.start_scan_cb = [](absl::Status status) {},
+                   .on_discovered_cb =
+                       [&](PresenceDevice pd) {
+                         // Runs on `executor_`, one call at a time.
+                         found.push_back(
+                             pd.GetMetadata().bluetooth_mac_address());
+                         found_all.CountDown();
+                       }});
+
+  // Decoded on kDecodeThreads threads, so they may finish in any order.
+  manager.NotifyFoundBleForTest(scan_session, MakeAdvertisement().content,
+                                remote_addresses);
+
+  EXPECT_TRUE(found_all.Await(kFoundTimeout).result());
+  SyncExecutor();
+  EXPECT_EQ(found, remote_addresses);
+  manager.StopScan(scan_session);
+}
+
+TEST_F(ScanManagerTest, DropsAdvertisementsFoundWhileQueueIsFull) {
+  constexpr int kDropped = 10;
+  Mediums mediums;
+  ScanManager manager(mediums, credential_manager_, executor_);
+  std::vector<std::string> remote_addresses =
+      MakeRemoteAddresses(ScanManager::kMaxQueuedAdvertisements + kDropped);
+  std::vector<std::string> found;
+  CountDownLatch found_queued(ScanManager::kMaxQueuedAdvertisements);
+  // Only counted down if a dropped advertisement is found anyway.
+  CountDownLatch found_dropped(ScanManager::kMaxQueuedAdvertisements + 1);
+  ScanSessionId scan_session = manager.StartScan(
+      MakeDefaultScanRequest(),
+      ScanCallback{.start_scan_cb = [](absl::Status status) {},
+                   .on_discovered_cb =
+                       [&](PresenceDevice pd) {
+                         found.push_back(
+                             pd.GetMetadata().bluetooth_mac_address());
+                         found_queued.CountDown();
+                         found_dropped.CountDown();
+                       }});
+
+  // Decoded advertisements are delivered on the thread that is still busy
+  // finding the others, so the queue fills up and the last ones are dropped.
+  manager.NotifyFoundBleForTest(scan_session, MakeAdvertisement().content,
+                                remote_addresses);
+
+  EXPECT_TRUE(found_queued.Await(kFoundTimeout).result());
+  EXPECT_FALSE(found_dropped.Await(kNotFoundTimeout).result());
+  SyncExecutor();
+  remote_addresses.resize(ScanManager::kMaxQueuedAdvertisements);
+  EXPECT_EQ(found, remote_addresses);
+  manager.StopScan(scan_session);
+}
+
+TEST_F(ScanManagerTest, DestructionWaitsForDecodesInFlight) {
+  Mediums mediums;
+  auto manager =
+      std::make_unique<ScanManager>(mediums, credential_manager_, executor_);
+  std::atomic_int found_count = 0;
+  // Only counted down if an advertisement is found after the destruction.
+  CountDownLatch found_after_destruction(1);
+  std::atomic_bool destroyed = false;
+  ScanSessionId scan_session = manager->StartScan(
+      MakeDefaultScanRequest(),
+      ScanCallback{.start_scan_cb = [](absl::Status status) {},
+                   .on_discovered_cb =
+                       [&](PresenceDevice pd) {
+                         ++found_count;
+                         if (destroyed) found_after_destruction.CountDown();
+                       }});
+  manager->NotifyFoundBleForTest(
+      scan_session, MakeAdvertisement().content,
+      MakeRemoteAddresses(ScanManager::kMaxQueuedAdvertisements));
+  // Makes sure the advertisements were handed to the decode threads.
+  EXPECT_EQ(manager->ScanningCallbacksLengthForTest(), 1);
+
+  manager.reset();
+  destroyed = true;
+  int found_before_destruction = found_count;
+
+  // Nothing decoded before the destruction is delivered after it.
+  EXPECT_FALSE(found_after_destruction.Await(kNotFoundTimeout).result());
+  SyncExecutor();
+  EXPECT_EQ(found_count.load(), found_before_destruction);
+  EXPECT_LE(found_before_destruction,
+            static_cast<int>(ScanManager::kMaxQueuedAdvertisements));
+}
+
 }  // namespace
 }  // namespace presence
 }  // namespace nearby